@@ -56,8 +56,13 @@ public:
     virtual std::string getName() const = 0;
     virtual DeviceType getDeviceType() const = 0;
 
+    // Reports handed to TinyUSB so far (latency probe: a change after setAxis
+    // means the update has been queued for the host)
+    uint32_t reportsQueued() const { return m_reportsQueued; }
+
 protected:
-    uint8_t m_interfaceNum = 0;
+    uint8_t  m_interfaceNum  = 0;
+    uint32_t m_reportsQueued = 0;
 };
 
 #endif // ABSTRACT_VIRTUAL_DEVICE_H
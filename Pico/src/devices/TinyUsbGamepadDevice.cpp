@@ -431,6 +431,7 @@ void TinyUsbGamepadDevice::sendReport() {
     // Send the properly formatted report
     tud_hid_n_report(getInterfaceNum(), REPORT_ID_GAMEPAD, reportBuffer, reportSize);
     reportChanged = false;
+    m_reportsQueued++;
 }
 
 uint16_t TinyUsbGamepadDevice::getReportDescriptor(uint8_t* buffer, uint16_t reqlen) {
@@ -275,6 +275,7 @@ void TinyUsbKeyboardDevice::sendReports() {
         tud_hid_n_report(m_interfaceNum, REPORT_ID_KEYBOARD_BOOT,
                         &bootReport, sizeof(bootReport));
         bootReportChanged = false;
+        m_reportsQueued++;
         return; // Only send one report per update
     }
 
@@ -304,6 +305,7 @@ void TinyUsbKeyboardDevice::sendReports() {
         tud_hid_n_report(m_interfaceNum, REPORT_ID_CONSUMER_CONTROL,
                         consumerKeys, sizeof(consumerKeys));
         consumerReportChanged = false;
+        m_reportsQueued++;
         return;
     }
 }
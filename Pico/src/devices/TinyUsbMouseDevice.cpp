@@ -178,6 +178,7 @@ void TinyUsbMouseDevice::update() {
 void TinyUsbMouseDevice::sendReport() {
     // Send mouse report
     tud_hid_n_report(m_interfaceNum, REPORT_ID_MOUSE, &mouseReport, sizeof(mouseReport));
+    m_reportsQueued++;
 
     // After sending movement/scroll, reset those values (buttons remain)
     // This prevents repeated movements from a single input
@@ -145,6 +145,7 @@ void XInputDevice::sendReport() {
     if (tud_xinput_ready(gamepadIndex)) {
         tud_xinput_report(gamepadIndex, &report);
         reportChanged = false;
+        m_reportsQueued++;
     }
 }
 
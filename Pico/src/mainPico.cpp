@@ -18,6 +18,7 @@
 #include "../shared/shared.h"
 #include "../shared/PicoConfig.h"
 #include "../shared/crc32.h"
+#include "../shared/LatencyProbe.h"
 #include "UartManagerPico.h"
 #include "PersistentStorage.h"
 #include "devices/AbstractDeviceManager.h"
@@ -42,6 +43,8 @@ static PersistentStorage persistentStorage;
 static Channel<bool>*        rebootChannel = nullptr;
 static Channel<std::string>* logChannel    = nullptr;
 
+static LatencyStampLog stampLog;   // M2P_LATENCY_MARK stamps waiting to go back to Main
+
 static char uartInputBuffer[2120];
 
 // ---------------------------------------------------------------------------
@@ -92,10 +95,20 @@ void reboot() {
 // RPC setup
 // ---------------------------------------------------------------------------
 
+// Packet buffers the link can hold at once: both RPC channels, the framer's
+// read queue plus its staging buffer, and a few handles in hand (the two
+// bridges, the dispatching handler and a caller mid-send). Sizes the Pico's
+// packet slab (COROCRPC_PACKET_POOL), 2 KB per buffer.
+static constexpr int RPC_OUT_QUEUE    = 8;
+static constexpr int RPC_IN_QUEUE     = 8;
+static constexpr int PICO_PACKETS_MAX = RPC_OUT_QUEUE + RPC_IN_QUEUE + StreamFramer::READ_QUEUE + 1 + 4;
+static_assert(PICO_PACKETS_MAX <= COROCRPC_PACKET_POOL,
+              "the RPC link can hold more packets than the slab has; raise COROCRPC_PACKET_POOL");
+
 void initUartRpcSystem() {
     framer    = new StreamFramer();
-    rpcOutCh  = makeChannel<RpcPacket>(8);
-    rpcInCh   = makeChannel<RpcPacket>(8);
+    rpcOutCh  = makeChannel<RpcPacket>(RPC_OUT_QUEUE);
+    rpcInCh   = makeChannel<RpcPacket>(RPC_IN_QUEUE);
     rpcManager = new RpcManager(rpcOutCh, rpcInCh, /*timeoutMs=*/5000);
 
     RpcManager* rpc = rpcManager;
@@ -153,6 +166,53 @@ void initUartRpcSystem() {
         return nullptr;
     });
 
+    // setAxisBatch(int32 count, count × (int32 device, int32 axis, int32 value)) → void
+    // Runs to completion without yielding, so the main loop's next
+    // deviceManager->update() sees the whole batch at once.
+    rpc->registerMethod(M2P_SET_AXIS_BATCH, [](RpcArg* arg) -> RpcArg* {
+        int32_t count = arg->getInt32();
+        if (!deviceManager || count < 0 || count > (corocrpc::RPC_ARG_BUF_SIZE - 4) / 12) return nullptr;
+        toggleDefaultLed();
+        for (int32_t i = 0; i < count; i++) {
+            int32_t device = arg->getInt32();
+            int32_t axis   = arg->getInt32();
+            int32_t value  = arg->getInt32();
+            deviceManager->setAxis(device, axis, value);
+        }
+        return nullptr;
+    });
+
+    // setAxisPacked(varuint count, count × axisUpdate) → void
+    rpc->registerMethod(M2P_SET_AXIS_PACKED, [](RpcArg* arg) -> RpcArg* {
+        uint32_t count = arg->getVarUInt();
+        if (!deviceManager) return nullptr;
+        toggleDefaultLed();
+        int32_t device, axis, value;
+        for (uint32_t i = 0; i < count && arg->getAxisUpdate(device, axis, value); i++)
+            deviceManager->setAxis(device, axis, value);
+        return nullptr;
+    });
+
+    // clockProbe() → int32 receivedUs, int32 repliedUs
+    rpc->registerMethod(M2P_CLOCK_PROBE, [rpc](RpcArg* arg) -> RpcArg* {
+        uint32_t received = time_us_32();
+        RpcArg* out = rpc->getRpcArg();
+        out->putInt32((int32_t)received);
+        out->putInt32((int32_t)time_us_32());
+        return out;
+    });
+
+    // latencyMark(varuint tag, varint device) → void
+    // Handlers run in arrival order, so the batch sent before the mark has
+    // already been applied; the main loop stamps the device's next report.
+    rpc->registerMethod(M2P_LATENCY_MARK, [](RpcArg* arg) -> RpcArg* {
+        uint32_t tag    = arg->getVarUInt();
+        int32_t  device = arg->getVarInt();
+        AbstractVirtualDevice* dev = deviceManager ? deviceManager->getDevice(device) : nullptr;
+        stampLog.mark(tag, device, dev ? dev->reportsQueued() : 0, time_us_32());
+        return nullptr;
+    });
+
     // setUsbConnected(bool connected) → void
     rpc->registerMethod(M2P_SET_USB_CONNECTED, [](RpcArg* arg) -> RpcArg* {
         bool connected = arg->getBool();
@@ -197,27 +257,22 @@ void initUartRpcSystem() {
 
     // ── Transport bridges ─────────────────────────────────────────────────
 
-    // Outbound: rpcOutCh → frame → UART send
+    // Outbound: rpcOutCh → frame in place → UART send
     coro([]() {
         while (true) {
             auto res = rpcOutCh->receive();
             if (res.error) break;
-            FramedPacket fp = framer->createPacket(
-                0, reinterpret_cast<const char*>(res.value.data), res.value.size);
-            if (fp.size > 0)
-                uartManager->sendData(reinterpret_cast<const char*>(fp.data), fp.size);
+            if (StreamFramer::frame(res.value, 0))
+                uartManager->sendData(reinterpret_cast<const char*>(res.value.data()), res.value.size());
         }
     });
 
-    // Inbound: framer.readCh → deframe → rpcInCh
+    // Inbound: framer.readCh → rpcInCh (the deframed buffer is handed over as is)
     coro([]() {
         while (true) {
             auto res = framer->readCh->receive();
             if (res.error) break;
-            static RpcPacket pkt;
-            pkt.size = res.value.getDataSize();
-            memcpy(pkt.data, res.value.getData(), pkt.size);
-            rpcInCh->send(pkt);
+            rpcInCh->send(std::move(res.value));
         }
     });
 }
@@ -232,6 +287,7 @@ static bool rpcOnBoot(const std::string& deviceId, uint32_t configCrc32) {
     RpcArg* arg = rpcManager->getRpcArg();
     arg->putString(deviceId.c_str());
     arg->putInt32(static_cast<int32_t>(configCrc32)); // uint32 sent as int32 bit-pattern
+    arg->putInt32(WIRE_CAP_PACKED_AXIS | WIRE_CAP_LATENCY_PROBE);
     RpcResult res = rpcManager->call(P2M_ON_BOOT, arg);
     rpcManager->disposeRpcArg(arg);
     bool accepted = (res.error == RPC_OK && res.arg && res.arg->getBool());
@@ -346,17 +402,7 @@ int _main() {
         while (true) {
             size_t len = uartManager->read(uartInputBuffer, sizeof(uartInputBuffer));
             if (len == 0) continue;
-            // Feed bytes to framer in MAX_SIZE chunks
-            size_t offset = 0;
-            while (offset < len) {
-                RawChunk chunk;
-                uint16_t chunkLen = static_cast<uint16_t>(
-                    std::min(len - offset, (size_t)RawChunk::MAX_SIZE));
-                memcpy(chunk.data, uartInputBuffer + offset, chunkLen);
-                chunk.len = chunkLen;
-                framer->writeCh->send(chunk);
-                offset += chunkLen;
-            }
+            framer->write(reinterpret_cast<const uint8_t*>(uartInputBuffer), len);   // parsed inline
         }
     });
 
@@ -380,6 +426,19 @@ int _main() {
         }
     });
 
+    // Latency report — sends finished M2P_LATENCY_MARK stamps to Main
+    coro([]() {
+        while (true) {
+            sleep(LatencyStampLog::POLL_MS);
+            while (stampLog.due(time_us_32())) {
+                RpcArg* arg = rpcManager->getRpcArg();
+                stampLog.encode(arg, time_us_32());
+                rpcManager->callNoResponse(P2M_LATENCY_REPORT, arg);
+                rpcManager->disposeRpcArg(arg);
+            }
+        }
+    });
+
     // Periodic heartbeat — sends "Hello world N" to Main every second
     coro([]() {
         int index = 0;
@@ -394,6 +453,10 @@ int _main() {
     // Main loop — update USB devices every tick
     while (true) {
         deviceManager->update();
+        stampLog.poll(time_us_32(), [](int32_t device) {
+            AbstractVirtualDevice* dev = deviceManager->getDevice(device);
+            return dev ? dev->reportsQueued() : 0u;
+        });
         tud_task();
         coro_yield();
     }
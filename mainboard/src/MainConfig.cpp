@@ -62,6 +62,9 @@ static ConfEmulationBoard confEmulationBoardFromJson(const json& j, std::vector<
     b.manufacturer = j.value("manufacturer", "InputProxy");
     b.product      = j.value("product", "InputProxy Device");
     b.serial       = j.value("serial", "000001");
+    b.coalesceWindowUs = j.value("coalesce_window_us", 0);
+    if (b.coalesceWindowUs < 0)
+        errors.push_back("emulation_boards[" + b.id + "]: coalesce_window_us must be >= 0");
     for (const auto& d : j.value("devices", json::array()))
         b.devices.push_back(confVodFromJson(d, errors));
     return b;
@@ -70,7 +73,7 @@ static ConfEmulationBoard confEmulationBoardFromJson(const json& j, std::vector<
 static json confEmulationBoardToJson(const ConfEmulationBoard& b) {
     json devs = json::array();
     for (const auto& d : b.devices) devs.push_back(confVodToJson(d));
-    return json{
+    json j = {
         {"id",           b.id},
         {"vid",          b.vid},
         {"pid",          b.pid},
@@ -79,6 +82,8 @@ static json confEmulationBoardToJson(const ConfEmulationBoard& b) {
         {"serial",       b.serial},
         {"devices",      devs}
     };
+    if (b.coalesceWindowUs != 0) j["coalesce_window_us"] = b.coalesceWindowUs;
+    return j;
 }
 
 static ConfVid confVidFromJson(const json& j) {
@@ -89,7 +94,30 @@ static json confVidToJson(const ConfVid& v) {
     return json{ {"id", v.id}, {"name", v.name} };
 }
 
-static ConfRealDevice confRealDeviceFromJson(const json& j) {
+static ConfAxisFilter confAxisFilterFromJson(const json& j, const std::string& where,
+                                             std::vector<std::string>& errors) {
+    ConfAxisFilter f;
+    f.deadzone   = j.value("deadzone", 0);
+    f.hysteresis = j.value("hysteresis", 0);
+    f.minDelta   = j.value("min_delta", 0);   // JSON key: min_delta
+    if (f.deadzone < 0 || f.deadzone > 999)
+        errors.push_back(where + ": deadzone must be 0..999");
+    if (f.hysteresis < 0 || f.deadzone + f.hysteresis > 999)
+        errors.push_back(where + ": hysteresis must be >= 0 and deadzone + hysteresis <= 999");
+    if (f.minDelta < 0 || f.minDelta > 1000)
+        errors.push_back(where + ": min_delta must be 0..1000");
+    return f;
+}
+
+static json confAxisFilterToJson(const ConfAxisFilter& f) {
+    json j = json::object();
+    if (f.deadzone   != 0) j["deadzone"]   = f.deadzone;
+    if (f.hysteresis != 0) j["hysteresis"] = f.hysteresis;
+    if (f.minDelta   != 0) j["min_delta"]  = f.minDelta;
+    return j;
+}
+
+static ConfRealDevice confRealDeviceFromJson(const json& j, std::vector<std::string>& errors) {
     ConfRealDevice r;
     r.id         = j.value("id", "");
     r.assignedTo = j.value("assignedTo", "");
@@ -98,17 +126,29 @@ static ConfRealDevice confRealDeviceFromJson(const json& j) {
         for (auto kt = it->begin(); kt != it->end(); ++kt)
             if (kt.value().is_string())
                 r.renameAxes[kt.key()] = kt.value().get<std::string>();
+    it = j.find("axis_filters");                  // JSON key: axis_filters
+    if (it != j.end() && it->is_object())
+        for (auto kt = it->begin(); kt != it->end(); ++kt)
+            if (kt.value().is_object())
+                r.axisFilters[kt.key()] = confAxisFilterFromJson(
+                    kt.value(), "real_devices[" + r.id + "].axis_filters[" + kt.key() + "]", errors);
     return r;
 }
 
 static json confRealDeviceToJson(const ConfRealDevice& r) {
     json renames = json::object();
     for (const auto& [k, v] : r.renameAxes) renames[k] = v;
-    return json{
+    json j = {
         {"id",          r.id},
         {"assignedTo",  r.assignedTo},
         {"rename_axes", renames}
     };
+    if (!r.axisFilters.empty()) {
+        json filters = json::object();
+        for (const auto& [k, f] : r.axisFilters) filters[k] = confAxisFilterToJson(f);
+        j["axis_filters"] = filters;
+    }
+    return j;
 }
 
 static ConfAxisEntry confAxisEntryFromJson(const json& j) {
@@ -143,17 +183,20 @@ static ConfAction confActionFromJson(const json& j, std::vector<std::string>& er
     a.axis     = j.value("axis", "");
     a.sequence = j.value("sequence", "");
     a.timeMs   = j.value("time", 0);
+    a.serialize = j.value("serialize", false);
     return a;
 }
 
 static json confActionToJson(const ConfAction& a) {
-    return json{
+    json j = {
         {"type",     serializeConfActionType(a.type)},
         {"vod",      a.vod},
         {"axis",     a.axis},
         {"sequence", a.sequence},
         {"time",     a.timeMs}
     };
+    if (a.serialize) j["serialize"] = true;
+    return j;
 }
 
 static std::vector<ConfAction> parseActionArray(const json& j, std::vector<std::string>& errors) {
@@ -265,6 +308,38 @@ static json confLayerToJson(const ConfLayer& l) {
     };
 }
 
+static ConfPipeline confPipelineFromJson(const json& j) {
+    ConfPipeline p;
+    p.enabled    = j.value("enabled", false);
+    p.ingestCpu  = j.value("ingest_cpu", -1);
+    p.mappingCpu = j.value("mapping_cpu", -1);
+    p.uartWriterCpus = j.value("uart_writer_cpus", std::vector<int>{});
+    p.inlineIo   = j.value("inline_io", false);
+    p.ioUring    = j.value("io_uring", false);
+    p.profile    = j.value("profile", false);
+    p.sliceBudgetUs = j.value("slice_budget_us", 0);
+    p.traceSampleEvery = j.value("trace_sample_every", 0);
+    p.recordPath = j.value("record_path", std::string());
+    p.recordingDir = j.value("recording_dir", std::string());
+    return p;
+}
+
+static json confPipelineToJson(const ConfPipeline& p) {
+    return json{
+        {"enabled",          p.enabled},
+        {"ingest_cpu",       p.ingestCpu},
+        {"mapping_cpu",      p.mappingCpu},
+        {"uart_writer_cpus", p.uartWriterCpus},
+        {"inline_io",        p.inlineIo},
+        {"io_uring",         p.ioUring},
+        {"profile",          p.profile},
+        {"slice_budget_us",  p.sliceBudgetUs},
+        {"trace_sample_every", p.traceSampleEvery},
+        {"record_path",      p.recordPath},
+        {"recording_dir",    p.recordingDir}
+    };
+}
+
 // ── loadConfig / saveConfig ───────────────────────────────────────────────────
 
 bool loadConfig(const std::string& path, std::vector<std::string>& errors) {
@@ -283,9 +358,12 @@ bool loadConfig(const std::string& path, std::vector<std::string>& errors) {
         for (const auto& v : root.value("virtual_input_devices", json::array()))
             local.vids.push_back(confVidFromJson(v));
         for (const auto& r : root.value("real_devices",          json::array()))
-            local.realDevices.push_back(confRealDeviceFromJson(r));
+            local.realDevices.push_back(confRealDeviceFromJson(r, errors));
         for (const auto& l : root.value("layers",                json::array()))
             local.layers.push_back(confLayerFromJson(l, errors));
+        auto pipeIt = root.find("pipeline");
+        if (pipeIt != root.end())
+            local.pipeline = confPipelineFromJson(*pipeIt);
 
         if (!errors.empty()) {
             for (const auto& e : errors)
@@ -319,6 +397,11 @@ bool saveConfig(const std::string& path) {
         root["virtual_input_devices"] = vids;
         root["real_devices"]          = rdevs;
         root["layers"]                = layers;
+        const ConfPipeline& p = gConfig.pipeline;
+        if (p.enabled || p.ingestCpu >= 0 || p.mappingCpu >= 0 || !p.uartWriterCpus.empty() || p.inlineIo
+            || p.ioUring || p.profile || p.sliceBudgetUs > 0 || p.traceSampleEvery > 0
+            || !p.recordPath.empty() || !p.recordingDir.empty())
+            root["pipeline"] = confPipelineToJson(p);
 
         std::ofstream f(path);
         if (!f) {
@@ -345,6 +428,7 @@ std::vector<BoardEntry> buildBoardEntries(const std::vector<ConfEmulationBoard>&
         entry.config.manufacturer = b.manufacturer;
         entry.config.product      = b.product;
         entry.config.serial       = b.serial;
+        entry.coalesceWindowUs    = b.coalesceWindowUs;
 
         bool hasXInput = false;
         for (const auto& d : b.devices) {
@@ -36,6 +36,7 @@ struct ConfEmulationBoard {
     std::string          manufacturer = "InputProxy";
     std::string          product      = "InputProxy Device";
     std::string          serial       = "000001";
+    int                  coalesceWindowUs = 0;   // JSON key: "coalesce_window_us"; setAxis batching window
     std::vector<ConfVod> devices;
 };
 
@@ -45,11 +46,19 @@ struct ConfVid {
     std::string name;
 };
 
+// Matches real_devices[].axis_filters.<axis>; values on the 0..1000 output scale
+struct ConfAxisFilter {
+    int deadzone   = 0;   // |value| <= deadzone reads as 0; the rest is rescaled to 0..1000
+    int hysteresis = 0;   // at rest, the deadzone is left only above deadzone + hysteresis
+    int minDelta   = 0;   // JSON key: "min_delta"; smaller changes are dropped (0 / 1000 always pass)
+};
+
 // Matches real_devices[]
 struct ConfRealDevice {
-    std::string                        id;
-    std::string                        assignedTo;
-    std::map<std::string, std::string> renameAxes;  // JSON key: "rename_axes"; old -> new
+    std::string                           id;
+    std::string                           assignedTo;
+    std::map<std::string, std::string>    renameAxes;   // JSON key: "rename_axes"; old -> new
+    std::map<std::string, ConfAxisFilter> axisFilters;  // JSON key: "axis_filters"; axis name ("*": every ABS axis)
 };
 
 // Axis from/to pair inside a "simple" rule
@@ -78,6 +87,7 @@ struct ConfAction {
     std::string    axis;
     std::string    sequence;
     int            timeMs   = 0;
+    bool           serialize = false;   // output_sequence only: run after earlier ones on the same VOD
 };
 
 // Matches layers[].rules[]
@@ -113,12 +123,29 @@ struct ConfLayer {
     std::optional<ConfActivation> activation;
 };
 
+// Matches pipeline{} — thread layout, read once at startup.
+// CPU numbers < 0 leave that thread unpinned.
+struct ConfPipeline {
+    bool             enabled    = false;   // ingest + UART writers on their own threads
+    int              ingestCpu  = -1;
+    int              mappingCpu = -1;      // scheduler thread (mapping, RPC, REST)
+    std::vector<int> uartWriterCpus;       // by UART link order; missing → unpinned
+    bool             inlineIo   = false;   // scheduler dispatches fd readiness itself (no poll thread hop)
+    bool             ioUring    = false;   // evdev/REST reads through io_uring (single scheduler thread)
+    bool             profile    = false;   // coroutine profiler on from startup (GET /scheduler/profile)
+    int              sliceBudgetUs = 0;    // > 0: log scheduler slices longer than this (turns the profiler on)
+    int              traceSampleEvery = 0; // > 0: trace 1 in N input events end to end (GET /latency)
+    std::string      recordPath;           // non-empty: record the input stream from startup (GET /recording)
+    std::string      recordingDir;         // POST /recording/start writes new files here; empty: disabled
+};
+
 // Top-level config document
 struct ConfRoot {
     std::vector<ConfEmulationBoard> emulationBoards;
     std::vector<ConfVid>            vids;
     std::vector<ConfRealDevice>     realDevices;
     std::vector<ConfLayer>          layers;
+    ConfPipeline                    pipeline;
 };
 
 // ── Runtime artifact (kept here — used by main.cpp and EmulatedDeviceManager) ─
@@ -127,6 +154,7 @@ struct BoardEntry {
     std::string              picoId;
     PicoConfig               config;
     std::vector<std::string> deviceIds;
+    int                      coalesceWindowUs = 0;   // not part of PicoConfig — mainboard-side only
 };
 
 // ── Global config instance ────────────────────────────────────────────────────
@@ -9,8 +9,13 @@
 #include <sys/ioctl.h>
 #include <sys/time.h>
 #include <cerrno>
+#include <thread>
+#include <chrono>
+#include <ctime>
 #include "corocgo/corocgo.h"
 #include "stringutils.h"
+#include "pipeline/LatencyTrace.h"
+#include "pipeline/InputLog.h"
 
 // ---------------------------------------------------------------------------
 // LinuxInputManager
@@ -37,6 +42,12 @@ int LinuxInputManager::openFd(const std::string& path) {
     int fd = open(path.c_str(), O_RDWR | O_NONBLOCK);
     if (fd < 0)
         fd = open(path.c_str(), O_RDONLY | O_NONBLOCK);
+    // Event timestamps on the monotonic clock, comparable with steady_clock
+    // for latency tracing (the default is CLOCK_REALTIME)
+    if (fd >= 0) {
+        int clk = CLOCK_MONOTONIC;
+        ioctl(fd, EVIOCSCLOCKID, &clk);
+    }
     return fd;
 }
 
@@ -137,11 +148,12 @@ RealDevice* RealDeviceManager::registerDevice(const std::string& path) {
         existing->originalAxes= AxisTable{};
         existing->axisInfo.clear();
         existing->centeredAxisMapping.clear();
-        existing->lastAxisValues.clear();
+        existing->axisSlots.clear();
         existing->nextVirtualAxisIndex = 10000;
         existing->mouseXYAxisIndex = -1;
-        existing->pendingRelX = 0;
-        existing->pendingRelY = 0;
+        std::fill(std::begin(existing->pendingRel), std::end(existing->pendingRel), 0);
+        existing->pendingRelMask   = 0;
+        existing->pendingRelFrames = 0;
 
         // Reactivate — reopen fd and re-read capabilities
         if (!openDevice(*existing)) return nullptr;
@@ -165,6 +177,7 @@ RealDevice* RealDeviceManager::registerDevice(const std::string& path) {
 
         existing->active = true;
         applyAxisRenames(*existing);
+        applyAxisFilters(*existing);
         std::cout << "[RealDeviceManager] Device reactivated: "
                   << existing->deviceId << " (" << existing->deviceName << ")" << std::endl;
         return existing;
@@ -201,6 +214,7 @@ RealDevice* RealDeviceManager::registerDevice(const std::string& path) {
     device.deviceIdStr = generateDeviceKey(id.vendor, id.product, device.serial, path, deviceName, axisCount);
     device.deviceId    = nextDeviceId++;
     applyAxisRenames(device);
+    applyAxisFilters(device);
 
     unsigned int assignedId = device.deviceId;
     deviceId2Device[assignedId] = std::move(device);
@@ -260,6 +274,7 @@ bool RealDeviceManager::openDevice(RealDevice& device) {
 bool RealDeviceManager::readDeviceCapabilities(RealDevice& device) {
     unsigned char evBits[(EV_MAX + 7) / 8] = {0};
     if (!linuxInput.readEventBits(device.fd, evBits, sizeof(evBits))) return false;
+    device.axisSlots.assign(KEY_CNT, AxisSlot{});
 
     auto testBit = [](int bit, const unsigned char* array) -> bool {
         return (array[bit / 8] & (1 << (bit % 8))) != 0;
@@ -293,6 +308,7 @@ bool RealDeviceManager::readDeviceCapabilities(RealDevice& device) {
                     device.axes.addEntry(axisName + "+", pos);
                     device.axes.addEntry(axisName + "-", neg);
                     device.centeredAxisMapping[code] = {pos, neg};
+                    device.axisSlots[code].known = true;   // both halves start at 0
                 }
             }
         }
@@ -351,13 +367,19 @@ bool RealDeviceManager::readDeviceCapabilities(RealDevice& device) {
 
 void RealDeviceManager::load(const std::vector<ConfRealDevice>& devices) {
     std::map<std::string, std::map<std::string,std::string>> allAxisRenames;
+    std::map<std::string, std::map<std::string,ConfAxisFilter>> allAxisFilters;
     for (const auto& rd : devices) {
         if (!rd.renameAxes.empty())
             allAxisRenames[rd.id] = rd.renameAxes;
+        if (!rd.axisFilters.empty())
+            allAxisFilters[rd.id] = rd.axisFilters;
     }
     axisRenames = std::move(allAxisRenames);
-    for (auto& [id, device] : deviceId2Device)
+    axisFilters = std::move(allAxisFilters);
+    for (auto& [id, device] : deviceId2Device) {
         applyAxisRenames(device);
+        applyAxisFilters(device);
+    }
 }
 
 void RealDeviceManager::applyAxisRenames(RealDevice& device) {
@@ -375,51 +397,247 @@ void RealDeviceManager::applyAxisRenames(RealDevice& device) {
     }
 }
 
+// Filters are looked up by current (renamed) axis name, then by the raw evdev
+// name; "*" covers every ABS axis without an entry of its own. The settings
+// are resolved first and each slot is stored once, so a reload never shows
+// the ingest thread a cleared axis on its way to the same value.
+void RealDeviceManager::applyAxisFilters(RealDevice& device) {
+    std::vector<ConfAxisFilter> resolved(device.axisSlots.size());
+    auto filtersIt = axisFilters.find(device.deviceIdStr);
+    if (filtersIt != axisFilters.end()) {
+        auto wildcard = filtersIt->second.find("*");
+        if (wildcard != filtersIt->second.end())
+            for (const auto& [code, info] : device.axisInfo)
+                if (info.eventType == EV_ABS && code >= 0 && code < (int)resolved.size())
+                    resolved[code] = wildcard->second;
+
+        for (const auto& [name, f] : filtersIt->second) {
+            if (name == "*") continue;
+            int code = device.axes.getIndex(name);
+            if (code < 0) code = device.originalAxes.getIndex(name);
+            if (code < 0 || code >= (int)resolved.size()) {
+                std::cerr << "[RealDeviceManager] axis_filters: no raw axis \"" << name
+                          << "\" on " << device.deviceIdStr << std::endl;
+                continue;
+            }
+            resolved[code] = f;
+        }
+    }
+
+    for (size_t code = 0; code < resolved.size(); code++) {
+        AxisSlot&             slot = device.axisSlots[code];
+        const ConfAxisFilter& f    = resolved[code];
+        slot.deadzone.store((int16_t)f.deadzone, std::memory_order_relaxed);
+        slot.hysteresis.store((int16_t)f.hysteresis, std::memory_order_relaxed);
+        slot.minDelta.store((int16_t)f.minDelta, std::memory_order_relaxed);
+    }
+}
+
 void RealDeviceManager::closeDevice(RealDevice& device) {
     linuxInput.closeFd(device.fd);
     device.fd = -1;
 }
 
 // ---------------------------------------------------------------------------
-// processDeviceInput — called by device reading coroutine after wait_file
+// processDeviceInput — called by device reading coroutine after wait_file,
+// or by the pipeline ingest thread (external = true)
 // ---------------------------------------------------------------------------
 
-bool RealDeviceManager::processDeviceInput(RealDevice* device, corocgo::Channel<AxisEvent>* channel) {
+// Deadzone (rescaled so the output still spans 0..1000), sticky deadzone
+// edge and min-delta on a signed −1000..1000 value. Updates the slot and
+// returns Pass when `v` (filtered in place) should be sent.
+enum class AxisFilterResult { Pass, Unchanged, BelowMinDelta };
+
+static AxisFilterResult filterAxis(AxisSlot& s, int& v) {
+    int deadzone = s.deadzone.load(std::memory_order_relaxed);
+    int minDelta = s.minDelta.load(std::memory_order_relaxed);
+    int mag  = std::abs(v);
+    int edge = s.resting ? deadzone + s.hysteresis.load(std::memory_order_relaxed) : deadzone;
+    if (mag <= edge) {
+        v = 0;
+        s.resting = true;
+    } else {
+        s.resting = false;
+        if (deadzone > 0) {
+            mag = (mag - deadzone) * 1000 / (1000 - deadzone);
+            v   = v < 0 ? -mag : mag;
+        }
+    }
+    if (s.known) {
+        if (v == s.last) return AxisFilterResult::Unchanged;
+        // Rest and full scale always go through so a release is never lost
+        if (minDelta > 0 && v != 0 && std::abs(v) < 1000 && std::abs(v - s.last) < minDelta)
+            return AxisFilterResult::BelowMinDelta;
+    }
+    s.last  = (int16_t)v;
+    s.known = true;
+    return AxisFilterResult::Pass;
+}
+
+void RealDeviceManager::markDisconnected(RealDevice* device) {
+    device->active = false;
+    closeDevice(*device);
+}
+
+bool RealDeviceManager::processDeviceInput(RealDevice* device, corocgo::Channel<AxisEvent>* channel,
+                                           bool external) {
+    // Read until a short read: edge-triggered waiters (register_fd) are only
+    // woken again by new input, so nothing may be left behind in the fd
     struct input_event events[64];
-    ssize_t bytesRead = linuxInput.readEvents(device->fd, events, sizeof(events));
+    while (true) {
+        ssize_t bytesRead = linuxInput.readEvents(device->fd, events, sizeof(events));
+
+        if (bytesRead < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return true; // nothing yet
+            std::cerr << "[RealDeviceManager] Read error on device " << device->deviceId
+                      << ": " << strerror(errno) << std::endl;
+            if (!external) markDisconnected(device);
+            return false;
+        }
 
-    if (bytesRead < 0) {
-        if (errno == EAGAIN || errno == EWOULDBLOCK) return true; // nothing yet
-        std::cerr << "[RealDeviceManager] Read error on device " << device->deviceId
-                  << ": " << strerror(errno) << std::endl;
-        device->active = false;
-        closeDevice(*device);
-        return false;
-    }
+        if (bytesRead == 0) {
+            std::cout << "[RealDeviceManager] Device disconnected: " << device->deviceId << std::endl;
+            if (!external) markDisconnected(device);
+            return false;
+        }
 
-    if (bytesRead == 0) {
-        std::cout << "[RealDeviceManager] Device disconnected: " << device->deviceId << std::endl;
-        device->active = false;
-        closeDevice(*device);
-        return false;
+        processEvents(device, events,
+                      static_cast<int>(bytesRead) / static_cast<int>(sizeof(struct input_event)),
+                      channel, external);
+        if (bytesRead < static_cast<ssize_t>(sizeof(events))) return true;
     }
+}
 
-    int numEvents = static_cast<int>(bytesRead) / static_cast<int>(sizeof(struct input_event));
+void RealDeviceManager::processEvents(RealDevice* device, const struct input_event* events, int numEvents,
+                                      corocgo::Channel<AxisEvent>* channel, bool external) {
+    // Ingest thread: the external ring is bounded, so wait for the scheduler
+    // to drain it rather than drop input (evdev's kernel buffer absorbs the rest)
+    // Latency tracing: a sampled event carries a trace id stamped with the
+    // evdev time of the input_event that produced it (the EV_SYN for motion)
+    int64_t readNs = gTracer.enabled() ? LatencyTracer::nowNs() : 0;
+    const struct input_event* cur = numEvents > 0 ? &events[0] : nullptr;
+    auto traced = [&readNs, &cur](AxisEvent ev) {
+        if (readNs && cur)
+            ev.trace = gTracer.begin((int64_t)cur->time.tv_sec * 1000000000LL + cur->time.tv_usec * 1000LL, readNs);
+        return ev;
+    };
+
+    // Input recording (gRecorder): every event that reaches the channel, at
+    // the same evdev time
+    auto record = [&cur](const AxisEvent& ev) {
+        if (!gRecorder.active()) return;
+        gRecorder.axisEvent(ev, cur ? (int64_t)cur->time.tv_sec * 1000000000LL + cur->time.tv_usec * 1000LL
+                                    : LatencyTracer::nowNs());
+    };
+
+    auto emit = [channel, external, &traced, &record](const AxisEvent& raw) {
+        AxisEvent ev = traced(raw);
+        if (!external) {
+            channel->send(ev);
+            record(ev);
+            return;
+        }
+        while (!channel->sendExternalNoBlock(ev)) {
+            if (channel->isClosed()) return;
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        record(ev);
+    };
+    auto tryEmit = [channel, external, &traced, &record](const AxisEvent& raw) {
+        AxisEvent ev = traced(raw);
+        bool sent = external ? channel->sendExternalNoBlock(ev) : channel->trySend(ev);
+        if (sent) record(ev);
+        return sent;
+    };
+
+    // Sends the pending relative deltas. With wait == false it stops at the
+    // first update the channel has no room for and keeps the rest pending,
+    // so a saturated link gets one combined delta later instead of a queue
+    // of stale ones. Returns true once nothing is pending.
+    auto flushRel = [&](bool wait) -> bool {
+        while (device->pendingRelMask) {
+            int code = __builtin_ctz(device->pendingRelMask);
+            if (device->mouseXYAxisIndex != -1 && (code == REL_X || code == REL_Y)) {
+                // Packed int16 X | int16 Y; anything beyond int16 goes out next round
+                int& px = device->pendingRel[REL_X];
+                int& py = device->pendingRel[REL_Y];
+                int dx = std::clamp(px, -32768, 32767);
+                int dy = std::clamp(py, -32768, 32767);
+                if (dx != 0 || dy != 0) {
+                    // Cast to uint16_t first to strip sign extension before packing
+                    int32_t packed = (int32_t)((uint32_t)(uint16_t)(int16_t)dx |
+                                               ((uint32_t)(uint16_t)(int16_t)dy << 16));
+                    AxisEvent xy{device->deviceId, device->mouseXYAxisIndex, packed};
+                    if (wait) emit(xy);
+                    else if (!tryEmit(xy)) return false;
+                    px -= dx;
+                    py -= dy;
+                }
+                if (px == 0 && py == 0) device->pendingRelMask &= ~((1u << REL_X) | (1u << REL_Y));
+                continue;
+            }
+
+            int& delta = device->pendingRel[code];
+            auto mappingIt = device->centeredAxisMapping.find(code);
+            if (delta == 0 || mappingIt == device->centeredAxisMapping.end()) {
+                delta = 0;
+                device->pendingRelMask &= ~(1u << code);
+                continue;
+            }
+            // Relative axes are deltas — passed through unscaled, at most 1000 per update.
+            // Both directions are always sent so the mapping manager sees a clean
+            // press/release cycle on each event. The zero on the inactive
+            // direction fires the pending release and resets WaitingForRelease
+            // state; the Pico ignores zero-value motion axis updates.
+            int step = std::clamp(delta, -1000, 1000);
+            AxisEvent pos{device->deviceId, mappingIt->second.first,  step > 0 ? step : 0};
+            AxisEvent neg{device->deviceId, mappingIt->second.second, step < 0 ? -step : 0};
+            if (wait) emit(pos);
+            else if (!tryEmit(pos)) return false;
+            emit(neg);   // completes the pair even if that means waiting
+            delta -= step;
+            if (delta == 0) device->pendingRelMask &= ~(1u << code);
+        }
+        uint64_t merged = (uint64_t)device->pendingRelFrames;
+        relStats.flushes.fetch_add(1, std::memory_order_relaxed);
+        if (merged > relStats.maxMerged.load(std::memory_order_relaxed))
+            relStats.maxMerged.store(merged, std::memory_order_relaxed);
+        device->pendingRelFrames = 0;
+        return true;
+    };
+
+    // Key and absolute events never pass motion a full channel held back:
+    // a click has to land where the cursor was when it happened
+    auto emitInOrder = [&](const AxisEvent& ev) {
+        if (device->pendingRelMask) flushRel(true);
+        emit(ev);
+    };
+
+    auto passFilter = [this](AxisSlot& slot, int& value) {
+        switch (filterAxis(slot, value)) {
+        case AxisFilterResult::Pass:
+            filterStats.passed.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        case AxisFilterResult::Unchanged:
+            filterStats.unchanged.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        case AxisFilterResult::BelowMinDelta:
+            filterStats.minDelta.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return false;
+    };
 
     for (int i = 0; i < numEvents; i++) {
         const struct input_event& ev = events[i];
+        cur = &ev;
 
-        // EV_SYN: flush any accumulated mouse XY delta as a single combined event
+        // EV_SYN: flush the frame's relative deltas as one update per axis
         if (ev.type == EV_SYN) {
-            if (device->mouseXYAxisIndex != -1 &&
-                (device->pendingRelX != 0 || device->pendingRelY != 0)) {
-                // Cast to uint16_t first to strip sign extension before packing
-                int32_t packed = (int32_t)(
-                    (uint32_t)(uint16_t)(int16_t)device->pendingRelX |
-                    ((uint32_t)(uint16_t)(int16_t)device->pendingRelY << 16));
-                channel->send(AxisEvent{device->deviceIdStr, device->mouseXYAxisIndex, packed});
-                device->pendingRelX = 0;
-                device->pendingRelY = 0;
+            if (device->pendingRelMask) {
+                device->pendingRelFrames++;
+                relStats.frames.fetch_add(1, std::memory_order_relaxed);
+                if (!flushRel(false)) relStats.deferred.fetch_add(1, std::memory_order_relaxed);
             }
             continue;
         }
@@ -429,17 +647,16 @@ bool RealDeviceManager::processDeviceInput(RealDevice* device, corocgo::Channel<
 
         auto infoIt = device->axisInfo.find(axisCode);
         if (infoIt == device->axisInfo.end()) {
-            channel->send(AxisEvent{device->deviceIdStr, axisCode, rawValue});
+            emitInOrder(AxisEvent{device->deviceId, axisCode, rawValue});
             continue;
         }
 
         const AxisInfo& info = infoIt->second;
 
-        // Combined mouse XY: accumulate REL_X and REL_Y until EV_SYN
-        if (info.eventType == EV_REL && device->mouseXYAxisIndex != -1 &&
-            (axisCode == REL_X || axisCode == REL_Y)) {
-            if (axisCode == REL_X) device->pendingRelX += rawValue;
-            else                   device->pendingRelY += rawValue;
+        // Relative deltas: accumulate until EV_SYN
+        if (info.eventType == EV_REL && axisCode < REL_CNT) {
+            device->pendingRel[axisCode] += rawValue;
+            device->pendingRelMask |= (uint16_t)(1u << axisCode);
             continue;
         }
 
@@ -451,13 +668,7 @@ bool RealDeviceManager::processDeviceInput(RealDevice* device, corocgo::Channel<
             int negIdx = mappingIt->second.second;
             int posVal = 0, negVal = 0;
 
-            if (info.eventType == EV_REL) {
-                // Relative axes are deltas — pass the raw value through without scaling
-                if (rawValue > 0)
-                    posVal = std::min(1000, rawValue);
-                else if (rawValue < 0)
-                    negVal = std::min(1000, -rawValue);
-            } else if (rawValue > info.defaultValue) {
+            if (rawValue > info.defaultValue) {
                 int range = info.maximum - info.defaultValue;
                 if (range > 0) {
                     posVal = std::min(1000, std::max(0,
@@ -471,28 +682,14 @@ bool RealDeviceManager::processDeviceInput(RealDevice* device, corocgo::Channel<
                 }
             }
 
-            if (info.eventType == EV_REL) {
-                // Always send both directions so the mapping manager sees a clean
-                // press/release cycle on each event. The zero on the inactive
-                // direction fires the pending release and resets WaitingForRelease
-                // state; the Pico ignores zero-value motion axis updates.
-                channel->send(AxisEvent{device->deviceIdStr, posIdx, posVal});
-                channel->send(AxisEvent{device->deviceIdStr, negIdx, negVal});
-            } else {
-                auto lastPosIt = device->lastAxisValues.find(posIdx);
-                int lastPos = (lastPosIt != device->lastAxisValues.end()) ? lastPosIt->second : 0;
-                if (posVal != lastPos) {
-                    channel->send(AxisEvent{device->deviceIdStr, posIdx, posVal});
-                    device->lastAxisValues[posIdx] = posVal;
-                }
-
-                auto lastNegIt = device->lastAxisValues.find(negIdx);
-                int lastNeg = (lastNegIt != device->lastAxisValues.end()) ? lastNegIt->second : 0;
-                if (negVal != lastNeg) {
-                    channel->send(AxisEvent{device->deviceIdStr, negIdx, negVal});
-                    device->lastAxisValues[negIdx] = negVal;
-                }
-            }
+            AxisSlot& slot = device->axisSlots[axisCode];
+            int prev  = slot.last;
+            int value = posVal - negVal;
+            if (!passFilter(slot, value)) continue;
+            posVal = std::max(value, 0);
+            negVal = std::max(-value, 0);
+            if (posVal != std::max(prev, 0))  emitInOrder(AxisEvent{device->deviceId, posIdx, posVal});
+            if (negVal != std::max(-prev, 0)) emitInOrder(AxisEvent{device->deviceId, negIdx, negVal});
         } else {
             int scaledValue = 0;
             int range = info.maximum - info.minimum;
@@ -500,11 +697,16 @@ bool RealDeviceManager::processDeviceInput(RealDevice* device, corocgo::Channel<
                 scaledValue = std::min(1000, std::max(0,
                     (rawValue - info.minimum) * 1000 / range));
             }
-            channel->send(AxisEvent{device->deviceIdStr, axisCode, scaledValue});
+            if (!passFilter(device->axisSlots[axisCode], scaledValue)) continue;
+            emitInOrder(AxisEvent{device->deviceId, axisCode, scaledValue});
         }
     }
 
-    return true;
+    // End of the batch: nothing more to fold in, so deliver what a full
+    // channel held back. A batch cut mid-frame (full read buffer) leaves it
+    // for the next read, which is already waiting; a drained fd ends on EV_SYN.
+    if (device->pendingRelMask && numEvents > 0 && events[numEvents - 1].type == EV_SYN)
+        flushRel(true);
 }
 
 // ---------------------------------------------------------------------------
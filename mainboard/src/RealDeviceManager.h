@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <atomic>
 #include <map>
 #include <vector>
 #include <functional>
@@ -22,11 +23,41 @@ struct AxisInfo {
     AxisInfo() : minimum(0), maximum(0), defaultValue(0), eventType(0), isCentered(false) {}
 };
 
-// Event emitted by a real device after axis scaling/splitting
+// Filter settings and last sent value for one raw axis code
+// (RealDevice::axisSlots). Values are on the 0..1000 output scale; centered
+// axes keep `last` signed (+ positive half, − negative half). A config reload
+// rewrites the settings on the scheduler thread while the pipeline ingest
+// thread filters with them, so they are relaxed atomics; the filter state
+// belongs to whichever thread reads the device.
+struct AxisSlot {
+    std::atomic<int16_t> deadzone{0};
+    std::atomic<int16_t> hysteresis{0};
+    std::atomic<int16_t> minDelta{0};
+    int16_t last       = 0;
+    bool    known      = false;   // `last` holds a sent value (centered axes start at 0)
+    bool    resting    = true;    // inside the deadzone
+
+    AxisSlot() = default;
+    AxisSlot(const AxisSlot& o) { *this = o; }
+    AxisSlot& operator=(const AxisSlot& o) {
+        deadzone.store(o.deadzone.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        hysteresis.store(o.hysteresis.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        minDelta.store(o.minDelta.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        last    = o.last;
+        known   = o.known;
+        resting = o.resting;
+        return *this;
+    }
+};
+
+// Event emitted by a real device after axis scaling/splitting.
+// Carries the numeric RealDevice::deviceId so the channel and mapping hot path
+// never copy or hash strings; resolve deviceIdStr via getDevice() for logging.
 struct AxisEvent {
-    std::string deviceIdStr;  // was: unsigned int deviceId
+    unsigned int deviceId;
     int axisIndex;
     int value;
+    uint32_t trace = 0;   // LatencyTracer id, 0 = not sampled
 };
 
 // Structure representing a real physical device
@@ -49,15 +80,20 @@ struct RealDevice {
     // Mapping from raw axis code to virtual split axis indices (for centered axes)
     std::map<int, std::pair<int, int>> centeredAxisMapping; // rawCode -> (positiveVirtualIndex, negativeVirtualIndex)
 
-    // Track last sent values for virtual axes to avoid redundant updates
-    std::map<int, int> lastAxisValues;              // virtualAxisIndex -> lastSentValue
+    // Per raw axis code (KEY_CNT entries, covers ABS and KEY codes): filter
+    // config and last sent value, so unchanged values are never re-sent
+    std::vector<AxisSlot> axisSlots;
 
     int nextVirtualAxisIndex;                       // Counter for assigning virtual axis indices
 
     // Combined mouse XY axis: set to virtual index when device has both REL_X and REL_Y
     int mouseXYAxisIndex;
-    int pendingRelX;   // Accumulated REL_X delta since last EV_SYN
-    int pendingRelY;   // Accumulated REL_Y delta since last EV_SYN
+
+    // Relative deltas (REL_X/REL_Y, wheels, ...) summed until EV_SYN, and
+    // across EV_SYNs while the event channel is full (see processEvents)
+    int      pendingRel[REL_CNT];
+    uint16_t pendingRelMask;     // bit per REL code with a pending delta
+    int      pendingRelFrames;   // EV_SYN frames folded into pendingRel
 
     // Device information
     uint16_t vendorId;
@@ -67,7 +103,25 @@ struct RealDevice {
     std::string deviceName;                         // Human-readable name
 
     RealDevice() : deviceId(0), fd(-1), active(true), vendorId(0), productId(0),
-                   nextVirtualAxisIndex(10000), mouseXYAxisIndex(-1), pendingRelX(0), pendingRelY(0) {}
+                   nextVirtualAxisIndex(10000), mouseXYAxisIndex(-1),
+                   pendingRel{}, pendingRelMask(0), pendingRelFrames(0) {}
+};
+
+// Relative-motion coalescing counters. Written by whichever thread reads
+// input (pipeline ingest or scheduler), read by REST.
+struct RelCoalesceStats {
+    std::atomic<uint64_t> frames{0};      // EV_SYN frames that carried REL deltas
+    std::atomic<uint64_t> flushes{0};     // combined deltas sent downstream
+    std::atomic<uint64_t> deferred{0};    // flushes put off: event channel full
+    std::atomic<uint64_t> maxMerged{0};   // most frames folded into one flush
+};
+
+// Axis filter counters (same threading as RelCoalesceStats). Dropped events
+// produced no AxisEvent at all.
+struct AxisFilterStats {
+    std::atomic<uint64_t> passed{0};      // ABS / key events that were sent
+    std::atomic<uint64_t> unchanged{0};   // dropped: same value as last sent (incl. deadzone)
+    std::atomic<uint64_t> minDelta{0};    // dropped: change below min_delta
 };
 
 /**
@@ -136,9 +190,29 @@ public:
     /**
      * Read one batch of input events from device fd, push AxisEvents to channel.
      * On disconnect: sets device.active = false, closes fd, returns false.
+     * @param external true when called from a non-coroutine thread (pipeline
+     *        ingest): events go through channel->sendExternalNoBlock, and on
+     *        disconnect the device is left for markDisconnected() on the
+     *        scheduler thread.
      * @return false if device is disconnected (caller should stop coroutine)
      */
-    bool processDeviceInput(RealDevice* device, corocgo::Channel<AxisEvent>* channel);
+    bool processDeviceInput(RealDevice* device, corocgo::Channel<AxisEvent>* channel,
+                            bool external = false);
+
+    /**
+     * Normalize already-read evdev events and push the AxisEvents to channel
+     * (the part of processDeviceInput after read(); used with co_read).
+     * Relative deltas go out once per EV_SYN; if the channel is full at that
+     * point they keep accumulating, and whatever is still pending when the
+     * batch ends is sent as one combined update (waiting for room).
+     */
+    void processEvents(RealDevice* device, const struct input_event* events, int numEvents,
+                       corocgo::Channel<AxisEvent>* channel, bool external = false);
+
+    /**
+     * Mark a device disconnected and close its fd (scheduler thread).
+     */
+    void markDisconnected(RealDevice* device);
 
     /**
      * Send an event to a device (e.g., force feedback, LED, rumble)
@@ -156,19 +230,24 @@ public:
     const std::map<unsigned int, RealDevice>& getDevices() const { return deviceId2Device; }
 
     /**
-     * Parse the real_devices section from config and extract axis rename overrides.
-     * Immediately re-applies renames to all already-registered devices.
+     * Parse the real_devices section from config and extract axis rename
+     * overrides and axis filters. Immediately re-applies both to all
+     * already-registered devices.
      */
     void load(const std::vector<ConfRealDevice>& devices);
 
     // Linux input abstraction — exposed so callers (e.g. main.cpp) can use it directly
     LinuxInputManager linuxInput;
 
+    RelCoalesceStats relStats;
+    AxisFilterStats  filterStats;
+
 public:
     std::map<unsigned int, RealDevice> deviceId2Device;   // numericId -> device
     std::vector<std::string> duplicateSerialIds;
     unsigned int nextDeviceId = 1;
     std::map<std::string, std::map<std::string,std::string>> axisRenames; // deviceIdStr -> (old -> new)
+    std::map<std::string, std::map<std::string,ConfAxisFilter>> axisFilters; // deviceIdStr -> (axis -> filter)
 
     // Generate stable string key from device info — used for config matching
     std::string generateDeviceKey(uint16_t vendor, uint16_t product, const std::string& serial,
@@ -187,6 +266,9 @@ private:
     // Rebuild device.axes from device.originalAxes applying axisRenames for this device
     void applyAxisRenames(RealDevice& device);
 
+    // Write this device's axisFilters into its axisSlots (last sent values kept)
+    void applyAxisFilters(RealDevice& device);
+
     // Close a device fd
     void closeDevice(RealDevice& device);
 };
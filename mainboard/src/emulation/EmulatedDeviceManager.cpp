@@ -15,7 +15,8 @@ void EmulatedDeviceManager::registerBoard(EmulationBoard* board,
 
     // First registration: append all devices and build idToIndex entries.
     for (auto d : newDevices) {
-        d.board = board;
+        d.board    = board;
+        d.silenced = silencedVods.count(d.id) > 0;
         int idx = (int)devices.size();
         idToIndex[d.id] = idx;
         devices.push_back(std::move(d));
@@ -30,13 +31,19 @@ void EmulatedDeviceManager::setAxis(int deviceIndex, int axis, int value) {
     if (deviceIndex < 0 || deviceIndex >= (int)devices.size()) return;
     auto& d = devices[deviceIndex];
     if (d.board == nullptr || !d.board->active) return;
-    if (silencedVods.count(d.id) > 0) return;
+    if (d.silenced) return;
+    if (sink) {
+        sink(deviceIndex, axis, value);
+        return;
+    }
     d.setAxis(axis, value);
 }
 
 void EmulatedDeviceManager::setSilenced(const std::string& vodId, bool silenced) {
     if (silenced) silencedVods.insert(vodId);
     else          silencedVods.erase(vodId);
+    int idx = resolveId(vodId);
+    if (idx != -1) devices[idx].silenced = silenced;
 }
 
 bool EmulatedDeviceManager::isSilenced(const std::string& vodId) const {
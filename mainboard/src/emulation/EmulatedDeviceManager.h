@@ -1,5 +1,6 @@
 // mainboard/src/EmulatedDeviceManager.h
 #pragma once
+#include <functional>
 #include <vector>
 #include <map>
 #include <set>
@@ -24,6 +25,13 @@ public:
     // Runtime axis dispatch. Silently drops if device out of range or board inactive.
     void setAxis(int deviceIndex, int axis, int value);
 
+    // Capture output instead of sending it: while a sink is set, setAxis hands
+    // every accepted (deviceIndex, axis, value) to it and no board is
+    // touched, so boards need no RPC. Used by the offline replayer
+    // (mapping_replay.cpp). Pass nullptr to restore normal dispatch.
+    using AxisSink = std::function<void(int deviceIndex, int axis, int value)>;
+    void setSink(AxisSink s) { sink = std::move(s); }
+
     // Silence a VOD: while silenced, setAxis calls are dropped.
     void setSilenced(const std::string& vodId, bool silenced);
     bool isSilenced(const std::string& vodId) const;
@@ -41,4 +49,5 @@ private:
     std::vector<VirtualOutputDevice> devices;
     std::map<std::string, int>       idToIndex;
     std::set<std::string>            silencedVods;
+    AxisSink                         sink;
 };
@@ -1,13 +1,20 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
+#include <memory>
+#include <unordered_map>
 #include "UartManager.h"
 #include "../shared/rpcinterface.h"
 #include "../shared/shared.h"
 #include "../shared/PicoConfig.h"
 #include "../shared/crc32.h"
-#include "Corocgo/corocrpc/corocrpc.h"
+#include "corocgo/corocrpc/corocrpc.h"
+#include "pipeline/LatencyTrace.h"
+#include "PicoLatency.h"
 
 class EmulationBoard {
 public:
@@ -19,6 +26,17 @@ public:
 
     PicoConfig picoConfig;  // the config this board should be running
 
+    // setAxis() coalescing window in microseconds. 0 = flush once per scheduler
+    // pass; >0 = keep collecting until the window elapses. Set from
+    // emulation_boards[].coalesce_window_us at onBoot.
+    int coalesceWindowUs = 0;
+
+    int32_t wireCaps = 0;   // WireCap bits advertised by the Pico at onBoot
+
+    // Input → USB report latency on this board; created by enableLatencyProbe()
+    // when the Pico advertises WIRE_CAP_LATENCY_PROBE
+    std::unique_ptr<PicoLatency> latency;
+
     // ── Main → Pico RPC calls ─────────────────────────────────────────────
 
     int pingPico(int32_t val) {
@@ -29,16 +47,68 @@ public:
         if (result.arg != nullptr) {
             pingResult = result.arg->getInt32();
         }
-        rpc->disposeRpcResult(result);
+        if (result.arg) rpc->disposeRpcArg(result.arg);
         rpc->disposeRpcArg(arg);
         return pingResult;
     }
 
+    // Sends `count` pings back to back through the RPC window (callAsync),
+    // collecting each result once DEPTH newer requests are queued behind it.
+    // Returns how many came back with `val`.
+    int pingPicoBurst(int32_t val, int count) {
+        constexpr int DEPTH = 8;   // results held at once (the default RPC window)
+        std::vector<corocrpc::RpcFuture> futures(count);
+        int ok = 0;
+        auto collect = [&](int i) {
+            corocrpc::RpcResult result = futures[i].get();
+            if (result.arg && result.arg->getInt32() == val) ok++;
+            if (result.arg) rpc->disposeRpcArg(result.arg);
+        };
+        for (int i = 0; i < count; i++) {
+            corocrpc::RpcArg* arg = rpc->getRpcArg();
+            arg->putInt32(val);
+            futures[i] = rpc->callAsync(M2P_PING, arg);
+            rpc->disposeRpcArg(arg);
+            if (i >= DEPTH) collect(i - DEPTH);
+        }
+        for (int i = std::max(0, count - DEPTH); i < count; i++) collect(i);
+        return ok;
+    }
+
+    // One M2P_CLOCK_PROBE round trip, fed to latency->clock. False on timeout.
+    bool probeClock() {
+        if (!latency) return false;
+        corocrpc::RpcArg* arg = rpc->getRpcArg();
+        uint32_t sent = PicoLatency::hostUs();
+        corocrpc::RpcResult result = rpc->call(M2P_CLOCK_PROBE, arg);
+        uint32_t replied = PicoLatency::hostUs();
+        bool ok = result.arg != nullptr;
+        if (ok) {
+            uint32_t received = (uint32_t)result.arg->getInt32();
+            uint32_t answered = (uint32_t)result.arg->getInt32();
+            latency->clock.addSample(sent, received, answered, replied);
+        }
+        if (result.arg) rpc->disposeRpcArg(result.arg);
+        rpc->disposeRpcArg(arg);
+        return ok;
+    }
+
+    // Called at onBoot. Starts the board's clock-probe coroutine the first
+    // time; after a Pico reboot only the clock estimate is dropped.
+    void enableLatencyProbe() {
+        if (latency) {
+            latency->clock.reset();
+            return;
+        }
+        latency = std::make_unique<PicoLatency>();
+        corocgo::coro_named("clock-probe", [this]() { clockProbeLoop(); });
+    }
+
     void setLed(bool state) {
         corocrpc::RpcArg* arg = rpc->getRpcArg();
         arg->putBool(state);
         corocrpc::RpcResult result = rpc->call(M2P_SET_LED, arg);
-        rpc->disposeRpcResult(result);
+        if (result.arg) rpc->disposeRpcArg(result.arg);
         rpc->disposeRpcArg(arg);
     }
 
@@ -49,7 +119,7 @@ public:
         if (result.arg != nullptr) {
             state = result.arg->getBool();
         }
-        rpc->disposeRpcResult(result);
+        if (result.arg) rpc->disposeRpcArg(result.arg);
         rpc->disposeRpcArg(arg);
         return state;
     }
@@ -61,7 +131,7 @@ public:
         if (result.arg != nullptr) {
             ok = result.arg->getBool();
         }
-        rpc->disposeRpcResult(result);
+        if (result.arg) rpc->disposeRpcArg(result.arg);
         rpc->disposeRpcArg(arg);
         return ok;
     }
@@ -72,15 +142,46 @@ public:
         rpc->disposeRpcArg(arg);
     }
 
+    // Queues the update; the board's flush coroutine sends all pending updates
+    // as one M2P_SET_AXIS_BATCH frame. Last write wins per (device, axis), except
+    // relative mouse motion which is summed so no movement is lost. A merged
+    // update keeps the first latency trace it saw.
+    // A press/release (or release/press) pair is never merged: when the new
+    // value would undo a pending transition, it starts a new packet instead.
     void setAxis(int32_t device, int32_t axis, int32_t value) {
-        corocrpc::RpcArg* arg = rpc->getRpcArg();
-        arg->putInt32(device);
-        arg->putInt32(axis);
-        arg->putInt32(value);
-        rpc->callNoResponse(M2P_SET_AXIS, arg);
-        rpc->disposeRpcArg(arg);
+        bool relative = isRelativeMouseAxis(device, axis);
+        for (size_t i = packetStart; i < pendingAxes.size(); i++) {
+            PendingAxis& p = pendingAxes[i];
+            if (p.device != device || p.axis != axis) continue;
+            if (!relative && undoesTransition(p, value)) {
+                packetStart = pendingAxes.size();
+                pendingAxes.push_back({device, axis, value, gTracer.current, true});
+                return;
+            }
+            p.value = relative ? addRelative(axis, p.value, value) : value;
+            if (!p.trace) p.trace = gTracer.current;
+            return;
+        }
+        pendingAxes.push_back({device, axis, value, gTracer.current, false});
+        scheduleAxisFlush();
     }
 
+    // Sends everything queued by setAxis() right now, bypassing the window.
+    void flushAxes() {
+        while (!pendingAxes.empty()) {
+            std::vector<PendingAxis> batch;
+            batch.swap(pendingAxes);   // setAxis() may refill while we are blocked in send
+            packetStart = 0;
+            for (const auto& p : batch) sentAxes[axisKey(p.device, p.axis)] = p.value;
+            size_t from = 0;
+            for (size_t i = 1; i <= batch.size(); i++) {
+                if (i < batch.size() && !batch[i].newPacket) continue;
+                if (from == 0 && i == batch.size()) sendAxisBatch(batch);
+                else sendAxisBatch(std::vector<PendingAxis>(batch.begin() + from, batch.begin() + i));
+                from = i;
+            }
+        }
+    }
     void setUsbConnected(bool connected) {
         corocrpc::RpcArg* arg = rpc->getRpcArg();
         arg->putBool(connected);
@@ -102,8 +203,217 @@ public:
             result.arg->getString(err, sizeof(err));
             errorMsg = err;
         }
-        rpc->disposeRpcResult(result);
+        if (result.arg) rpc->disposeRpcArg(result.arg);
         rpc->disposeRpcArg(arg);
         return ok;
     }
+
+private:
+    // ── setAxis coalescing ────────────────────────────────────────────────
+
+    struct PendingAxis {
+        int32_t  device;
+        int32_t  axis;
+        int32_t  value;
+        uint32_t trace;   // LatencyTracer id, 0 = not sampled; a packet carries its first one
+        bool     newPacket;   // sent in a later packet than the entries before it
+    };
+
+    // int32 count + count × 3 int32 must fit into one RpcArg
+    static constexpr int AXIS_BATCH_MAX = (corocrpc::RPC_ARG_BUF_SIZE - 4) / 12;
+
+    std::vector<PendingAxis>        pendingAxes;
+    size_t                          packetStart = 0;   // first entry setAxis() may merge into
+    std::unordered_map<uint32_t, int32_t> sentAxes;    // last value handed to sendAxisBatch, by axisKey
+    corocgo::Channel<bool>*         axisFlushCh = nullptr;   // created lazily, never freed (boards live forever)
+    bool                            axisFlushScheduled = false;
+
+    bool isRelativeMouseAxis(int32_t device, int32_t axis) const {
+        if (axis < MOUSE_AXIS_X_MINUS || axis > MOUSE_AXIS_XY) return false;
+        if (device < 0 || device >= (int)picoConfig.devices.size()) return false;
+        return picoConfig.devices[device].type == PicoDeviceType::MOUSE;
+    }
+
+    static uint32_t axisKey(int32_t device, int32_t axis) {
+        return ((uint32_t)device << 16) | (uint16_t)axis;
+    }
+
+    // Value (device, axis) has before the packet being filled: an earlier
+    // packet's pending entry, else the last one sent, else released (0)
+    int32_t valueBeforePacket(int32_t device, int32_t axis) const {
+        for (size_t i = packetStart; i-- > 0; )
+            if (pendingAxes[i].device == device && pendingAxes[i].axis == axis) return pendingAxes[i].value;
+        auto it = sentAxes.find(axisKey(device, axis));
+        return it != sentAxes.end() ? it->second : 0;
+    }
+
+    // Overwriting `p` with `value` would lose a press or release: p changes
+    // the pressed (non-zero) state and value changes it back. Analog moves
+    // that stay on one side of zero keep merging.
+    bool undoesTransition(const PendingAxis& p, int32_t value) const {
+        bool pressed = value != 0;
+        if (pressed == (p.value != 0)) return false;
+        return pressed == (valueBeforePacket(p.device, p.axis) != 0);
+    }
+
+    static int16_t clampInt16(int32_t v) {
+        return (int16_t)(v < INT16_MIN ? INT16_MIN : (v > INT16_MAX ? INT16_MAX : v));
+    }
+
+    static int32_t addRelative(int32_t axis, int32_t a, int32_t b) {
+        if (axis != MOUSE_AXIS_XY) return a + b;
+        int16_t x = clampInt16((int16_t)(a & 0xFFFF) + (int16_t)(b & 0xFFFF));
+        int16_t y = clampInt16((int16_t)((a >> 16) & 0xFFFF) + (int16_t)((b >> 16) & 0xFFFF));
+        return (int32_t)(((uint32_t)(uint16_t)y << 16) | (uint16_t)x);
+    }
+
+    // The flush coroutine captures `this`; boards live in a reserved vector and
+    // are never moved once setAxis() has been called on them.
+    void scheduleAxisFlush() {
+        if (axisFlushScheduled) return;
+        axisFlushScheduled = true;
+        if (!axisFlushCh) {
+            axisFlushCh = new corocgo::Channel<bool>(1);
+            corocgo::coro_named("axis-flush", [this]() { axisFlushLoop(); });
+        }
+        axisFlushCh->send(true);
+    }
+
+    void axisFlushLoop() {
+        while (true) {
+            auto res = axisFlushCh->receive();
+            if (res.error) break;
+            waitCoalesceWindow();
+            flushAxes();
+            axisFlushScheduled = false;
+        }
+    }
+
+    // A quick burst fills the PicoClock window, then one probe a second keeps
+    // up with the drift between the two crystals
+    static constexpr int CLOCK_PROBE_FAST_MS = 50;
+    static constexpr int CLOCK_PROBE_MS      = 1000;
+
+    void clockProbeLoop() {
+        while (true) {
+            if (active) probeClock();
+            corocgo::sleep(latency->clock.windowFull() ? CLOCK_PROBE_MS : CLOCK_PROBE_FAST_MS);
+        }
+    }
+
+    // Follows a traced batch packet with M2P_LATENCY_MARK for `device`
+    void sendLatencyMark(uint32_t trace, int32_t device) {
+        if (!latency || !trace) return;
+        int64_t origin = gTracer.originNs(trace);
+        if (!origin) return;
+        corocrpc::RpcArg* arg = rpc->getRpcArg();
+        if (!arg) return;
+        arg->putVarUInt(latency->mark(origin));
+        arg->putVarInt(device);
+        rpc->callNoResponse(M2P_LATENCY_MARK, arg);
+        rpc->disposeRpcArg(arg);
+    }
+
+    void waitCoalesceWindow() {
+        if (coalesceWindowUs <= 0) {
+            corocgo::coro_yield();
+            return;
+        }
+        corocgo::sleep_us(coalesceWindowUs);
+    }
+
+    void sendAxisBatch(const std::vector<PendingAxis>& batch) {
+        if (wireCaps & WIRE_CAP_PACKED_AXIS) sendAxisBatchPacked(batch);
+        else                                 sendAxisBatchUnpacked(batch);
+    }
+
+    // M2P_SET_AXIS / M2P_SET_AXIS_BATCH (3 × int32 per update)
+    void sendAxisBatchUnpacked(const std::vector<PendingAxis>& batch) {
+        size_t pos = 0;
+        while (pos < batch.size()) {
+            size_t n = std::min(batch.size() - pos, (size_t)AXIS_BATCH_MAX);
+            corocrpc::RpcArg* arg = rpc->getRpcArg();
+            if (!arg) return;
+            uint32_t trace = 0;
+            int32_t  traceDevice = 0;
+            for (size_t i = pos; i < pos + n && !trace; i++) {
+                trace       = batch[i].trace;
+                traceDevice = batch[i].device;
+            }
+            gTracer.stamp(trace, TS_FLUSH);
+            if (n == 1) {
+                const PendingAxis& p = batch[pos];
+                arg->putInt32(p.device);
+                arg->putInt32(p.axis);
+                arg->putInt32(p.value);
+                rpc->callNoResponse(M2P_SET_AXIS, arg, trace);
+            } else {
+                arg->putInt32((int32_t)n);
+                for (size_t i = pos; i < pos + n; i++) {
+                    arg->putInt32(batch[i].device);
+                    arg->putInt32(batch[i].axis);
+                    arg->putInt32(batch[i].value);
+                }
+                rpc->callNoResponse(M2P_SET_AXIS_BATCH, arg, trace);
+            }
+            rpc->disposeRpcArg(arg);
+            sendLatencyMark(trace, traceDevice);
+            pos += n;
+        }
+    }
+
+    // M2P_SET_AXIS_PACKED. Updates putAxisUpdate can't encode (slot > 15)
+    // follow the packed frames as one unpacked batch, in their original order,
+    // so the Pico still applies the whole batch before its next report.
+    void sendAxisBatchPacked(const std::vector<PendingAxis>& batch) {
+        static constexpr size_t PACKED_BATCH_MAX =
+            (corocrpc::RPC_ARG_BUF_SIZE - 5) / corocrpc::RPC_AXIS_UPDATE_MAX_SIZE;
+        std::vector<size_t> packable, unpacked;   // indices into batch
+        packable.reserve(batch.size());
+        for (size_t i = 0; i < batch.size(); i++) {
+            const PendingAxis& p = batch[i];
+            bool fits = p.device >= 0 && p.device <= 15 && p.axis >= 0;   // 4-bit slot field
+            (fits ? packable : unpacked).push_back(i);
+        }
+        auto put = [&batch](corocrpc::RpcArg* arg, size_t i) {
+            return arg->putAxisUpdate(batch[i].device, batch[i].axis, batch[i].value);
+        };
+        size_t pos = 0;
+        while (pos < packable.size()) {
+            size_t n = std::min(packable.size() - pos, PACKED_BATCH_MAX);
+            corocrpc::RpcArg* arg = rpc->getRpcArg();
+            if (!arg) return;
+            arg->putVarUInt((uint32_t)n);
+            size_t done = 0;
+            while (done < n && put(arg, packable[pos + done])) done++;
+            if (done < n) {
+                // Out of room: the frame takes what fitted, the rest goes unpacked
+                unpacked.insert(unpacked.end(), packable.begin() + pos + done, packable.end());
+                packable.resize(pos + done);
+                n = done;
+                arg->reset();
+                arg->putVarUInt((uint32_t)n);
+                for (size_t i = pos; i < pos + n; i++) put(arg, packable[i]);
+            }
+            uint32_t trace = 0;
+            int32_t  traceDevice = 0;
+            for (size_t i = pos; i < pos + n && !trace; i++) {
+                trace       = batch[packable[i]].trace;
+                traceDevice = batch[packable[i]].device;
+            }
+            if (n > 0) {
+                gTracer.stamp(trace, TS_FLUSH);
+                rpc->callNoResponse(M2P_SET_AXIS_PACKED, arg, trace);
+            }
+            rpc->disposeRpcArg(arg);
+            sendLatencyMark(trace, traceDevice);
+            pos += n;
+        }
+        if (unpacked.empty()) return;
+        std::sort(unpacked.begin(), unpacked.end());
+        std::vector<PendingAxis> rest;
+        rest.reserve(unpacked.size());
+        for (size_t i : unpacked) rest.push_back(batch[i]);
+        sendAxisBatchUnpacked(rest);
+    }
 };
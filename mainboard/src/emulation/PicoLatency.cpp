@@ -0,0 +1,74 @@
+// mainboard/src/emulation/PicoLatency.cpp
+#include "PicoLatency.h"
+
+// ── PicoClock ───────────────────────────────────────────────────────────────
+
+// offset = ((t2 - t1) + (t3 - t4)) / 2 = (t2 - t1) - rtt / 2, with
+// rtt = (t4 - t1) - (t3 - t2). Both spans are short, so the subtraction is
+// done in 32-bit wrapping arithmetic. The lowest-RTT sample in the window has
+// the least queueing in it and gives the tightest bound (±rtt/2).
+void PicoClock::addSample(uint32_t t1, uint32_t t2, uint32_t t3, uint32_t t4) {
+    int32_t rtt = (int32_t)(t4 - t1) - (int32_t)(t3 - t2);
+    if (rtt < 0) rtt = 0;
+    window[next] = {rtt, (t2 - t1) - (uint32_t)(rtt / 2)};
+    next = (next + 1) % WINDOW;
+    if (count < WINDOW) count++;
+    total++;
+    best = window[0];
+    for (int i = 1; i < count; i++)
+        if (window[i].rtt < best.rtt) best = window[i];
+}
+
+void PicoClock::reset() {
+    count = 0;
+    next  = 0;
+    best  = {};
+}
+
+// ── PicoLatency ─────────────────────────────────────────────────────────────
+
+const char* PicoLatency::stageName(Stage s) {
+    switch (s) {
+        case ST_WIRE:  return "wire";
+        case ST_USB:   return "usb";
+        case ST_TOTAL: return "total";
+        default:       return "?";
+    }
+}
+
+uint32_t PicoLatency::mark(int64_t originNs) {
+    uint32_t tag = nextTag++;
+    if (nextTag == 0) nextTag = 1;
+    pending[tag % PENDING] = {tag, (uint32_t)(originNs / 1000), hostUs()};
+    markCount++;
+    return tag;
+}
+
+void PicoLatency::onStamp(uint32_t tag, uint32_t appliedUs, uint32_t reportUs, bool reported) {
+    Pending& p = pending[tag % PENDING];
+    if (p.tag != tag || !clock.valid()) {
+        unmatchedCount++;
+        return;
+    }
+    p.tag = 0;
+    stampedCount++;
+    // The offset is only good to ±rtt/2, so a short span can come out negative
+    auto span = [](uint32_t from, uint32_t to) -> uint64_t {
+        int32_t d = (int32_t)(to - from);
+        return d > 0 ? (uint64_t)d : 0;
+    };
+    uint32_t applied = clock.toHostUs(appliedUs);
+    hist[ST_WIRE].record(span(p.sentUs, applied));
+    if (!reported) {
+        noReportCount++;
+        return;
+    }
+    uint32_t report = clock.toHostUs(reportUs);
+    hist[ST_USB].record(span(applied, report));
+    hist[ST_TOTAL].record(span(p.originUs, report));
+}
+
+void PicoLatency::reset() {
+    for (auto& h : hist) h.reset();
+    markCount = stampedCount = noReportCount = unmatchedCount = 0;
+}
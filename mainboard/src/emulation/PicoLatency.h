@@ -0,0 +1,78 @@
+// mainboard/src/emulation/PicoLatency.h
+// Per-board input → USB report latency, measured on the Pico.
+//
+// PicoClock estimates the offset between the mainboard's steady clock and the
+// Pico's time_us_32() from M2P_CLOCK_PROBE round trips, NTP style. When a
+// traced axis batch is sent, the board sends an M2P_LATENCY_MARK after it. The
+// Pico stamps when the batch was applied and when the device queued its next
+// USB report, and returns the stamps in P2M_LATENCY_REPORT. PicoLatency
+// converts them to mainboard time and records them per stage.
+#pragma once
+#include <cstdint>
+#include "pipeline/LatencyTrace.h"
+
+class PicoClock {
+public:
+    static constexpr int WINDOW = 8;   // recent samples; the one with the lowest RTT wins
+
+    // t1/t4: mainboard µs when the probe was sent / the reply arrived.
+    // t2/t3: Pico µs when the handler ran / replied.
+    void addSample(uint32_t t1, uint32_t t2, uint32_t t3, uint32_t t4);
+    void reset();   // Pico rebooted: its clock restarted
+
+    bool     valid() const      { return count > 0; }
+    bool     windowFull() const { return count == WINDOW; }
+    int32_t  rttUs() const      { return best.rtt; }
+    uint32_t offsetUs() const   { return best.offset; }   // pico - mainboard, mod 2^32
+    uint64_t samples() const    { return total; }
+    uint32_t toHostUs(uint32_t picoUs) const { return picoUs - best.offset; }
+
+private:
+    struct Sample { int32_t rtt; uint32_t offset; };
+
+    Sample   window[WINDOW] = {};
+    int      count = 0;
+    int      next  = 0;
+    Sample   best  = {};
+    uint64_t total = 0;
+};
+
+class PicoLatency {
+public:
+    enum Stage {
+        ST_WIRE,    // batch packet built → applied on the Pico (RPC queue, UART, Pico dispatch)
+        ST_USB,     // applied → USB report queued (waiting for the endpoint)
+        ST_TOTAL,   // input (evdev timestamp) → USB report queued
+        ST_COUNT
+    };
+
+    PicoClock clock;
+
+    // Registers a mark for a traced batch sent now; returns its tag.
+    uint32_t mark(int64_t originNs);
+    // One P2M_LATENCY_REPORT entry (Pico time)
+    void     onStamp(uint32_t tag, uint32_t appliedUs, uint32_t reportUs, bool reported);
+
+    const LatencyHistogram& histogram(Stage s) const { return hist[s]; }
+    static const char*      stageName(Stage s);
+    uint64_t marks() const     { return markCount; }
+    uint64_t stamped() const   { return stampedCount; }
+    uint64_t noReport() const  { return noReportCount; }   // applied, but no USB report followed
+    uint64_t unmatched() const { return unmatchedCount; }  // tag expired, or no clock estimate yet
+    void     reset();
+
+    static uint32_t hostUs() { return (uint32_t)(LatencyTracer::nowNs() / 1000); }
+
+private:
+    static constexpr int PENDING = 64;   // marks in flight; an older one is overwritten
+
+    struct Pending { uint32_t tag; uint32_t originUs; uint32_t sentUs; };
+
+    Pending          pending[PENDING] = {};
+    uint32_t         nextTag = 1;
+    LatencyHistogram hist[ST_COUNT];
+    uint64_t         markCount      = 0;
+    uint64_t         stampedCount   = 0;
+    uint64_t         noReportCount  = 0;
+    uint64_t         unmatchedCount = 0;
+};
@@ -7,6 +7,7 @@
 #include <cstring>
 #include <cerrno>
 #include <cstdint>
+#include <cstdlib>
 #include <functional>
 #include <vector>
 #include <string>
@@ -29,7 +30,11 @@ class UartManager {
     int uartFileHandle;
     char buffer[10*1024];
 
+    // INPUTPROXY_UART<n>=<path> replaces the channel's device, e.g. with the
+    // pty of a simulated Pico (pico_sim)
     static std::vector<std::string> getPathsForChannel(UART_CHANNEL ch) {
+        std::string env = "INPUTPROXY_UART" + std::to_string((int)ch);
+        if (const char* path = getenv(env.c_str())) return {path};
         switch(ch) {
             case UART0: return {"/dev/ttyAMA0"};
             case UART1: return {"/dev/ttyAMA1"};
@@ -115,6 +120,7 @@ class UartManager {
         // 8N1 mode
         tty.c_cflag = (tty.c_cflag & ~CSIZE) | CS8;  // 8-bit chars
         tty.c_iflag &= ~IGNBRK;  // disable break processing
+        tty.c_iflag &= ~(ICRNL | INLCR | IGNCR | ISTRIP);  // binary frames: no CR/LF translation
         tty.c_lflag = 0;  // no signaling chars, no echo, no canonical processing
         tty.c_oflag = 0;  // no remapping, no delays
         tty.c_cc[VMIN]  = 0;  // read doesn't block
@@ -15,6 +15,7 @@ struct VirtualOutputDevice {
     PicoDeviceType  type;
     AxisTable       axisTable;   // built from forKeyboard()/forMouse()/forHidGamepad()/forXbox360()
     EmulationBoard* board;       // back-pointer to owning Pico board; nullptr until activated
+    bool            silenced = false;  // mirrors EmulatedDeviceManager::setSilenced for the hot path
 
     // Dispatch axis value to the Pico via RPC. No-op if board is nullptr or inactive.
     void setAxis(int axis, int value);
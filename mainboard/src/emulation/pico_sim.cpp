@@ -0,0 +1,315 @@
+// mainboard/src/emulation/pico_sim.cpp
+// Simulated Pico on a pseudo-terminal, for exercising the latency probe
+// (M2P_CLOCK_PROBE, M2P_LATENCY_MARK, P2M_LATENCY_REPORT) without hardware.
+// Not part of the `app` target. Build from mainboard/:
+//
+//   g++ -std=c++20 -O2 -Isrc -Isrc/emulation -I../shared -I../shared/corocgo
+//       src/emulation/pico_sim.cpp src/emulation/PicoLatency.cpp src/pipeline/LatencyTrace.cpp
+//       ../shared/shared.cpp ../shared/PicoConfig.cpp
+//       ../shared/corocgo/corocgo.cpp ../shared/corocgo/corocrpc/corocrpc.cpp
+//       -o pico_sim -lpthread
+//
+//   ./pico_sim          self-test: an EmulationBoard talks to the simulated Pico
+//                       through the pty's slave side, sends traced axis updates,
+//                       and checks the clock estimate and the latency histograms.
+//                       Exits non-zero on failure.
+//   ./pico_sim --serve  simulated Pico only. Prints the pty path; start the
+//                       mainboard with INPUTPROXY_UART0=<path> and read
+//                       GET /emulationboard/{id}/latency.
+//
+// The simulated Pico's clock runs PICO_CLOCK_AHEAD_US ahead of the mainboard's.
+// A device that received a batch queues its USB report at the next
+// USB_FRAME_US boundary, like a full-speed HID endpoint polled every 1 ms.
+
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "EmulationBoard.h"
+#include "LatencyProbe.h"
+
+using namespace corocgo;
+using namespace corocrpc;
+
+static constexpr uint32_t PICO_CLOCK_AHEAD_US = 1234567890u;
+static constexpr int64_t  USB_FRAME_US        = 1000;
+static constexpr int      SIM_DEVICES         = 4;
+static constexpr int      TEST_EVENTS         = 300;
+
+static uint32_t picoNowUs() { return PicoLatency::hostUs() + PICO_CLOCK_AHEAD_US; }
+
+// ── Simulated Pico ──────────────────────────────────────────────────────────
+
+struct SimDevice {
+    bool     changed = false;
+    uint32_t reports = 0;
+};
+
+static SimDevice       simDevices[SIM_DEVICES];
+static LatencyStampLog simStampLog;
+
+static SimDevice* simDevice(int32_t device) {
+    return device >= 0 && device < SIM_DEVICES ? &simDevices[device] : nullptr;
+}
+
+static void simSetAxis(int32_t device) {
+    if (SimDevice* d = simDevice(device)) d->changed = true;
+}
+
+// Runs the Pico side on the pty master
+static RpcManager* startSimPico(int fd) {
+    auto* framer = new StreamFramer();
+    auto* outCh  = makeChannel<RpcPacket>(8);
+    auto* inCh   = makeChannel<RpcPacket>(8);
+    auto* rpc    = new RpcManager(outCh, inCh, /*timeoutMs=*/2000);
+
+    rpc->registerMethod(M2P_PING, [rpc](RpcArg* arg) -> RpcArg* {
+        RpcArg* out = rpc->getRpcArg();
+        out->putInt32(arg->getInt32() + 1);
+        return out;
+    });
+    rpc->registerMethod(M2P_CLOCK_PROBE, [rpc](RpcArg*) -> RpcArg* {
+        uint32_t received = picoNowUs();
+        RpcArg* out = rpc->getRpcArg();
+        out->putInt32((int32_t)received);
+        out->putInt32((int32_t)picoNowUs());
+        return out;
+    });
+    rpc->registerMethod(M2P_SET_AXIS, [](RpcArg* arg) -> RpcArg* {
+        simSetAxis(arg->getInt32());
+        return nullptr;
+    });
+    rpc->registerMethod(M2P_SET_AXIS_BATCH, [](RpcArg* arg) -> RpcArg* {
+        int32_t count = arg->getInt32();
+        for (int32_t i = 0; i < count && i < RPC_ARG_BUF_SIZE / 12; i++) {
+            simSetAxis(arg->getInt32());
+            arg->getInt32();
+            arg->getInt32();
+        }
+        return nullptr;
+    });
+    rpc->registerMethod(M2P_SET_AXIS_PACKED, [](RpcArg* arg) -> RpcArg* {
+        uint32_t count = arg->getVarUInt();
+        int32_t device, axis, value;
+        for (uint32_t i = 0; i < count && arg->getAxisUpdate(device, axis, value); i++)
+            simSetAxis(device);
+        return nullptr;
+    });
+    rpc->registerMethod(M2P_LATENCY_MARK, [](RpcArg* arg) -> RpcArg* {
+        uint32_t tag    = arg->getVarUInt();
+        int32_t  device = arg->getVarInt();
+        SimDevice* d = simDevice(device);
+        simStampLog.mark(tag, device, d ? d->reports : 0, picoNowUs());
+        return nullptr;
+    });
+    rpc->registerMethod(M2P_SET_USB_CONNECTED, [](RpcArg*) -> RpcArg* { return nullptr; });
+
+    coro_named("sim-uart-read", [fd, framer]() {
+        while (true) {
+            uint8_t bytes[SF_BUFFER_SIZE];
+            ssize_t n = co_read(fd, bytes, sizeof(bytes));
+            if (n <= 0) { sleep(10); continue; }   // EIO until the slave side is opened
+            framer->write(bytes, (size_t)n);
+        }
+    });
+    coro_named("sim-uart-write", [fd, outCh]() {
+        while (true) {
+            auto res = outCh->receive();
+            if (res.error) break;
+            if (!StreamFramer::frame(res.value, 0)) continue;
+            const uint8_t* data = res.value.data();
+            int size = res.value.size(), off = 0;
+            while (off < size) {
+                ssize_t n = co_write(fd, data + off, size - off);
+                if (n == -EINTR) continue;
+                if (n <= 0) break;
+                off += (int)n;
+            }
+        }
+    });
+    coro_named("sim-rpc-in", [framer, inCh]() {
+        while (true) {
+            auto res = framer->readCh->receive();
+            if (res.error) break;
+            inCh->send(std::move(res.value));
+        }
+    });
+
+    // USB: changed devices queue a report on the next frame, then the stamp log is polled
+    coro_named("sim-usb", []() {
+        while (true) {
+            int64_t now = PicoLatency::hostUs();
+            sleep_us(USB_FRAME_US - now % USB_FRAME_US);
+            for (auto& d : simDevices) {
+                if (!d.changed) continue;
+                d.changed = false;
+                d.reports++;
+            }
+            simStampLog.poll(picoNowUs(), [](int32_t device) {
+                SimDevice* d = simDevice(device);
+                return d ? d->reports : 0u;
+            });
+        }
+    });
+
+    coro_named("sim-latency-report", [rpc]() {
+        while (true) {
+            sleep(LatencyStampLog::POLL_MS);
+            while (simStampLog.due(picoNowUs())) {
+                RpcArg* arg = rpc->getRpcArg();
+                simStampLog.encode(arg, picoNowUs());
+                rpc->callNoResponse(P2M_LATENCY_REPORT, arg);
+                rpc->disposeRpcArg(arg);
+            }
+        }
+    });
+    return rpc;
+}
+
+static bool simOnBoot(RpcManager* rpc) {
+    RpcArg* arg = rpc->getRpcArg();
+    arg->putString("SIMPICO");
+    arg->putInt32(0);
+    arg->putInt32(WIRE_CAP_PACKED_AXIS | WIRE_CAP_LATENCY_PROBE);
+    RpcResult res = rpc->call(P2M_ON_BOOT, arg);
+    rpc->disposeRpcArg(arg);
+    bool ok = res.error == RPC_OK && res.arg && res.arg->getBool();
+    if (res.arg) rpc->disposeRpcArg(res.arg);
+    return ok;
+}
+
+static int openPty(std::string& slavePath) {
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0) {
+        perror("posix_openpt");
+        return -1;
+    }
+    slavePath = ptsname(fd);
+    return fd;
+}
+
+// ── Self-test: EmulationBoard over the pty slave ────────────────────────────
+
+static void printHistogram(const char* name, const LatencyHistogram& h) {
+    printf("  %-6s count=%-5llu p50=%-6llu p99=%-6llu max=%llu us\n", name,
+           (unsigned long long)h.count(), (unsigned long long)h.percentileUs(50.0),
+           (unsigned long long)h.percentileUs(99.0), (unsigned long long)h.maxUs());
+}
+
+static int selfTest(const std::string& slavePath) {
+    setenv("INPUTPROXY_UART0", slavePath.c_str(), 1);
+    auto* uart = new UartManager(UART0);
+    if (!uart->configureUart()) return 1;
+    int fd = uart->getUartFd();
+
+    auto* framer = new StreamFramer();
+    auto* outCh  = makeChannel<RpcPacket>(100);
+    auto* inCh   = makeChannel<RpcPacket>(100);
+    auto* rpc    = new RpcManager(outCh, inCh, /*timeoutMs=*/2000);
+
+    auto* board = new EmulationBoard();
+    board->id          = 0;
+    board->rpc         = rpc;
+    board->uartChannel = UART0;
+    board->active      = true;
+    board->wireCaps    = WIRE_CAP_PACKED_AXIS | WIRE_CAP_LATENCY_PROBE;
+
+    rpc->registerMethod(P2M_LATENCY_REPORT, [board](RpcArg* arg) -> RpcArg* {
+        LatencyStampLog::decode(arg, [board](uint32_t tag, uint32_t applied, uint32_t report, bool reported) {
+            board->latency->onStamp(tag, applied, report, reported);
+        });
+        return nullptr;
+    });
+    coro_named("uart-read", [fd, framer]() {
+        while (true) {
+            uint8_t bytes[SF_BUFFER_SIZE];
+            ssize_t n = co_read(fd, bytes, sizeof(bytes));
+            if (n > 0) framer->write(bytes, (size_t)n);
+        }
+    });
+    coro_named("uart-write", [fd, outCh]() {
+        while (true) {
+            auto res = outCh->receive();
+            if (res.error) break;
+            uint32_t trace = res.value.trace();
+            gTracer.stamp(trace, TS_WRITE);
+            if (!StreamFramer::frame(res.value, 0)) continue;
+            const uint8_t* data = res.value.data();
+            int size = res.value.size(), off = 0;
+            while (off < size) {
+                ssize_t n = co_write(fd, data + off, size - off);
+                if (n == -EINTR) continue;
+                if (n <= 0) break;
+                off += (int)n;
+            }
+            gTracer.finish(trace);
+        }
+    });
+    coro_named("rpc-in", [framer, inCh]() {
+        while (true) {
+            auto res = framer->readCh->receive();
+            if (res.error) break;
+            inCh->send(std::move(res.value));
+        }
+    });
+
+    board->enableLatencyProbe();
+    while (!board->latency->clock.windowFull()) sleep(10);
+
+    gTracer.setSampleEvery(1);
+    for (int i = 0; i < TEST_EVENTS; i++) {
+        gTracer.current = gTracer.begin(0, LatencyTracer::nowNs());
+        board->setAxis(i % SIM_DEVICES, i % 8, i);
+        gTracer.current = 0;
+        sleep_us(500 + (i * 997) % 3000);
+    }
+    sleep(3 * LatencyStampLog::REPORT_MS);
+
+    const PicoLatency& l = *board->latency;
+    int32_t offsetError = (int32_t)(l.clock.offsetUs() - PICO_CLOCK_AHEAD_US);
+    printf("clock: offset error %d us, rtt %d us, %llu probes\n", offsetError, l.clock.rttUs(),
+           (unsigned long long)l.clock.samples());
+    printf("marks: %llu sent, %llu stamped, %llu without report, %llu unmatched\n",
+           (unsigned long long)l.marks(), (unsigned long long)l.stamped(),
+           (unsigned long long)l.noReport(), (unsigned long long)l.unmatched());
+    for (int st = 0; st < PicoLatency::ST_COUNT; st++)
+        printHistogram(PicoLatency::stageName((PicoLatency::Stage)st), l.histogram((PicoLatency::Stage)st));
+
+    bool ok = true;
+    auto check = [&ok](bool cond, const char* what) {
+        if (!cond) { printf("FAIL: %s\n", what); ok = false; }
+    };
+    // The estimate is only bounded by ±rtt/2; allow scheduling jitter on top
+    check(std::abs(offsetError) <= l.clock.rttUs() / 2 + 200, "clock offset within rtt/2");
+    check(l.marks() == TEST_EVENTS, "one mark per traced batch");
+    check(l.stamped() >= l.marks() * 9 / 10, "most marks stamped");
+    const LatencyHistogram& usb = l.histogram(PicoLatency::ST_USB);
+    check(usb.count() > 0 && usb.percentileUs(50.0) <= USB_FRAME_US + 500, "usb stage within a frame");
+    check(l.histogram(PicoLatency::ST_TOTAL).count() == usb.count(), "total recorded with usb");
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    bool serve = argc > 1 && strcmp(argv[1], "--serve") == 0;
+    std::string slavePath;
+    int fd = openPty(slavePath);
+    if (fd < 0) return 1;
+
+    RpcManager* pico = startSimPico(fd);
+    if (serve) {
+        // The mainboard sends M2P_REBOOT at startup; a real Pico answers by rebooting and announcing itself
+        pico->registerMethod(M2P_REBOOT, [pico](RpcArg*) -> RpcArg* {
+            coro([pico]() { simOnBoot(pico); });
+            return nullptr;
+        });
+        printf("simulated Pico on %s (INPUTPROXY_UART0=%s)\n", slavePath.c_str(), slavePath.c_str());
+        fflush(stdout);
+    } else {
+        coro([slavePath]() { exit(selfTest(slavePath)); });
+    }
+    scheduler_start();
+    return 0;
+}
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <cstring>
+#include <cerrno>
 #include <fcntl.h>
 #include <unistd.h>
 #include "rest/CoHttpServer.h"
@@ -6,6 +8,7 @@
 #include "../shared/shared.h"
 #include "../shared/PicoConfig.h"
 #include "../shared/crc32.h"
+#include "../shared/LatencyProbe.h"
 #include "corocrpc/corocrpc.h"
 #include "../shared/rpcinterface.h"
 #include "UartManager.h"
@@ -14,6 +17,9 @@
 #include "EmulatedDeviceManager.h"
 #include "MainConfig.h"
 #include "MappingManager.h"
+#include "pipeline/Pipeline.h"
+#include "pipeline/LatencyTrace.h"
+#include "pipeline/InputLog.h"
 
 using namespace corocrpc;
 using namespace corocgo;
@@ -26,6 +32,7 @@ struct UartRpcLink {
     Channel<RpcPacket>*  rpcOutCh;
     Channel<RpcPacket>*  rpcInCh;
     RpcManager*          rpcManager;
+    UartWriter*          writer;        // pipelined mode only, else nullptr
 };
 
 std::vector<UartRpcLink> uartLinks;
@@ -38,6 +45,11 @@ int nextEmulationBoardId = 1;
 Channel<AxisEvent>* axisEventChannel;
 RealDeviceManager* deviceManager;
 
+// Pipelined mode (gConfig.pipeline.enabled): evdev is read on ingestThread,
+// which reports disconnects through deviceGoneChannel
+IngestThread*          ingestThread      = nullptr;
+Channel<unsigned int>* deviceGoneChannel = nullptr;
+
 EmulatedDeviceManager* emulatedDeviceManager = nullptr;
 MappingManager* mappingManager = nullptr;
 std::vector<BoardEntry> boardConfigs;          // loaded from config.json at startup
@@ -50,9 +62,23 @@ int         turboAxisIndex = -1;
 // UART detection and RPC system setup
 // ---------------------------------------------------------------------------
 
+static const UART_CHANNEL uartChannels[] = { UART0, UART1, UART2, UART3, UART4, UART5 };
+
+// Packet buffers one link can pin while its Pico or UART stalls: both RPC
+// channels, the writer ring, the framer's read queue plus its staging buffer,
+// and a few handles in hand (the two bridges, a handler or caller mid-send).
+// Every link stalled at once still fits in the packet slab, so a stuck board
+// cannot starve the others.
+static constexpr int LINK_RPC_OUT_QUEUE = 16;
+static constexpr int LINK_RPC_IN_QUEUE  = 16;
+static constexpr int LINK_WRITER_RING   = 16;
+static constexpr int LINK_PACKETS_MAX   = LINK_RPC_OUT_QUEUE + LINK_RPC_IN_QUEUE + LINK_WRITER_RING
+                                        + StreamFramer::READ_QUEUE + 1 + 4;
+static_assert(std::size(uartChannels) * LINK_PACKETS_MAX <= COROCRPC_PACKET_POOL * 3 / 4,
+              "UART links can hold most of the packet slab; raise COROCRPC_PACKET_POOL");
+
 void detectUarts() {
-    UART_CHANNEL channels[] = { UART0, UART1, UART2, UART3, UART4, UART5 };
-    for (auto ch : channels) {
+    for (auto ch : uartChannels) {
         if (!UartManager::testUartChannel(ch)) continue;
 
         auto* uart = new UartManager(ch);
@@ -70,6 +96,7 @@ void detectUarts() {
         link.rpcOutCh    = nullptr;
         link.rpcInCh     = nullptr;
         link.rpcManager  = nullptr;
+        link.writer      = nullptr;
         uartLinks.push_back(std::move(link));
         std::cout << "UART" << ch << ": detected at " << uart->getActiveDevicePath() << std::endl;
     }
@@ -85,11 +112,18 @@ bool initRpcSystem() {
         return false;
     }
 
-    for (auto& link : uartLinks) {
+    const ConfPipeline& pipeline = gConfig.pipeline;
+    for (size_t i = 0; i < uartLinks.size(); i++) {
+        UartRpcLink& link = uartLinks[i];
         link.framer    = new StreamFramer();
-        link.rpcOutCh  = makeChannel<RpcPacket>(100);
-        link.rpcInCh   = makeChannel<RpcPacket>(100);
+        link.rpcOutCh  = makeChannel<RpcPacket>(LINK_RPC_OUT_QUEUE);
+        link.rpcInCh   = makeChannel<RpcPacket>(LINK_RPC_IN_QUEUE);
         link.rpcManager = new RpcManager(link.rpcOutCh, link.rpcInCh, /*timeoutMs=*/2000);
+        if (pipeline.enabled) {
+            int cpu = i < pipeline.uartWriterCpus.size() ? pipeline.uartWriterCpus[i] : -1;
+            link.writer = new UartWriter(link.uartManager, cpu, LINK_WRITER_RING);
+            link.writer->start();
+        }
 
         RpcManager*         rpc    = link.rpcManager;
         StreamFramer*       framer = link.framer;
@@ -128,6 +162,7 @@ bool initRpcSystem() {
             // as uint32. Values with high bit set arrive as negative int32 but recover
             // correctly: e.g. 0xFFFFFFFF → -1 → (uint32_t)-1 == 0xFFFFFFFF.
             uint32_t receivedCrc = static_cast<uint32_t>(arg->getInt32());
+            int32_t  wireCaps    = arg->getInt32();  // absent on older firmware → 0
             std::string picoId(picoIdBuf);
 
             std::cout << "[UART" << link.channel << "] onBoot picoId=" << picoId
@@ -159,6 +194,8 @@ bool initRpcSystem() {
                     board->uartChannel = link.channel;
                     board->active      = true;
                 }
+                board->wireCaps = wireCaps;
+                if (wireCaps & WIRE_CAP_LATENCY_PROBE) board->enableLatencyProbe();
                 emulatedDeviceManager->registerBoard(board, {});
                 if (mappingManager) mappingManager->onBoardRegistered();
                 RpcArg* out = rpc->getRpcArg();
@@ -189,6 +226,9 @@ bool initRpcSystem() {
                 board->uartChannel = link.channel;
                 board->picoConfig  = entry->config;
             }
+            board->coalesceWindowUs = entry->coalesceWindowUs;
+            board->wireCaps         = wireCaps;
+            if (wireCaps & WIRE_CAP_LATENCY_PROBE) board->enableLatencyProbe();
 
             if (receivedCrc == expectedCrc) {
                 board->active = true;
@@ -217,29 +257,55 @@ bool initRpcSystem() {
             return out;
         });
 
+        // latencyReport(varuint count, int32 baseUs, count × stamps) → void
+        rpc->registerMethod(P2M_LATENCY_REPORT, [rpc](RpcArg* arg) -> RpcArg* {
+            for (auto& b : emulationBoards) {
+                if (b.rpc != rpc || !b.latency) continue;
+                LatencyStampLog::decode(arg, [&b](uint32_t tag, uint32_t applied, uint32_t report, bool reported) {
+                    b.latency->onStamp(tag, applied, report, reported);
+                });
+                break;
+            }
+            return nullptr;
+        });
+
         // ── Transport bridges ─────────────────────────────────────────────
 
-        // Outbound: rpcOutCh → frame → UART send
-        coro([rpcOutChannel, framer, uart]() {
+        // Outbound: rpcOutCh → frame → UART send (framing and write() happen on
+        // the link's writer thread in pipelined mode)
+        UartWriter* writer = link.writer;
+        coro_named("uart-write", [rpcOutChannel, uart, writer]() {
             while (true) {
                 ChannelResult<RpcPacket> res = rpcOutChannel->receive();
                 if (res.error) break;
-                FramedPacket fp = framer->createPacket(
-                    0, reinterpret_cast<const char*>(res.value.data), res.value.size);
-                if (fp.size > 0)
-                    uart->uartSend(reinterpret_cast<const char*>(fp.data), fp.size);
+                if (writer) {
+                    if (!writer->queue(res.value)) break;   // parks while the writer is behind
+                    continue;
+                }
+                uint32_t trace = res.value.trace();
+                gTracer.stamp(trace, TS_WRITE);
+                if (!StreamFramer::frame(res.value, 0)) continue;   // header built in the headroom
+                const uint8_t* data = res.value.data();
+                int size = res.value.size(), off = 0;
+                while (off < size) {
+                    ssize_t n = co_write(uart->getUartFd(), data + off, size - off);
+                    if (n == -EINTR) continue;
+                    if (n <= 0) {
+                        std::cerr << "Error writing to UART: " << strerror((int)-n) << std::endl;
+                        break;
+                    }
+                    off += (int)n;
+                }
+                gTracer.finish(trace);
             }
         });
 
-        // Inbound: framer.readCh → deframe → rpcInCh
-        coro([rpcInChannel, framer]() {
+        // Inbound: framer.readCh → rpcInCh (the deframed buffer is handed over as is)
+        coro_named("rpc-in", [rpcInChannel, framer]() {
             while (true) {
                 auto res = framer->readCh->receive();
                 if (res.error) break;
-                RpcPacket pkt;
-                pkt.size = res.value.getDataSize();
-                memcpy(pkt.data, res.value.getData(), pkt.size);
-                rpcInChannel->send(pkt);
+                rpcInChannel->send(std::move(res.value));
             }
         });
     }
@@ -249,34 +315,28 @@ bool initRpcSystem() {
 }
 
 // ---------------------------------------------------------------------------
-static std::string resolveAxisName(const std::string& deviceIdStr, int axisIndex) {
-    for(auto& [id, dev] : deviceManager->getDevices())
-        if(dev.deviceIdStr == deviceIdStr)
-            return dev.axes.getName(axisIndex);
-    return {};
+static std::string resolveAxisName(unsigned int deviceId, int axisIndex) {
+    RealDevice* dev = deviceManager->getDevice(deviceId);
+    return dev ? dev->axes.getName(axisIndex) : std::string{};
 }
 
 void logRealDeviceEvent(AxisEvent&event) {
     bool printEvent=false;
     bool printAxisStringName=false;
     if(printEvent) {
-        std::cout<<"Event="<<event.deviceIdStr<<" axisIndex="<<event.axisIndex;
+        RealDevice* dev = deviceManager->getDevice(event.deviceId);
+        std::cout<<"Event="<<(dev ? dev->deviceIdStr : std::string("?"))<<" axisIndex="<<event.axisIndex;
         if(printAxisStringName){
-            std::cout<<"("<<resolveAxisName(event.deviceIdStr, event.axisIndex)<<")";
+            std::cout<<"("<<resolveAxisName(event.deviceId, event.axisIndex)<<")";
         }
         std::cout<<" value="<<event.value<<std::endl;
     }
 }
 
 void _main() {
-    std::cout << "=== Raspberry Pi 4 to Pico RPC System ===" << std::endl;
-
-    {
-        std::vector<std::string> startupErrors;
-        if (!loadConfig("config.json", startupErrors))
-            for (const auto& e : startupErrors)
-                std::cerr << "[config] " << e << "\n";
-    }
+    // _main runs on the scheduler thread — the mapping stage in pipelined mode
+    if (gConfig.pipeline.enabled)
+        pinCurrentThread(gConfig.pipeline.mappingCpu, "ip-mapping");
     boardConfigs = buildBoardEntries(gConfig.emulationBoards);
     std::cout << "Loaded " << boardConfigs.size() << " emulation board config(s)" << std::endl;
     emulatedDeviceManager = new EmulatedDeviceManager();
@@ -295,25 +355,42 @@ void _main() {
     deviceManager = new RealDeviceManager(duplicateSerialIds);
     deviceManager->load(gConfig.realDevices);
 
-    axisEventChannel = makeChannel<AxisEvent>(64);
+    if (!gConfig.pipeline.recordPath.empty()) {
+        std::string err;
+        if (gRecorder.start(gConfig.pipeline.recordPath, deviceManager->getDevices(), err))
+            std::cout << "[record] recording input to " << gConfig.pipeline.recordPath << std::endl;
+        else
+            std::cerr << "[record] " << err << std::endl;
+    }
+
+    if (gConfig.pipeline.enabled) {
+        // Ingest thread is the single external producer of axisEventChannel
+        axisEventChannel  = makeChannel<AxisEvent>(64, 1024);
+        deviceGoneChannel = makeChannel<unsigned int>(16, 64);
+        ingestThread = new IngestThread(deviceManager, axisEventChannel, deviceGoneChannel,
+                                        gConfig.pipeline.ingestCpu);
+        if (!ingestThread->start()) {
+            delete ingestThread;
+            ingestThread = nullptr;
+        }
+    } else {
+        axisEventChannel = makeChannel<AxisEvent>(64);
+    }
 
     // 1. UART → framer coroutines (one per detected channel)
     for (auto& link : uartLinks) {
-        coro([&link]() {
+        coro_named("uart-read", [&link]() {
             int fd = link.uartManager->getUartFd();
             while (true) {
-                auto [flags, err] = wait_file(fd, WAIT_IN);
-                if (err) {
+                // io_uring: the read is posted ahead of the data; otherwise
+                // wait_file + read(). VTIME makes an idle read return 0 every 0.5 s.
+                uint8_t bytes[SF_BUFFER_SIZE];
+                ssize_t n = co_read(fd, bytes, sizeof(bytes));
+                if (n < 0 && n != -EINTR) {
                     sleep(200);
                     continue;
                 }
-                RawChunk chunk;
-                ssize_t n = link.uartManager->uartRead(
-                    reinterpret_cast<char*>(chunk.data), RawChunk::MAX_SIZE);
-                if (n > 0) {
-                    chunk.len = static_cast<uint16_t>(n);
-                    link.framer->writeCh->send(chunk);
-                }
+                if (n > 0) link.framer->write(bytes, static_cast<size_t>(n));   // parsed inline
             }
         });
     }
@@ -327,7 +404,7 @@ void _main() {
     }
 
     // 3. Device discovery coroutine — loops every 5 seconds
-    coro([]() {
+    coro_named("discovery", []() {
         while (true) {
             auto allPaths = deviceManager->linuxInput.scanEventPaths();
             for (auto& path : allPaths) {
@@ -340,10 +417,40 @@ void _main() {
 
                 RealDevice* dev = deviceManager->registerDevice(path);
                 if (!dev) continue;
+                if (ingestThread) {
+                    std::cout << "[CONNECT] device=" << dev->deviceIdStr << std::endl;
+                    gRecorder.deviceConnected(*dev);
+                    if (mappingManager) mappingManager->onRealDeviceConnected(dev->deviceIdStr, *dev);
+                    ingestThread->addDevice(dev);
+                    continue;
+                }
                 // Spawn one reading coroutine per device
-                coro([dev]() {
+                coro_named("device-read", [dev]() {
                     std::cout << "[CONNECT] device=" << dev->deviceIdStr << std::endl;
+                    gRecorder.deviceConnected(*dev);
                     if (mappingManager) mappingManager->onRealDeviceConnected(dev->deviceIdStr, *dev);
+                    if (co_uring_active()) {
+                        // Completion I/O: one io_uring read per batch, no readiness hop
+                        struct input_event events[64];
+                        while (true) {
+                            ssize_t n = co_read(dev->fd, events, sizeof(events));
+                            if (n == -EINTR) continue;
+                            if (n <= 0) {
+                                deviceManager->markDisconnected(dev);
+                                break;
+                            }
+                            deviceManager->processEvents(dev, events, (int)(n / sizeof(struct input_event)),
+                                                         axisEventChannel);
+                        }
+                        std::cout << "[DISCONNECT] device=" << dev->deviceIdStr << std::endl;
+                        gRecorder.deviceDisconnected(*dev);
+                        if (mappingManager) mappingManager->onRealDeviceDisconnected(*dev);
+                        return;
+                    }
+                    // Persistent registration: no per-report epoll_ctl; processDeviceInput
+                    // drains the fd as the edge-triggered wait requires
+                    int fd = dev->fd;
+                    register_fd(fd, WAIT_IN);
                     while (true) {
                         auto [flags, err] = wait_file(dev->fd, WAIT_IN);
                         if (err || !(flags & WAIT_IN)) {
@@ -352,27 +459,57 @@ void _main() {
                         }
                         if (!deviceManager->processDeviceInput(dev, axisEventChannel)) break;
                     }
+                    unregister_fd(fd);
                     std::cout << "[DISCONNECT] device=" << dev->deviceIdStr << std::endl;
-                    if (mappingManager) mappingManager->onRealDeviceDisconnected(dev->deviceIdStr);
+                    gRecorder.deviceDisconnected(*dev);
+                    if (mappingManager) mappingManager->onRealDeviceDisconnected(*dev);
                 });
             }
             sleep(5000);
         }
     });
 
+    // Input recording (pipeline.record_path / POST /recording/start)
+    coro_named("record-flush", []() {
+        while (true) {
+            sleep(1000);
+            if (gRecorder.active()) gRecorder.flush();
+        }
+    });
+
+    // Pipelined mode: devices the ingest thread lost are closed here
+    if (ingestThread) {
+        coro_named("device-gone", []() {
+            while (true) {
+                auto [deviceId, err] = deviceGoneChannel->receive();
+                if (err) break;
+                RealDevice* dev = deviceManager->getDevice(deviceId);
+                if (!dev) continue;
+                deviceManager->markDisconnected(dev);
+                std::cout << "[DISCONNECT] device=" << dev->deviceIdStr << std::endl;
+                gRecorder.deviceDisconnected(*dev);
+                if (mappingManager) mappingManager->onRealDeviceDisconnected(*dev);
+            }
+        });
+    }
+
     // 4. Axis event processor coroutine
-    coro([]() {
+    coro_named("axis-dispatch", []() {
         while (true) {
             auto [event, err] = axisEventChannel->receive();
             if (err) break;
             logRealDeviceEvent(event);
+            gTracer.stamp(event.trace, TS_DISPATCH);
+            gTracer.current = event.trace;   // picked up by EmulationBoard::setAxis
             if (mappingManager)
-                mappingManager->axisEvent(event.deviceIdStr, event.axisIndex, event.value);
+                mappingManager->axisEvent(event.deviceId, event.axisIndex, event.value);
+            gTracer.stamp(event.trace, TS_MAPPED);
+            gTracer.current = 0;
         }
     });
 
     // 5. Debug turbo axis event generator coroutine (disabled by default)
-    coro([]() {
+    coro_named("debug-turbo", []() {
         while (true) {
             if (turboTimesPerSecond <= 0 || turboAxisIndex < 0) {
                 sleep(100);
@@ -380,9 +517,20 @@ void _main() {
             }
             int intervalMs = 1000 / turboTimesPerSecond;
 
-            axisEventChannel->send(AxisEvent{turboDeviceIdStr, turboAxisIndex, 1000});
+            // Events carry numeric ids; the target may reconnect under a new one
+            unsigned int turboDeviceId = 0;
+            bool         found         = false;
+            for (auto& [id, dev] : deviceManager->getDevices()) {
+                if (dev.deviceIdStr == turboDeviceIdStr) { turboDeviceId = id; found = true; break; }
+            }
+            if (!found) {
+                sleep(100);
+                continue;
+            }
+
+            axisEventChannel->send(AxisEvent{turboDeviceId, turboAxisIndex, 1000});
             sleep(intervalMs / 2);
-            axisEventChannel->send(AxisEvent{turboDeviceIdStr, turboAxisIndex, 0});
+            axisEventChannel->send(AxisEvent{turboDeviceId, turboAxisIndex, 0});
 
             sleep(intervalMs/2);
         }
@@ -420,16 +568,34 @@ void _main() {
     };
 
     startRestApi(8080, deviceManager, &emulationBoards, emulatedDeviceManager,
-                 &mappingManager->getLayerManager(), reloadConfigFn,
+                 &mappingManager->getLayerManager(), mappingManager, reloadConfigFn,
                  &turboTimesPerSecond, &turboDeviceIdStr, &turboAxisIndex);
 }
 
 int main() {
-    coro(_main);
+    std::cout << "=== Raspberry Pi 4 to Pico RPC System ===" << std::endl;
+
+    // Loaded before the scheduler starts: pipeline.inline_io configures it
+    {
+        std::vector<std::string> startupErrors;
+        if (!loadConfig("config.json", startupErrors))
+            for (const auto& e : startupErrors)
+                std::cerr << "[config] " << e << "\n";
+    }
+    scheduler_io_inline(gConfig.pipeline.inlineIo);
+    scheduler_io_uring(gConfig.pipeline.ioUring);
+    gTracer.setSampleEvery(gConfig.pipeline.traceSampleEvery);
+    if (gConfig.pipeline.profile || gConfig.pipeline.sliceBudgetUs > 0)
+        profiler_enable(true, gConfig.pipeline.sliceBudgetUs);
+
+    coro_named("main", _main);
     scheduler_start();
 
     // Cleanup
+    if (ingestThread) ingestThread->stop();
     for (auto& link : uartLinks) {
+        if (link.writer) link.writer->stop();
+        delete link.writer;
         delete link.rpcManager;
         delete link.framer;
         delete link.rpcOutCh;
@@ -2,24 +2,50 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <cstdint>
 #include "SequenceStep.h"
 
+// Config-side action lists keep names; MappingManager compiles them into an
+// ActionProgram whenever a board registers and only the program runs.
+
 struct Action {
     virtual ~Action() = default;
 };
 
 struct EmitAxisAction : Action {
     std::string vodId;
-    int         axisIndex = -1;  // resolved in phase 3
-    std::string axisName;        // retained for resolution
+    std::string axisName;
 };
 
 struct OutputSequenceAction : Action {
     std::string               vodId;
     std::vector<SequenceStep> steps;
     std::vector<std::string>  axisNames; // parallel to steps; empty for Wait steps
+    bool                      serialize = false; // queue behind earlier serialized sequences on this VOD
 };
 
 struct SleepAction : Action {
     int timeMs = 0;
 };
+
+// ── Compiled form ────────────────────────────────────────────────────────
+
+enum class ActionOp : uint8_t {
+    EmitValue,   // set the axis to the triggering event's value
+    SetAxis,     // set the axis to `value`
+};
+
+// One output step. Sleeps and sequence waits are folded into offsetMs.
+struct ActionInstr {
+    ActionOp op        = ActionOp::SetAxis;
+    int      offsetMs  = 0;
+    int      devIdx    = -1;   // EmulatedDeviceManager index
+    int      axisIndex = -1;
+    int      value     = 0;    // SetAxis only
+};
+
+struct ActionProgram {
+    std::vector<ActionInstr> code;            // sorted by offsetMs; unresolved steps dropped
+    std::vector<int>         serializeVods;   // devIdx lanes to queue behind
+    bool empty() const { return code.empty(); }
+};
@@ -11,31 +11,14 @@ std::vector<VidAxisRef> AxisRule::getActivationAxes() const {
     return first.modifiers;
 }
 
-bool AxisRule::checkExactMatch(const HotkeyPart& part, const VidStateMap& vidState) const {
-    for (const auto& vidId : part.involvedVids) {
-        auto vsIt = vidState.find(vidId);
-        if (vsIt == vidState.end()) continue;
-        for (const auto& [axisIdx, val] : vsIt->second) {
-            if (val == 0) continue;
-            bool allowed = false;
-            if (part.activationAxis && part.activationAxis->vidId == vidId
-                && part.activationAxis->axisIndex == axisIdx) {
-                allowed = true;
-            }
-            for (const auto& mod : part.modifiers) {
-                if (mod.vidId == vidId && mod.axisIndex == axisIdx) {
-                    allowed = true;
-                    break;
-                }
-            }
-            if (!allowed) return false;
-        }
+bool AxisRule::checkExactMatch(const HotkeyPart& part, const VidState& vidState) const {
+    // Masks are built after axis resolution; until then nothing can match.
+    if (part.allowedMasks.size() != part.involvedVids.size()) return false;
+    for (size_t i = 0; i < part.involvedVids.size(); i++) {
+        if (!vidState.activeSubsetOf(part.involvedVids[i], part.allowedMasks[i])) return false;
     }
     for (const auto& mod : part.modifiers) {
-        auto vsIt = vidState.find(mod.vidId);
-        if (vsIt == vidState.end()) return false;
-        auto axIt = vsIt->second.find(mod.axisIndex);
-        if (axIt == vsIt->second.end() || axIt->second == 0) return false;
+        if (!vidState.isHeld(mod.vid, mod.axisIndex)) return false;
     }
     return true;
 }
@@ -50,31 +33,28 @@ AxisRule::EventResult AxisRule::advance() {
     return EventResult::Advanced;
 }
 
-AxisRule::EventResult AxisRule::tryActivateFirstStep(const std::string& vidId,
+AxisRule::EventResult AxisRule::tryActivateFirstStep(int vid,
                                                       int axisIndex,
-                                                      const VidStateMap& vidState) {
+                                                      const VidState& vidState) {
     if (hotkeyParts.empty()) return EventResult::Ignored;
     const HotkeyPart& part = hotkeyParts[0];
 
     if (part.activationAxis.has_value()) {
-        if (part.activationAxis->vidId != vidId ||
+        if (part.activationAxis->vid != vid ||
             part.activationAxis->axisIndex != axisIndex)
             return EventResult::Ignored;
         if (exclusive && !checkExactMatch(part, vidState)) return EventResult::Ignored;
     } else {
         bool isOurModifier = false;
         for (const auto& mod : part.modifiers) {
-            if (mod.vidId == vidId && mod.axisIndex == axisIndex) {
+            if (mod.vid == vid && mod.axisIndex == axisIndex) {
                 isOurModifier = true;
                 break;
             }
         }
         if (!isOurModifier) return EventResult::Ignored;
         for (const auto& mod : part.modifiers) {
-            auto vsIt = vidState.find(mod.vidId);
-            if (vsIt == vidState.end()) return EventResult::Ignored;
-            auto axIt = vsIt->second.find(mod.axisIndex);
-            if (axIt == vsIt->second.end() || axIt->second == 0) return EventResult::Ignored;
+            if (!vidState.isHeld(mod.vid, mod.axisIndex)) return EventResult::Ignored;
         }
     }
 
@@ -83,19 +63,19 @@ AxisRule::EventResult AxisRule::tryActivateFirstStep(const std::string& vidId,
     return advance();
 }
 
-AxisRule::EventResult AxisRule::processAxisEvent(const std::string& vidId,
+AxisRule::EventResult AxisRule::processAxisEvent(int vid,
                                                   int axisIndex,
-                                                  const VidStateMap& vidState) {
+                                                  const VidState& vidState) {
     if (hotkeyParts.empty() || state != State::InProgress) return EventResult::Ignored;
     const HotkeyPart& part = hotkeyParts[currentStep];
 
     for (const auto& mod : part.modifiers) {
-        if (mod.vidId == vidId && mod.axisIndex == axisIndex)
+        if (mod.vid == vid && mod.axisIndex == axisIndex)
             return EventResult::Ignored;
     }
 
     if (part.activationAxis.has_value() &&
-        part.activationAxis->vidId == vidId &&
+        part.activationAxis->vid == vid &&
         part.activationAxis->axisIndex == axisIndex) {
         if (exclusive && !checkExactMatch(part, vidState)) {
             reset();
@@ -104,7 +84,7 @@ AxisRule::EventResult AxisRule::processAxisEvent(const std::string& vidId,
         return advance();
     }
 
-    bool inPartVid = std::find(part.involvedVids.begin(), part.involvedVids.end(), vidId)
+    bool inPartVid = std::find(part.involvedVids.begin(), part.involvedVids.end(), vid)
                      != part.involvedVids.end();
     if (!inPartVid) return EventResult::Ignored;
 
@@ -112,11 +92,11 @@ AxisRule::EventResult AxisRule::processAxisEvent(const std::string& vidId,
     return EventResult::Cancelled;
 }
 
-bool AxisRule::isReleaseEvent(const std::string& vidId, int axisIndex, int value) const {
+bool AxisRule::isReleaseEvent(int vid, int axisIndex, int value) const {
     if (value != 0) return false;
     if (hotkeyParts.empty()) return false;
     const HotkeyPart& last = hotkeyParts.back();
     if (!last.activationAxis.has_value()) return false;
-    return last.activationAxis->vidId == vidId &&
+    return last.activationAxis->vid == vid &&
            last.activationAxis->axisIndex == axisIndex;
 }
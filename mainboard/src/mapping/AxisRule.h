@@ -4,13 +4,15 @@
 #include <memory>
 #include "HotkeyPart.h"
 #include "Action.h"
-#include "VidStateMap.h"
+#include "VidState.h"
 
 class AxisRule {
 public:
     std::vector<HotkeyPart>               hotkeyParts;
     std::vector<std::unique_ptr<Action>>  pressActions;
     std::vector<std::unique_ptr<Action>>  releaseActions;
+    ActionProgram                         pressProgram;    // compiled from pressActions
+    ActionProgram                         releaseProgram;  // compiled from releaseActions
     bool                                  propagate  = true;
     bool                                  exclusive  = true;  // false = skip exact-match check
 
@@ -31,21 +33,21 @@ public:
 
     // Called while rule is InProgress (in layer.activeRules).
     // Only called for press events (value > 0).
-    EventResult processAxisEvent(const std::string& vidId, int axisIndex,
-                                 const VidStateMap& vidState);
+    EventResult processAxisEvent(int vid, int axisIndex,
+                                 const VidState& vidState);
 
     // Called from activation index when rule is Idle.
     // Only called for press events (value > 0).
-    EventResult tryActivateFirstStep(const std::string& vidId, int axisIndex,
-                                     const VidStateMap& vidState);
+    EventResult tryActivateFirstStep(int vid, int axisIndex,
+                                     const VidState& vidState);
 
     // Returns true if this is a release event for the last part's activation axis.
     // Only meaningful when state == WaitingForRelease.
-    bool isReleaseEvent(const std::string& vidId, int axisIndex, int value) const;
+    bool isReleaseEvent(int vid, int axisIndex, int value) const;
 
     void reset() { state = State::Idle; currentStep = 0; }
 
 private:
-    bool checkExactMatch(const HotkeyPart& part, const VidStateMap& vidState) const;
+    bool checkExactMatch(const HotkeyPart& part, const VidState& vidState) const;
     EventResult advance();
 };
@@ -10,6 +10,6 @@ struct BlockEntry {
 };
 
 struct BlockRule {
-    std::string             vidId;
+    int                     vid = -1;   // interned VID id
     std::vector<BlockEntry> entries;
 };
@@ -0,0 +1,92 @@
+// mainboard/src/mapping/DispatchIndex.cpp
+#include "DispatchIndex.h"
+#include "LayerManager.h"
+#include <algorithm>
+
+bool DispatchIndex::isStale(const LayerManager& lm) const {
+    return stackVersion != lm.version;
+}
+
+void DispatchIndex::rebuildStack(const LayerManager& lm) {
+    stackIndex.clear();
+    std::unordered_map<VidAxisKey, DispatchEntry, VidAxisKeyHash> layerEntries;
+
+    for (Layer* layer : lm.stack()) {
+        layerEntries.clear();
+        auto entryFor = [&](int vid, int axisIndex) -> DispatchEntry& {
+            DispatchEntry& e = layerEntries[VidAxisKey{ vid, axisIndex }];
+            e.layer = layer;
+            return e;
+        };
+
+        // First matching block entry wins, as in rule order
+        for (const auto& br : layer->blockRules) {
+            for (const auto& be : br.entries) {
+                if (be.axisIndex == -1) continue;
+                DispatchEntry& e = entryFor(br.vid, be.axisIndex);
+                if (e.blocked) continue;
+                e.blocked    = true;
+                e.blockValue = be.value;
+            }
+        }
+
+        for (const auto& tr : layer->turboRules) {
+            if (tr.axisIndex == -1) continue;
+            DispatchEntry& e = entryFor(tr.vid, tr.axisIndex);
+            if (!e.turbo) e.turbo = &tr;
+            if (tr.condition == TurboCondition::WhileAxisActive) e.turboRelease = true;
+        }
+
+        for (const auto& [key, rules] : layer->activationIndex)
+            entryFor(key.vid, key.axisIndex).hotkeys = &rules;
+
+        // Release events must reach layers whose completed hotkeys wait on the axis
+        for (const auto& rule : layer->rules) {
+            if (rule.releaseActions.empty() || rule.hotkeyParts.empty()) continue;
+            const auto& last = rule.hotkeyParts.back();
+            if (last.activationAxis && last.activationAxis->axisIndex != -1)
+                entryFor(last.activationAxis->vid, last.activationAxis->axisIndex);
+        }
+
+        for (const auto& [key, e] : layerEntries)
+            stackIndex[key].push_back(e);
+    }
+    stackVersion = lm.version;
+}
+
+void DispatchIndex::rebuildTriggers(std::vector<Layer>& allLayers) {
+    triggerIndex.clear();
+    for (auto& layer : allLayers) {
+        if (!layer.activationRule || !layer.activation.has_value()) continue;
+        const AxisRule& rule = *layer.activationRule;
+        if (rule.hotkeyParts.empty()) continue;
+
+        auto add = [&](const VidAxisRef& ref) {
+            if (ref.axisIndex == -1) return;
+            auto& layers = triggerIndex[VidAxisKey{ ref.vid, ref.axisIndex }];
+            if (std::find(layers.begin(), layers.end(), &layer) == layers.end())
+                layers.push_back(&layer);
+        };
+        // Presses can only start a trigger on its first step's axes; releases
+        // only matter on the last part's activation axis.
+        for (const auto& ref : rule.getActivationAxes()) add(ref);
+        const auto& last = rule.hotkeyParts.back();
+        if (last.activationAxis) add(*last.activationAxis);
+    }
+}
+
+void DispatchIndex::clear() {
+    stackIndex.clear();
+    triggerIndex.clear();
+    invalidate();
+}
+
+const std::vector<DispatchEntry>* DispatchIndex::findStack(int vid, int axisIndex) const {
+    auto it = stackIndex.find(VidAxisKey{ vid, axisIndex });
+    return it != stackIndex.end() ? &it->second : nullptr;
+}
+
+const std::vector<Layer*>* DispatchIndex::findTriggers(int vid, int axisIndex) const {
+    auto it = triggerIndex.find(VidAxisKey{ vid, axisIndex });
+    return it != triggerIndex.end() ? &it->second : nullptr;
+}
@@ -0,0 +1,45 @@
+// mainboard/src/mapping/DispatchIndex.h
+// Per-(VID, axis) candidate lists compiled from the layer rules, so a VID axis
+// event visits only the layers and rules that can react to it instead of
+// scanning every block/turbo rule of every active layer and every trigger.
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+#include "Layer.h"
+
+class LayerManager;
+
+// What one active layer does with events on one (vid, axis).
+struct DispatchEntry {
+    Layer*                        layer        = nullptr;
+    bool                          blocked      = false;
+    int                           blockValue   = 0;
+    const TurboRule*              turbo        = nullptr;  // first turbo rule on the axis
+    bool                          turboRelease = false;    // a WhileAxisActive turbo stops on release
+    const std::vector<AxisRule*>* hotkeys      = nullptr;  // layer->activationIndex bucket
+};
+
+class DispatchIndex {
+public:
+    // Active-stack candidates, top layer first. Rebuilt lazily whenever the
+    // LayerManager stack version moves on.
+    bool isStale(const LayerManager& lm) const;
+    void rebuildStack(const LayerManager& lm);
+
+    // Layers whose activation trigger involves the axis, config order.
+    // Rebuilt after axis resolution (load / device connect).
+    void rebuildTriggers(std::vector<Layer>& allLayers);
+
+    // Forces the next isStale() to report true (rules or indices changed).
+    void invalidate() { stackVersion = ~0ull; }
+    void clear();
+
+    const std::vector<DispatchEntry>* findStack(int vid, int axisIndex) const;
+    const std::vector<Layer*>*        findTriggers(int vid, int axisIndex) const;
+
+private:
+    std::unordered_map<VidAxisKey, std::vector<DispatchEntry>, VidAxisKeyHash> stackIndex;
+    std::unordered_map<VidAxisKey, std::vector<Layer*>, VidAxisKeyHash>        triggerIndex;
+    uint64_t                                                                   stackVersion = ~0ull;
+};
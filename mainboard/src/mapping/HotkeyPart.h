@@ -3,29 +3,46 @@
 #include <vector>
 #include <optional>
 #include <functional>
+#include <cstdint>
+#include "VidState.h"
+
+// VID ids are dense integers from MappingManager's SymbolTable (-1 = unknown).
 
 struct VidAxisRef {
-    std::string vidId;
+    int         vid       = -1;
     std::string axisName;  // retained for deferred resolution
     int         axisIndex = -1;
 };
 
 struct VidAxisKey {
-    std::string vidId;
-    int         axisIndex = -1;
+    int vid       = -1;
+    int axisIndex = -1;
     bool operator==(const VidAxisKey& o) const {
-        return vidId == o.vidId && axisIndex == o.axisIndex;
+        return vid == o.vid && axisIndex == o.axisIndex;
     }
 };
 
 struct VidAxisKeyHash {
     std::size_t operator()(const VidAxisKey& k) const {
-        return std::hash<std::string>{}(k.vidId) ^ (std::hash<int>{}(k.axisIndex) << 16);
+        return std::hash<uint64_t>{}(((uint64_t)(uint32_t)k.vid << 32) | (uint32_t)k.axisIndex);
     }
 };
 
 struct HotkeyPart {
     std::vector<VidAxisRef>  modifiers;
     std::optional<VidAxisRef> activationAxis;  // absent = modifier-only part
-    std::vector<std::string>  involvedVids;    // derived: unique VIDs in this part
+    std::vector<int>          involvedVids;    // derived: unique VIDs in this part
+    std::vector<AxisMask>     allowedMasks;    // derived: parallel to involvedVids
+
+    // Rebuilds allowedMasks from the resolved modifier/activation indices.
+    void rebuildAllowedMasks() {
+        allowedMasks.assign(involvedVids.size(), AxisMask{});
+        auto add = [&](const VidAxisRef& ref) {
+            if (ref.axisIndex < 0) return;
+            for (size_t i = 0; i < involvedVids.size(); i++)
+                if (involvedVids[i] == ref.vid) axisMaskSet(allowedMasks[i], ref.axisIndex);
+        };
+        for (const auto& m : modifiers) add(m);
+        if (activationAxis) add(*activationAxis);
+    }
 };
@@ -0,0 +1,25 @@
+// mainboard/src/mapping/LatencyStat.h
+#pragma once
+#include <cstdint>
+#include <chrono>
+
+// Running count / mean / max of a latency in microseconds.
+struct LatencyStat {
+    uint64_t count   = 0;
+    uint64_t totalUs = 0;
+    uint64_t maxUs   = 0;
+
+    void record(uint64_t us) {
+        count++;
+        totalUs += us;
+        if (us > maxUs) maxUs = us;
+    }
+
+    void record(std::chrono::steady_clock::duration d) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        record(us > 0 ? (uint64_t)us : 0);
+    }
+
+    uint64_t avgUs() const { return count ? totalUs / count : 0; }
+    void     reset()       { *this = LatencyStat{}; }
+};
@@ -8,7 +8,7 @@ void Layer::rebuildActivationIndex() {
     for (auto& rule : rules) {
         for (const auto& ref : rule.getActivationAxes()) {
             if (ref.axisIndex == -1) continue;
-            VidAxisKey key { ref.vidId, ref.axisIndex };
+            VidAxisKey key { ref.vid, ref.axisIndex };
             activationIndex[key].push_back(&rule);
         }
     }
@@ -37,6 +37,7 @@ void LayerManager::activate(const std::string& id) {
     for (auto* l : activeStack)
         if (l->id == id) return;
     activeStack.insert(activeStack.begin(), layer);
+    version++;
     if (onActivate) onActivate(layer);
     std::cout << "[layers] activated '" << id << "'\n";
 }
@@ -48,5 +49,6 @@ void LayerManager::deactivate(const std::string& id) {
     if (onDeactivate) onDeactivate(*it);
     (*it)->resetActiveRules();
     activeStack.erase(it);
+    version++;
     std::cout << "[layers] deactivated '" << id << "'\n";
 }
@@ -3,12 +3,14 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <cstdint>
 #include "Layer.h"
 
 class LayerManager {
 public:
     std::vector<Layer>   allLayers;    // all defined layers, config order
     std::vector<Layer*>  activeStack;  // active layers, top = front
+    uint64_t             version = 0;  // bumped on every activeStack change
 
     // Optional callbacks called on activate/deactivate
     std::function<void(Layer*)> onActivate;
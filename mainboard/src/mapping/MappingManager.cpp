@@ -7,6 +7,7 @@
 #include "corocgo/corocgo.h"
 #include <iostream>
 #include <algorithm>
+#include <chrono>
 
 using namespace corocgo;
 
@@ -20,7 +21,8 @@ struct ParsedHotkey {
 };
 
 static ParsedHotkey parseHotkeyString(const std::string& hotkey,
-                                       const std::string& defaultVidId) {
+                                       const std::string& defaultVidId,
+                                       SymbolTable& vidSymbols) {
     ParsedHotkey result;
     std::vector<std::string> partStrs;
     std::string remaining = hotkey;
@@ -69,7 +71,7 @@ static ParsedHotkey parseHotkeyString(const std::string& hotkey,
             }
 
             VidAxisRef ref;
-            ref.vidId     = vidId;
+            ref.vid       = vidSymbols.intern(vidId);
             ref.axisName  = axisName;
             ref.axisIndex = -1;
 
@@ -84,13 +86,13 @@ static ParsedHotkey parseHotkeyString(const std::string& hotkey,
             }
         }
 
-        auto addVid = [&](const std::string& vid) {
+        auto addVid = [&](int vid) {
             if (std::find(part.involvedVids.begin(), part.involvedVids.end(), vid)
                 == part.involvedVids.end())
                 part.involvedVids.push_back(vid);
         };
-        for (const auto& m : part.modifiers) addVid(m.vidId);
-        if (part.activationAxis) addVid(part.activationAxis->vidId);
+        for (const auto& m : part.modifiers) addVid(m.vid);
+        if (part.activationAxis) addVid(part.activationAxis->vid);
 
         result.parts.push_back(std::move(part));
     }
@@ -104,7 +106,6 @@ static std::vector<std::unique_ptr<Action>> buildActions(const std::vector<ConfA
             auto act       = std::make_unique<EmitAxisAction>();
             act->vodId     = a.vod;
             act->axisName  = a.axis;
-            act->axisIndex = -1;
             result.push_back(std::move(act));
         } else if (a.type == ConfActionType::OutputSequence) {
             auto act       = std::make_unique<OutputSequenceAction>();
@@ -112,6 +113,7 @@ static std::vector<std::unique_ptr<Action>> buildActions(const std::vector<ConfA
             auto parsed    = parseOutputSequence(a.sequence);
             act->steps     = std::move(parsed.steps);
             act->axisNames = std::move(parsed.axisNames);
+            act->serialize = a.serialize;
             result.push_back(std::move(act));
         } else if (a.type == ConfActionType::Sleep) {
             auto act    = std::make_unique<SleepAction>();
@@ -127,39 +129,53 @@ static std::vector<std::unique_ptr<Action>> buildActions(const std::vector<ConfA
 // ---------------------------------------------------------------------------
 
 void MappingManager::clear() {
+    sequencer.cancelAll();
     // Stop all turbos before clearing
-    for (auto& [key, running] : activeTurbos) *running = false;
+    for (auto& [key, turbo] : activeTurbos) {
+        turbo->running = false;
+        corocgo::sleep_cancel(turbo->coro);
+    }
     activeTurbos.clear();
     usbDisconnectedBoards.clear();
     vids.clear();
+    vidSymbols.clear();
     realDeviceMappings.clear();
     deviceAssignments.clear();
     vidState.clear();
     layerManager.allLayers.clear();
     layerManager.activeStack.clear();
+    layerManager.version++;
+    dispatchIndex.clear();
+    inProgressRules = 0;
 }
 
 void MappingManager::load(const ConfRoot& config, EmulatedDeviceManager* edm_) {
     edm = edm_;
+    sequencer.setDeviceManager(edm);
 
     for (const auto& v : config.vids) {
         if (v.id.empty()) { std::cerr << "[mapping] VID missing id\n"; continue; }
+        if (vidSymbols.find(v.id) != -1) { std::cerr << "[mapping] duplicate VID '" << v.id << "'\n"; continue; }
+        vidSymbols.intern(v.id);
         VirtualInputDevice vid;
         vid.id   = v.id;
         vid.name = v.name;
-        vids.emplace(v.id, std::move(vid));
+        vids.push_back(std::move(vid));
     }
 
     for (const auto& rd : config.realDevices) {
         if (rd.id.empty() || rd.assignedTo.empty()) continue;
-        if (vids.find(rd.assignedTo) == vids.end()) {
+        int vid = vidSymbols.find(rd.assignedTo);
+        if (vid == -1) {
             std::cerr << "[mapping] device '" << rd.id
                       << "' assigned to unknown VID '" << rd.assignedTo << "'\n";
             continue;
         }
-        deviceAssignments[rd.id] = rd.assignedTo;
+        deviceAssignments[rd.id] = vid;
     }
 
+    // activeStack and rule indexes hold Layer pointers — no reallocation past this point
+    layerManager.allLayers.reserve(config.layers.size());
     for (const auto& lc : config.layers) {
         Layer layer;
         layer.id   = lc.id;
@@ -168,6 +184,7 @@ void MappingManager::load(const ConfRoot& config, EmulatedDeviceManager* edm_) {
 
         for (const auto& rc : lc.rules) {
             std::string vidId = rc.vid;
+            int         vid   = vidSymbols.intern(vidId);
 
             if (rc.type == ConfRuleType::Simple) {
                 std::string vodId = rc.vod;
@@ -180,11 +197,11 @@ void MappingManager::load(const ConfRoot& config, EmulatedDeviceManager* edm_) {
 
                     HotkeyPart part;
                     VidAxisRef ref;
-                    ref.vidId     = vidId;
+                    ref.vid       = vid;
                     ref.axisName  = ax.from;
                     ref.axisIndex = -1;
                     part.activationAxis = ref;
-                    part.involvedVids   = { vidId };
+                    part.involvedVids   = { vid };
                     rule.hotkeyParts.push_back(std::move(part));
 
                     auto press = std::make_unique<EmitAxisAction>();
@@ -202,7 +219,7 @@ void MappingManager::load(const ConfRoot& config, EmulatedDeviceManager* edm_) {
             } else if (rc.type == ConfRuleType::Hotkey) {
                 AxisRule rule;
                 rule.propagate   = rc.propagate;
-                auto parsed      = parseHotkeyString(rc.hotkey, vidId);
+                auto parsed      = parseHotkeyString(rc.hotkey, vidId, vidSymbols);
                 rule.hotkeyParts = std::move(parsed.parts);
                 rule.exclusive   = !parsed.inclusive;
                 rule.pressActions   = buildActions(rc.pressActions);
@@ -211,7 +228,7 @@ void MappingManager::load(const ConfRoot& config, EmulatedDeviceManager* edm_) {
 
             } else if (rc.type == ConfRuleType::Block) {
                 BlockRule br;
-                br.vidId = vidId;
+                br.vid = vid;
                 for (const auto& ba : rc.blockAxes) {
                     BlockEntry e;
                     e.axisName = ba.axis;
@@ -232,7 +249,7 @@ void MappingManager::load(const ConfRoot& config, EmulatedDeviceManager* edm_) {
 
             } else if (rc.type == ConfRuleType::Turbo) {
                 TurboRule tr;
-                tr.vidId        = vidId;
+                tr.vid          = vid;
                 tr.axisName     = rc.turboAxis;
                 tr.onMs         = rc.turboOnMs;
                 tr.offMs        = rc.turboOffMs;
@@ -256,7 +273,7 @@ void MappingManager::load(const ConfRoot& config, EmulatedDeviceManager* edm_) {
             if (!act.hotkey.empty() && !act.vid.empty()) {
                 auto rule = std::make_unique<AxisRule>();
                 rule->propagate  = false;
-                auto parsed      = parseHotkeyString(act.hotkey, act.vid);
+                auto parsed      = parseHotkeyString(act.hotkey, act.vid, vidSymbols);
                 rule->hotkeyParts = std::move(parsed.parts);
                 rule->exclusive  = !parsed.inclusive;
                 layer.activationRule = std::move(rule);
@@ -279,17 +296,22 @@ void MappingManager::load(const ConfRoot& config, EmulatedDeviceManager* edm_) {
     };
 
     layerManager.onDeactivate = [this](Layer* layer) {
+        inProgressRules -= (int)layer->activeRules.size();   // reset by the LayerManager
         for (auto& br : layer->blockRules) {
             for (auto& e : br.entries) {
                 if (e.axisIndex == -1 || e.value == 0) continue;
-                vidState[br.vidId][e.axisIndex] = 0;
-                dispatchVidAxisEvent(br.vidId, e.axisIndex, 0);
+                vidState.set(br.vid, e.axisIndex, 0);
+                dispatchVidAxisEvent(br.vid, e.axisIndex, 0);
             }
         }
         stopAllTurbosForLayer(layer);
+        sequencer.cancelOwner(layer);
         evaluateVodStates();
     };
 
+    // Every VID id that rules can mention exists by now
+    vidState.reset(vidSymbols.size());
+
     // Start always-turbos for layers active at boot
     for (Layer* layer : layerManager.activeStack) {
         for (auto& tr : layer->turboRules) {
@@ -313,32 +335,33 @@ void MappingManager::resolveVidAxes() {
             for (auto& part : rule.hotkeyParts) {
                 auto resolveRef = [&](VidAxisRef& ref) {
                     if (ref.axisIndex != -1 || ref.axisName.empty()) return;
-                    auto vidIt = vids.find(ref.vidId);
-                    if (vidIt == vids.end()) return;
-                    ref.axisIndex = vidIt->second.axisTable.getIndex(ref.axisName);
+                    VirtualInputDevice* vid = findVid(ref.vid);
+                    if (!vid) return;
+                    ref.axisIndex = vid->axisTable.getIndex(ref.axisName);
                 };
                 for (auto& mod : part.modifiers) resolveRef(mod);
                 if (part.activationAxis) resolveRef(part.activationAxis.value());
+                part.rebuildAllowedMasks();
             }
         }
         layer.rebuildActivationIndex();
 
         // Resolve BlockRule axis indices
         for (auto& br : layer.blockRules) {
-            auto vidIt = vids.find(br.vidId);
-            if (vidIt == vids.end()) continue;
+            VirtualInputDevice* vid = findVid(br.vid);
+            if (!vid) continue;
             for (auto& e : br.entries) {
                 if (e.axisIndex == -1 && !e.axisName.empty())
-                    e.axisIndex = vidIt->second.axisTable.getIndex(e.axisName);
+                    e.axisIndex = vid->axisTable.getIndex(e.axisName);
             }
         }
 
         // Resolve TurboRule axis indices
         for (auto& tr : layer.turboRules) {
-            auto vidIt = vids.find(tr.vidId);
-            if (vidIt == vids.end()) continue;
+            VirtualInputDevice* vid = findVid(tr.vid);
+            if (!vid) continue;
             if (tr.axisIndex == -1 && !tr.axisName.empty())
-                tr.axisIndex = vidIt->second.axisTable.getIndex(tr.axisName);
+                tr.axisIndex = vid->axisTable.getIndex(tr.axisName);
         }
 
         // Resolve activation rule axis indices
@@ -346,56 +369,85 @@ void MappingManager::resolveVidAxes() {
             for (auto& part : layer.activationRule->hotkeyParts) {
                 auto resolveRef = [&](VidAxisRef& ref) {
                     if (ref.axisIndex != -1 || ref.axisName.empty()) return;
-                    auto vidIt = vids.find(ref.vidId);
-                    if (vidIt == vids.end()) return;
-                    ref.axisIndex = vidIt->second.axisTable.getIndex(ref.axisName);
+                    VirtualInputDevice* vid = findVid(ref.vid);
+                    if (!vid) return;
+                    ref.axisIndex = vid->axisTable.getIndex(ref.axisName);
                 };
                 for (auto& mod : part.modifiers) resolveRef(mod);
                 if (part.activationAxis) resolveRef(part.activationAxis.value());
+                part.rebuildAllowedMasks();
             }
         }
     }
+
+    // activationIndex buckets were rebuilt; entries point into them
+    dispatchIndex.rebuildTriggers(layerManager.allLayers);
+    dispatchIndex.invalidate();
 }
 
-void MappingManager::resolveVodAxes() {
+// Resolves VOD/axis names against the currently registered boards and
+// flattens the list into instructions. Actions whose VOD or axis does not
+// resolve yet compile to nothing; the next board registration retries.
+static ActionProgram compileActions(const std::vector<std::unique_ptr<Action>>& actions,
+                                    EmulatedDeviceManager* edm) {
+    ActionProgram prog;
+    int offset = 0;
+    for (const auto& a : actions) {
+        const Action* act = a.get();
+        if (auto* ea = dynamic_cast<const EmitAxisAction*>(act)) {
+            int devIdx = edm->resolveId(ea->vodId);
+            if (devIdx == -1) continue;
+            int axis = edm->getDevices()[devIdx].axisTable.getIndex(ea->axisName);
+            if (axis == -1) continue;
+            prog.code.push_back({ActionOp::EmitValue, offset, devIdx, axis, 0});
+        } else if (auto* osa = dynamic_cast<const OutputSequenceAction*>(act)) {
+            int devIdx = edm->resolveId(osa->vodId);
+            if (devIdx != -1 && osa->serialize &&
+                std::find(prog.serializeVods.begin(), prog.serializeVods.end(), devIdx) == prog.serializeVods.end())
+                prog.serializeVods.push_back(devIdx);
+            for (size_t i = 0; i < osa->steps.size(); ++i) {
+                const SequenceStep& step = osa->steps[i];
+                if (step.type == SequenceStep::Type::Wait) {
+                    offset += step.timeMs;
+                    continue;
+                }
+                if (devIdx == -1 || i >= osa->axisNames.size()) continue;
+                int axis = edm->getDevices()[devIdx].axisTable.getIndex(osa->axisNames[i]);
+                if (axis == -1) continue;
+                prog.code.push_back({ActionOp::SetAxis, offset, devIdx, axis, step.value});
+            }
+        } else if (auto* sa = dynamic_cast<const SleepAction*>(act)) {
+            offset += sa->timeMs;
+        }
+    }
+    return prog;
+}
+
+void MappingManager::compileActionPrograms() {
     for (auto& layer : layerManager.allLayers) {
         for (auto& rule : layer.rules) {
-            auto resolveAction = [&](Action* act) {
-                if (auto* ea = dynamic_cast<EmitAxisAction*>(act)) {
-                    if (ea->axisIndex != -1 || ea->axisName.empty()) return;
-                    int devIdx = edm->resolveId(ea->vodId);
-                    if (devIdx == -1) return;
-                    ea->axisIndex = edm->getDevices()[devIdx].axisTable.getIndex(ea->axisName);
-                } else if (auto* osa = dynamic_cast<OutputSequenceAction*>(act)) {
-                    int devIdx = edm->resolveId(osa->vodId);
-                    if (devIdx == -1) return;
-                    for (size_t i = 0; i < osa->steps.size(); ++i) {
-                        if (osa->steps[i].type == SequenceStep::Type::SetAxis &&
-                            osa->steps[i].axisIndex == -1 &&
-                            i < osa->axisNames.size() && !osa->axisNames[i].empty()) {
-                            osa->steps[i].axisIndex =
-                                edm->getDevices()[devIdx].axisTable.getIndex(osa->axisNames[i]);
-                        }
-                    }
-                }
-            };
-            for (auto& a : rule.pressActions)  resolveAction(a.get());
-            for (auto& a : rule.releaseActions) resolveAction(a.get());
+            rule.pressProgram   = compileActions(rule.pressActions, edm);
+            rule.releaseProgram = compileActions(rule.releaseActions, edm);
         }
     }
 }
 
 void MappingManager::onBoardRegistered() {
-    resolveVodAxes();
+    compileActionPrograms();
 }
 
 void MappingManager::onRealDeviceConnected(const std::string& deviceIdStr,
                                             const RealDevice& device) {
+    if (device.deviceId >= realDeviceMappings.size())
+        realDeviceMappings.resize(device.deviceId + 1);
+    // Same numeric id may come back as a different device (evdev path reuse)
+    realDeviceMappings[device.deviceId] = RealDeviceToVidMapping{};
+
     auto assignIt = deviceAssignments.find(deviceIdStr);
     if (assignIt == deviceAssignments.end()) return;
 
-    const std::string& vidId = assignIt->second;
-    VirtualInputDevice& vid  = vids.at(vidId);
+    int                 vidIdx = assignIt->second;
+    VirtualInputDevice& vid    = vids[vidIdx];
 
     for (const auto& entry : device.axes.getEntries()) {
         if (!vid.axisTable.hasName(entry.name))
@@ -403,24 +455,25 @@ void MappingManager::onRealDeviceConnected(const std::string& deviceIdStr,
     }
 
     RealDeviceToVidMapping mapping;
-    mapping.vid    = &vid;
+    mapping.vid    = vidIdx;
     mapping.active = true;
     for (const auto& entry : device.axes.getEntries()) {
         int vidAxisIndex = vid.axisTable.getIndex(entry.name);
         if (vidAxisIndex != -1)
             mapping.realToVidAxisIndex[entry.index] = vidAxisIndex;
     }
-    realDeviceMappings[deviceIdStr] = std::move(mapping);
+    realDeviceMappings[device.deviceId] = std::move(mapping);
 
     resolveVidAxes();
-    std::cout << "[mapping] device '" << deviceIdStr << "' → VID '" << vidId << "'\n";
+    std::cout << "[mapping] device '" << deviceIdStr << "' → VID '" << vid.id << "'\n";
 }
 
-void MappingManager::onRealDeviceDisconnected(const std::string& deviceIdStr) {
-    auto it = realDeviceMappings.find(deviceIdStr);
-    if (it != realDeviceMappings.end()) {
-        it->second.active = false;
-        std::cout << "[mapping] device '" << deviceIdStr << "' disconnected\n";
+void MappingManager::onRealDeviceDisconnected(const RealDevice& device) {
+    if (device.deviceId >= realDeviceMappings.size()) return;
+    RealDeviceToVidMapping& mapping = realDeviceMappings[device.deviceId];
+    if (mapping.vid != -1) {
+        mapping.active = false;
+        std::cout << "[mapping] device '" << device.deviceIdStr << "' disconnected\n";
     }
 }
 
@@ -428,220 +481,193 @@ void MappingManager::onRealDeviceDisconnected(const std::string& deviceIdStr) {
 // Dispatch
 // ---------------------------------------------------------------------------
 
-void MappingManager::executeActions(std::vector<std::unique_ptr<Action>>& actions, int value) {
-    for (auto& a : actions) {
-        Action* act = a.get();
-        if (auto* ea = dynamic_cast<EmitAxisAction*>(act)) {
-            int devIdx = edm->resolveId(ea->vodId);
-            if (devIdx != -1 && ea->axisIndex != -1){
-                //td::cout<<"Action Emit axis index="<<ea->axisIndex<<" value="<<value<<std::endl;
-                edm->setAxis(devIdx, ea->axisIndex, value);
-            }
-        } else if (auto* osa = dynamic_cast<OutputSequenceAction*>(act)) {
-            int devIdx = edm->resolveId(osa->vodId);
-            for (const auto& step : osa->steps) {
-                if (step.type == SequenceStep::Type::SetAxis) {
-                    if (devIdx != -1 && step.axisIndex != -1){
-                      // std::cout<<"Action sequence index="<<step.axisIndex<<" value="<<step.value<<std::endl;
-                        edm->setAxis(devIdx, step.axisIndex, step.value);
-                    }
-                } else {
-                    sleep(step.timeMs);
-                }
-            }
-        } else if (auto* sa = dynamic_cast<SleepAction*>(act)) {
-            sleep(sa->timeMs);
+// Hands the program to the sequencer. Steps at offset 0 are emitted before
+// this returns; later ones never block the caller. A rule's press and release
+// programs share `rule` as their chain, so the release queues behind delayed
+// press steps instead of overtaking them.
+void MappingManager::executeActions(const ActionProgram& prog, int value,
+                                    const Layer* owner, const AxisRule* rule) {
+    sequencer.submit(prog, value, owner, rule);
+}
+
+// Records a completed hotkey so its release actions run when the last
+// part's activation axis is released.
+static void addPendingRelease(Layer* layer, AxisRule* rule) {
+    if (rule->releaseActions.empty()) return;
+    const auto& lastPart = rule->hotkeyParts.back();
+    if (!lastPart.activationAxis.has_value()) return;
+    VidAxisKey key { lastPart.activationAxis->vid, lastPart.activationAxis->axisIndex };
+    auto& pl = layer->pendingReleaseRules[key];
+    if (std::find(pl.begin(), pl.end(), rule) == pl.end())
+        pl.push_back(rule);
+    rule->state = AxisRule::State::WaitingForRelease;
+}
+
+void MappingManager::dispatchVidAxisEvent(int vid, int vidAxisIndex, int value) {
+    if (dispatchIndex.isStale(layerManager)) dispatchIndex.rebuildStack(layerManager);
+    const std::vector<DispatchEntry>* entries = dispatchIndex.findStack(vid, vidAxisIndex);
+
+    if (value > 0 && inProgressRules > 0) {
+        // A multi-part hotkey is mid-sequence: every layer holding one must see
+        // the press (it may cancel the sequence), so walk the whole stack and
+        // pick up this axis' entries on the way. Both are in stack order.
+        size_t next = 0;
+        for (Layer* layer : layerManager.stack()) {
+            const DispatchEntry* e = nullptr;
+            if (entries && next < entries->size() && (*entries)[next].layer == layer)
+                e = &(*entries)[next++];
+            if (!e && layer->activeRules.empty()) continue;
+            if (dispatchLayer(layer, e, vid, vidAxisIndex, value)) break;
         }
+    } else if (entries) {
+        for (const DispatchEntry& e : *entries)
+            if (dispatchLayer(e.layer, &e, vid, vidAxisIndex, value)) break;
+    }
+
+    // --- Activation trigger evaluation (all layers, regardless of active state) ---
+    if (const std::vector<Layer*>* triggers = dispatchIndex.findTriggers(vid, vidAxisIndex)) {
+        for (Layer* layer : *triggers)
+            dispatchActivation(*layer, vid, vidAxisIndex, value);
     }
 }
 
-void MappingManager::dispatchVidAxisEvent(const std::string& vidId,
-                                           int vidAxisIndex, int value) {
-    for (Layer* layer : layerManager.stack()) {
-        bool consumed = false;
-
-        // --- Block rule check ---
-        {
-            bool blocked   = false;
-            int  blockValue = value;
-            for (auto& br : layer->blockRules) {
-                if (br.vidId != vidId) continue;
-                for (const auto& e : br.entries) {
-                    if (e.axisIndex == vidAxisIndex) {
-                        blockValue = e.value;
-                        blocked    = true;
-                        break;
-                    }
-                }
-                if (blocked) break;
-            }
-            if (blocked) {
-                vidState[vidId][vidAxisIndex] = blockValue;
-                break;  // consumed — exit the layer stack loop
-            }
-        }
+// Returns true when the event is consumed and lower layers must not see it.
+// `e` is null for layers visited only because they hold in-progress rules.
+bool MappingManager::dispatchLayer(Layer* layer, const DispatchEntry* e,
+                                   int vid, int vidAxisIndex, int value) {
+    // --- Block rule check ---
+    if (e && e->blocked) {
+        vidState.set(vid, vidAxisIndex, e->blockValue);
+        return true;
+    }
 
-        if (value == 0) {
-            // Stop turbo on release (for WhileAxisActive turbos)
-            for (auto& tr : layer->turboRules) {
-                if (tr.vidId == vidId && tr.axisIndex == vidAxisIndex &&
-                    tr.condition == TurboCondition::WhileAxisActive) {
-                    stopTurbo(vidId, vidAxisIndex);
-                    break;
-                }
-            }
+    if (value == 0) {
+        if (!e) return false;
+        // Stop turbo on release (for WhileAxisActive turbos)
+        if (e->turboRelease) stopTurbo(vid, vidAxisIndex);
 
-            VidAxisKey key { vidId, vidAxisIndex };
+        if (!layer->pendingReleaseRules.empty()) {
+            VidAxisKey key { vid, vidAxisIndex };
             auto it = layer->pendingReleaseRules.find(key);
             if (it != layer->pendingReleaseRules.end()) {
                 for (auto* rule : it->second) {
-                    executeActions(rule->releaseActions, 0);
+                    executeActions(rule->releaseProgram, 0, layer, rule);
                     rule->reset();
                 }
                 layer->pendingReleaseRules.erase(it);
             }
-            continue;
         }
+        return false;
+    }
 
-        // --- Turbo rule check (press only) ---
-        {
-            bool turboConsumed = false;
-            for (auto& tr : layer->turboRules) {
-                if (tr.vidId != vidId || tr.axisIndex != vidAxisIndex) continue;
-                if (tr.condition == TurboCondition::WhileAxisActive) {
-                    startTurbo(tr);
-                    turboConsumed = true;
-                }
-                break;  // at most one turbo rule per axis per layer
-            }
-            if (turboConsumed) break;
-        }
+    // --- Turbo rule check (press only; at most one turbo rule per axis per layer) ---
+    if (e && e->turbo && e->turbo->condition == TurboCondition::WhileAxisActive) {
+        startTurbo(*e->turbo);
+        return true;
+    }
 
-        // Press: process active rules first
-        {
-            std::vector<AxisRule*> toRemove;
-            for (auto* rule : layer->activeRules) {
-                auto result = rule->processAxisEvent(vidId, vidAxisIndex, vidState);
-                if (result == AxisRule::EventResult::Cancelled) {
-                    toRemove.push_back(rule);
-                } else if (result == AxisRule::EventResult::Completed) {
-                    toRemove.push_back(rule);
-                    executeActions(rule->pressActions, value);
-                    if (!rule->releaseActions.empty()) {
-                        const auto& lastPart = rule->hotkeyParts.back();
-                        if (lastPart.activationAxis.has_value()) {
-                            VidAxisKey key { lastPart.activationAxis->vidId,
-                                             lastPart.activationAxis->axisIndex };
-                            auto& pl = layer->pendingReleaseRules[key];
-                            if (std::find(pl.begin(), pl.end(), rule) == pl.end())
-                                pl.push_back(rule);
-                            rule->state = AxisRule::State::WaitingForRelease;
-                        }
-                    }
-                    if (!rule->propagate) consumed = true;
-                }
-            }
-            for (auto* r : toRemove) {
-                layer->activeRules.erase(
-                    std::remove(layer->activeRules.begin(), layer->activeRules.end(), r),
-                    layer->activeRules.end());
+    bool consumed = false;
+
+    // Press: process active rules first
+    if (!layer->activeRules.empty()) {
+        std::vector<AxisRule*> toRemove;
+        for (auto* rule : layer->activeRules) {
+            auto result = rule->processAxisEvent(vid, vidAxisIndex, vidState);
+            if (result == AxisRule::EventResult::Cancelled) {
+                toRemove.push_back(rule);
+            } else if (result == AxisRule::EventResult::Completed) {
+                toRemove.push_back(rule);
+                executeActions(rule->pressProgram, value, layer, rule);
+                addPendingRelease(layer, rule);
+                if (!rule->propagate) consumed = true;
             }
         }
+        for (auto* r : toRemove) {
+            layer->activeRules.erase(
+                std::remove(layer->activeRules.begin(), layer->activeRules.end(), r),
+                layer->activeRules.end());
+        }
+        inProgressRules -= (int)toRemove.size();
+    }
 
-        if (!consumed) {
-            VidAxisKey key { vidId, vidAxisIndex };
-            auto it = layer->activationIndex.find(key);
-            if (it != layer->activationIndex.end()) {
-                for (auto* rule : it->second) {
-                    if (std::find(layer->activeRules.begin(), layer->activeRules.end(), rule)
-                        != layer->activeRules.end()) continue;
-
-                    auto result = rule->tryActivateFirstStep(vidId, vidAxisIndex, vidState);
-                    if (result == AxisRule::EventResult::Advanced) {
-                        layer->activeRules.push_back(rule);
-                        if (!rule->propagate) consumed = true;
-                    } else if (result == AxisRule::EventResult::Completed) {
-                        executeActions(rule->pressActions, value);
-                        if (!rule->releaseActions.empty()) {
-                            const auto& lastPart = rule->hotkeyParts.back();
-                            if (lastPart.activationAxis.has_value()) {
-                                VidAxisKey rKey { lastPart.activationAxis->vidId,
-                                                  lastPart.activationAxis->axisIndex };
-                                auto& pl = layer->pendingReleaseRules[rKey];
-                                if (std::find(pl.begin(), pl.end(), rule) == pl.end())
-                                    pl.push_back(rule);
-                                rule->state = AxisRule::State::WaitingForRelease;
-                            }
-                        }
-                        if (!rule->propagate) consumed = true;
-                    }
-                }
+    if (!consumed && e && e->hotkeys) {
+        for (auto* rule : *e->hotkeys) {
+            if (std::find(layer->activeRules.begin(), layer->activeRules.end(), rule)
+                != layer->activeRules.end()) continue;
+
+            auto result = rule->tryActivateFirstStep(vid, vidAxisIndex, vidState);
+            if (result == AxisRule::EventResult::Advanced) {
+                layer->activeRules.push_back(rule);
+                inProgressRules++;
+                if (!rule->propagate) consumed = true;
+            } else if (result == AxisRule::EventResult::Completed) {
+                executeActions(rule->pressProgram, value, layer, rule);
+                addPendingRelease(layer, rule);
+                if (!rule->propagate) consumed = true;
             }
         }
-
-        if (consumed) break;
     }
 
-    // --- Activation trigger evaluation (all layers, regardless of active state) ---
-    for (auto& layer : layerManager.allLayers) {
-        if (!layer.activationRule || !layer.activation.has_value()) continue;
-        const ConfActivation& act = layer.activation.value();
-        AxisRule* rule = layer.activationRule.get();
-
-        if (act.mode == ConfActivationMode::WhileActive) {
-            if (value > 0) {
-                auto result = rule->tryActivateFirstStep(vidId, vidAxisIndex, vidState);
-                if (result == AxisRule::EventResult::Completed) {
-                    rule->state = AxisRule::State::WaitingForRelease;
-                    layerManager.activate(layer.id);
-                } else if (result == AxisRule::EventResult::Advanced) {
-                    rule->state = AxisRule::State::InProgress;
-                }
-            } else {
-                if (rule->state == AxisRule::State::WaitingForRelease) {
-                    // Check if the released axis is the last activation axis
-                    const auto& lastPart = rule->hotkeyParts.back();
-                    if (lastPart.activationAxis.has_value() &&
-                        lastPart.activationAxis->vidId == vidId &&
-                        lastPart.activationAxis->axisIndex == vidAxisIndex) {
-                        rule->reset();
-                        layerManager.deactivate(layer.id);
-                    }
-                }
+    return consumed;
+}
+
+void MappingManager::dispatchActivation(Layer& layer, int vid, int vidAxisIndex, int value) {
+    const ConfActivation& act = layer.activation.value();
+    AxisRule* rule = layer.activationRule.get();
+
+    if (act.mode == ConfActivationMode::WhileActive) {
+        if (value > 0) {
+            auto result = rule->tryActivateFirstStep(vid, vidAxisIndex, vidState);
+            if (result == AxisRule::EventResult::Completed) {
+                rule->state = AxisRule::State::WaitingForRelease;
+                layerManager.activate(layer.id);
+            } else if (result == AxisRule::EventResult::Advanced) {
+                rule->state = AxisRule::State::InProgress;
             }
-        } else if (act.mode == ConfActivationMode::WhileNotActive) {
-            if (value > 0) {
-                auto result = rule->tryActivateFirstStep(vidId, vidAxisIndex, vidState);
-                if (result == AxisRule::EventResult::Completed) {
-                    rule->state = AxisRule::State::WaitingForRelease;
+        } else {
+            if (rule->state == AxisRule::State::WaitingForRelease) {
+                // Check if the released axis is the last activation axis
+                const auto& lastPart = rule->hotkeyParts.back();
+                if (lastPart.activationAxis.has_value() &&
+                    lastPart.activationAxis->vid == vid &&
+                    lastPart.activationAxis->axisIndex == vidAxisIndex) {
+                    rule->reset();
                     layerManager.deactivate(layer.id);
-                } else if (result == AxisRule::EventResult::Advanced) {
-                    rule->state = AxisRule::State::InProgress;
-                }
-            } else {
-                if (rule->state == AxisRule::State::WaitingForRelease) {
-                    const auto& lastPart = rule->hotkeyParts.back();
-                    if (lastPart.activationAxis.has_value() &&
-                        lastPart.activationAxis->vidId == vidId &&
-                        lastPart.activationAxis->axisIndex == vidAxisIndex) {
-                        rule->reset();
-                        layerManager.activate(layer.id);
-                    }
                 }
             }
-        } else if (act.mode == ConfActivationMode::Toggle) {
-            if (value > 0) {
-                auto result = rule->tryActivateFirstStep(vidId, vidAxisIndex, vidState);
-                if (result == AxisRule::EventResult::Completed) {
+        }
+    } else if (act.mode == ConfActivationMode::WhileNotActive) {
+        if (value > 0) {
+            auto result = rule->tryActivateFirstStep(vid, vidAxisIndex, vidState);
+            if (result == AxisRule::EventResult::Completed) {
+                rule->state = AxisRule::State::WaitingForRelease;
+                layerManager.deactivate(layer.id);
+            } else if (result == AxisRule::EventResult::Advanced) {
+                rule->state = AxisRule::State::InProgress;
+            }
+        } else {
+            if (rule->state == AxisRule::State::WaitingForRelease) {
+                const auto& lastPart = rule->hotkeyParts.back();
+                if (lastPart.activationAxis.has_value() &&
+                    lastPart.activationAxis->vid == vid &&
+                    lastPart.activationAxis->axisIndex == vidAxisIndex) {
                     rule->reset();
-                    layer.toggleState = !layer.toggleState;
-                    if (layer.toggleState) layerManager.activate(layer.id);
-                    else                   layerManager.deactivate(layer.id);
-                } else if (result == AxisRule::EventResult::Advanced) {
-                    rule->state = AxisRule::State::InProgress;
+                    layerManager.activate(layer.id);
                 }
             }
         }
+    } else if (act.mode == ConfActivationMode::Toggle) {
+        if (value > 0) {
+            auto result = rule->tryActivateFirstStep(vid, vidAxisIndex, vidState);
+            if (result == AxisRule::EventResult::Completed) {
+                rule->reset();
+                layer.toggleState = !layer.toggleState;
+                if (layer.toggleState) layerManager.activate(layer.id);
+                else                   layerManager.deactivate(layer.id);
+            } else if (result == AxisRule::EventResult::Advanced) {
+                rule->state = AxisRule::State::InProgress;
+            }
+        }
     }
 }
 
@@ -683,13 +709,13 @@ void MappingManager::evaluateVodStates() {
 
 void MappingManager::startTurbo(const TurboRule& rule) {
     if (rule.axisIndex == -1) return;
-    TurboKey key { rule.vidId, rule.axisIndex };
+    TurboKey key { rule.vid, rule.axisIndex };
     if (activeTurbos.count(key)) return;  // already running
 
-    auto running = std::make_shared<bool>(true);
-    activeTurbos[key] = running;
+    auto turbo = std::make_shared<TurboState>();
+    activeTurbos[key] = turbo;
 
-    std::string vidId     = rule.vidId;
+    int         vid       = rule.vid;
     int         axisIdx   = rule.axisIndex;
     int         onMs      = rule.onMs;
     int         offMs     = rule.offMs;
@@ -697,56 +723,66 @@ void MappingManager::startTurbo(const TurboRule& rule) {
     int         maxVal    = rule.maxValue;
     int         minVal    = rule.minValue;
 
-    coro([this, running, vidId, axisIdx, onMs, offMs, initDelay, maxVal, minVal]() {
-        if (initDelay > 0) {
+    coro_named("turbo", [this, turbo, vid, axisIdx, onMs, offMs, initDelay, maxVal, minVal]() {
+        turbo->coro = coro_self();
+        if (initDelay > 0 && turbo->running) {
             sleep(initDelay);
-            if (!*running) {
-                vidState[vidId][axisIdx] = minVal;
-                dispatchVidAxisEvent(vidId, axisIdx, minVal);
+            if (!turbo->running) {
+                vidState.set(vid, axisIdx, minVal);
+                dispatchVidAxisEvent(vid, axisIdx, minVal);
                 return;
             }
         }
-        while (*running) {
-            vidState[vidId][axisIdx] = maxVal;
-            dispatchVidAxisEvent(vidId, axisIdx, maxVal);
-            sleep(onMs);
-            if (!*running) break;
-            vidState[vidId][axisIdx] = minVal;
-            dispatchVidAxisEvent(vidId, axisIdx, minVal);
-            sleep(offMs);
+        // Absolute deadlines: dispatch time doesn't stretch the on/off period
+        auto next = std::chrono::steady_clock::now();
+        while (turbo->running) {
+            vidState.set(vid, axisIdx, maxVal);
+            dispatchVidAxisEvent(vid, axisIdx, maxVal);
+            next += std::chrono::milliseconds(onMs);
+            sleep_until(next);
+            if (!turbo->running) break;
+            vidState.set(vid, axisIdx, minVal);
+            dispatchVidAxisEvent(vid, axisIdx, minVal);
+            next += std::chrono::milliseconds(offMs);
+            sleep_until(next);
         }
-        vidState[vidId][axisIdx] = minVal;
-        dispatchVidAxisEvent(vidId, axisIdx, minVal);
+        vidState.set(vid, axisIdx, minVal);
+        dispatchVidAxisEvent(vid, axisIdx, minVal);
     });
 }
 
-void MappingManager::stopTurbo(const std::string& vidId, int axisIndex) {
-    TurboKey key { vidId, axisIndex };
+void MappingManager::stopTurbo(int vid, int axisIndex) {
+    TurboKey key { vid, axisIndex };
     auto it = activeTurbos.find(key);
     if (it == activeTurbos.end()) return;
-    *it->second = false;
+    // Wake the coroutine out of its on/off sleep so the release goes out now
+    // rather than up to onMs/offMs later.
+    it->second->running = false;
+    corocgo::sleep_cancel(it->second->coro);
     activeTurbos.erase(it);
 }
 
 void MappingManager::stopAllTurbosForLayer(Layer* layer) {
     for (const auto& tr : layer->turboRules) {
         if (tr.axisIndex != -1)
-            stopTurbo(tr.vidId, tr.axisIndex);
+            stopTurbo(tr.vid, tr.axisIndex);
     }
 }
 
-void MappingManager::axisEvent(const std::string& deviceIdStr, int axisIndex, int value) {
-    auto it = realDeviceMappings.find(deviceIdStr);
-    if (it == realDeviceMappings.end() || !it->second.active) return;
+void MappingManager::axisEvent(unsigned int deviceId, int axisIndex, int value) {
+    if (deviceId >= realDeviceMappings.size()) return;
+    RealDeviceToVidMapping& mapping = realDeviceMappings[deviceId];
+    if (!mapping.active) return;
 
-    RealDeviceToVidMapping& mapping = it->second;
     auto axisIt = mapping.realToVidAxisIndex.find(axisIndex);
     if (axisIt == mapping.realToVidAxisIndex.end()) return;
 
-    const std::string& vidId   = mapping.vid->id;
-    int                vidAxis = axisIt->second;
+    int vid     = mapping.vid;
+    int vidAxis = axisIt->second;
 
-    vidState[vidId][vidAxis] = value;
+    vidState.set(vid, vidAxis, value);
 
-    dispatchVidAxisEvent(vidId, vidAxis, value);
+    auto start = std::chrono::steady_clock::now();
+    dispatchVidAxisEvent(vid, vidAxis, value);
+    dispatchLatency.record(std::chrono::steady_clock::now() - start);
 }
@@ -3,13 +3,18 @@
 #include <string>
 #include <map>
 #include <set>
+#include <vector>
 #include <memory>
 #include <unordered_map>
 #include "../../shared/shared.h"
 #include "../MainConfig.h"
-#include "VidStateMap.h"
+#include "VidState.h"
+#include "DispatchIndex.h"
 #include "LayerManager.h"
 #include "TurboRule.h"
+#include "Sequencer.h"
+#include "LatencyStat.h"
+#include "SymbolTable.h"
 
 class EmulatedDeviceManager;
 struct RealDevice;
@@ -21,19 +26,26 @@ struct VirtualInputDevice {
 };
 
 struct RealDeviceToVidMapping {
-    VirtualInputDevice*         vid;
+    int                         vid = -1;   // index into MappingManager::vids
     std::unordered_map<int,int> realToVidAxisIndex;
     bool                        active = false;
 };
 
 struct TurboKey {
-    std::string vidId;
-    int         axisIndex;
+    int vid;
+    int axisIndex;
     bool operator<(const TurboKey& o) const {
-        return vidId < o.vidId || (vidId == o.vidId && axisIndex < o.axisIndex);
+        return vid < o.vid || (vid == o.vid && axisIndex < o.axisIndex);
     }
 };
 
+// Shared between MappingManager and the turbo's coroutine; stopping clears
+// `running` and cancels the coroutine's current on/off sleep.
+struct TurboState {
+    bool                 running = true;
+    corocgo::CoroHandle  coro;
+};
+
 class MappingManager {
 public:
     MappingManager() : edm(nullptr) {}
@@ -42,31 +54,54 @@ public:
     void clear();
     void onBoardRegistered();
     void onRealDeviceConnected(const std::string& deviceIdStr, const RealDevice& device);
-    void onRealDeviceDisconnected(const std::string& deviceIdStr);
-    void axisEvent(const std::string& deviceIdStr, int axisIndex, int value);
+    void onRealDeviceDisconnected(const RealDevice& device);
+    // deviceId is RealDevice::deviceId (the AxisEvent key).
+    void axisEvent(unsigned int deviceId, int axisIndex, int value);
 
     LayerManager& getLayerManager() { return layerManager; }
+    // VID id ↔ name, for logging / REST.
+    const SymbolTable& getVidSymbols() const { return vidSymbols; }
+
+    // ── Metrics ──
+    // dispatchLatency: time axisEvent() spends before returning (event → outputs queued).
+    // Stays flat while sequences run because waits live in the sequencer.
+    const LatencyStat&    getDispatchLatency() const { return dispatchLatency; }
+    const SequencerStats& getSequencerStats()  const { return sequencer.getStats(); }
+    void resetStats() { dispatchLatency.reset(); sequencer.resetStats(); }
 
 private:
     EmulatedDeviceManager*                        edm;
-    std::map<std::string, VirtualInputDevice>     vids;
-    std::map<std::string, RealDeviceToVidMapping> realDeviceMappings;
-    std::map<std::string, std::string>            deviceAssignments;
-    VidStateMap                                   vidState;
+    // VIDs are interned at load: configured VIDs get ids 0..vids.size()-1,
+    // unknown VIDs referenced by rules get higher ids and never resolve.
+    SymbolTable                                   vidSymbols;
+    std::vector<VirtualInputDevice>               vids;
+    std::vector<RealDeviceToVidMapping>           realDeviceMappings;   // [RealDevice::deviceId]
+    std::map<std::string, int>                    deviceAssignments;    // deviceIdStr → vid
+    VidState                                      vidState;
     LayerManager                                  layerManager;
+    DispatchIndex                                 dispatchIndex;
+    int                                           inProgressRules = 0;  // sum of layer activeRules sizes
 
     // Turbo state
-    std::map<TurboKey, std::shared_ptr<bool>>     activeTurbos;
+    std::map<TurboKey, std::shared_ptr<TurboState>> activeTurbos;
 
     // USB disconnect tracking: board serial IDs currently disconnected
     std::set<std::string>                         usbDisconnectedBoards;
 
+    Sequencer                                     sequencer;
+    LatencyStat                                   dispatchLatency;
+
     void resolveVidAxes();
-    void resolveVodAxes();
-    void dispatchVidAxisEvent(const std::string& vidId, int vidAxisIndex, int value);
-    void executeActions(std::vector<std::unique_ptr<Action>>& actions, int value);
+    void compileActionPrograms();
+    VirtualInputDevice* findVid(int vid) { return (vid >= 0 && vid < (int)vids.size()) ? &vids[vid] : nullptr; }
+    void dispatchVidAxisEvent(int vid, int vidAxisIndex, int value);
+    bool dispatchLayer(Layer* layer, const DispatchEntry* entry,
+                       int vid, int vidAxisIndex, int value);
+    void dispatchActivation(Layer& layer, int vid, int vidAxisIndex, int value);
+    void executeActions(const ActionProgram& prog, int value, const Layer* owner,
+                        const AxisRule* rule);
     void evaluateVodStates();
     void startTurbo(const TurboRule& rule);
-    void stopTurbo(const std::string& vidId, int axisIndex);
+    void stopTurbo(int vid, int axisIndex);
     void stopAllTurbosForLayer(Layer* layer);
 };
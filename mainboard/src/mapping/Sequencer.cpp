@@ -0,0 +1,278 @@
+// mainboard/src/mapping/Sequencer.cpp
+#include "Sequencer.h"
+#include "EmulatedDeviceManager.h"
+#include <algorithm>
+
+using namespace corocgo;
+
+uint64_t Sequencer::nowTick() const {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        Clock::now() - epoch).count();
+}
+
+// ---------------------------------------------------------------------------
+// Submission / cancellation
+// ---------------------------------------------------------------------------
+
+void Sequencer::submit(Timeline&& tl) {
+    if (tl.steps.empty()) return;
+    stats.submitted++;
+
+    advanceTo(nowTick());   // catch up first so offsets are relative to now
+    uint64_t start = currentTick;
+
+    for (int vod : tl.serializeVods) {
+        auto it = laneFreeAt.find(vod);
+        if (it != laneFreeAt.end() && it->second > start) start = it->second;
+    }
+    uint64_t end = start + tl.durationMs();
+    for (int vod : tl.serializeVods) laneFreeAt[vod] = end;
+
+    uint32_t id = nextId++;
+    Running& r  = running[id];
+    r.tl        = std::move(tl);
+    r.startTick = start;
+
+    // Fast path: everything due right now goes out before we return.
+    while (r.next < r.tl.steps.size()
+           && start + r.tl.steps[r.next].offsetMs <= currentTick)
+        emit(r, r.tl.steps[r.next++]);
+
+    if (r.next == r.tl.steps.size()) {
+        running.erase(id);
+        return;
+    }
+    stats.active = running.size();
+    insert(id, start + r.tl.steps[r.next].offsetMs);
+    wake(r.dueTick);
+}
+
+void Sequencer::submit(const ActionProgram& prog, int value, const void* owner, const void* chain) {
+    if (prog.code.empty()) return;
+
+    if (chain) {
+        advanceTo(nowTick());   // a chain whose steps are all due is done
+        if (Running* r = pendingChain(chain)) {
+            append(*r, prog, value);
+            return;
+        }
+    }
+
+    if (prog.serializeVods.empty() && prog.code.back().offsetMs == 0) {
+        stats.submitted++;
+        advanceTo(nowTick());   // overdue steps of older timelines go out first
+        for (const ActionInstr& in : prog.code) {
+            stats.fired++;
+            if (edm && in.devIdx != -1 && in.axisIndex != -1)
+                edm->setAxis(in.devIdx, in.axisIndex, in.op == ActionOp::EmitValue ? value : in.value);
+        }
+        return;
+    }
+
+    Timeline tl;
+    tl.owner         = owner;
+    tl.chain         = chain;
+    tl.serializeVods = prog.serializeVods;
+    tl.steps.reserve(prog.code.size());
+    for (const ActionInstr& in : prog.code)
+        tl.steps.push_back({in.offsetMs, in.devIdx, in.axisIndex,
+                            in.op == ActionOp::EmitValue ? value : in.value});
+    submit(std::move(tl));
+}
+
+// The chain's timeline that ends last, or null when none has steps left
+Sequencer::Running* Sequencer::pendingChain(const void* chain) {
+    Running* last = nullptr;
+    for (auto& [id, r] : running)
+        if (r.tl.chain == chain
+            && (!last || r.startTick + r.tl.durationMs() > last->startTick + last->tl.durationMs()))
+            last = &r;
+    return last;
+}
+
+// Queues `prog` after r's last step. r still has a step pending, so that step
+// is later than now and the appended offsets keep the timeline sorted; the
+// wheel entry (r's next step) is unchanged.
+void Sequencer::append(Running& r, const ActionProgram& prog, int value) {
+    stats.submitted++;
+    uint64_t oldEnd = r.startTick + r.tl.durationMs();
+    int      base   = r.tl.durationMs();
+    for (const ActionInstr& in : prog.code)
+        r.tl.steps.push_back({base + in.offsetMs, in.devIdx, in.axisIndex,
+                              in.op == ActionOp::EmitValue ? value : in.value});
+
+    uint64_t end = r.startTick + r.tl.durationMs();
+    for (int vod : r.tl.serializeVods) {
+        auto lane = laneFreeAt.find(vod);
+        if (lane != laneFreeAt.end() && lane->second == oldEnd) lane->second = end;
+    }
+    for (int vod : prog.serializeVods) {
+        if (std::find(r.tl.serializeVods.begin(), r.tl.serializeVods.end(), vod) != r.tl.serializeVods.end())
+            continue;
+        r.tl.serializeVods.push_back(vod);
+        uint64_t& freeAt = laneFreeAt[vod];
+        if (freeAt < end) freeAt = end;
+    }
+}
+
+void Sequencer::cancelOwner(const void* owner) {
+    for (auto it = running.begin(); it != running.end(); ) {
+        if (it->second.tl.owner != owner) { ++it; continue; }
+        Running& r   = it->second;
+        uint64_t end = r.startTick + r.tl.durationMs();
+        release(r);
+        for (int vod : r.tl.serializeVods) {
+            auto lane = laneFreeAt.find(vod);
+            if (lane != laneFreeAt.end() && lane->second == end) laneFreeAt.erase(lane);
+        }
+        stats.cancelled++;
+        it = running.erase(it);   // wheel entries for this id are skipped lazily
+    }
+    stats.active = running.size();
+}
+
+void Sequencer::cancelAll() {
+    for (auto& [id, r] : running) release(r);
+    stats.cancelled += running.size();
+    running.clear();
+    laneFreeAt.clear();
+    for (auto& slot : level0) slot.clear();
+    for (auto& slot : level1) slot.clear();
+    overflow.clear();
+    stats.active = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Timer wheel
+// ---------------------------------------------------------------------------
+
+void Sequencer::insert(uint32_t id, uint64_t dueTick) {
+    if (dueTick <= currentTick) dueTick = currentTick + 1;   // current slot already fired
+    running[id].dueTick = dueTick;
+    uint64_t delta = dueTick - currentTick;
+    if (delta < (uint64_t)L0_SIZE)
+        level0[dueTick & (L0_SIZE - 1)].push_back(id);
+    else if (delta < (uint64_t)L0_SIZE * L1_SIZE)
+        level1[(dueTick >> L0_BITS) & (L1_SIZE - 1)].push_back(id);
+    else
+        overflow.push_back(id);
+}
+
+// Earliest tick at which advanceTo() has work: the first occupied level-0
+// slot, or the first level-1 cascade (overflow re-sort at slot 0) before it.
+// Cancelled timelines leave stale entries behind, which at worst cost an
+// early wakeup that fires nothing.
+uint64_t Sequencer::nextWakeTick() const {
+    uint64_t next = currentTick + L0_SIZE;
+    for (uint64_t t = currentTick + 1; t < currentTick + L0_SIZE; t++)
+        if (!level0[t & (L0_SIZE - 1)].empty()) { next = t; break; }
+    for (uint64_t b = (currentTick | (L0_SIZE - 1)) + 1; b < next; b += L0_SIZE) {
+        uint64_t l1 = (b >> L0_BITS) & (L1_SIZE - 1);
+        if (!level1[l1].empty() || (l1 == 0 && !overflow.empty())) return b;
+    }
+    return next;
+}
+
+void Sequencer::advanceTo(uint64_t tick) {
+    while (currentTick < tick && !running.empty()) {
+        currentTick++;
+
+        if ((currentTick & (L0_SIZE - 1)) == 0) {
+            uint64_t l1 = (currentTick >> L0_BITS) & (L1_SIZE - 1);
+            if (l1 == 0) {
+                std::vector<uint32_t> ids;
+                ids.swap(overflow);
+                for (uint32_t id : ids)
+                    if (running.count(id)) insert(id, running[id].dueTick);
+            }
+            std::vector<uint32_t> ids;
+            ids.swap(level1[l1]);
+            for (uint32_t id : ids)
+                if (running.count(id)) insert(id, running[id].dueTick);
+        }
+
+        std::vector<uint32_t> due;
+        due.swap(level0[currentTick & (L0_SIZE - 1)]);
+        for (uint32_t id : due) fireDue(id);
+    }
+    if (running.empty()) currentTick = tick;
+}
+
+void Sequencer::fireDue(uint32_t id) {
+    auto it = running.find(id);
+    if (it == running.end()) return;            // cancelled
+    Running& r = it->second;
+    if (r.dueTick != currentTick) return;       // stale entry
+
+    while (r.next < r.tl.steps.size()
+           && r.startTick + r.tl.steps[r.next].offsetMs <= currentTick) {
+        const TimelineStep& s = r.tl.steps[r.next++];
+        auto scheduled = epoch + std::chrono::milliseconds(r.startTick + s.offsetMs);
+        stats.lateness.record(Clock::now() - scheduled);
+        emit(r, s);
+    }
+
+    if (r.next == r.tl.steps.size()) running.erase(it);
+    else                             insert(id, r.startTick + r.tl.steps[r.next].offsetMs);
+    stats.active = running.size();
+}
+
+void Sequencer::emit(Running& r, const TimelineStep& s) {
+    stats.fired++;
+    if (edm && s.devIdx != -1 && s.axisIndex != -1)
+        edm->setAxis(s.devIdx, s.axisIndex, s.value);
+
+    auto key = std::make_pair(s.devIdx, s.axisIndex);
+    auto it  = std::find(r.held.begin(), r.held.end(), key);
+    if (s.value != 0 && it == r.held.end()) r.held.push_back(key);
+    if (s.value == 0 && it != r.held.end()) r.held.erase(it);
+}
+
+void Sequencer::release(Running& r) {
+    if (edm)
+        for (auto& [devIdx, axis] : r.held)
+            if (devIdx != -1 && axis != -1) edm->setAxis(devIdx, axis, 0);
+    r.held.clear();
+}
+
+// ---------------------------------------------------------------------------
+// Service coroutine
+// ---------------------------------------------------------------------------
+
+// A timeline now has a step at dueTick: start the loop if it is parked, or
+// cut its sleep short if it would wake after that step.
+void Sequencer::wake(uint64_t dueTick) {
+    if (!loopStarted) {
+        loopStarted = true;
+        wakeCh = makeChannel<bool>(1);
+        coro_named("sequencer", [this]() {
+            loopCoro = coro_self();
+            loop();
+        });
+    }
+    if (idle) {
+        idle = false;
+        wakeCh->send(true);
+    } else if (dueTick < sleepTick) {
+        sleep_cancel(loopCoro);
+    }
+}
+
+// While timelines are pending, sleeps until the next tick with work on it
+// (an absolute deadline, so steps aren't late by the time spent firing the
+// previous ones); parks on wakeCh otherwise. submit() interrupts the sleep
+// when it schedules something sooner.
+void Sequencer::loop() {
+    while (true) {
+        if (running.empty()) {
+            idle = true;
+            auto res = wakeCh->receive();
+            if (res.error) break;
+            continue;
+        }
+        sleepTick = nextWakeTick();
+        sleep_until(epoch + std::chrono::milliseconds(sleepTick));
+        sleepTick = UINT64_MAX;
+        advanceTo(nowTick());
+    }
+}
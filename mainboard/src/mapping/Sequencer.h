@@ -0,0 +1,116 @@
+// mainboard/src/mapping/Sequencer.h
+// Runs output timelines (sequences, sleeps, delayed emits) off the dispatch path.
+//
+// A timeline is a list of (offsetMs, vod, axis, value) steps compiled from an
+// action list. submit() fires the steps due now inline and parks the rest in a
+// two-level timer wheel serviced by one sequencer coroutine, so the axis event
+// coroutine never sleeps.
+#pragma once
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <cstdint>
+#include "LatencyStat.h"
+#include "Action.h"
+#include "corocgo/corocgo.h"
+
+class EmulatedDeviceManager;
+
+struct TimelineStep {
+    int offsetMs;
+    int devIdx;
+    int axisIndex;
+    int value;
+};
+
+struct Timeline {
+    std::vector<TimelineStep> steps;      // sorted by offsetMs
+    const void*               owner = nullptr;   // cancellation key (the Layer)
+    const void*               chain = nullptr;   // ordering key (the rule): see submit()
+    std::vector<int>          serializeVods;     // devIdx lanes this timeline waits on
+    int durationMs() const { return steps.empty() ? 0 : steps.back().offsetMs; }
+};
+
+struct SequencerStats {
+    uint64_t    submitted = 0;
+    uint64_t    fired     = 0;   // steps emitted
+    uint64_t    cancelled = 0;   // timelines cancelled before completion
+    uint64_t    active    = 0;   // timelines still pending
+    LatencyStat lateness;        // actual − scheduled emit time
+};
+
+class Sequencer {
+public:
+    void setDeviceManager(EmulatedDeviceManager* e) { edm = e; }
+
+    // Takes ownership of the timeline. Steps due now are emitted before return.
+    void submit(Timeline&& tl);
+
+    // Runs a compiled action program; EmitValue steps output `value`.
+    // Programs with nothing delayed or serialized never allocate a timeline.
+    // Programs with the same non-null `chain` keep their order: one submitted
+    // while an earlier timeline of that chain still has steps pending is
+    // appended behind it, so a quick tap's release never overtakes the
+    // press's delayed steps.
+    void submit(const ActionProgram& prog, int value, const void* owner,
+                const void* chain = nullptr);
+
+    // Drops pending steps of every timeline owned by `owner` and releases
+    // (sets to 0) outputs those timelines left non-zero.
+    void cancelOwner(const void* owner);
+    void cancelAll();
+
+    const SequencerStats& getStats() const { return stats; }
+    void resetStats() { uint64_t a = stats.active; stats = {}; stats.active = a; }
+
+private:
+    // ── Timer wheel ──────────────────────────────────────────────────────
+    // Level 0: 256 × 1 ms. Level 1: 64 × 256 ms (~16 s). Beyond that entries
+    // sit in overflow and are re-sorted every level-1 revolution.
+    static constexpr int L0_BITS = 8;
+    static constexpr int L0_SIZE = 1 << L0_BITS;
+    static constexpr int L1_SIZE = 64;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Running {
+        Timeline                          tl;
+        size_t                            next      = 0;
+        uint64_t                          startTick = 0;
+        uint64_t                          dueTick   = 0;   // tick of steps[next]
+        std::vector<std::pair<int,int>>   held;            // (devIdx, axis) left non-zero
+    };
+
+    EmulatedDeviceManager*                 edm = nullptr;
+    std::unordered_map<uint32_t, Running>  running;
+    uint32_t                               nextId = 1;
+
+    std::vector<uint32_t> level0[L0_SIZE];
+    std::vector<uint32_t> level1[L1_SIZE];
+    std::vector<uint32_t> overflow;
+    uint64_t              currentTick = 0; // ms since epoch
+    Clock::time_point     epoch = Clock::now();
+
+    // Per-VOD serialization: devIdx → tick at which the lane is free again
+    std::unordered_map<int, uint64_t> laneFreeAt;
+
+    bool                  loopStarted = false;
+    bool                  idle = true;
+    corocgo::Channel<bool>* wakeCh = nullptr;
+    corocgo::CoroHandle   loopCoro;
+    uint64_t              sleepTick = UINT64_MAX;   // tick the loop is sleeping until
+
+    SequencerStats        stats;
+
+    uint64_t nowTick() const;
+    uint64_t nextWakeTick() const;
+    void     insert(uint32_t id, uint64_t dueTick);
+    void     advanceTo(uint64_t tick);
+    void     fireDue(uint32_t id);
+    void     emit(Running& r, const TimelineStep& s);
+    void     release(Running& r);
+    Running* pendingChain(const void* chain);
+    void     append(Running& r, const ActionProgram& prog, int value);
+    void     wake(uint64_t dueTick);
+    void     loop();
+};
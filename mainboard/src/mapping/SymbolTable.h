@@ -0,0 +1,39 @@
+// mainboard/src/mapping/SymbolTable.h
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+// Interns string identifiers into dense integer ids (0, 1, 2, ...).
+// Strings are looked up at config-load / connect time only; the hot path
+// carries the ids and uses name() just for logging and REST.
+class SymbolTable {
+public:
+    // Returns the existing id for s, or assigns the next one.
+    int intern(const std::string& s) {
+        auto it = ids.find(s);
+        if (it != ids.end()) return it->second;
+        int id = (int)names.size();
+        ids.emplace(s, id);
+        names.push_back(s);
+        return id;
+    }
+
+    // Returns -1 if s was never interned.
+    int find(const std::string& s) const {
+        auto it = ids.find(s);
+        return it != ids.end() ? it->second : -1;
+    }
+
+    const std::string& name(int id) const {
+        static const std::string unknown = "?";
+        return (id >= 0 && id < (int)names.size()) ? names[id] : unknown;
+    }
+
+    int  size() const { return (int)names.size(); }
+    void clear()      { ids.clear(); names.clear(); }
+
+private:
+    std::unordered_map<std::string, int> ids;
+    std::vector<std::string>             names;
+};
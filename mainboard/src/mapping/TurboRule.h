@@ -5,7 +5,7 @@
 enum class TurboCondition { WhileAxisActive, Always };
 
 struct TurboRule {
-    std::string    vidId;
+    int            vid         = -1;   // interned VID id
     std::string    axisName;   // retained for resolution
     int            axisIndex   = -1;
     int            onMs        = 100;
@@ -0,0 +1,70 @@
+// mainboard/src/mapping/VidState.h
+#pragma once
+#include <vector>
+#include <cstdint>
+
+// One bit per VID axis index.
+using AxisMask = std::vector<uint64_t>;
+
+inline void axisMaskSet(AxisMask& m, int axis) {
+    size_t w = (size_t)axis >> 6;
+    if (w >= m.size()) m.resize(w + 1, 0);
+    m[w] |= 1ull << (axis & 63);
+}
+
+// Current value (0-1000) of every VID axis, plus the set of non-zero axes.
+// Indexed by [vid id][axis index]; per-VID arrays grow on first write to a
+// higher axis index (device connect), so reads of unseen axes return 0.
+class VidState {
+public:
+    void reset(int vidCount) { slots.assign(vidCount, Slot{}); }
+    void clear()             { slots.clear(); }
+
+    int get(int vid, int axis) const {
+        if (!valid(vid) || axis < 0) return 0;
+        const Slot& s = slots[vid];
+        return axis < (int)s.values.size() ? s.values[axis] : 0;
+    }
+
+    bool isHeld(int vid, int axis) const { return get(vid, axis) != 0; }
+
+    void set(int vid, int axis, int value) {
+        if (!valid(vid) || axis < 0) return;
+        Slot& s = slots[vid];
+        if (axis >= (int)s.values.size()) {
+            if (value == 0) return;
+            s.values.resize(axis + 1, 0);
+            s.active.resize(((size_t)axis >> 6) + 1, 0);
+        }
+        int& cur = s.values[axis];
+        if ((cur != 0) != (value != 0)) {
+            s.active[axis >> 6] ^= 1ull << (axis & 63);
+            s.activeCount += value != 0 ? 1 : -1;
+        }
+        cur = value;
+    }
+
+    int activeCount(int vid) const { return valid(vid) ? slots[vid].activeCount : 0; }
+
+    // True if every non-zero axis of `vid` has its bit set in `allowed`.
+    bool activeSubsetOf(int vid, const AxisMask& allowed) const {
+        if (!valid(vid)) return true;
+        const Slot& s = slots[vid];
+        if (s.activeCount == 0) return true;
+        for (size_t w = 0; w < s.active.size(); w++) {
+            uint64_t mask = w < allowed.size() ? allowed[w] : 0;
+            if (s.active[w] & ~mask) return false;
+        }
+        return true;
+    }
+
+private:
+    struct Slot {
+        std::vector<int>      values;
+        AxisMask              active;
+        int                   activeCount = 0;
+    };
+    std::vector<Slot> slots;
+
+    bool valid(int vid) const { return vid >= 0 && vid < (int)slots.size(); }
+};
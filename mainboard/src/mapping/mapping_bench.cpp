@@ -0,0 +1,278 @@
+// mainboard/src/mapping/mapping_bench.cpp
+// Standalone microbenchmark for MappingManager::axisEvent throughput.
+// Not part of the `app` target. Build from mainboard/:
+//
+//   g++ -std=c++20 -O2 -Isrc -Isrc/emulation -Isrc/mapping -I../shared -I../shared/corocgo
+//       src/mapping/mapping_bench.cpp src/mapping/MappingManager.cpp src/mapping/AxisRule.cpp
+//       src/mapping/LayerManager.cpp src/mapping/DispatchIndex.cpp src/mapping/OutputSequenceParser.cpp
+//       src/mapping/Sequencer.cpp
+//       src/emulation/EmulatedDeviceManager.cpp src/emulation/VirtualOutputDevice.cpp src/emulation/PicoLatency.cpp
+//       src/pipeline/LatencyTrace.cpp
+//       src/MainConfig.cpp ../shared/shared.cpp ../shared/PicoConfig.cpp ../shared/stringutils.cpp
+//       ../shared/corocgo/corocgo.cpp ../shared/corocgo/corocrpc/corocrpc.cpp
+//       -o mapping_bench -lpthread
+//
+// Scenarios (same input: a fake RealDevice assigned to VID "vgp", events on
+// BTN_0..BTN_23, output to one Xbox 360 VOD on an in-process EmulationBoard
+// whose RPC output is drained and discarded):
+//   basic  — one base layer of simple mappings plus a top layer with
+//            hotkey/block/turbo rules that the events must pass through.
+//   stress — the basic layers under STRESS_LAYERS extra active layers, each
+//            with hotkeys, blocks, turbos and an activation trigger on axes
+//            the events never touch.
+//
+// Before timing, a tap check taps a hotkey whose press sequence has a delay
+// (press A, sleep, B; release A=0, B=0) for less than that delay, and exits
+// 1 unless the release still comes after B and leaves both outputs at 0.
+
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include "MappingManager.h"
+#include "EmulatedDeviceManager.h"
+#include "EmulationBoard.h"
+#include "RealDeviceManager.h"
+
+using namespace corocgo;
+using namespace corocrpc;
+
+static constexpr int BUTTONS       = 24;   // axes the events hit
+static constexpr int DEVICE_AXES   = 64;   // axes the device exposes
+static constexpr int STRESS_LAYERS = 300;
+static constexpr int STRESS_RULES  = 12;   // hotkeys per stress layer
+
+static std::string btn(int i) { return "BTN_" + std::to_string(i); }
+
+static ConfRoot benchConfig(int stressLayers) {
+    ConfRoot root;
+
+    ConfEmulationBoard b;
+    b.id = "BENCH";
+    ConfVod vod;
+    vod.id   = "vxbx1";
+    vod.type = PicoDeviceType::XBOX360_GAMEPAD;
+    b.devices.push_back(vod);
+    root.emulationBoards.push_back(b);
+
+    root.vids.push_back({"vgp", "Bench pad"});
+    root.realDevices.push_back({"bench-pad", "vgp", {}, {}});
+
+    AxisTable   xboxTable = AxisTable::forXbox360();
+    const auto& xbox      = xboxTable.getEntries();
+
+    auto emit = [&](int i) {
+        ConfAction a;
+        a.type = ConfActionType::EmitAxis;
+        a.vod  = "vxbx1";
+        a.axis = xbox[i % xbox.size()].name;
+        return a;
+    };
+
+    // Stress layers: everything keyed on BTN_24..BTN_63
+    for (int l = 0; l < stressLayers; l++) {
+        ConfLayer layer;
+        layer.id = "stress" + std::to_string(l);
+        for (int r = 0; r < STRESS_RULES; r++) {
+            int a = BUTTONS + (l + r) % (DEVICE_AXES - BUTTONS);
+            int c = BUTTONS + (l + r + 7) % (DEVICE_AXES - BUTTONS);
+            ConfRule hk;
+            hk.type   = ConfRuleType::Hotkey;
+            hk.vid    = "vgp";
+            hk.hotkey = "!" + btn(a) + "+" + btn(c);
+            hk.pressActions.push_back(emit(r));
+            layer.rules.push_back(hk);
+        }
+        ConfRule block;
+        block.type = ConfRuleType::Block;
+        block.vid  = "vgp";
+        for (int k = 0; k < 4; k++)
+            block.blockAxes.push_back({btn(BUTTONS + (l * 4 + k) % (DEVICE_AXES - BUTTONS)), 0});
+        layer.rules.push_back(block);
+        for (int k = 0; k < 2; k++) {
+            ConfRule turbo;
+            turbo.type      = ConfRuleType::Turbo;
+            turbo.vid       = "vgp";
+            turbo.turboAxis = btn(BUTTONS + (l * 2 + k) % (DEVICE_AXES - BUTTONS));
+            layer.rules.push_back(turbo);
+        }
+        ConfActivation act;
+        act.mode   = ConfActivationMode::Toggle;
+        act.vid    = "vgp";
+        act.hotkey = "!" + btn(DEVICE_AXES - 1) + "+" + btn(BUTTONS + l % (DEVICE_AXES - BUTTONS - 1));
+        layer.activation = act;
+        root.layers.push_back(std::move(layer));
+    }
+
+    ConfLayer top;
+    top.id = "combos";
+    for (int i = 0; i < 4; i++) {
+        ConfRule hk;
+        hk.type   = ConfRuleType::Hotkey;
+        hk.vid    = "vgp";
+        hk.hotkey = "!" + btn(20 + i) + "+" + btn((21 + i) % BUTTONS);
+        hk.pressActions.push_back(emit(i));
+        top.rules.push_back(hk);
+    }
+    ConfRule block;
+    block.type = ConfRuleType::Block;
+    block.vid  = "vgp";
+    block.blockAxes.push_back({"BTN_99", 0});   // present in config, never matches
+    top.rules.push_back(block);
+    ConfRule turbo;
+    turbo.type      = ConfRuleType::Turbo;
+    turbo.vid       = "vgp";
+    turbo.turboAxis = "BTN_98";
+    top.rules.push_back(turbo);
+
+    ConfLayer base;
+    base.id = "base";
+    ConfRule simple;
+    simple.type = ConfRuleType::Simple;
+    simple.vid  = "vgp";
+    simple.vod  = "vxbx1";
+    for (int i = 0; i < BUTTONS; i++)
+        simple.axes.push_back({btn(i), xbox[i % xbox.size()].name});
+    base.rules.push_back(simple);
+
+    root.layers.push_back(std::move(top));
+    root.layers.push_back(std::move(base));
+    return root;
+}
+
+// Runs `events` axisEvents through a freshly loaded MappingManager. Must be
+// called from a coroutine; the board and managers stay alive until exit.
+static void runScenario(const char* label, int stressLayers, int events) {
+    auto* outCh = makeChannel<RpcPacket>(16);
+    auto* inCh  = makeChannel<RpcPacket>(16);
+    auto* rpc   = new RpcManager(outCh, inCh);
+    coro([outCh]() { while (!outCh->receive().error) {} });
+
+    ConfRoot config = benchConfig(stressLayers);
+    auto entries    = buildBoardEntries(config.emulationBoards);
+
+    auto* board         = new EmulationBoard();
+    board->id           = 1;
+    board->serialString = "BENCH";
+    board->rpc          = rpc;
+    board->uartChannel  = UART_CHANNEL(0);
+    board->active       = true;
+    board->picoConfig   = entries[0].config;
+
+    auto* edm = new EmulatedDeviceManager();
+    edm->registerBoard(board, buildVirtualDevices(entries[0]));
+
+    auto* mapping = new MappingManager();
+    mapping->load(config, edm);
+    mapping->onBoardRegistered();
+
+    RealDevice dev;
+    dev.deviceId    = 1;
+    dev.deviceIdStr = "bench-pad";
+    for (int i = 0; i < DEVICE_AXES; i++) dev.axes.addEntry(btn(i), i);
+    mapping->onRealDeviceConnected(dev.deviceIdStr, dev);
+
+    auto run = [&](int n) {
+        for (int i = 0; i < n; i++) {
+            int axis  = i % BUTTONS;
+            int value = ((i / BUTTONS) & 1) ? 0 : 1000;
+            mapping->axisEvent(dev.deviceId, axis, value);
+            if ((i & 255) == 255) coro_yield();   // let the board flush / RPC drain run
+        }
+    };
+    run(events / 20);
+    auto start = std::chrono::steady_clock::now();
+    run(events);
+    double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    printf("axisEvent %-6s: %d events in %.3f s — %.0f events/s, %.1f ns/event\n",
+           label, events, secs, events / secs, secs * 1e9 / events);
+}
+
+// Hotkey on BTN_0: press A, sleep TAP_DELAY_MS, B; release A=0, B=0. Tapped
+// for a fraction of the delay, the release has to queue behind B.
+static constexpr int TAP_DELAY_MS = 60;
+
+static bool checkTapOrder() {
+    ConfRoot root;
+    ConfEmulationBoard b;
+    b.id = "BENCH";
+    ConfVod vod;
+    vod.id   = "vxbx1";
+    vod.type = PicoDeviceType::XBOX360_GAMEPAD;
+    b.devices.push_back(vod);
+    root.emulationBoards.push_back(b);
+    root.vids.push_back({"vgp", "Bench pad"});
+    root.realDevices.push_back({"bench-pad", "vgp", {}, {}});
+
+    AxisTable   xboxTable = AxisTable::forXbox360();
+    const auto& xbox      = xboxTable.getEntries();
+    auto emit = [&](int i) {
+        ConfAction a;
+        a.type = ConfActionType::EmitAxis;
+        a.vod  = "vxbx1";
+        a.axis = xbox[i].name;
+        return a;
+    };
+    ConfAction pause;
+    pause.type   = ConfActionType::Sleep;
+    pause.timeMs = TAP_DELAY_MS;
+
+    ConfLayer layer;
+    layer.id = "tap";
+    ConfRule hk;
+    hk.type   = ConfRuleType::Hotkey;
+    hk.vid    = "vgp";
+    hk.hotkey = btn(0);
+    hk.pressActions   = {emit(0), pause, emit(1)};
+    hk.releaseActions = {emit(0), emit(1)};
+    layer.rules.push_back(hk);
+    root.layers.push_back(std::move(layer));
+
+    auto  entries = buildBoardEntries(root.emulationBoards);
+    auto* board   = new EmulationBoard();
+    board->id           = 1;
+    board->serialString = "BENCH";
+    board->rpc          = nullptr;
+    board->active       = true;
+    board->picoConfig   = entries[0].config;
+    auto* edm = new EmulatedDeviceManager();
+    edm->registerBoard(board, buildVirtualDevices(entries[0]));
+
+    std::vector<std::pair<int, int>> out;   // (axis, value) in emit order
+    edm->setSink([&out](int, int axis, int value) { out.push_back({axis, value}); });
+
+    auto* mapping = new MappingManager();
+    mapping->load(root, edm);
+    mapping->onBoardRegistered();
+    RealDevice dev;
+    dev.deviceId    = 1;
+    dev.deviceIdStr = "bench-pad";
+    dev.axes.addEntry(btn(0), 0);
+    mapping->onRealDeviceConnected(dev.deviceIdStr, dev);
+
+    mapping->axisEvent(dev.deviceId, 0, 1000);
+    sleep(TAP_DELAY_MS / 4);
+    mapping->axisEvent(dev.deviceId, 0, 0);
+    sleep(TAP_DELAY_MS * 3);
+
+    int axisA = xbox[0].index, axisB = xbox[1].index;
+    std::vector<std::pair<int, int>> expected = {{axisA, 1000}, {axisB, 1000}, {axisA, 0}, {axisB, 0}};
+    bool ok = out == expected;
+    printf("tap check: %s", ok ? "PASS" : "FAIL, got");
+    if (!ok)
+        for (auto& [axis, value] : out) printf(" %s=%d", xboxTable.getName(axis).c_str(), value);
+    printf("\n");
+    return ok;
+}
+
+int main() {
+    std::cout.setstate(std::ios::failbit);   // silence load/connect logging
+    coro([]() {
+        if (!checkTapOrder()) exit(1);
+        runScenario("basic",  0,             2000000);
+        runScenario("stress", STRESS_LAYERS, 200000);
+        exit(0);
+    });
+
+    scheduler_start();
+    return 0;
+}
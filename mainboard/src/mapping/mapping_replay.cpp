@@ -0,0 +1,214 @@
+// mainboard/src/mapping/mapping_replay.cpp
+// Replays an input recording (pipeline/InputLog.h: pipeline.record_path or
+// POST /recording/start) through MappingManager::axisEvent with the emulated
+// side captured by an EmulatedDeviceManager sink instead of Pico boards.
+// Not part of the `app` target. Build from mainboard/:
+//
+//   g++ -std=c++20 -O2 -Isrc -Isrc/emulation -Isrc/mapping -I../shared -I../shared/corocgo
+//       src/mapping/mapping_replay.cpp src/mapping/MappingManager.cpp src/mapping/AxisRule.cpp
+//       src/mapping/LayerManager.cpp src/mapping/DispatchIndex.cpp src/mapping/OutputSequenceParser.cpp
+//       src/mapping/Sequencer.cpp
+//       src/emulation/EmulatedDeviceManager.cpp src/emulation/VirtualOutputDevice.cpp src/emulation/PicoLatency.cpp
+//       src/pipeline/LatencyTrace.cpp src/pipeline/InputLog.cpp
+//       src/MainConfig.cpp ../shared/shared.cpp ../shared/PicoConfig.cpp ../shared/stringutils.cpp
+//       ../shared/corocgo/corocgo.cpp ../shared/corocgo/corocrpc/corocrpc.cpp
+//       -o mapping_replay -lpthread
+//
+// Usage: mapping_replay <config.json> <recording> [options]
+//   --speed X        replay at X × the recorded pace (default 1)
+//   --fast           no pacing: as fast as the mapping engine goes (throughput)
+//   --repeat N       replay N times, reloading the mapping state between runs
+//   --expect DIGEST  exit 1 unless every run's output digest equals DIGEST
+//   --dump           print every output (time, VOD, axis, value)
+//
+// The digest is FNV-1a over the ordered (VOD, axis, value) outputs, without
+// times, so a recording replays to the same digest at any pace as long as its
+// rules don't depend on timing (turbo, sequences with delays, hold times).
+
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include "MappingManager.h"
+#include "EmulatedDeviceManager.h"
+#include "EmulationBoard.h"
+#include "RealDeviceManager.h"
+#include "pipeline/InputLog.h"
+
+using namespace corocgo;
+
+struct ReplayOptions {
+    double      speed  = 1.0;   // 0 = --fast
+    int         repeat = 1;
+    bool        dump   = false;
+    bool        expect = false;
+    uint64_t    expectDigest = 0;
+};
+
+struct ReplayStats {
+    uint64_t events    = 0;   // REC_AXIS records fed to axisEvent
+    uint64_t outputs   = 0;   // setAxis calls that reached the sink
+    uint64_t digest    = 14695981039346656037ULL;
+    double   secs      = 0;
+    int64_t  maxLagUs  = 0;   // paced runs: worst delivery behind schedule
+};
+
+static void mix(uint64_t& h, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        h ^= (v >> (i * 8)) & 0xff;
+        h *= 1099511628211ULL;
+    }
+}
+
+// Feeds the whole log through `mapping`. Must be called from a coroutine.
+static void replayOnce(InputLogReader& log, MappingManager* mapping, const ReplayOptions& opt,
+                       ReplayStats& stats) {
+    std::map<uint32_t, RealDevice> devices;   // by recorded deviceId
+    InputLogReader::Entry e;
+    log.rewind();
+    auto start = std::chrono::steady_clock::now();
+    while (log.next(e)) {
+        if (opt.speed > 0) {
+            auto due = start + std::chrono::nanoseconds((int64_t)(e.timeNs / opt.speed));
+            auto now = std::chrono::steady_clock::now();
+            if (now < due) sleep_until(due);
+            else {
+                int64_t lag = std::chrono::duration_cast<std::chrono::microseconds>(now - due).count();
+                if (lag > stats.maxLagUs) stats.maxLagUs = lag;
+            }
+        }
+        switch (e.type) {
+            case REC_AXIS:
+                mapping->axisEvent(e.deviceId, e.axisIndex, e.value);
+                stats.events++;
+                if (opt.speed == 0 && (stats.events & 255) == 0) coro_yield();   // let sequencers run
+                break;
+            case REC_CONNECT: {
+                RealDevice& dev = devices[e.deviceId];
+                dev             = RealDevice();
+                dev.deviceId    = e.deviceId;
+                dev.deviceIdStr = e.deviceIdStr;
+                dev.active      = true;
+                for (const auto& a : e.axes) dev.axes.addEntry(a.name, a.index);
+                mapping->onRealDeviceConnected(dev.deviceIdStr, dev);
+                break;
+            }
+            case REC_DISCONNECT: {
+                auto it = devices.find(e.deviceId);
+                if (it == devices.end()) break;
+                it->second.active = false;
+                mapping->onRealDeviceDisconnected(it->second);
+                break;
+            }
+        }
+    }
+    stats.secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (stats.events == 0)
+        fprintf(stderr, "warning: no axis events in the recording\n");
+}
+
+static int usage() {
+    fprintf(stderr, "usage: mapping_replay <config.json> <recording> [--speed X | --fast] [--repeat N]"
+                    " [--expect DIGEST] [--dump]\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) return usage();
+    std::string configPath = argv[1];
+    std::string logPath    = argv[2];
+    ReplayOptions opt;
+    for (int i = 3; i < argc; i++) {
+        std::string a = argv[i];
+        bool more = i + 1 < argc;
+        if (a == "--fast")                    opt.speed = 0;
+        else if (a == "--dump")               opt.dump = true;
+        else if (a == "--speed" && more)      opt.speed = atof(argv[++i]);
+        else if (a == "--repeat" && more)     opt.repeat = std::max(1, atoi(argv[++i]));
+        else if (a == "--expect" && more) {
+            opt.expect       = true;
+            opt.expectDigest = strtoull(argv[++i], nullptr, 16);
+        } else return usage();
+    }
+    if (opt.speed < 0) return usage();
+
+    std::cout.setstate(std::ios::failbit);   // silence load/connect logging
+    std::vector<std::string> errors;
+    if (!loadConfig(configPath, errors)) {
+        for (auto& err : errors) fprintf(stderr, "%s\n", err.c_str());
+        return 2;
+    }
+    static InputLogReader log;
+    std::string err;
+    if (!log.open(logPath, err)) {
+        fprintf(stderr, "%s\n", err.c_str());
+        return 2;
+    }
+
+    static int exitCode = 0;
+    coro([opt]() {
+        // One board per configured emulation board; nothing goes over RPC
+        // because the sink takes every output first
+        auto* edm     = new EmulatedDeviceManager();
+        auto  entries = buildBoardEntries(gConfig.emulationBoards);
+        for (size_t i = 0; i < entries.size(); i++) {
+            auto* board         = new EmulationBoard();
+            board->id           = (int)i + 1;
+            board->serialString = entries[i].picoId;
+            board->rpc          = nullptr;
+            board->active       = true;
+            board->picoConfig   = entries[i].config;
+            edm->registerBoard(board, buildVirtualDevices(entries[i]));
+        }
+
+        ReplayStats stats;
+        auto runStart = std::chrono::steady_clock::now();
+        edm->setSink([edm, &stats, &opt, &runStart](int deviceIndex, int axis, int value) {
+            stats.outputs++;
+            mix(stats.digest, (uint32_t)deviceIndex);
+            mix(stats.digest, (uint32_t)axis);
+            mix(stats.digest, (uint32_t)value);
+            if (opt.dump) {
+                const VirtualOutputDevice& vod = edm->getDevices()[deviceIndex];
+                double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+                printf("%10.6f %-10s %-24s %d\n", t, vod.id.c_str(), vod.axisTable.getName(axis).c_str(), value);
+            }
+        });
+
+        auto* mapping = new MappingManager();
+        uint64_t firstDigest = 0;
+        for (int run = 0; run < opt.repeat; run++) {
+            if (run) mapping->clear();
+            mapping->load(gConfig, edm);
+            mapping->onBoardRegistered();
+
+            stats    = ReplayStats();
+            runStart = std::chrono::steady_clock::now();
+            replayOnce(log, mapping, opt, stats);
+
+            printf("run %d: %llu events in %.3f s — %.0f events/s, %.1f ns/event, %llu outputs, digest %016llx",
+                   run + 1, (unsigned long long)stats.events, stats.secs,
+                   stats.secs > 0 ? stats.events / stats.secs : 0.0,
+                   stats.events ? stats.secs * 1e9 / stats.events : 0.0,
+                   (unsigned long long)stats.outputs, (unsigned long long)stats.digest);
+            if (opt.speed > 0) printf(", max lag %lld us", (long long)stats.maxLagUs);
+            printf("\n");
+
+            if (run == 0) firstDigest = stats.digest;
+            else if (stats.digest != firstDigest) {
+                printf("run %d: digest differs from run 1\n", run + 1);
+                exitCode = 1;
+            }
+            if (opt.expect && stats.digest != opt.expectDigest) {
+                printf("run %d: expected digest %016llx\n", run + 1, (unsigned long long)opt.expectDigest);
+                exitCode = 1;
+            }
+        }
+        fflush(stdout);
+        exit(exitCode);
+    });
+
+    scheduler_start();
+    return 0;
+}
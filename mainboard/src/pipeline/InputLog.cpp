@@ -0,0 +1,221 @@
+// mainboard/src/pipeline/InputLog.cpp
+#include "InputLog.h"
+#include "LatencyTrace.h"
+#include <cstring>
+#include <cerrno>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+InputRecorder gRecorder;
+
+static constexpr size_t RECORD_ALIGN   = 16;
+static constexpr size_t WRITE_BUF_SIZE = 256 * 1024;   // stdio buffer: one write() per ~16k events
+
+static size_t padded(size_t n) { return (n + RECORD_ALIGN - 1) & ~(RECORD_ALIGN - 1); }
+
+// ── InputRecorder ───────────────────────────────────────────────────────────
+
+bool InputRecorder::start(const std::string& path, const std::map<unsigned int, RealDevice>& devices,
+                          std::string& error, bool exclusive) {
+    std::lock_guard<std::mutex> g(lock);
+    if (file) {
+        error = "already recording to " + filePath;
+        return false;
+    }
+    int flags = O_WRONLY | O_CREAT | O_NOFOLLOW | O_CLOEXEC | (exclusive ? O_EXCL : O_TRUNC);
+    int fd    = open(path.c_str(), flags, 0644);
+    if (fd < 0 || !(file = fdopen(fd, "wb"))) {
+        int err = errno;
+        error   = path + ": " + strerror(err);
+        if (fd >= 0) close(fd);
+        errno = err;   // EEXIST: the REST caller answers 409
+        return false;
+    }
+    setvbuf(file, nullptr, _IOFBF, WRITE_BUF_SIZE);
+
+    InputLogHeader h{};
+    memcpy(h.magic, INPUT_LOG_MAGIC, sizeof(h.magic));
+    h.version     = INPUT_LOG_VERSION;
+    h.headerSize  = sizeof(InputLogHeader);
+    h.startNs     = LatencyTracer::nowNs();
+    h.wallStartNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::fwrite(&h, sizeof(h), 1, file);
+
+    filePath = path;
+    lastNs   = h.startNs;
+    recordCount.store(0, std::memory_order_relaxed);
+    byteCount.store(sizeof(h), std::memory_order_relaxed);
+    for (const auto& [id, device] : devices)
+        if (device.active) writeConnect(device, h.startNs);
+    on.store(true, std::memory_order_release);
+    return true;
+}
+
+void InputRecorder::stop() {
+    std::lock_guard<std::mutex> g(lock);
+    on.store(false, std::memory_order_release);
+    if (!file) return;
+    std::fclose(file);
+    file = nullptr;
+}
+
+void InputRecorder::flush() {
+    std::lock_guard<std::mutex> g(lock);
+    if (file) std::fflush(file);
+}
+
+std::string InputRecorder::path() const {
+    std::lock_guard<std::mutex> g(lock);
+    return filePath;
+}
+
+void InputRecorder::deviceConnected(const RealDevice& device) {
+    if (active()) write(REC_CONNECT, device.deviceId, 0, 0, LatencyTracer::nowNs(), &device);
+}
+
+void InputRecorder::deviceDisconnected(const RealDevice& device) {
+    if (active()) write(REC_DISCONNECT, device.deviceId, 0, 0, LatencyTracer::nowNs(), nullptr);
+}
+
+void InputRecorder::write(InputLogRecordType type, uint32_t deviceId, int axisIndex, int32_t value,
+                          int64_t timeNs, const RealDevice* device) {
+    std::lock_guard<std::mutex> g(lock);
+    if (!file) return;   // stopped while we waited for the lock
+    if (type == REC_CONNECT) {
+        writeConnect(*device, timeNs);
+        return;
+    }
+    InputLogRecord r{advance(timeNs), deviceId, (uint16_t)axisIndex, (uint8_t)type, 0, value};
+    std::fwrite(&r, sizeof(r), 1, file);
+    recordCount.fetch_add(1, std::memory_order_relaxed);
+    byteCount.fetch_add(sizeof(r), std::memory_order_relaxed);
+}
+
+// Devices are interleaved, so evdev times can step back a little: clamp to
+// 0 and keep the running total exact (no drift from truncating to µs).
+// Caller holds `lock`.
+uint32_t InputRecorder::advance(int64_t timeNs) {
+    int64_t  delta = timeNs > lastNs ? (timeNs - lastNs) / 1000 : 0;
+    uint32_t us    = delta > UINT32_MAX ? UINT32_MAX : (uint32_t)delta;
+    lastNs += (int64_t)us * 1000;
+    return us;
+}
+
+// Caller holds `lock`
+void InputRecorder::writeConnect(const RealDevice& device, int64_t timeNs) {
+    std::vector<uint8_t> payload;
+    auto put16 = [&payload](uint16_t v) {
+        payload.push_back((uint8_t)v);
+        payload.push_back((uint8_t)(v >> 8));
+    };
+    auto putStr = [&](const std::string& s) {
+        put16((uint16_t)s.size());
+        payload.insert(payload.end(), s.begin(), s.end());
+    };
+    putStr(device.deviceIdStr);
+    const auto& axes = device.axes.getEntries();
+    put16((uint16_t)axes.size());
+    for (const auto& a : axes) {
+        put16((uint16_t)a.index);
+        putStr(a.name);
+    }
+    // The record holds the length before padding; the reader rounds up
+    InputLogRecord r{advance(timeNs), device.deviceId, 0, REC_CONNECT, 0, (int32_t)payload.size()};
+    payload.resize(padded(payload.size()), 0);
+    std::fwrite(&r, sizeof(r), 1, file);
+    std::fwrite(payload.data(), payload.size(), 1, file);
+    recordCount.fetch_add(1, std::memory_order_relaxed);
+    byteCount.fetch_add(sizeof(r) + payload.size(), std::memory_order_relaxed);
+}
+
+// ── InputLogReader ──────────────────────────────────────────────────────────
+
+InputLogReader::~InputLogReader() {
+    if (base) munmap(const_cast<uint8_t*>(base), length);
+}
+
+bool InputLogReader::open(const std::string& path, std::string& error) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = path + ": " + strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(InputLogHeader)) {
+        close(fd);
+        error = path + ": not an input recording (too short)";
+        return false;
+    }
+    void* p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        error = path + ": mmap: " + strerror(errno);
+        return false;
+    }
+    base   = static_cast<const uint8_t*>(p);
+    length = (size_t)st.st_size;
+    madvise(p, length, MADV_SEQUENTIAL);
+
+    const InputLogHeader& h = header();
+    if (memcmp(h.magic, INPUT_LOG_MAGIC, sizeof(h.magic)) != 0 || h.version != INPUT_LOG_VERSION
+        || h.headerSize < sizeof(InputLogHeader) || h.headerSize > length) {
+        error = path + ": not an input recording (bad header)";
+        return false;
+    }
+    rewind();
+    return true;
+}
+
+void InputLogReader::rewind() {
+    offset = base ? header().headerSize : 0;
+    timeNs = 0;
+}
+
+bool InputLogReader::next(Entry& e) {
+    if (offset + sizeof(InputLogRecord) > length) return false;
+    InputLogRecord r;
+    memcpy(&r, base + offset, sizeof(r));
+    offset += sizeof(r);
+    timeNs += (int64_t)r.deltaUs * 1000;
+
+    e.type      = (InputLogRecordType)r.type;
+    e.timeNs    = timeNs;
+    e.deviceId  = r.deviceId;
+    e.axisIndex = r.axisIndex;
+    e.value     = r.value;
+    if (r.type == REC_AXIS || r.type == REC_DISCONNECT) return true;
+    if (r.type != REC_CONNECT || r.value < 4) return false;
+
+    size_t end = offset + (size_t)r.value;
+    if (end > length) return false;
+    const uint8_t* p = base + offset;
+    auto get16 = [&p]() {
+        uint16_t v = (uint16_t)(p[0] | (p[1] << 8));
+        p += 2;
+        return v;
+    };
+    auto getStr = [&](std::string& s) {
+        uint16_t n = get16();
+        if ((size_t)(p - base) + n > end) return false;
+        s.assign(reinterpret_cast<const char*>(p), n);
+        p += n;
+        return true;
+    };
+    e.axes.clear();
+    if (!getStr(e.deviceIdStr)) return false;
+    if ((size_t)(p - base) + 2 > end) return false;
+    uint16_t count = get16();
+    for (uint16_t i = 0; i < count; i++) {
+        if ((size_t)(p - base) + 4 > end) return false;
+        AxisEntry a;
+        a.index = get16();
+        if (!getStr(a.name)) return false;
+        e.axes.push_back(std::move(a));
+    }
+    offset += padded((size_t)r.value);
+    return true;
+}
@@ -0,0 +1,134 @@
+// mainboard/src/pipeline/InputLog.h
+// Binary recording of the normalized input stream: every AxisEvent handed to
+// the mapping engine with its evdev timestamp, plus device connect/disconnect
+// (with the device's axis table, so a replay can rebuild the RealDevice).
+//
+// Recorded by gRecorder (POST /recording/start, or pipeline.record_path) and
+// read back by InputLogReader; mapping/mapping_replay.cpp feeds a log into
+// MappingManager::axisEvent for offline regression and throughput runs.
+//
+// File layout, little endian. Every record starts 16-byte aligned, so the
+// file can be mmap'd and walked in place:
+//   InputLogHeader
+//   InputLogRecord...   REC_CONNECT is followed by its payload, padded to 16:
+//                       uint16 idLen, id bytes, uint16 axisCount,
+//                       axisCount × (uint16 index, uint16 nameLen, name bytes)
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "RealDeviceManager.h"
+
+static constexpr char     INPUT_LOG_MAGIC[8]  = {'I', 'P', 'X', 'R', 'E', 'C', '1', '\0'};
+static constexpr uint32_t INPUT_LOG_VERSION   = 1;
+
+struct InputLogHeader {
+    char     magic[8];        // INPUT_LOG_MAGIC
+    uint32_t version;         // INPUT_LOG_VERSION
+    uint32_t headerSize;      // sizeof(InputLogHeader); records start here
+    int64_t  startNs;         // CLOCK_MONOTONIC at start; record times are relative to it
+    int64_t  wallStartNs;     // CLOCK_REALTIME at start, for display only
+};
+static_assert(sizeof(InputLogHeader) == 32, "InputLogHeader layout");
+
+enum InputLogRecordType : uint8_t {
+    REC_AXIS       = 1,
+    REC_CONNECT    = 2,
+    REC_DISCONNECT = 3,
+};
+
+struct InputLogRecord {
+    uint32_t deltaUs;         // since the previous record (0 if the clock went backwards)
+    uint32_t deviceId;        // RealDevice::deviceId
+    uint16_t axisIndex;       // REC_AXIS
+    uint8_t  type;            // InputLogRecordType
+    uint8_t  reserved;
+    int32_t  value;           // REC_AXIS: value; REC_CONNECT: payload bytes before padding
+};
+static_assert(sizeof(InputLogRecord) == 16, "InputLogRecord layout");
+
+// ── InputRecorder ───────────────────────────────────────────────────────────
+// Thread-safe: axisEvent() runs on the ingest thread in pipelined mode,
+// connect/disconnect on the scheduler thread. While stopped every call is one
+// relaxed load.
+class InputRecorder {
+public:
+    // Opens `path` and writes a connect record for each active device in
+    // `devices` (the ones already connected). Fails if already recording.
+    // Never follows a symlink at `path`; `exclusive` also refuses an existing
+    // file instead of truncating it (recordings started over REST). On
+    // failure errno is left as the open error.
+    bool start(const std::string& path, const std::map<unsigned int, RealDevice>& devices,
+               std::string& error, bool exclusive = false);
+    void stop();
+    // Pushes buffered records to the file, so a killed process loses at most
+    // the time since the last call (main.cpp's "record-flush", every second)
+    void flush();
+
+    bool active() const { return on.load(std::memory_order_relaxed); }
+
+    // timeNs: CLOCK_MONOTONIC time of the event (the evdev timestamp)
+    void axisEvent(const AxisEvent& ev, int64_t timeNs) {
+        if (active()) write(REC_AXIS, ev.deviceId, ev.axisIndex, ev.value, timeNs, nullptr);
+    }
+    void deviceConnected(const RealDevice& device);
+    void deviceDisconnected(const RealDevice& device);
+
+    std::string path() const;
+    uint64_t    records() const { return recordCount.load(std::memory_order_relaxed); }
+    uint64_t    bytes() const   { return byteCount.load(std::memory_order_relaxed); }
+
+private:
+    void write(InputLogRecordType type, uint32_t deviceId, int axisIndex, int32_t value,
+               int64_t timeNs, const RealDevice* device);
+    void writeConnect(const RealDevice& device, int64_t timeNs);
+    uint32_t advance(int64_t timeNs);
+
+    mutable std::mutex    lock;
+    std::FILE*            file = nullptr;
+    std::string           filePath;
+    int64_t               lastNs = 0;   // time the previous record's delta brought us to
+    std::atomic<bool>     on{false};
+    std::atomic<uint64_t> recordCount{0};
+    std::atomic<uint64_t> byteCount{0};
+};
+
+extern InputRecorder gRecorder;
+
+// ── InputLogReader ──────────────────────────────────────────────────────────
+// Maps a recording read-only and walks it record by record.
+class InputLogReader {
+public:
+    struct Entry {
+        InputLogRecordType     type;
+        int64_t                timeNs;     // since the start of the recording
+        uint32_t               deviceId;
+        int                    axisIndex;  // REC_AXIS
+        int32_t                value;      // REC_AXIS
+        std::string            deviceIdStr; // REC_CONNECT
+        std::vector<AxisEntry> axes;        // REC_CONNECT
+    };
+
+    InputLogReader() = default;
+    InputLogReader(const InputLogReader&) = delete;
+    InputLogReader& operator=(const InputLogReader&) = delete;
+    ~InputLogReader();
+
+    bool open(const std::string& path, std::string& error);
+    // False at the end of the log, or at a truncated / corrupt record
+    bool next(Entry& entry);
+    void rewind();
+
+    const InputLogHeader& header() const { return *reinterpret_cast<const InputLogHeader*>(base); }
+    size_t                size() const   { return length; }
+
+private:
+    const uint8_t* base   = nullptr;
+    size_t         length = 0;
+    size_t         offset = 0;
+    int64_t        timeNs = 0;
+};
@@ -0,0 +1,138 @@
+// mainboard/src/pipeline/LatencyTrace.cpp
+#include "LatencyTrace.h"
+#include <chrono>
+
+LatencyTracer gTracer;
+
+// ── LatencyHistogram ────────────────────────────────────────────────────────
+
+// Values below 2^(SUB_BITS+1) get a bucket each; above that, each power of two
+// is split into 2^SUB_BITS buckets by the bits under the leading one.
+int LatencyHistogram::bucketOf(uint64_t us) {
+    if (us < (2u << SUB_BITS)) return (int)us;
+    int msb = 63 - __builtin_clzll(us);
+    if (msb > MAX_MSB) return BUCKETS - 1;
+    return ((msb - SUB_BITS) << SUB_BITS) + (int)(us >> (msb - SUB_BITS));
+}
+
+uint64_t LatencyHistogram::bucketHigh(int idx) {
+    if (idx < (2 << SUB_BITS)) return (uint64_t)idx;
+    int shift    = (idx >> SUB_BITS) - 1;                          // msb - SUB_BITS
+    uint64_t top = (uint64_t)(idx - (shift << SUB_BITS));          // leading SUB_BITS+1 bits
+    return ((top + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t us) {
+    counts[bucketOf(us)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(us, std::memory_order_relaxed);
+    uint64_t m = max.load(std::memory_order_relaxed);
+    while (us > m && !max.compare_exchange_weak(m, us, std::memory_order_relaxed)) {}
+}
+
+uint64_t LatencyHistogram::avgUs() const {
+    uint64_t n = count();
+    return n ? sum.load(std::memory_order_relaxed) / n : 0;
+}
+
+uint64_t LatencyHistogram::percentileUs(double p) const {
+    uint64_t n = count();
+    if (n == 0) return 0;
+    uint64_t rank = (uint64_t)(p / 100.0 * (double)n + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+    uint64_t seenSoFar = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seenSoFar += counts[i].load(std::memory_order_relaxed);
+        if (seenSoFar >= rank) {
+            uint64_t hi = bucketHigh(i);
+            return hi < maxUs() ? hi : maxUs();
+        }
+    }
+    return maxUs();
+}
+
+void LatencyHistogram::reset() {
+    for (auto& c : counts) c.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+// ── LatencyTracer ───────────────────────────────────────────────────────────
+
+int64_t LatencyTracer::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char* LatencyTracer::stageName(TraceStage s) {
+    switch (s) {
+        case ST_EVDEV:    return "evdev";
+        case ST_QUEUE:    return "queue";
+        case ST_MAPPING:  return "mapping";
+        case ST_COALESCE: return "coalesce";
+        case ST_OUTBOUND: return "outbound";
+        case ST_WRITE:    return "write";
+        case ST_TOTAL:    return "total";
+        default:          return "?";
+    }
+}
+
+uint32_t LatencyTracer::begin(int64_t kernelNs, int64_t readNs) {
+    int every = sampleEvery.load(std::memory_order_relaxed);
+    if (every <= 0 || seen.fetch_add(1, std::memory_order_relaxed) % (uint32_t)every != 0) return 0;
+    uint32_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+    if (id == 0) id = nextId.fetch_add(1, std::memory_order_relaxed);   // 0 means "not traced"
+    Slot& s = slots[id % SLOTS];
+    s.id.store(0, std::memory_order_relaxed);   // retire whatever trace held the slot
+    for (auto& t : s.t) t.store(0, std::memory_order_relaxed);
+    s.t[TS_KERNEL].store(kernelNs, std::memory_order_relaxed);
+    s.t[TS_READ].store(readNs, std::memory_order_relaxed);
+    s.id.store(id, std::memory_order_release);
+    startedCount.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+void LatencyTracer::stamp(uint32_t trace, TraceStamp ts) {
+    if (!trace) return;
+    Slot& s = slots[trace % SLOTS];
+    if (s.id.load(std::memory_order_acquire) != trace) return;
+    s.t[ts].store(nowNs(), std::memory_order_relaxed);
+}
+
+int64_t LatencyTracer::originNs(uint32_t trace) const {
+    if (!trace) return 0;
+    const Slot& s = slots[trace % SLOTS];
+    if (s.id.load(std::memory_order_acquire) != trace) return 0;
+    int64_t kernel = s.t[TS_KERNEL].load(std::memory_order_relaxed);
+    int64_t read   = s.t[TS_READ].load(std::memory_order_relaxed);
+    return (kernel && kernel <= read) ? kernel : read;
+}
+
+void LatencyTracer::finish(uint32_t trace) {
+    if (!trace) return;
+    int64_t done = nowNs();
+    Slot& s = slots[trace % SLOTS];
+    uint32_t expected = trace;
+    if (!s.id.compare_exchange_strong(expected, 0, std::memory_order_acq_rel)) return;
+
+    int64_t t[TS_COUNT + 1];
+    for (int i = 0; i < TS_COUNT; i++) t[i] = s.t[i].load(std::memory_order_relaxed);
+    t[TS_COUNT] = done;
+    // A stage is recorded when both ends were stamped; a negative span means
+    // the kernel time was not on CLOCK_MONOTONIC (EVIOCSCLOCKID unsupported)
+    for (int st = ST_EVDEV; st <= ST_WRITE; st++) {
+        if (t[st] && t[st + 1] && t[st + 1] >= t[st])
+            hist[st].record((uint64_t)(t[st + 1] - t[st]) / 1000);
+    }
+    int64_t from = (t[TS_KERNEL] && t[TS_KERNEL] <= t[TS_READ]) ? t[TS_KERNEL] : t[TS_READ];
+    if (from && done >= from) hist[ST_TOTAL].record((uint64_t)(done - from) / 1000);
+    completedCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LatencyTracer::reset() {
+    for (auto& h : hist) h.reset();
+    startedCount.store(0, std::memory_order_relaxed);
+    completedCount.store(0, std::memory_order_relaxed);
+}
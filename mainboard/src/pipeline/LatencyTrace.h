@@ -0,0 +1,104 @@
+// mainboard/src/pipeline/LatencyTrace.h
+// Sampled end-to-end input latency: evdev timestamp → UART write.
+//
+// One emitted AxisEvent in every `sampleEvery` gets a trace id at ingest. The
+// id rides along with the event through the pipeline:
+//   - AxisEvent::trace
+//   - LatencyTracer::current, while the mapping engine dispatches the event
+//   - the board's pending axis update
+//   - the RpcPacket (PacketBuf::trace())
+// Each hop stamps the time into the trace's slot. The UART write closes the
+// trace and records every stage into a histogram. Unsampled events carry
+// trace 0 and cost one branch per hop.
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Log-linear histogram of microsecond values (HDR style): 32 buckets per
+// power of two, so a reported percentile is within ~3% of the true value.
+// Lock-free; record() may run on any thread.
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BITS = 5;
+    static constexpr int MAX_MSB  = 36;   // ~19 h, larger values land in the last bucket
+    static constexpr int BUCKETS  = (MAX_MSB - SUB_BITS + 2) << SUB_BITS;
+
+    void     record(uint64_t us);
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t maxUs() const { return max.load(std::memory_order_relaxed); }
+    uint64_t avgUs() const;
+    // Highest value in the bucket that holds percentile p (0..100), capped at maxUs()
+    uint64_t percentileUs(double p) const;
+    void     reset();
+
+    static int      bucketOf(uint64_t us);
+    static uint64_t bucketHigh(int idx);
+
+private:
+    std::atomic<uint64_t> counts[BUCKETS] = {};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+};
+
+// Points along the path, in order
+enum TraceStamp { TS_KERNEL, TS_READ, TS_DISPATCH, TS_MAPPED, TS_FLUSH, TS_WRITE, TS_COUNT };
+
+// Spans between consecutive stamps; ST_WRITE ends when the write returns
+enum TraceStage {
+    ST_EVDEV,      // kernel timestamp → read by the mainboard
+    ST_QUEUE,      // read → axis-dispatch (axisEventChannel / ingest ring)
+    ST_MAPPING,    // MappingManager::axisEvent
+    ST_COALESCE,   // mapped → board batch packet built (coalescing window)
+    ST_OUTBOUND,   // packet → UART writer (rpcOutCh / writer ring)
+    ST_WRITE,      // framing + write()
+    ST_TOTAL,      // kernel (or read, without a kernel time) → written
+    ST_COUNT
+};
+
+class LatencyTracer {
+public:
+    // Ingest side: returns a new trace id for a sampled event, else 0.
+    // kernelNs: evdev timestamp on CLOCK_MONOTONIC (0 = unknown).
+    uint32_t begin(int64_t kernelNs, int64_t readNs);
+    void     stamp(uint32_t trace, TraceStamp s);
+    // After the UART write: records the stages. Later calls for the same
+    // trace (one event fanned out to several packets) are ignored.
+    void     finish(uint32_t trace);
+    // Kernel time of a live trace (read time when the kernel time is unusable), 0 if gone
+    int64_t  originNs(uint32_t trace) const;
+
+    bool enabled() const          { return sampleEvery.load(std::memory_order_relaxed) > 0; }
+    int  getSampleEvery() const   { return sampleEvery.load(std::memory_order_relaxed); }
+    void setSampleEvery(int n)    { sampleEvery.store(n > 0 ? n : 0, std::memory_order_relaxed); }
+
+    const LatencyHistogram& histogram(TraceStage s) const { return hist[s]; }
+    static const char*      stageName(TraceStage s);
+    uint64_t started() const   { return startedCount.load(std::memory_order_relaxed); }
+    uint64_t completed() const { return completedCount.load(std::memory_order_relaxed); }
+    void     reset();
+
+    static int64_t nowNs();   // CLOCK_MONOTONIC, same clock as steady_clock
+
+    // Trace of the event the mapping engine is dispatching; read by
+    // EmulationBoard::setAxis(). Scheduler thread only.
+    uint32_t current = 0;
+
+private:
+    static constexpr int SLOTS = 1024;   // traces in flight; an unfinished one is overwritten
+
+    struct Slot {
+        std::atomic<uint32_t> id{0};
+        std::atomic<int64_t>  t[TS_COUNT] = {};
+    };
+
+    Slot                  slots[SLOTS];
+    LatencyHistogram      hist[ST_COUNT];
+    std::atomic<int>      sampleEvery{0};
+    std::atomic<uint32_t> seen{0};
+    std::atomic<uint32_t> nextId{1};
+    std::atomic<uint64_t> startedCount{0};
+    std::atomic<uint64_t> completedCount{0};
+};
+
+extern LatencyTracer gTracer;
@@ -0,0 +1,162 @@
+// mainboard/src/pipeline/Pipeline.cpp
+#include "Pipeline.h"
+#include "LatencyTrace.h"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+using namespace corocgo;
+using namespace corocrpc;
+
+bool pinCurrentThread(int cpu, const char* name) {
+    pthread_setname_np(pthread_self(), name);   // names are limited to 15 chars
+    if (cpu < 0) return true;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        std::cerr << "[pipeline] cannot pin " << name << " to cpu " << cpu
+                  << ": " << strerror(rc) << std::endl;
+        return false;
+    }
+    std::cout << "[pipeline] " << name << " pinned to cpu " << cpu << std::endl;
+    return true;
+}
+
+// ── IngestThread ────────────────────────────────────────────────────────────
+
+IngestThread::IngestThread(RealDeviceManager* rdm, Channel<AxisEvent>* events,
+                           Channel<unsigned int>* gone, int cpu)
+    : rdm(rdm), events(events), gone(gone), cpu(cpu) {}
+
+IngestThread::~IngestThread() {
+    stop();
+}
+
+bool IngestThread::start() {
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd  = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        std::cerr << "[pipeline] ingest setup failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+    epoll_event ev{};
+    ev.events   = EPOLLIN;
+    ev.data.ptr = nullptr;   // nullptr marks the wake fd
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+    thread = std::thread([this] { run(); });
+    return true;
+}
+
+void IngestThread::stop() {
+    if (!thread.joinable()) return;
+    stopping.store(true, std::memory_order_release);
+    uint64_t one = 1;
+    (void)!write(wakeFd, &one, sizeof(one));
+    thread.join();
+    close(wakeFd);
+    close(epollFd);
+    wakeFd = epollFd = -1;
+}
+
+void IngestThread::addDevice(RealDevice* dev) {
+    {
+        std::lock_guard<std::mutex> lock(pendingMtx);
+        pending.push_back(dev);
+    }
+    uint64_t one = 1;
+    (void)!write(wakeFd, &one, sizeof(one));
+}
+
+void IngestThread::watchPending() {
+    uint64_t n;
+    (void)!read(wakeFd, &n, sizeof(n));
+    std::vector<RealDevice*> added;
+    {
+        std::lock_guard<std::mutex> lock(pendingMtx);
+        added.swap(pending);
+    }
+    for (RealDevice* dev : added) {
+        epoll_event ev{};
+        ev.events   = EPOLLIN;
+        ev.data.ptr = dev;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, dev->fd, &ev) < 0) {
+            std::cerr << "[pipeline] cannot watch device " << dev->deviceId
+                      << ": " << strerror(errno) << std::endl;
+            dropDevice(dev);
+        }
+    }
+}
+
+// Stops watching the fd and hands the device back to the scheduler thread.
+void IngestThread::dropDevice(RealDevice* dev) {
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, dev->fd, nullptr);
+    while (!gone->sendExternalNoBlock(dev->deviceId)) {
+        if (gone->isClosed()) return;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+void IngestThread::run() {
+    pinCurrentThread(cpu, "ip-ingest");
+    epoll_event ready[32];
+    while (!stopping.load(std::memory_order_acquire)) {
+        int n = epoll_wait(epollFd, ready, 32, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[pipeline] epoll_wait: " << strerror(errno) << std::endl;
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            RealDevice* dev = static_cast<RealDevice*>(ready[i].data.ptr);
+            if (!dev) {
+                watchPending();
+                continue;
+            }
+            bool alive = (ready[i].events & EPOLLIN)
+                       ? rdm->processDeviceInput(dev, events, /*external=*/true)
+                       : false;   // EPOLLERR / EPOLLHUP without data
+            if (!alive) dropDevice(dev);
+        }
+    }
+}
+
+// ── UartWriter ──────────────────────────────────────────────────────────────
+
+UartWriter::UartWriter(UartManager* uart, int cpu, int capacity)
+    : uart(uart), cpu(cpu), ring(capacity) {}
+
+UartWriter::~UartWriter() {
+    stop();
+}
+
+bool UartWriter::start() {
+    thread = std::thread([this] { run(); });
+    return true;
+}
+
+void UartWriter::stop() {
+    if (!thread.joinable()) return;
+    ring.close();
+    thread.join();
+}
+
+void UartWriter::run() {
+    std::string name = "ip-uart" + std::to_string((int)uart->getChannel());
+    pinCurrentThread(cpu, name.c_str());
+    RpcPacket pkt;
+    while (ring.pop(pkt)) {
+        uint32_t trace = pkt.trace();
+        gTracer.stamp(trace, TS_WRITE);
+        if (StreamFramer::frame(pkt, 0))
+            uart->uartSend(reinterpret_cast<const char*>(pkt.data()), pkt.size());
+        gTracer.finish(trace);
+        pkt.reset();   // back to the slab before blocking in pop()
+    }
+}
@@ -0,0 +1,88 @@
+// mainboard/src/pipeline/Pipeline.h
+// Optional pipelined mode (config.json "pipeline"): evdev ingestion and UART
+// writes move off the scheduler thread.
+//
+//   IngestThread ──Channel ext ring──▶ scheduler (mapping, RPC, REST) ──SpscRing──▶ UartWriter ×N
+//
+// The scheduler is the single corocgo thread, so the mapping engine stays on
+// it (pinned to mapping_cpu); everything it hands off goes through an SPSC
+// ring with exactly one producer and one consumer thread.
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "corocgo/corocgo.h"
+#include "corocrpc/corocrpc.h"
+#include "RealDeviceManager.h"
+#include "UartManager.h"
+#include "SpscRing.h"
+
+// Pins the calling thread to `cpu` (no-op when cpu < 0) and names it for
+// top/htop. Returns false if the affinity call failed.
+bool pinCurrentThread(int cpu, const char* name);
+
+// ── IngestThread ────────────────────────────────────────────────────────────
+// Reads and normalizes evdev input for every added device on one thread and
+// pushes AxisEvents through `events`' external send ring. When a device goes
+// away it stops watching the fd and posts the deviceId to `gone`; the fd is
+// closed on the scheduler side (RealDeviceManager::markDisconnected).
+class IngestThread {
+public:
+    IngestThread(RealDeviceManager* rdm,
+                 corocgo::Channel<AxisEvent>*    events,
+                 corocgo::Channel<unsigned int>* gone,
+                 int cpu);
+    ~IngestThread();
+
+    bool start();
+    void stop();
+
+    // Scheduler thread. The device must stay registered (RealDevice
+    // pointers are stable) until its id comes back through `gone`.
+    void addDevice(RealDevice* dev);
+
+private:
+    void run();
+    void watchPending();
+    void dropDevice(RealDevice* dev);
+
+    RealDeviceManager*              rdm;
+    corocgo::Channel<AxisEvent>*    events;
+    corocgo::Channel<unsigned int>* gone;
+    int                             cpu;
+
+    int               epollFd = -1;
+    int               wakeFd  = -1;   // eventfd: new devices / stop
+    std::thread       thread;
+    std::atomic<bool> stopping{false};
+
+    std::mutex               pendingMtx;
+    std::vector<RealDevice*> pending;   // added, not yet in epoll
+};
+
+// ── UartWriter ──────────────────────────────────────────────────────────────
+// Owns the framing + blocking write() for one UartRpcLink. The scheduler's
+// outbound bridge hands over RpcPacket buffers; this thread CRC-frames them
+// in place (StreamFramer::frame is stateless), writes them to the UART and
+// drops the buffer back into the packet slab.
+class UartWriter {
+public:
+    UartWriter(UartManager* uart, int cpu, int capacity = 16);   // packets queued for write()
+    ~UartWriter();
+
+    bool start();
+    void stop();
+
+    // Scheduler thread, from a coroutine. Parks while the ring is full until
+    // the writer thread takes a packet; false once the writer has stopped.
+    bool queue(corocrpc::RpcPacket& pkt) { return ring.push(std::move(pkt)); }
+
+private:
+    void run();
+
+    UartManager*                  uart;
+    int                           cpu;
+    SpscRing<corocrpc::RpcPacket> ring;
+    std::thread                   thread;
+};
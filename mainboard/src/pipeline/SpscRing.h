@@ -0,0 +1,112 @@
+// mainboard/src/pipeline/SpscRing.h
+// Bounded lock-free single-producer / single-consumer ring for handing work
+// from the scheduler thread to a plain worker thread.
+//
+// Same index scheme as Channel's external send buffer (one slot kept empty to
+// tell full from empty). tryPush/tryPop never block. A consumer that runs dry
+// parks in pop(); the producer only takes the mutex when it sees the consumer
+// parked, so the steady-state handoff is two atomic stores. A producer
+// coroutine that finds the ring full parks in push() on a thread-safe
+// corocgo monitor, woken by the consumer's next pop.
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include "corocgo/corocgo.h"
+
+template<typename T>
+class SpscRing {
+public:
+    explicit SpscRing(int capacity)
+        : size(capacity + 1), buffer(new T[capacity + 1]), spaceMonitor(corocgo::_monitor_ts_create()) {}
+    ~SpscRing() {
+        corocgo::_monitor_ts_destroy(spaceMonitor);
+        delete[] buffer;
+    }
+    SpscRing(const SpscRing&)            = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer. Returns false if the ring is full or closed.
+    bool tryPush(const T& value) {
+        T copy = value;
+        return tryPush(std::move(copy));
+    }
+
+    // Producer. `value` is only moved from on success, so the caller can retry.
+    bool tryPush(T&& value) {
+        if (closed.load(std::memory_order_acquire)) return false;
+        int w    = writeIdx.load(std::memory_order_relaxed);
+        int next = (w + 1) % size;
+        if (next == readIdx.load(std::memory_order_acquire)) return false;   // full
+        buffer[w] = std::move(value);
+        writeIdx.store(next, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);   // pairs with the fence in pop()
+        if (parked.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(mtx);
+            cv.notify_one();
+        }
+        return true;
+    }
+
+    // Producer, from a corocgo coroutine. Parks while the ring is full.
+    // Returns false once closed; `value` is only moved from on success.
+    bool push(T&& value) {
+        while (!tryPush(std::move(value))) {
+            if (closed.load(std::memory_order_acquire)) return false;
+            int seen = readIdx.load(std::memory_order_acquire);
+            if ((writeIdx.load(std::memory_order_relaxed) + 1) % size != seen) continue;   // room already
+            // Abandoned if readIdx moves after we register (the pop's wake may have missed us)
+            corocgo::_monitor_ts_wait(spaceMonitor, nullptr, &readIdx, seen);
+        }
+        return true;
+    }
+
+    // Consumer. Returns false if the ring is empty.
+    bool tryPop(T& out) {
+        int r = readIdx.load(std::memory_order_relaxed);
+        if (r == writeIdx.load(std::memory_order_acquire)) return false;
+        out = std::move(buffer[r]);
+        readIdx.store((r + 1) % size, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);   // pairs with the recheck in _monitor_ts_wait
+        corocgo::_monitor_ts_wake_external(spaceMonitor);      // one load when no producer is parked
+        return true;
+    }
+
+    // Consumer. Blocks until an item arrives; returns false once closed and drained.
+    bool pop(T& out) {
+        while (true) {
+            if (tryPop(out)) return true;
+            std::unique_lock<std::mutex> lock(mtx);
+            parked.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            cv.wait(lock, [this] { return !empty() || closed.load(std::memory_order_acquire); });
+            parked.store(false, std::memory_order_relaxed);
+            if (empty() && closed.load(std::memory_order_acquire)) return false;
+        }
+    }
+
+    // Either side. Wakes a parked consumer; pending items can still be popped.
+    void close() {
+        closed.store(true, std::memory_order_release);
+        corocgo::_monitor_ts_wake_all(spaceMonitor);
+        std::lock_guard<std::mutex> lock(mtx);
+        cv.notify_all();
+    }
+
+    bool empty() const {
+        return readIdx.load(std::memory_order_acquire) == writeIdx.load(std::memory_order_acquire);
+    }
+
+    int capacity() const { return size - 1; }
+
+private:
+    const int         size;
+    T*                buffer;
+    std::atomic<int>  writeIdx{0};   // producer writes, consumer reads
+    std::atomic<int>  readIdx{0};    // consumer writes, producer reads
+    std::atomic<bool> closed{false};
+    std::atomic<bool> parked{false};
+    std::mutex              mtx;
+    std::condition_variable cv;
+    void*                   spaceMonitor;   // producer coroutine parked in push()
+};
@@ -66,17 +66,16 @@ static std::string toLower(std::string s) {
     return s;
 }
 
-// Non-blocking write loop: keep sending until all bytes are delivered,
-// yielding via wait_file(WAIT_OUT) whenever the kernel buffer is full.
+// Write loop: keep sending until all bytes are delivered. co_send parks the
+// coroutine while the kernel buffer is full (io_uring or wait_file).
 static void sendAll(int fd, const char* data, int size) {
     int offset = 0;
     while (offset < size) {
-        int n = static_cast<int>(::send(fd, data + offset, size - offset, MSG_NOSIGNAL));
+        int n = static_cast<int>(co_send(fd, data + offset, size - offset, MSG_NOSIGNAL));
         if (n > 0) {
             offset += n;
-        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
-            auto [flags, err] = wait_file(fd, WAIT_OUT);
-            if (err) return;
+        } else if (n == -EINTR) {
+            continue;
         } else {
             return; // connection closed or hard error
         }
@@ -204,26 +203,18 @@ coSession CoServerImpl::accept() {
     // Only a failure on the *listening* socket returns nullptr.
     for (;;) {
 
-    // 1. Wait for an incoming connection.
-    auto [flags, err] = wait_file(sockfd, WAIT_IN);
-    if (err) {
-        closed = true;
-        return nullptr;
-    }
-
-    // 2. Accept the connection.
+    // 1-2. Wait for and accept an incoming connection.
     sockaddr_in clientAddr{};
     socklen_t   addrLen = sizeof(clientAddr);
-    int connfd = ::accept(sockfd,
-                          reinterpret_cast<sockaddr*>(&clientAddr),
-                          &addrLen);
+    int connfd = co_accept(sockfd,
+                           reinterpret_cast<sockaddr*>(&clientAddr),
+                           &addrLen, SOCK_NONBLOCK);
     if (connfd < 0) {
-        if (errno == EAGAIN || errno == EWOULDBLOCK) continue; // spurious wakeup
+        if (connfd == -EINTR || connfd == -ECONNABORTED) continue;
         closed = true;
-        std::cout<<"connfd error:"<<errno<<std::endl;
+        std::cout<<"connfd error:"<<-connfd<<std::endl;
         return nullptr;
     }
-    ::fcntl(connfd, F_SETFL, ::fcntl(connfd, F_GETFL, 0) | O_NONBLOCK);
 
     // 3. Read until we have the full header block (\r\n\r\n).
     std::string rawBuf;
@@ -232,10 +223,8 @@ coSession CoServerImpl::accept() {
     bool clientFail = false;
 
     while (headerEnd == std::string::npos) {
-        auto [rf, re] = wait_file(connfd, WAIT_IN);
-        if (re) { clientFail = true; break; }
         char tmp[4096];
-        int n = static_cast<int>(::recv(connfd, tmp, sizeof(tmp), 0));
+        int n = static_cast<int>(co_recv(connfd, tmp, sizeof(tmp)));
         if (n <= 0) { clientFail = true; break; }
         rawBuf.append(tmp, n);
         headerEnd = rawBuf.find("\r\n\r\n");
@@ -356,10 +345,7 @@ int CoSessionImpl::read(char* buf, int maxSize) {
     //    Without Content-Length there is no body (e.g. GET), so don't block.
     if (contentLength >= 0) {
         while (total < maxSize && total < contentLength) {
-            auto [flags, err] = wait_file(fd, WAIT_IN);
-            if (err) break;
-
-            int n = static_cast<int>(::recv(fd, buf + total, maxSize - total, 0));
+            int n = static_cast<int>(co_recv(fd, buf + total, maxSize - total));
             if (n <= 0) break;
             total += n;
         }
@@ -2,11 +2,17 @@
 #include "CoHttpServer.h"
 #include "RealDeviceManager.h"
 #include "EmulatedDeviceManager.h"
+#include "MappingManager.h"
+#include "MainConfig.h"
 #include "PicoConfig.h"
+#include "pipeline/LatencyTrace.h"
+#include "pipeline/InputLog.h"
 #include <iostream>
 #include <memory>
 #include <sstream>
+#include <cerrno>
 #include <algorithm>
+#include <chrono>
 #include <vector>
 #include <functional>
 
@@ -42,6 +48,16 @@ static std::string qparam(const coSession& session, const std::string& key,
     return it != session->queryString.end() ? it->second : def;
 }
 
+// {"count":..,"avgUs":..,"p50Us":..,"p99Us":..,"p999Us":..,"maxUs":..}
+static void histogramJson(std::ostringstream& json, const LatencyHistogram& h) {
+    json << "{\"count\":"  << h.count()              << ","
+         << "\"avgUs\":"  << h.avgUs()              << ","
+         << "\"p50Us\":"  << h.percentileUs(50.0)   << ","
+         << "\"p99Us\":"  << h.percentileUs(99.0)   << ","
+         << "\"p999Us\":" << h.percentileUs(99.9)   << ","
+         << "\"maxUs\":"  << h.maxUs()              << "}";
+}
+
 static EmulationBoard* findBoard(std::vector<EmulationBoard>* boards, int id) {
     for (auto& b : *boards)
         if (b.id == id) return &b;
@@ -84,11 +100,12 @@ void startRestApi(int port, RealDeviceManager* deviceManager,
                   std::vector<EmulationBoard>* boards,
                   EmulatedDeviceManager* emulatedDeviceManager,
                   LayerManager* layerManager,
+                  MappingManager* mappingManager,
                   std::function<std::vector<std::string>()> reloadConfigFn,
                   int* turboTimesPerSecond,
                   std::string* turboDeviceIdStr,
                   int* turboAxisIndex) {
-    coro([port, deviceManager, boards, emulatedDeviceManager, layerManager, reloadConfigFn,
+    coro_named("http-server", [port, deviceManager, boards, emulatedDeviceManager, layerManager, mappingManager, reloadConfigFn,
           turboTimesPerSecond, turboDeviceIdStr, turboAxisIndex]() {
         auto router = std::make_shared<CoHttpRouter>();
 
@@ -119,6 +136,47 @@ void startRestApi(int port, RealDeviceManager* deviceManager,
                 sendJson(session, 200, boardJson(*b));
             });
 
+        router->endpoint("GET", "/emulationboard/{id}/rpcstats",
+            [boards](coSession session, auto vars) {
+                int32_t id;
+                if (!parseId(vars, "id", id)) {
+                    sendJson(session, 400, "{\"error\":\"invalid id\"}"); return;
+                }
+                EmulationBoard* b = findBoard(boards, id);
+                if (!b) { sendJson(session, 404, "{\"error\":\"board not found\"}"); return; }
+                corocrpc::RpcCallStats    c = b->rpc->callStats();
+                corocrpc::RpcArgPoolStats a = b->rpc->argPoolStats();
+                auto cls = [](std::ostringstream& json, const corocrpc::RpcArgClassStats& k) {
+                    json << "{"
+                         << "\"size\":"     << k.size     << ","
+                         << "\"capacity\":" << k.capacity << ","
+                         << "\"inUse\":"    << k.inUse    << ","
+                         << "\"peak\":"     << k.peak
+                         << "}";
+                };
+                std::ostringstream json;
+                json << "{"
+                     << "\"calls\":{"
+                     <<   "\"total\":"        << c.calls        << ","
+                     <<   "\"inFlight\":"     << c.inFlight     << ","
+                     <<   "\"peakInFlight\":" << c.peakInFlight << ","
+                     <<   "\"timeouts\":"     << c.timeouts     << ","
+                     <<   "\"windowStalls\":" << c.windowStalls
+                     << "},"
+                     << "\"args\":{"
+                     <<   "\"small\":";
+                cls(json, a.small);
+                json <<   ",\"large\":";
+                cls(json, a.large);
+                json <<   ",\"waits\":"      << a.waits      << ","
+                     <<   "\"promotions\":"  << a.promotions << ","
+                     <<   "\"borrowed\":"    << a.borrowed   << ","
+                     <<   "\"slabsFreed\":"  << a.slabsFreed
+                     << "}"
+                     << "}";
+                sendJson(session, 200, json.str());
+            });
+
         router->endpoint("GET", "/emulationboard/{id}/devices",
             [boards, emulatedDeviceManager](coSession session, auto vars) {
                 int32_t id;
@@ -180,14 +238,73 @@ void startRestApi(int port, RealDeviceManager* deviceManager,
                 EmulationBoard* b = findBoard(boards, id);
                 if (!b)         { sendJson(session, 404, "{\"error\":\"board not found\"}"); return; }
                 if (!b->active) { sendJson(session, 503, "{\"error\":\"board not active\"}"); return; }
-                int32_t val = 0;
-                try { val = std::stoi(qparam(session, "value", "0")); } catch (...) {}
-                int result = b->pingPico(val);
+                int32_t val = 0, count = 1;
+                try {
+                    val   = std::stoi(qparam(session, "value", "0"));
+                    count = std::stoi(qparam(session, "count", "1"));
+                } catch (...) {}
+                if (count <= 1) {
+                    int result = b->pingPico(val);
+                    std::ostringstream json;
+                    json << "{\"result\":" << result << "}";
+                    sendJson(session, 200, json.str());
+                    return;
+                }
+                // count > 1: pipelined burst, reports throughput of the RPC link
+                count = std::min(count, 10000);
+                auto start = std::chrono::steady_clock::now();
+                int ok = b->pingPicoBurst(val, count);
+                auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start).count();
                 std::ostringstream json;
-                json << "{\"result\":" << result << "}";
+                json << "{\"count\":" << count << ",\"ok\":" << ok
+                     << ",\"elapsed_us\":" << us << ",\"per_call_us\":" << us / count << "}";
                 sendJson(session, 200, json.str());
             });
 
+        // Input → USB report latency measured on the Pico (needs trace_sample_every > 0)
+        router->endpoint("GET", "/emulationboard/{id}/latency",
+            [boards](coSession session, auto vars) {
+                int32_t id;
+                if (!parseId(vars, "id", id)) {
+                    sendJson(session, 400, "{\"error\":\"invalid id\"}"); return;
+                }
+                EmulationBoard* b = findBoard(boards, id);
+                if (!b)          { sendJson(session, 404, "{\"error\":\"board not found\"}"); return; }
+                if (!b->latency) { sendJson(session, 501, "{\"error\":\"firmware has no latency probe\"}"); return; }
+                const PicoLatency& l = *b->latency;
+                std::ostringstream json;
+                json << "{\"clock\":{\"synced\":" << (l.clock.valid() ? "true" : "false")
+                     << ",\"offsetUs\":"  << l.clock.offsetUs()
+                     << ",\"rttUs\":"     << l.clock.rttUs()
+                     << ",\"samples\":"   << l.clock.samples() << "}"
+                     << ",\"marks\":"     << l.marks()
+                     << ",\"stamped\":"   << l.stamped()
+                     << ",\"noReport\":"  << l.noReport()
+                     << ",\"unmatched\":" << l.unmatched()
+                     << ",\"stages\":{";
+                for (int st = 0; st < PicoLatency::ST_COUNT; st++) {
+                    if (st) json << ",";
+                    json << "\"" << PicoLatency::stageName((PicoLatency::Stage)st) << "\":";
+                    histogramJson(json, l.histogram((PicoLatency::Stage)st));
+                }
+                json << "}}";
+                sendJson(session, 200, json.str());
+            });
+
+        router->endpoint("POST", "/emulationboard/{id}/latency/reset",
+            [boards](coSession session, auto vars) {
+                int32_t id;
+                if (!parseId(vars, "id", id)) {
+                    sendJson(session, 400, "{\"error\":\"invalid id\"}"); return;
+                }
+                EmulationBoard* b = findBoard(boards, id);
+                if (!b)          { sendJson(session, 404, "{\"error\":\"board not found\"}"); return; }
+                if (!b->latency) { sendJson(session, 501, "{\"error\":\"firmware has no latency probe\"}"); return; }
+                b->latency->reset();
+                sendJson(session, 200, "{\"ok\":true}");
+            });
+
         router->endpoint("POST", "/emulationboard/{id}/led",
             [boards](coSession session, auto vars) {
                 int32_t id;
@@ -259,6 +376,33 @@ void startRestApi(int port, RealDeviceManager* deviceManager,
                 sendJson(session, 200, json.str());
             });
 
+        router->endpoint("GET", "/realdevices/stats",
+            [deviceManager](coSession session, auto) {
+                const RelCoalesceStats& r = deviceManager->relStats;
+                const AxisFilterStats&  f = deviceManager->filterStats;
+                uint64_t frames    = r.frames.load(std::memory_order_relaxed);
+                uint64_t flushes   = r.flushes.load(std::memory_order_relaxed);
+                uint64_t unchanged = f.unchanged.load(std::memory_order_relaxed);
+                uint64_t minDelta  = f.minDelta.load(std::memory_order_relaxed);
+                std::ostringstream json;
+                json << "{"
+                     << "\"relMotion\":{"
+                     <<   "\"frames\":"    << frames                                          << ","
+                     <<   "\"flushes\":"   << flushes                                         << ","
+                     <<   "\"coalesced\":" << (frames > flushes ? frames - flushes : 0)       << ","
+                     <<   "\"deferred\":"  << r.deferred.load(std::memory_order_relaxed)      << ","
+                     <<   "\"maxMerged\":" << r.maxMerged.load(std::memory_order_relaxed)
+                     << "},"
+                     << "\"filter\":{"
+                     <<   "\"passed\":"    << f.passed.load(std::memory_order_relaxed)        << ","
+                     <<   "\"dropped\":"   << unchanged + minDelta                            << ","
+                     <<   "\"unchanged\":" << unchanged                                       << ","
+                     <<   "\"minDelta\":"  << minDelta
+                     << "}"
+                     << "}";
+                sendJson(session, 200, json.str());
+            });
+
         router->endpoint("GET", "/realdevices/detailed/{deviceId}",
             [deviceManager](coSession session, auto vars) {
                 unsigned int deviceId = 0;
@@ -313,6 +457,37 @@ void startRestApi(int port, RealDeviceManager* deviceManager,
                 sendJson(session, 200, json.str());
             });
 
+        // ---- /mapping/* ----
+
+        router->endpoint("GET", "/mapping/stats",
+            [mappingManager](coSession session, auto) {
+                const LatencyStat&    d = mappingManager->getDispatchLatency();
+                const SequencerStats& s = mappingManager->getSequencerStats();
+                std::ostringstream json;
+                json << "{"
+                     << "\"dispatch\":{"
+                     <<   "\"count\":"  << d.count   << ","
+                     <<   "\"avgUs\":"  << d.avgUs() << ","
+                     <<   "\"maxUs\":"  << d.maxUs
+                     << "},"
+                     << "\"sequencer\":{"
+                     <<   "\"submitted\":"      << s.submitted          << ","
+                     <<   "\"active\":"         << s.active             << ","
+                     <<   "\"fired\":"          << s.fired              << ","
+                     <<   "\"cancelled\":"      << s.cancelled          << ","
+                     <<   "\"latenessAvgUs\":"  << s.lateness.avgUs()   << ","
+                     <<   "\"latenessMaxUs\":"  << s.lateness.maxUs
+                     << "}"
+                     << "}";
+                sendJson(session, 200, json.str());
+            });
+
+        router->endpoint("POST", "/mapping/stats/reset",
+            [mappingManager](coSession session, auto) {
+                mappingManager->resetStats();
+                sendJson(session, 200, "{\"ok\":true}");
+            });
+
         // ---- /layers/* ----
 
         router->endpoint("GET", "/layers",
@@ -399,6 +574,139 @@ void startRestApi(int port, RealDeviceManager* deviceManager,
                 sendJson(session, 422, json.str());
             });
 
+        // ---- /scheduler/* ----
+
+        router->endpoint("GET", "/scheduler/profile",
+            [](coSession session, auto) {
+                std::vector<CoroProfile> rows = profiler_snapshot();
+                std::sort(rows.begin(), rows.end(),
+                          [](const CoroProfile& a, const CoroProfile& b) { return a.runNs > b.runNs; });
+                std::ostringstream json;
+                json << "{\"enabled\":"       << (profiler_enabled() ? "true" : "false")
+                     << ",\"sliceBudgetUs\":" << profiler_slice_budget_us()
+                     << ",\"coroutines\":[";
+                bool first = true;
+                for (const CoroProfile& p : rows) {
+                    if (!first) json << ",";
+                    first = false;
+                    json << "{\"name\":\""      << jsonEscape(p.name) << "\","
+                         <<  "\"live\":"        << p.live             << ","
+                         <<  "\"coroutines\":"  << p.coroutines       << ","
+                         <<  "\"resumes\":"     << p.resumes          << ","
+                         <<  "\"runUs\":"       << p.runNs / 1000     << ","
+                         <<  "\"avgSliceUs\":"  << (p.resumes ? p.runNs / 1000 / (int64_t)p.resumes : 0) << ","
+                         <<  "\"maxSliceUs\":"  << p.maxSliceNs / 1000 << ","
+                         <<  "\"parkedUs\":"    << p.parkedNs / 1000  << ","
+                         <<  "\"longSlices\":"  << p.longSlices       << "}";
+                }
+                json << "]}";
+                sendJson(session, 200, json.str());
+            });
+
+        // ?enable=true|false&budget_us=N — budget_us alone keeps the current on/off state
+        router->endpoint("POST", "/scheduler/profile",
+            [](coSession session, auto) {
+                std::string en = qparam(session, "enable");
+                bool enable = en.empty() ? profiler_enabled() : en == "true";
+                int64_t budget = profiler_slice_budget_us();
+                try {
+                    std::string b = qparam(session, "budget_us");
+                    if (!b.empty()) budget = std::stoll(b);
+                } catch (...) {
+                    sendJson(session, 400, "{\"error\":\"invalid budget_us\"}"); return;
+                }
+                profiler_enable(enable, budget);
+                std::ostringstream json;
+                json << "{\"ok\":true,\"enabled\":" << (enable ? "true" : "false")
+                     << ",\"sliceBudgetUs\":" << profiler_slice_budget_us() << "}";
+                sendJson(session, 200, json.str());
+            });
+
+        router->endpoint("POST", "/scheduler/profile/reset",
+            [](coSession session, auto) {
+                profiler_reset();
+                sendJson(session, 200, "{\"ok\":true}");
+            });
+
+        // ---- /latency/* ----
+
+        router->endpoint("GET", "/latency",
+            [](coSession session, auto) {
+                std::ostringstream json;
+                json << "{\"sampleEvery\":" << gTracer.getSampleEvery()
+                     << ",\"started\":"     << gTracer.started()
+                     << ",\"completed\":"   << gTracer.completed()
+                     << ",\"stages\":{";
+                for (int st = 0; st < ST_COUNT; st++) {
+                    if (st) json << ",";
+                    json << "\"" << LatencyTracer::stageName((TraceStage)st) << "\":";
+                    histogramJson(json, gTracer.histogram((TraceStage)st));
+                }
+                json << "}}";
+                sendJson(session, 200, json.str());
+            });
+
+        // ?sample_every=N — 0 turns tracing off
+        router->endpoint("POST", "/latency",
+            [](coSession session, auto) {
+                int32_t n = 0;
+                try { n = std::stoi(qparam(session, "sample_every", "0")); }
+                catch (...) { sendJson(session, 400, "{\"error\":\"invalid sample_every\"}"); return; }
+                gTracer.setSampleEvery(n);
+                std::ostringstream json;
+                json << "{\"ok\":true,\"sampleEvery\":" << gTracer.getSampleEvery() << "}";
+                sendJson(session, 200, json.str());
+            });
+
+        router->endpoint("POST", "/latency/reset",
+            [](coSession session, auto) {
+                gTracer.reset();
+                sendJson(session, 200, "{\"ok\":true}");
+            });
+
+        // ---- /recording/* ----
+
+        router->endpoint("GET", "/recording",
+            [](coSession session, auto) {
+                std::ostringstream json;
+                json << "{\"active\":"  << (gRecorder.active() ? "true" : "false")
+                     << ",\"path\":\""  << jsonEscape(gRecorder.path()) << "\""
+                     << ",\"records\":" << gRecorder.records()
+                     << ",\"bytes\":"   << gRecorder.bytes() << "}";
+                sendJson(session, 200, json.str());
+            });
+
+        // ?name=FILE — a new file in pipeline.recording_dir; existing files are
+        // never overwritten (the server has no authentication)
+        router->endpoint("POST", "/recording/start",
+            [deviceManager](coSession session, auto) {
+                const std::string& dir = gConfig.pipeline.recordingDir;
+                if (dir.empty()) {
+                    sendJson(session, 403, "{\"error\":\"pipeline.recording_dir is not set\"}"); return;
+                }
+                std::string name = qparam(session, "name");
+                if (name.empty() || name == "." || name == ".." || name.find('/') != std::string::npos
+                    || name.find('\0') != std::string::npos) {
+                    sendJson(session, 400, "{\"error\":\"name must be a plain file name\"}"); return;
+                }
+                std::string path = dir + "/" + name;
+                std::string err;
+                if (!gRecorder.start(path, deviceManager->getDevices(), err, /*exclusive=*/true)) {
+                    int status = (gRecorder.active() || errno == EEXIST) ? 409 : 500;
+                    sendJson(session, status, "{\"error\":\"" + jsonEscape(err) + "\"}"); return;
+                }
+                sendJson(session, 200, "{\"ok\":true,\"path\":\"" + jsonEscape(path) + "\"}");
+            });
+
+        router->endpoint("POST", "/recording/stop",
+            [](coSession session, auto) {
+                gRecorder.stop();
+                std::ostringstream json;
+                json << "{\"ok\":true,\"records\":" << gRecorder.records()
+                     << ",\"bytes\":" << gRecorder.bytes() << "}";
+                sendJson(session, 200, json.str());
+            });
+
         // ---- /debug/* ----
 
         router->endpoint("POST", "/debug/turbo/off",
@@ -455,7 +763,7 @@ void startRestApi(int port, RealDeviceManager* deviceManager,
             coSession session = server->accept();
             if (!session || server->isClosed())
                 break;
-            coro([session, router]() {
+            coro_named("http-session", [session, router]() {
                 router->dispatch(session);
             });
         }
@@ -8,12 +8,14 @@
 #include "../mapping/LayerManager.h"
 
 class RealDeviceManager;
+class MappingManager;
 
 void startRestApi(int port,
                   RealDeviceManager* deviceManager,
                   std::vector<EmulationBoard>* boards,
                   EmulatedDeviceManager* emulatedDeviceManager,
                   LayerManager* layerManager,
+                  MappingManager* mappingManager,
                   std::function<std::vector<std::string>()> reloadConfigFn,
                   int* turboTimesPerSecond,
                   std::string* turboDeviceIdStr,
@@ -0,0 +1,122 @@
+// shared/LatencyProbe.h
+// Pico side of the input → USB report latency probe (M2P_LATENCY_MARK and
+// P2M_LATENCY_REPORT in rpcinterface.h). No Pico SDK or TinyUSB dependencies,
+// so the mainboard's simulated Pico (pico_sim.cpp) runs the same code.
+//
+// Times are Pico microseconds (time_us_32()), which wrap every ~71 min. Only
+// differences are used, so the wrap is harmless for spans under ~35 min.
+#pragma once
+#include <cstdint>
+
+class LatencyStampLog {
+public:
+    static constexpr int      CAPACITY      = 64;       // marks waiting for a report or to be sent
+    static constexpr int      REPORT_MAX    = 16;       // entries per P2M_LATENCY_REPORT
+    static constexpr int      REPORT_MS     = 100;      // send at least this often while marks are finished
+    static constexpr int      POLL_MS       = 10;       // how often the sender checks due()
+    static constexpr uint32_t NO_REPORT_US  = 250000;   // stop waiting for a USB report after this
+
+    // M2P_LATENCY_MARK arrived: the batch sent before it has been applied.
+    // `reports` is the target device's queued-report count right now.
+    void mark(uint32_t tag, int32_t device, uint32_t reports, uint32_t nowUs) {
+        for (auto& e : entries) {
+            if (e.state != FREE) continue;
+            e = {tag, nowUs, 0, reports, device, WAITING};
+            waiting++;
+            return;
+        }
+        dropped++;
+    }
+
+    // Call after deviceManager->update(). reportsOf(device) returns the
+    // device's current queued-report count; a mark whose device has queued a
+    // report since mark() is stamped with nowUs.
+    template<class F>
+    void poll(uint32_t nowUs, F reportsOf) {
+        if (!waiting) return;
+        for (auto& e : entries) {
+            if (e.state != WAITING) continue;
+            bool reported = reportsOf(e.device) != e.reports;
+            if (!reported && nowUs - e.appliedUs < NO_REPORT_US) continue;
+            e.reportUs = reported ? nowUs : e.appliedUs;
+            e.state    = reported ? DONE : DONE_NO_REPORT;
+            waiting--;
+            done++;
+        }
+    }
+
+    int  ready() const   { return done; }
+    bool pending() const { return waiting > 0; }
+
+    // A full report's worth is finished, or REPORT_MS passed since the last one
+    bool due(uint32_t nowUs) const {
+        return done >= REPORT_MAX || (done > 0 && nowUs - lastReportUs >= REPORT_MS * 1000u);
+    }
+
+    // Writes up to maxEntries finished marks, oldest first, as
+    // P2M_LATENCY_REPORT args and frees them. Layout: varuint count, int32
+    // baseUs, count × (varuint tag, varuint appliedUs - baseUs, varuint
+    // reportUs - appliedUs + 1, 0 = no report was queued). Returns the count.
+    template<class Arg>
+    int encode(Arg* out, uint32_t nowUs, int maxEntries = REPORT_MAX) {
+        int n = done < maxEntries ? done : maxEntries;
+        if (n == 0) return 0;
+        lastReportUs = nowUs;
+        uint32_t base = oldestDone()->appliedUs;
+        out->putVarUInt((uint32_t)n);
+        out->putInt32((int32_t)base);
+        for (int i = 0; i < n; i++) {
+            Entry* e = oldestDone();
+            out->putVarUInt(e->tag);
+            out->putVarUInt(e->appliedUs - base);
+            out->putVarUInt(e->state == DONE ? e->reportUs - e->appliedUs + 1 : 0);
+            e->state = FREE;
+            done--;
+        }
+        return n;
+    }
+
+    // Mainboard side: calls onStamp(tag, appliedUs, reportUs, reported) per entry.
+    template<class Arg, class F>
+    static void decode(Arg* in, F onStamp) {
+        uint32_t count = in->getVarUInt();
+        uint32_t base  = (uint32_t)in->getInt32();
+        for (uint32_t i = 0; i < count && i < CAPACITY; i++) {
+            uint32_t tag     = in->getVarUInt();
+            uint32_t applied = base + in->getVarUInt();
+            uint32_t report  = in->getVarUInt();
+            onStamp(tag, applied, applied + (report ? report - 1 : 0), report != 0);
+        }
+    }
+
+    uint32_t droppedCount() const { return dropped; }
+
+private:
+    enum State : uint8_t { FREE, WAITING, DONE, DONE_NO_REPORT };
+
+    struct Entry {
+        uint32_t tag;
+        uint32_t appliedUs;
+        uint32_t reportUs;
+        uint32_t reports;   // device's queued-report count at mark()
+        int32_t  device;
+        State    state;
+    };
+
+    static bool isDone(const Entry& e) { return e.state == DONE || e.state == DONE_NO_REPORT; }
+
+    // Oldest first, so a stamp is never held back behind newer ones (the
+    // mainboard only remembers the most recent marks)
+    Entry* oldestDone() {
+        Entry* oldest = nullptr;
+        for (auto& e : entries)
+            if (isDone(e) && (!oldest || (int32_t)(e.appliedUs - oldest->appliedUs) < 0)) oldest = &e;
+        return oldest;
+    }
+
+    Entry    entries[CAPACITY] = {};
+    int      waiting = 0;
+    int      done    = 0;
+    uint32_t dropped = 0;   // marks that found the log full
+    uint32_t lastReportUs = 0;
+};
@@ -4,14 +4,47 @@
 #include <chrono>
 #include <atomic>
 #include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#if defined(__SANITIZE_ADDRESS__)
+#include <sanitizer/asan_interface.h>
+#endif
 #if COROCGO_HAS_THREADS
 #include <thread>
+#include <deque>
+#include <queue>
 #endif
 #if COROCGO_HAS_FILE_IO
 #include <poll.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <cerrno>
+#include <sys/socket.h>
+#endif
+#if COROCGO_HAS_FILE_IO && defined(__linux__)
+#define COROCGO_EPOLL 1
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unordered_map>
+#else
+#define COROCGO_EPOLL 0
+#endif
+#if COROCGO_HAS_THREADS && COROCGO_EPOLL
+#define COROCGO_IDLE_TIMERFD 1
+#include <sys/timerfd.h>
+#include <sys/prctl.h>
+#else
+#define COROCGO_IDLE_TIMERFD 0
+#endif
+#if COROCGO_IDLE_TIMERFD && __has_include(<linux/io_uring.h>)
+#define COROCGO_URING 1
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <cstring>
+#else
+#define COROCGO_URING 0
 #endif
 
 using namespace std;
@@ -19,6 +52,8 @@ using corocgo::coro_mutex_t;
 using corocgo::coro_cond_var_t;
 using corocgo::coro_lock_guard_t;
 using corocgo::coro_unique_lock_t;
+using corocgo::_SpinLock;
+using corocgo::_mt_on;
 
 template<typename T> class BiLinkedList;
 template<typename T>
@@ -231,6 +266,18 @@ public:
     mco_coro* coroutine=nullptr;
     BiLinkedCell<Coroutine*>* cell=nullptr;
     chrono::steady_clock::time_point wakeUpTime;
+#if COROCGO_HAS_THREADS
+    // M:N scheduler only: (parkSeq << 3) | MtState. parkSeq grows on every
+    // park, so a wake carrying an older seq (stale select entry) is ignored.
+    std::atomic<uint64_t> mtState{0};
+#endif
+    int pinnedWorker=-1;    // coro_pinned worker, -1 = any
+    int timerIndex=-1;      // slot in the timer heap while sleeping, else -1
+    bool sleepCancelled=false;
+    uint32_t generation=0;  // bumped on release — invalidates old CoroHandles
+    const char* name=nullptr;   // coro_named()
+    int profRow=-1;             // profiler row, bound at the first profiled resume
+    int64_t parkedAt=0;         // profiler: when its last slice ended in a block
     // Park this coroutine (remove from whichever queue it's currently in).
     // Must be called from within the coroutine.
     void moveToWaitingQueue();
@@ -242,16 +289,84 @@ public:
     void moveToRunningQueueExternal();
 };
 
+// ── Timer heap ──
+// Binary min-heap of sleeping coroutines ordered by wakeUpTime. Each
+// coroutine keeps its slot in timerIndex, so cancel is O(log n) like insert
+// and pop.
+
+class TimerHeap {
+    vector<Coroutine*> heap;
+
+    void place(size_t i, Coroutine* c) {
+        heap[i]=c;
+        c->timerIndex=(int)i;
+    }
+    void up(size_t i) {
+        Coroutine* c=heap[i];
+        while(i>0) {
+            size_t parent=(i-1)/2;
+            if(heap[parent]->wakeUpTime<=c->wakeUpTime) break;
+            place(i, heap[parent]);
+            i=parent;
+        }
+        place(i, c);
+    }
+    void down(size_t i) {
+        Coroutine* c=heap[i];
+        size_t n=heap.size();
+        while(true) {
+            size_t child=2*i+1;
+            if(child>=n) break;
+            if(child+1<n && heap[child+1]->wakeUpTime<heap[child]->wakeUpTime) child++;
+            if(c->wakeUpTime<=heap[child]->wakeUpTime) break;
+            place(i, heap[child]);
+            i=child;
+        }
+        place(i, c);
+    }
+public:
+    bool       empty() const { return heap.empty(); }
+    size_t     size()  const { return heap.size(); }
+    Coroutine* top()   const { return heap.front(); }
+
+    void push(Coroutine* c) {
+        heap.push_back(c);
+        up(heap.size()-1);
+    }
+    void remove(Coroutine* c) {
+        size_t i=(size_t)c->timerIndex;
+        Coroutine* last=heap.back();
+        heap.pop_back();
+        c->timerIndex=-1;
+        if(i<heap.size()) {
+            place(i, last);
+            up(i);
+            down((size_t)last->timerIndex);
+        }
+    }
+    Coroutine* pop() {
+        Coroutine* c=heap.front();
+        remove(c);
+        return c;
+    }
+    void clear() {
+        for(Coroutine* c : heap) c->timerIndex=-1;
+        heap.clear();
+    }
+};
+
 BiLinkedList<Coroutine*> mainCoroutinesQueue;
-BiLinkedList<Coroutine*> sleepQueue;
+TimerHeap sleepTimers;    // single-thread scheduler; the M:N scheduler uses mtTimers
 int totalCoroutines=0;
 
 // ── Object pools ──
 
 vector<Coroutine*> freeCoroutines;
 BiLinkedCell<Coroutine*>* freeCellHead=nullptr;
+_SpinLock poolLock;   // M:N scheduler only
 
 Coroutine* acquireCoroutine() {
+    corocgo::_MtGuard g(poolLock);
     if(!freeCoroutines.empty()) {
         Coroutine* c=freeCoroutines.back();
         freeCoroutines.pop_back();
@@ -264,10 +379,18 @@ void releaseCoroutine(Coroutine* c) {
     c->runnable=nullptr;
     c->coroutine=nullptr;
     c->cell=nullptr;
+    c->pinnedWorker=-1;
+    c->sleepCancelled=false;
+    c->generation++;
+    c->name=nullptr;
+    c->profRow=-1;
+    c->parkedAt=0;
+    corocgo::_MtGuard g(poolLock);
     freeCoroutines.push_back(c);
 }
 
 BiLinkedCell<Coroutine*>* acquireCell() {
+    corocgo::_MtGuard g(poolLock);
     if(freeCellHead) {
         BiLinkedCell<Coroutine*>* c=freeCellHead;
         freeCellHead=c->next;
@@ -283,10 +406,164 @@ void releaseCell(BiLinkedCell<Coroutine*>* cell) {
     cell->data=nullptr;
     cell->previous=nullptr;
     cell->list=nullptr;
+    corocgo::_MtGuard g(poolLock);
     cell->next=freeCellHead;
     freeCellHead=cell;
 }
 
+// ── Stack pool ──
+// minicoro allocates a coroutine as one block: mco_coro, context, storage and
+// stack. A dead coroutine's block goes back to the free list of its stack size
+// class; the next spawn of that class takes it without touching malloc. Each
+// class keeps at most COROCGO_STACK_POOL_BYTES idle.
+
+struct StackClass {
+    size_t stackSize;
+    void*  head=nullptr;    // free blocks, linked through their first word
+    int    count=0;
+};
+
+// Above the default, classes double from the first power of two that is at
+// least twice the default: 128 KB .. 1 MB on Linux, 16 .. 128 KB on the Pico.
+static constexpr size_t stackClassBase() {
+    size_t s=1;
+    while(s<2*(size_t)MCO_DEFAULT_STACK_SIZE) s<<=1;
+    return s;
+}
+
+static StackClass stackClasses[]={
+    {MCO_MIN_STACK_SIZE}, {MCO_DEFAULT_STACK_SIZE},
+    {stackClassBase()}, {2*stackClassBase()}, {4*stackClassBase()}, {8*stackClassBase()},
+};
+static corocgo::StackPoolStats stackStats{};
+
+static StackClass* stackClassFor(size_t stackSize) {
+    if(stackSize==0) stackSize=MCO_DEFAULT_STACK_SIZE;
+    for(StackClass& sc : stackClasses)
+        if(stackSize<=sc.stackSize) return &sc;
+    return nullptr;
+}
+
+static void* stackAlloc(size_t size, void* cls) {
+    StackClass* sc=(StackClass*)cls;
+    void* block=nullptr;
+    {
+        corocgo::_MtGuard g(poolLock);
+        if(!sc) stackStats.oversize++;
+        else if(sc->head) {
+            block=sc->head;
+            sc->head=*(void**)block;
+            sc->count--;
+            stackStats.hits++;
+            stackStats.pooled--;
+            stackStats.pooledBytes-=size;
+        } else {
+            stackStats.misses++;
+        }
+    }
+#if defined(__SANITIZE_ADDRESS__)
+    // The previous owner's stack frames can leave redzones poisoned
+    if(block) __asan_unpoison_memory_region(block, size);
+#endif
+    return block ? block : malloc(size);
+}
+
+static void stackFree(void* block, size_t size, void* cls) {
+    StackClass* sc=(StackClass*)cls;
+    if(sc) {
+        corocgo::_MtGuard g(poolLock);
+        if((sc->count+1)*sc->stackSize<=COROCGO_STACK_POOL_BYTES) {
+            *(void**)block=sc->head;
+            sc->head=block;
+            sc->count++;
+            stackStats.pooled++;
+            stackStats.pooledBytes+=size;
+            return;
+        }
+    }
+    free(block);
+}
+
+#if COROCGO_STACK_CHECK
+// The stack grows down towards stack_base; the canary fills its lowest bytes.
+// A coroutine that ran past it has already corrupted whatever lies below
+// (its own storage and context), so the check aborts rather than recover.
+static const int STACK_CANARY_WORDS=8;
+static const uint64_t STACK_CANARY=0xC0C0CA7A57AC4D00ull;
+
+static void stackArm(mco_coro* co) {
+    uint64_t* w=(uint64_t*)co->stack_base;
+    for(int i=0;i<STACK_CANARY_WORDS;i++) w[i]=STACK_CANARY+i;
+}
+
+static void stackCheck(mco_coro* co) {
+    const uint64_t* w=(const uint64_t*)co->stack_base;
+    for(int i=0;i<STACK_CANARY_WORDS;i++) {
+        if(w[i]!=STACK_CANARY+i) {
+            fprintf(stderr, "[corocgo] coroutine stack overflow (%zu-byte stack), pass a larger stackSize to coro()\n",
+                    co->stack_size);
+            abort();
+        }
+    }
+}
+#else
+static inline void stackArm(mco_coro*) {}
+static inline void stackCheck(mco_coro*) {}
+#endif
+
+// ── Profiler ──
+// One row per coroutine name. A coroutine binds to its row at its first resume
+// with the profiler on, so enabling it needs no walk over live coroutines.
+// Rows are never removed and own a copy of the name, so snapshots stay valid
+// after the coroutine (and its name string) is gone.
+
+struct ProfRow {
+    corocgo::CoroProfile p;
+    int64_t lastWarnNs;
+};
+static bool profOn=false;
+static int64_t profBudgetNs=0;
+static vector<ProfRow> profRows;
+
+static int64_t profNow() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int profRowFor(const char* name) {
+    if(!name) name="(unnamed)";
+    for(size_t i=0;i<profRows.size();i++)
+        if(strcmp(profRows[i].p.name, name)==0) return (int)i;
+    ProfRow r{};
+    r.p.name=strdup(name);
+    profRows.push_back(r);
+    return (int)profRows.size()-1;
+}
+
+// Accounts one resume of `c` that started at t0
+static void profSlice(Coroutine* c, int64_t t0) {
+    int64_t t1=profNow(), d=t1-t0;
+    if(c->profRow<0) {
+        c->profRow=profRowFor(c->name);
+        profRows[c->profRow].p.live++;
+        profRows[c->profRow].p.coroutines++;
+    }
+    ProfRow& r=profRows[c->profRow];
+    r.p.resumes++;
+    r.p.runNs+=d;
+    if(d>r.p.maxSliceNs) r.p.maxSliceNs=d;
+    if(c->parkedAt) r.p.parkedNs+=t0-c->parkedAt;
+    // Suspended off the run queue (not just yielded): it blocked on something
+    c->parkedAt=c->cell->list!=&mainCoroutinesQueue ? t1 : 0;
+    if(profBudgetNs>0 && d>profBudgetNs) {
+        r.p.longSlices++;
+        if(t1-r.lastWarnNs>=1000000000) {
+            r.lastWarnNs=t1;
+            fprintf(stderr, "[corocgo] long slice: %s ran %.2f ms (budget %lld us)\n",
+                    r.p.name, d/1e6, (long long)(profBudgetNs/1000));
+        }
+    }
+}
+
 // ── Thread-safe wake infrastructure ──
 coro_mutex_t pendingWakeMtx;
 BiLinkedList<Coroutine*> pendingWakeQueue;
@@ -296,11 +573,273 @@ ThreadPool* globalThreadPool=nullptr;
 #endif
 
 coro_cond_var_t schedulerCV;
+
+// ── Scheduler idle wait ──
+// Where the single-thread scheduler blocks when nothing is runnable. On Linux
+// it polls a timerfd armed with the earliest sleeper's absolute deadline plus
+// an eventfd that the wake paths signal. timerfd expiry is not subject to
+// timer slack the way futex/poll timeouts are, so sleepers wake within a few
+// µs of their deadline. Elsewhere (or if the fds can't be created) it falls
+// back to schedulerCV.wait_until. All state is guarded by pendingWakeMtx.
+
+static bool schedulerIdle=false;    // scheduler is (about to be) blocked in idleWaitUntil
+#if COROCGO_EPOLL
+static bool ioInline=false;         // requested via scheduler_io_inline()
+static bool ioInlineActive=false;   // this run dispatches epoll on the scheduler thread
+static int  ioInlineFd();          // the epoll fd, polled by idleWaitUntil
+static void ioDispatchInline();
+#endif
+#if COROCGO_URING
+static bool uringRequested=false;   // via scheduler_io_uring()
+static bool uringActive=false;      // ring is up for this single-thread run
+static int  uringFd();
+static void uringReap();
+#endif
+
+#if COROCGO_IDLE_TIMERFD
+static int idleTimerFd=-1;
+static int idleWakeFd=-1;
+
+static void idleFdsOpen() {
+    idleTimerFd=timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK|TFD_CLOEXEC);
+    idleWakeFd=eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+    if(idleTimerFd<0 || idleWakeFd<0) {
+        if(idleTimerFd>=0) close(idleTimerFd);
+        if(idleWakeFd>=0) close(idleWakeFd);
+        idleTimerFd=idleWakeFd=-1;
+    }
+}
+
+static void idleFdsClose() {
+    if(idleTimerFd>=0) close(idleTimerFd);
+    if(idleWakeFd>=0) close(idleWakeFd);
+    idleTimerFd=idleWakeFd=-1;
+}
+#endif
+
+// Called by wake paths after appending to pendingWakeQueue under
+// pendingWakeMtx; `idle` is schedulerIdle as read under that lock.
+static void schedulerNotify(bool idle) {
+#if COROCGO_IDLE_TIMERFD
+    if(idleWakeFd>=0) {
+        if(idle) {
+            uint64_t one=1;
+            (void)!write(idleWakeFd, &one, sizeof(one));
+        }
+        return;
+    }
+#endif
+    (void)idle;
+    schedulerCV.notify_one();
+}
+
+// `lock` holds pendingWakeMtx; returns with it held. time_point::max() waits
+// for a wake only.
+static void idleWaitUntil(coro_unique_lock_t<coro_mutex_t>& lock, chrono::steady_clock::time_point deadline) {
+#if COROCGO_IDLE_TIMERFD
+    if(idleTimerFd>=0) {
+        itimerspec its{};
+        if(deadline!=chrono::steady_clock::time_point::max()) {
+            // steady_clock is CLOCK_MONOTONIC on Linux
+            int64_t ns=chrono::duration_cast<chrono::nanoseconds>(deadline.time_since_epoch()).count();
+            if(ns<=0) ns=1;   // an all-zero it_value would disarm the timer
+            its.it_value.tv_sec=ns/1000000000;
+            its.it_value.tv_nsec=ns%1000000000;
+        }
+        timerfd_settime(idleTimerFd, TFD_TIMER_ABSTIME, &its, nullptr);
+        schedulerIdle=true;
+        lock.unlock();
+        pollfd fds[4]={{idleTimerFd, POLLIN, 0}, {idleWakeFd, POLLIN, 0}, {-1, POLLIN, 0}, {-1, POLLIN, 0}};
+        if(ioInlineActive) fds[2].fd=ioInlineFd();
+#if COROCGO_URING
+        if(uringActive) fds[3].fd=uringFd();   // readable while the CQ ring is non-empty
+#endif
+        while(poll(fds, 4, -1)<0 && errno==EINTR) {}
+        uint64_t n;
+        (void)!read(idleTimerFd, &n, sizeof(n));
+        (void)!read(idleWakeFd, &n, sizeof(n));   // may be left over from an earlier wake
+        lock.lock();
+        schedulerIdle=false;
+        if(fds[2].revents) {
+            lock.unlock();   // dispatch wakes through pendingWakeMtx
+            ioDispatchInline();
+            lock.lock();
+        }
+#if COROCGO_URING
+        if(fds[3].revents) uringReap();
+#endif
+        return;
+    }
+#endif
+    if(deadline==chrono::steady_clock::time_point::max())
+        schedulerCV.wait(lock, []() { return pendingWakeQueue.size()>0; });
+    else
+        schedulerCV.wait_until(lock, deadline, []() { return pendingWakeQueue.size()>0; });
+}
 #if COROCGO_HAS_FILE_IO
 class PollThread;
 PollThread* globalPollThread=nullptr;
 #endif
 
+// ── M:N scheduler core ──
+//
+// Park/wake protocol: a coroutine about to block calls mtPrepare() (state
+// PARKING, new seq), registers itself wherever wakers will find it, releases
+// its locks and yields. The worker then CASes PARKING→PARKED. A waker CASes
+// PARKED→RUNNABLE and enqueues, or PARKING→WOKEN if the coroutine has not
+// finished yielding yet — the worker sees the failed CAS and enqueues it.
+
+#if COROCGO_HAS_THREADS
+namespace corocgo { bool _mt_active=false; }
+
+enum MtState : uint64_t { MT_RUNNING=0, MT_RUNNABLE=1, MT_PARKING=2, MT_PARKED=3, MT_WOKEN=4 };
+
+struct Worker {
+    int                id;
+    thread             th;
+    mutex              mtx;
+    deque<Coroutine*>  runQueue;      // stealable
+    deque<Coroutine*>  pinnedQueue;   // coro_pinned — never stolen
+    uint32_t           tick=0;
+};
+
+static vector<Worker*>   mtWorkers;
+static mutex             injectMtx;           // wakes from non-worker threads
+static deque<Coroutine*> injectQueue;
+static mutex             idleMtx;
+static condition_variable idleCV;
+static atomic<int>       idleWorkers{0};
+static atomic<int>       mtTotal{0};          // live coroutines
+static atomic<int>       mtExternalWaits{0};  // parked on wait_file / exec_thread / ts monitors
+static atomic<bool>      mtShutdown{false};
+static corocgo::SchedulerResult mtResult=corocgo::SUCCESS;
+static mutex             timerMtx;
+static TimerHeap         mtTimers;            // under timerMtx
+static atomic<int64_t>   mtNextTimerNs{INT64_MAX};
+static atomic<int>       spinningWorkers{0};
+static int               maxSpinning=0;       // 0 on single-CPU hosts
+static thread_local Worker* tlsWorker=nullptr;
+
+// Not inlined: coroutine code may migrate between threads across a yield, so
+// thread_local reads must not be hoisted out of the call.
+__attribute__((noinline)) static Worker* currentWorker() { return tlsWorker; }
+
+static int64_t toNs(chrono::steady_clock::time_point t) {
+    return chrono::duration_cast<chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+static void mtNotify(bool all) {
+    atomic_thread_fence(memory_order_seq_cst);   // pairs with idleWorkers++ in mtIdle
+    if(idleWorkers.load(memory_order_relaxed)==0) return;
+    lock_guard<mutex> lock(idleMtx);
+    if(all) idleCV.notify_all();
+    else    idleCV.notify_one();
+}
+
+static void mtEnqueue(Coroutine* c, bool notify=true) {
+    if(c->pinnedWorker>=0) {
+        Worker* w=mtWorkers[c->pinnedWorker%(int)mtWorkers.size()];
+        { lock_guard<mutex> lock(w->mtx); w->pinnedQueue.push_back(c); }
+        if(notify && w!=currentWorker()) mtNotify(true);   // only that worker can take it
+        return;
+    }
+    Worker* w=currentWorker();
+    if(w) {
+        lock_guard<mutex> lock(w->mtx);
+        w->runQueue.push_back(c);
+    } else {
+        lock_guard<mutex> lock(injectMtx);
+        injectQueue.push_back(c);
+    }
+    if(notify) mtNotify(false);
+}
+
+// Called by the coroutine itself before registering as a waiter
+static uint64_t mtPrepare(Coroutine* c) {
+    uint64_t seq=(c->mtState.load(memory_order_relaxed)>>3)+1;
+    c->mtState.store((seq<<3)|MT_PARKING, memory_order_release);
+    return seq;
+}
+
+// Called by the coroutine after mtPrepare() when it decides not to block
+static void mtCancel(Coroutine* c, uint64_t seq) {
+    c->mtState.store((seq<<3)|MT_RUNNING, memory_order_release);
+}
+
+// Returns true if this call woke the coroutine (seq matched and it was parking/parked)
+static bool mtWake(Coroutine* c, uint64_t seq) {
+    uint64_t v=c->mtState.load(memory_order_acquire);
+    while(true) {
+        if((v>>3)!=seq) return false;
+        uint64_t st=v&7;
+        if(st==MT_PARKING) {
+            if(c->mtState.compare_exchange_weak(v, (seq<<3)|MT_WOKEN, memory_order_acq_rel)) return true;
+        } else if(st==MT_PARKED) {
+            if(c->mtState.compare_exchange_weak(v, (seq<<3)|MT_RUNNABLE, memory_order_acq_rel)) {
+                mtEnqueue(c);
+                return true;
+            }
+        } else {
+            return false;
+        }
+    }
+}
+
+// Single-waiter parks (sleep, wait_file, exec_thread): the current seq is the right one
+static void mtWakeCurrent(Coroutine* c) {
+    mtWake(c, c->mtState.load(memory_order_acquire)>>3);
+}
+
+struct MtWaiter {
+    Coroutine* cor;
+    uint64_t   seq;
+};
+
+// Waiter list behind WaitQueue / TSWaitQueue under the M:N scheduler
+class MtWaitList {
+    _SpinLock        lk;
+    deque<MtWaiter>  q;
+    atomic<int>      n{0};
+public:
+    void add(Coroutine* c, uint64_t seq) {
+        lk.lock();
+        q.push_back({c,seq});
+        n.fetch_add(1);
+        lk.unlock();
+    }
+    void remove(Coroutine* c, uint64_t seq) {
+        if(n.load()==0) return;
+        lk.lock();
+        for(auto it=q.begin(); it!=q.end(); ++it) {
+            if(it->cor==c && it->seq==seq) { q.erase(it); n.fetch_sub(1); break; }
+        }
+        lk.unlock();
+    }
+    // Skips stale entries so a wake is never spent on a coroutine that moved on
+    bool wakeOne() {
+        while(n.load()>0) {
+            lk.lock();
+            if(q.empty()) { lk.unlock(); return false; }
+            MtWaiter w=q.front();
+            q.pop_front();
+            n.fetch_sub(1);
+            lk.unlock();
+            if(mtWake(w.cor, w.seq)) return true;
+        }
+        return false;
+    }
+    void wakeAll() {
+        if(n.load()==0) return;
+        deque<MtWaiter> all;
+        lk.lock();
+        all.swap(q);
+        n.store(0);
+        lk.unlock();
+        for(auto& w : all) mtWake(w.cor, w.seq);
+    }
+};
+#endif // COROCGO_HAS_THREADS
+
 // ── Coroutine queue primitives ──
 
 void Coroutine::moveToWaitingQueue() {
@@ -313,32 +852,60 @@ void Coroutine::moveToRunningQueue() {
 }
 
 void Coroutine::moveToRunningQueueExternal() {
+#if COROCGO_HAS_THREADS
+    if(_mt_on()) {
+        mtWakeCurrent(this);
+        return;
+    }
+#endif
+    bool idle;
     {
         coro_lock_guard_t<coro_mutex_t> lock(pendingWakeMtx);
         if(cell->list!=nullptr) return;
         pendingWakeQueue.append(cell);
         threadWaitCount--;
+        idle=schedulerIdle;
     }
-    schedulerCV.notify_one();
+    schedulerNotify(idle);
 }
 
 // ── WaitQueue (internal coroutine condition variable) ──
 
 class WaitQueue {
     BiLinkedList<Coroutine*> waitQueue;
+#if COROCGO_HAS_THREADS
+    MtWaitList mt;
+#endif
 public:
-    void wait() {
+    void wait(_SpinLock* held) {
         Coroutine* cor=(Coroutine*)mco_running()->user_data;
+#if COROCGO_HAS_THREADS
+        if(_mt_on()) {
+            uint64_t seq=mtPrepare(cor);
+            mt.add(cor, seq);
+            if(held) held->unlock();
+            mco_yield(mco_running());
+            if(held) held->lock();
+            return;
+        }
+#endif
+        (void)held;
         cor->moveToWaitingQueue();
         waitQueue.append(cor->cell);
         mco_yield(mco_running());
     }
     void wake() {
+#if COROCGO_HAS_THREADS
+        if(_mt_on()) { mt.wakeOne(); return; }
+#endif
         BiLinkedCell<Coroutine*>* cell=waitQueue.removeFront();
         if(cell==nullptr) return;
         cell->data->moveToRunningQueue();
     }
     void wakeAll() {
+#if COROCGO_HAS_THREADS
+        if(_mt_on()) { mt.wakeAll(); return; }
+#endif
         BiLinkedCell<Coroutine*>* cell=waitQueue.removeFront();
         while(cell!=nullptr) {
             cell->data->moveToRunningQueue();
@@ -351,6 +918,10 @@ public:
     void removeWaiter(BiLinkedCell<Coroutine*>* cell) {
         waitQueue.remove(cell);
     }
+#if COROCGO_HAS_THREADS
+    void mtAddWaiter(Coroutine* c, uint64_t seq)    { mt.add(c, seq); }
+    void mtRemoveWaiter(Coroutine* c, uint64_t seq) { mt.remove(c, seq); }
+#endif
 };
 
 // ── TSWaitQueue (thread-safe coroutine condition variable) ──
@@ -359,27 +930,67 @@ class TSWaitQueue {
     BiLinkedList<Coroutine*> waitQueue;
     coro_mutex_t mtx;
     std::atomic<int> waitCount{0};
+#if COROCGO_HAS_THREADS
+    MtWaitList mt;
+#endif
 public:
-    void wait() {
+    void wait(_SpinLock* held, const std::atomic<int>* word, int seen) {
 #if COROCGO_HAS_THREADS
         Coroutine* cor=(Coroutine*)mco_running()->user_data;
+        if(_mt_on()) {
+            uint64_t seq=mtPrepare(cor);
+            mt.add(cor, seq);
+            mtExternalWaits.fetch_add(1);
+            if(held) held->unlock();
+            if(word && word->load()!=seen) {
+                mt.remove(cor, seq);
+                mtCancel(cor, seq);
+            } else {
+                mco_yield(mco_running());
+            }
+            mtExternalWaits.fetch_sub(1);
+            if(held) held->lock();
+            return;
+        }
+        (void)held;
         cor->moveToWaitingQueue();
         {
             coro_lock_guard_t<coro_mutex_t> lock(mtx);
             waitQueue.append(cor->cell);
-            waitCount.fetch_add(1,std::memory_order_release);
+            waitCount.fetch_add(1);
         }
         {
             coro_lock_guard_t<coro_mutex_t> lock(pendingWakeMtx);
             threadWaitCount++;
         }
+        // An external producer may have published between the caller's check
+        // and our registration without seeing a waiter — don't sleep on it.
+        if(word && word->load()!=seen) {
+            bool stillWaiting;
+            {
+                coro_lock_guard_t<coro_mutex_t> lock(mtx);
+                stillWaiting=waitQueue.remove(cor->cell);
+                if(stillWaiting) waitCount.fetch_sub(1);
+            }
+            if(stillWaiting) {
+                {
+                    coro_lock_guard_t<coro_mutex_t> lock(pendingWakeMtx);
+                    threadWaitCount--;
+                }
+                cor->moveToRunningQueue();
+                return;
+            }
+            // else a waker already queued us — just yield to it
+        }
         mco_yield(mco_running());
 #else
+        (void)held; (void)word; (void)seen;
         mco_yield(mco_running());
 #endif
     }
     void wake() {
 #if COROCGO_HAS_THREADS
+        if(_mt_on()) { mt.wakeOne(); return; }
         if(waitCount.load(std::memory_order_acquire)==0) return;
         BiLinkedCell<Coroutine*>* cell;
         {
@@ -397,7 +1008,8 @@ public:
     }
     void wakeExternal() {
 #if COROCGO_HAS_THREADS
-        if(waitCount.load(std::memory_order_acquire)==0) return;
+        if(_mt_on()) { mt.wakeOne(); return; }
+        if(waitCount.load()==0) return;
         BiLinkedCell<Coroutine*>* cell;
         {
             coro_lock_guard_t<coro_mutex_t> lock(mtx);
@@ -410,7 +1022,9 @@ public:
     }
     void wakeAll() {
 #if COROCGO_HAS_THREADS
+        if(_mt_on()) { mt.wakeAll(); return; }
         if(waitCount.load(std::memory_order_acquire)==0) return;
+        bool idle;
         {
             coro_lock_guard_t<coro_mutex_t> lock(mtx);
             BiLinkedCell<Coroutine*>*cell=waitQueue.removeFront();
@@ -422,17 +1036,241 @@ public:
                     threadWaitCount--;
                     cell=waitQueue.removeFront();
                 }
+                idle=schedulerIdle;
             }
             waitCount.store(0,std::memory_order_release);
         }
-        schedulerCV.notify_one();
+        schedulerNotify(idle);
 #endif
     }
 };
 
 // ── Poll thread ──
+// Edge-triggered epoll behind wait_file(). A plain wait_file() adds the fd
+// with EPOLLONESHOT straight from the calling thread — no hand-off queue, no
+// wake write — and the event takes it out again. register_fd() keeps an fd in
+// the set: readiness is latched per registration, so a reader that drains the
+// fd to EAGAIN waits again without any syscall. Events are dispatched by the
+// poll thread, or with scheduler_io_inline() by the single-thread scheduler
+// itself.
+
+#if COROCGO_EPOLL
+class PollThread {
+public:
+    struct Watch {
+        int        fd=-1;
+        int        epFd=-1;         // fd in the epoll set — a dup() when fd was already there
+        uint32_t   events=0;        // EPOLLIN / EPOLLOUT
+        bool       persistent=false;
+        // Persistent watches: guarded by mtx
+        int        ready=0;         // latched WAIT_* bits not yet handed to a waiter
+        int        error=0;
+        int        waitMode=0;
+        Coroutine* waiter=nullptr;
+        FdResult*  result=nullptr;  // points into the waiting coroutine's stack frame
+    };
+private:
+    int          epollFd=-1;
+    int          wakeFd=-1;         // eventfd: stop / retire nudge
+    thread       worker;
+    atomic<bool> stopped{false};
+    mutex        mtx;
+    unordered_map<int, Watch*> registered;
+    atomic<int>  registeredCount{0};
+    vector<Watch*> retired;         // unregistered; freed between epoll_wait batches
+    atomic<bool> hasRetired{false};
+    atomic<int>  parked{0};         // coroutines waiting on any watch
+
+    static int toWaitBits(uint32_t ev) {
+        int bits=0;
+        if(ev&(EPOLLIN|EPOLLRDHUP)) bits|=corocgo::WAIT_IN;
+        if(ev&EPOLLOUT)             bits|=corocgo::WAIT_OUT;
+        return bits;
+    }
+    static int toError(uint32_t ev, int bits) {
+        if(ev&EPOLLERR) return EIO;
+        if((ev&EPOLLHUP) && bits==0) return EPIPE;
+        return 0;
+    }
+public:
+    // inlineMode: no thread — the scheduler calls dispatch() itself
+    explicit PollThread(bool inlineMode=false) {
+        epollFd=epoll_create1(EPOLL_CLOEXEC);
+        wakeFd=eventfd(0, EFD_NONBLOCK|EFD_CLOEXEC);
+        epoll_event ev{};
+        ev.events=EPOLLIN;
+        ev.data.ptr=nullptr;   // nullptr marks the wake fd
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &ev);
+        if(!inlineMode) worker=thread([this]() { run(); });
+    }
+    ~PollThread() {
+        for(auto& [fd, w] : registered) delete w;
+        for(Watch* w : retired) delete w;
+    }
 
-#if COROCGO_HAS_FILE_IO
+    int  fd() const { return epollFd; }
+    bool hasWaiters() const { return parked.load(memory_order_relaxed)>0; }
+
+    // One-shot: `w` lives on the waiting coroutine's stack and must already be
+    // parked — the event can fire before this returns. Returns errno or 0.
+    int watchOnce(Watch* w) {
+        epoll_event ev{};
+        ev.events=w->events|EPOLLONESHOT;
+        ev.data.ptr=w;
+        w->epFd=w->fd;
+        parked.fetch_add(1);
+        if(epoll_ctl(epollFd, EPOLL_CTL_ADD, w->epFd, &ev)==0) return 0;
+        int err=errno;
+        if(err==EEXIST) {
+            // Registered, or another coroutine waits on it: watch a duplicate
+            w->epFd=fcntl(w->fd, F_DUPFD_CLOEXEC, 0);
+            if(w->epFd>=0 && epoll_ctl(epollFd, EPOLL_CTL_ADD, w->epFd, &ev)==0) return 0;
+            err=errno;
+            if(w->epFd>=0) close(w->epFd);
+        }
+        parked.fetch_sub(1);
+        return err;
+    }
+
+    int registerFd(int fd, uint32_t events) {
+        Watch* w=new Watch();
+        w->fd=w->epFd=fd;
+        w->events=events;
+        w->persistent=true;
+        lock_guard<mutex> lock(mtx);
+        if(registered.count(fd)) { delete w; return EEXIST; }
+        epoll_event ev{};
+        ev.events=events|EPOLLET|EPOLLRDHUP;
+        ev.data.ptr=w;
+        if(epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev)<0) { int err=errno; delete w; return err; }
+        registered[fd]=w;
+        registeredCount.fetch_add(1);
+        return 0;
+    }
+
+    // A coroutine still waiting on the fd is woken with EBADF.
+    void unregisterFd(int fd) {
+        Coroutine* waiter=nullptr;
+        {
+            lock_guard<mutex> lock(mtx);
+            auto it=registered.find(fd);
+            if(it==registered.end()) return;
+            Watch* w=it->second;
+            registered.erase(it);
+            registeredCount.fetch_sub(1);
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+            if(w->waiter) {
+                w->result->error=EBADF;
+                waiter=w->waiter;
+                w->waiter=nullptr;
+                parked.fetch_sub(1);
+            }
+            retired.push_back(w);   // the dispatcher may hold it from the current batch
+            hasRetired.store(true, memory_order_release);
+        }
+        nudge();
+        if(waiter) waiter->moveToRunningQueueExternal();
+    }
+
+    // Persistent fast path. Returns true with `res` filled if readiness was
+    // already latched; otherwise parks `cor` via `park` (under the lock, so an
+    // event can't slip in between) and returns true. False: fd not registered
+    // for `mode`.
+    template<typename Park>
+    bool waitRegistered(int fd, int mode, Coroutine* cor, FdResult* res, bool& parkedNow, Park park) {
+        if(registeredCount.load(memory_order_relaxed)==0) return false;
+        lock_guard<mutex> lock(mtx);
+        auto it=registered.find(fd);
+        if(it==registered.end()) return false;
+        Watch* w=it->second;
+        if((toWaitBits(w->events)&mode)!=mode) return false;
+        if((w->ready&mode) || w->error) {
+            res->result=w->ready&mode;
+            res->error=w->error;
+            w->ready&=~mode;
+            w->error=0;
+            parkedNow=false;
+            return true;
+        }
+        park();
+        w->waiter=cor;
+        w->waitMode=mode;
+        w->result=res;
+        parked.fetch_add(1);
+        parkedNow=true;
+        return true;
+    }
+
+    // Handles ready events; timeoutMs as for epoll_wait. Returns false once stopped.
+    bool dispatch(int timeoutMs) {
+        if(hasRetired.load(memory_order_acquire)) {
+            lock_guard<mutex> lock(mtx);
+            for(Watch* w : retired) delete w;
+            retired.clear();
+            hasRetired.store(false, memory_order_relaxed);
+        }
+        epoll_event ready[64];
+        int n=epoll_wait(epollFd, ready, 64, timeoutMs);
+        for(int i=0;i<n;i++) {
+            Watch* w=(Watch*)ready[i].data.ptr;
+            if(!w) {
+                uint64_t v;
+                (void)!read(wakeFd, &v, sizeof(v));
+                if(stopped.load(memory_order_acquire)) return false;
+                continue;
+            }
+            uint32_t ev=ready[i].events;
+            int bits=toWaitBits(ev);
+            int err=toError(ev, bits);
+            if(!w->persistent) {
+                epoll_ctl(epollFd, EPOLL_CTL_DEL, w->epFd, nullptr);
+                if(w->epFd!=w->fd) close(w->epFd);
+                w->result->result=bits&toWaitBits(w->events);
+                w->result->error=err;
+                Coroutine* cor=w->waiter;   // w is gone once the coroutine runs
+                parked.fetch_sub(1);
+                cor->moveToRunningQueueExternal();
+                continue;
+            }
+            Coroutine* wake=nullptr;
+            {
+                lock_guard<mutex> lock(mtx);
+                w->ready|=bits&toWaitBits(w->events);
+                if(err) w->error=err;
+                if(w->waiter && ((w->ready&w->waitMode) || w->error)) {
+                    w->result->result=w->ready&w->waitMode;
+                    w->result->error=w->error;
+                    w->ready&=~w->waitMode;
+                    w->error=0;
+                    wake=w->waiter;
+                    w->waiter=nullptr;
+                    parked.fetch_sub(1);
+                }
+            }
+            if(wake) wake->moveToRunningQueueExternal();
+        }
+        return true;
+    }
+
+    void stop() {
+        stopped.store(true, memory_order_release);
+        if(worker.joinable()) {
+            nudge();
+            worker.join();
+        }
+        close(wakeFd);
+        close(epollFd);
+    }
+private:
+    void nudge() {
+        uint64_t one=1;
+        (void)!write(wakeFd, &one, sizeof(one));
+    }
+    void run() {
+        while(dispatch(-1)) {}
+    }
+};
+#elif COROCGO_HAS_FILE_IO
 class PollThread {
     struct Registration {
         int fd;
@@ -520,6 +1358,165 @@ private:
 };
 #endif // COROCGO_HAS_FILE_IO
 
+#if COROCGO_EPOLL
+static int ioInlineFd() {
+    return globalPollThread->fd();
+}
+
+static void ioDispatchInline() {
+    globalPollThread->dispatch(0);
+}
+
+// Inline I/O while the scheduler is busy: the idle wait only sees ready fds
+// when nothing else is runnable
+static unsigned ioInlinePasses=0;
+static void scheduler_poll_io(bool every) {
+    if(!ioInlineActive || !globalPollThread->hasWaiters()) return;
+    if(!every && (++ioInlinePasses&63)!=0) return;
+    globalPollThread->dispatch(0);
+}
+#endif
+
+// ── io_uring ──
+// Completion-based backend for co_read / co_write / co_accept / co_recv /
+// co_send under the single-thread scheduler. An operation fills an SQE whose
+// user_data points at a UringOp on the coroutine's stack and parks the
+// coroutine. The scheduler submits everything queued during a pass with one
+// io_uring_enter, reaps the CQ ring (plain memory reads) every pass and polls
+// the ring fd from its idle wait. Raw syscalls — no liburing dependency.
+
+#if COROCGO_URING
+struct UringOp {
+    Coroutine* cor;
+    int        res=0;
+};
+
+class Uring {
+    int            ringFd=-1;
+    unsigned       entries=0;
+    unsigned*      sqHead=nullptr;
+    unsigned*      sqTail=nullptr;
+    unsigned*      sqMask=nullptr;
+    unsigned*      sqArray=nullptr;
+    unsigned*      cqHead=nullptr;
+    unsigned*      cqTail=nullptr;
+    unsigned*      cqMask=nullptr;
+    io_uring_sqe*  sqes=nullptr;
+    io_uring_cqe*  cqes=nullptr;
+    void*          sqMap=nullptr;
+    void*          cqMap=nullptr;
+    size_t         sqMapSize=0;
+    size_t         cqMapSize=0;
+    unsigned       queued=0;     // SQEs filled since the last flush
+public:
+    unsigned       inflight=0;   // submitted or queued, not yet reaped
+    uint64_t       enters=0;     // io_uring_enter calls (bench_uring)
+
+    bool open(unsigned n) {
+        io_uring_params p{};
+        ringFd=(int)syscall(__NR_io_uring_setup, n, &p);
+        if(ringFd<0) return false;
+        entries=p.sq_entries;
+        sqMapSize=p.sq_off.array+p.sq_entries*sizeof(unsigned);
+        cqMapSize=p.cq_off.cqes+p.cq_entries*sizeof(io_uring_cqe);
+        bool single=p.features&IORING_FEAT_SINGLE_MMAP;
+        if(single) sqMapSize=cqMapSize=max(sqMapSize, cqMapSize);
+        sqMap=mmap(nullptr, sqMapSize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        cqMap=single ? sqMap
+                     : mmap(nullptr, cqMapSize, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        sqes=(io_uring_sqe*)mmap(nullptr, p.sq_entries*sizeof(io_uring_sqe), PROT_READ|PROT_WRITE,
+                                 MAP_SHARED|MAP_POPULATE, ringFd, IORING_OFF_SQES);
+        if(sqMap==MAP_FAILED || cqMap==MAP_FAILED || sqes==MAP_FAILED) {
+            close();
+            return false;
+        }
+        char* sq=(char*)sqMap;
+        char* cq=(char*)cqMap;
+        sqHead=(unsigned*)(sq+p.sq_off.head);
+        sqTail=(unsigned*)(sq+p.sq_off.tail);
+        sqMask=(unsigned*)(sq+p.sq_off.ring_mask);
+        sqArray=(unsigned*)(sq+p.sq_off.array);
+        cqHead=(unsigned*)(cq+p.cq_off.head);
+        cqTail=(unsigned*)(cq+p.cq_off.tail);
+        cqMask=(unsigned*)(cq+p.cq_off.ring_mask);
+        cqes=(io_uring_cqe*)(cq+p.cq_off.cqes);
+        return true;
+    }
+
+    void close() {
+        if(sqes && sqes!=MAP_FAILED) munmap(sqes, entries*sizeof(io_uring_sqe));
+        if(cqMap && cqMap!=MAP_FAILED && cqMap!=sqMap) munmap(cqMap, cqMapSize);
+        if(sqMap && sqMap!=MAP_FAILED) munmap(sqMap, sqMapSize);
+        if(ringFd>=0) ::close(ringFd);
+        ringFd=-1;
+        sqes=nullptr;
+        sqMap=cqMap=nullptr;
+        queued=inflight=0;
+    }
+
+    int fd() const { return ringFd; }
+
+    // Next free SQE, zeroed. Flushes first if the SQ ring is full.
+    io_uring_sqe* sqe() {
+        unsigned tail=*sqTail;
+        if(tail-__atomic_load_n(sqHead, __ATOMIC_ACQUIRE)>=entries) {
+            flush();
+            tail=*sqTail;
+        }
+        unsigned idx=tail&*sqMask;
+        io_uring_sqe* s=&sqes[idx];
+        memset(s, 0, sizeof(*s));
+        sqArray[idx]=idx;
+        __atomic_store_n(sqTail, tail+1, __ATOMIC_RELEASE);
+        queued++;
+        inflight++;
+        return s;
+    }
+
+    void flush() {
+        while(queued>0) {
+            int n=(int)syscall(__NR_io_uring_enter, ringFd, queued, 0, 0, nullptr, 0);
+            enters++;
+            if(n>=0) {
+                queued-=(unsigned)n;
+                continue;
+            }
+            if(errno==EINTR) continue;
+            if(errno==EBUSY || errno==EAGAIN) {   // CQ overflow backlog — make room
+                reap();
+                continue;
+            }
+            break;
+        }
+    }
+
+    // Wakes the coroutine of every completed op; scheduler thread only
+    void reap() {
+        unsigned head=*cqHead;
+        unsigned tail=__atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+        if(head==tail) return;
+        for(; head!=tail; head++) {
+            io_uring_cqe* c=&cqes[head&*cqMask];
+            UringOp* op=(UringOp*)(uintptr_t)c->user_data;
+            op->res=c->res;
+            op->cor->moveToRunningQueue();
+            inflight--;
+        }
+        __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+    }
+};
+
+static Uring ring;
+
+static int uringFd() {
+    return ring.fd();
+}
+
+static void uringReap() {
+    ring.reap();
+}
+#endif
+
 // ── Public API ──
 
 namespace corocgo {
@@ -534,8 +1531,8 @@ void _monitor_destroy(void* monitor) {
     delete (WaitQueue*)monitor;
 }
 
-void _monitor_wait(void* monitor) {
-    ((WaitQueue*)monitor)->wait();
+void _monitor_wait(void* monitor, _SpinLock* held) {
+    ((WaitQueue*)monitor)->wait(held);
 }
 
 void _monitor_wake(void* monitor) {
@@ -556,10 +1553,25 @@ void _monitor_remove_waiter(void* monitor, void* cell) {
 
 // ── Select wait ──
 
-void _select_wait(void** monitors, int count) {
+void _select_wait(void** monitors, int count, bool (*recheck)(void*), void* ctx) {
     mco_coro* co=mco_running();
     Coroutine* cor=(Coroutine*)co->user_data;
 
+#if COROCGO_HAS_THREADS
+    if(_mt_on()) {
+        // Register everywhere, then recheck: a send that landed before we were
+        // visible to its wake() is caught here instead of being lost.
+        uint64_t seq=mtPrepare(cor);
+        for(int i=0;i<count;i++) ((WaitQueue*)monitors[i])->mtAddWaiter(cor, seq);
+        bool ready=recheck && recheck(ctx);
+        if(ready) mtCancel(cor, seq);
+        else      mco_yield(co);
+        for(int i=0;i<count;i++) ((WaitQueue*)monitors[i])->mtRemoveWaiter(cor, seq);
+        return;
+    }
+#endif
+    (void)recheck; (void)ctx;
+
     BiLinkedCell<Coroutine*>** tempCells=
         (BiLinkedCell<Coroutine*>**)alloca(count*sizeof(BiLinkedCell<Coroutine*>*));
     for(int i=0;i<count;i++) {
@@ -595,8 +1607,8 @@ void _monitor_ts_destroy(void* monitor) {
     delete (TSWaitQueue*)monitor;
 }
 
-void _monitor_ts_wait(void* monitor) {
-    ((TSWaitQueue*)monitor)->wait();
+void _monitor_ts_wait(void* monitor, _SpinLock* held, const std::atomic<int>* word, int seen) {
+    ((TSWaitQueue*)monitor)->wait(held, word, seen);
 }
 
 void _monitor_ts_wake(void* monitor) {
@@ -613,7 +1625,91 @@ void _monitor_ts_wake_all(void* monitor) {
 
 // ── Fd wait ──
 
-#if COROCGO_HAS_FILE_IO
+#if COROCGO_EPOLL
+// Park / cancel / resume bookkeeping for a coroutine woken from the poll side
+static uint64_t fdParkPrepare(Coroutine* cor) {
+#if COROCGO_HAS_THREADS
+    if(_mt_on()) {
+        uint64_t seq=mtPrepare(cor);
+        mtExternalWaits.fetch_add(1);
+        return seq;
+    }
+#endif
+    cor->moveToWaitingQueue();
+    coro_lock_guard_t<coro_mutex_t> lock(pendingWakeMtx);
+    threadWaitCount++;
+    return 0;
+}
+
+static void fdParkCancel(Coroutine* cor, uint64_t seq) {
+#if COROCGO_HAS_THREADS
+    if(_mt_on()) {
+        mtCancel(cor, seq);
+        mtExternalWaits.fetch_sub(1);
+        return;
+    }
+#endif
+    (void)seq;
+    {
+        coro_lock_guard_t<coro_mutex_t> lock(pendingWakeMtx);
+        threadWaitCount--;
+    }
+    cor->moveToRunningQueue();
+}
+
+static void fdParkResumed() {
+#if COROCGO_HAS_THREADS
+    if(_mt_on()) mtExternalWaits.fetch_sub(1);
+#endif
+}
+
+pair<int,int> wait_file(int fd, int modeBitFlag) {
+    mco_coro* co=mco_running();
+    Coroutine* cor=(Coroutine*)co->user_data;
+    int mode=modeBitFlag&(WAIT_IN|WAIT_OUT);
+    if(mode==0) return {0,EINVAL};
+    FdResult res;   // lives on the coroutine's own stack — safe while suspended
+
+    bool parkedNow=false;
+    if(globalPollThread->waitRegistered(fd, mode, cor, &res, parkedNow,
+                                        [cor]() { fdParkPrepare(cor); })) {
+        if(parkedNow) {
+            mco_yield(co);
+            fdParkResumed();
+        }
+        return {res.result,res.error};
+    }
+
+    PollThread::Watch w;   // one-shot — on this stack until the event fires
+    w.fd=fd;
+    w.events=((mode&WAIT_IN) ? (uint32_t)EPOLLIN : 0u)|((mode&WAIT_OUT) ? (uint32_t)EPOLLOUT : 0u);
+    w.waiter=cor;
+    w.result=&res;
+    uint64_t seq=fdParkPrepare(cor);
+    int err=globalPollThread->watchOnce(&w);
+    if(err) {
+        fdParkCancel(cor, seq);
+        return {0,err};
+    }
+    mco_yield(co);
+    fdParkResumed();
+    return {res.result,res.error};
+}
+
+int register_fd(int fd, int modeBitFlag) {
+    uint32_t events=((modeBitFlag&WAIT_IN) ? (uint32_t)EPOLLIN : 0u)|((modeBitFlag&WAIT_OUT) ? (uint32_t)EPOLLOUT : 0u);
+    if(events==0) return EINVAL;
+    return globalPollThread->registerFd(fd, events);
+}
+
+void unregister_fd(int fd) {
+    globalPollThread->unregisterFd(fd);
+}
+
+void scheduler_io_inline(bool enable) {
+    ioInline=enable;
+}
+#elif COROCGO_HAS_FILE_IO
 pair<int,int> wait_file(int fd, int modeBitFlag) {
     mco_coro* co=mco_running();
     Coroutine* cor=(Coroutine*)co->user_data;
@@ -622,6 +1718,16 @@ pair<int,int> wait_file(int fd, int modeBitFlag) {
     if(modeBitFlag&WAIT_OUT) events|=POLLOUT;
     if(events==0) return {0,EINVAL};
     FdResult res;   // lives on the coroutine's own stack — safe while suspended
+#if COROCGO_HAS_THREADS
+    if(_mt_on()) {
+        mtPrepare(cor);
+        mtExternalWaits.fetch_add(1);
+        globalPollThread->addFd(fd,events,cor,&res);
+        mco_yield(co);
+        mtExternalWaits.fetch_sub(1);
+        return {res.result,res.error};
+    }
+#endif
     cor->moveToWaitingQueue();
     {
         coro_lock_guard_t<coro_mutex_t> lock(pendingWakeMtx);
@@ -631,6 +1737,154 @@ pair<int,int> wait_file(int fd, int modeBitFlag) {
     mco_yield(co);
     return {res.result,res.error};
 }
+
+// poll() backend: no persistent registrations, wait_file() works unregistered
+int register_fd(int, int) { return 0; }
+void unregister_fd(int) {}
+void scheduler_io_inline(bool) {}
+#endif // COROCGO_HAS_FILE_IO
+
+// ── Completion I/O ──
+
+#if COROCGO_HAS_FILE_IO
+#if COROCGO_URING
+// Submits a prepared SQE and parks until its CQE; returns cqe->res. An
+// -EAGAIN (kernels that honour O_NONBLOCK on ring reads) waits for readiness
+// and resubmits.
+template<typename Prep>
+static int uringRun(int fd, int waitMode, Prep prep) {
+    mco_coro* co=mco_running();
+    Coroutine* cor=(Coroutine*)co->user_data;
+    while(true) {
+        UringOp op{cor};
+        io_uring_sqe* s=ring.sqe();
+        prep(s);
+        s->user_data=(uint64_t)(uintptr_t)&op;
+        cor->moveToWaitingQueue();
+        mco_yield(co);
+        if(op.res!=-EAGAIN) return op.res;
+        auto [flags, err]=wait_file(fd, waitMode);
+        if(err) return -err;
+    }
+}
+
+static bool uringUsable() {
+    return uringActive && !_mt_on();
+}
+#endif
+
+// Readiness fallback: try the call, wait_file() on EAGAIN. `waitFirst` for
+// fds that may be blocking (read/write), so the call itself can't stall the
+// scheduler.
+template<typename Call>
+static ssize_t readyRun(int fd, int waitMode, bool waitFirst, Call call) {
+    if(waitFirst) {
+        auto [flags, err]=wait_file(fd, waitMode);
+        if(err) return -err;
+    }
+    while(true) {
+        ssize_t n=call();
+        if(n>=0) return n;
+        if(errno==EINTR) continue;
+        if(errno!=EAGAIN && errno!=EWOULDBLOCK) return -errno;
+        auto [flags, err]=wait_file(fd, waitMode);
+        if(err) return -err;
+    }
+}
+
+ssize_t co_read(int fd, void* buf, size_t len) {
+#if COROCGO_URING
+    if(uringUsable())
+        return uringRun(fd, WAIT_IN, [&](io_uring_sqe* s) {
+            s->opcode=IORING_OP_READ;
+            s->fd=fd;
+            s->addr=(uint64_t)(uintptr_t)buf;
+            s->len=(unsigned)len;
+            s->off=(uint64_t)-1;   // current position — streams don't have one
+        });
+#endif
+    return readyRun(fd, WAIT_IN, true, [&]() { return ::read(fd, buf, len); });
+}
+
+ssize_t co_write(int fd, const void* buf, size_t len) {
+#if COROCGO_URING
+    if(uringUsable())
+        return uringRun(fd, WAIT_OUT, [&](io_uring_sqe* s) {
+            s->opcode=IORING_OP_WRITE;
+            s->fd=fd;
+            s->addr=(uint64_t)(uintptr_t)buf;
+            s->len=(unsigned)len;
+            s->off=(uint64_t)-1;
+        });
+#endif
+    return readyRun(fd, WAIT_OUT, true, [&]() { return ::write(fd, buf, len); });
+}
+
+int co_accept(int fd, sockaddr* addr, socklen_t* addrlen, int flags) {
+#if COROCGO_URING
+    if(uringUsable())
+        return uringRun(fd, WAIT_IN, [&](io_uring_sqe* s) {
+            s->opcode=IORING_OP_ACCEPT;
+            s->fd=fd;
+            s->addr=(uint64_t)(uintptr_t)addr;
+            s->addr2=(uint64_t)(uintptr_t)addrlen;
+            s->accept_flags=(uint32_t)flags;
+        });
+#endif
+    return (int)readyRun(fd, WAIT_IN, false, [&]() { return (ssize_t)::accept4(fd, addr, addrlen, flags); });
+}
+
+ssize_t co_recv(int fd, void* buf, size_t len, int flags) {
+#if COROCGO_URING
+    if(uringUsable())
+        return uringRun(fd, WAIT_IN, [&](io_uring_sqe* s) {
+            s->opcode=IORING_OP_RECV;
+            s->fd=fd;
+            s->addr=(uint64_t)(uintptr_t)buf;
+            s->len=(unsigned)len;
+            s->msg_flags=(uint32_t)flags;
+        });
+#endif
+    return readyRun(fd, WAIT_IN, false, [&]() { return ::recv(fd, buf, len, flags|MSG_DONTWAIT); });
+}
+
+ssize_t co_send(int fd, const void* buf, size_t len, int flags) {
+#if COROCGO_URING
+    if(uringUsable())
+        return uringRun(fd, WAIT_OUT, [&](io_uring_sqe* s) {
+            s->opcode=IORING_OP_SEND;
+            s->fd=fd;
+            s->addr=(uint64_t)(uintptr_t)buf;
+            s->len=(unsigned)len;
+            s->msg_flags=(uint32_t)flags;
+        });
+#endif
+    return readyRun(fd, WAIT_OUT, false, [&]() { return ::send(fd, buf, len, flags|MSG_DONTWAIT); });
+}
+
+void scheduler_io_uring(bool enable) {
+#if COROCGO_URING
+    uringRequested=enable;
+#else
+    (void)enable;
+#endif
+}
+
+bool co_uring_active() {
+#if COROCGO_URING
+    return uringActive;
+#else
+    return false;
+#endif
+}
+
+uint64_t co_uring_enters() {
+#if COROCGO_URING
+    return ring.enters;
+#else
+    return 0;
+#endif
+}
 #endif // COROCGO_HAS_FILE_IO
 
 // ── Thread-safe exec ──
@@ -640,8 +1894,11 @@ void exec_thread(function<void(function<void()>)> future) {
     mco_coro* co=mco_running();
     Coroutine* cor=(Coroutine*)co->user_data;
 
-    cor->moveToWaitingQueue();
-    {
+    if(_mt_on()) {
+        mtPrepare(cor);
+        mtExternalWaits.fetch_add(1);
+    } else {
+        cor->moveToWaitingQueue();
         coro_lock_guard_t<coro_mutex_t> lock(pendingWakeMtx);
         threadWaitCount++;
     }
@@ -654,6 +1911,7 @@ void exec_thread(function<void(function<void()>)> future) {
     });
 
     mco_yield(co);
+    if(_mt_on()) mtExternalWaits.fetch_sub(1);
 }
 #endif // COROCGO_HAS_THREADS
 
@@ -665,39 +1923,168 @@ static void coroutine_entry(mco_coro* co) {
     cor->runnable();
 }
 
-void coro(function<void()>runnable) {
-    mco_desc desc = mco_desc_init(coroutine_entry, 0);
+static void spawn(function<void()>&& runnable, int pinnedWorker, size_t stackSize, const char* name) {
+    StackClass* sc=stackClassFor(stackSize);
+    mco_desc desc = mco_desc_init(coroutine_entry, sc ? sc->stackSize : stackSize);
+    desc.alloc_cb=stackAlloc;
+    desc.dealloc_cb=stackFree;
+    desc.allocator_data=sc;
     mco_coro* co;
     mco_create(&co, &desc);
+    stackArm(co);
 
     BiLinkedCell<Coroutine*>*cell = acquireCell();
     Coroutine*cor=acquireCoroutine();
     cor->runnable = std::move(runnable);
     cor->coroutine = co;
     cor->cell = cell;
+    cor->pinnedWorker = pinnedWorker;
+    cor->name = name;
     cell->data=cor;
+    co->user_data=cor;
+    mco_push(co, &cor, sizeof(cor));
+
+#if COROCGO_HAS_THREADS
+    if(_mt_on()) {
+        mtTotal.fetch_add(1);
+        mtEnqueue(cor);
+        return;
+    }
+#endif
     mainCoroutinesQueue.append(cell);
     totalCoroutines++;
+}
 
-    co->user_data=cor;
-    mco_push(co, &cor, sizeof(cor));
+void coro_named(const char* name, function<void()>runnable, size_t stackSize) {
+    // Children of a pinned coroutine stay on its worker
+    mco_coro* parent=mco_running();
+    int pin=parent ? ((Coroutine*)parent->user_data)->pinnedWorker : -1;
+    spawn(std::move(runnable), pin, stackSize, name);
+}
+
+void coro(function<void()>runnable, size_t stackSize) {
+    coro_named(nullptr, std::move(runnable), stackSize);
+}
+
+void coro_pinned(int workerId, function<void()>runnable) {
+    spawn(std::move(runnable), workerId<0 ? 0 : workerId, 0, nullptr);
+}
+
+void profiler_enable(bool enable, int64_t sliceBudgetUs) {
+    profOn=enable;
+    profBudgetNs=sliceBudgetUs>0 ? sliceBudgetUs*1000 : 0;
+}
+
+bool profiler_enabled() { return profOn; }
+
+int64_t profiler_slice_budget_us() { return profBudgetNs/1000; }
+
+vector<CoroProfile> profiler_snapshot() {
+    vector<CoroProfile> out;
+    out.reserve(profRows.size());
+    for(const ProfRow& r : profRows) out.push_back(r.p);
+    return out;
+}
+
+void profiler_reset() {
+    for(ProfRow& r : profRows) {
+        int live=r.p.live;
+        const char* name=r.p.name;
+        r=ProfRow{};
+        r.p.name=name;
+        r.p.live=live;
+    }
+}
+
+StackPoolStats stack_pool_stats() {
+    _MtGuard g(poolLock);
+    return stackStats;
+}
+
+int coro_worker_id() {
+#if COROCGO_HAS_THREADS
+    Worker* w=currentWorker();
+    if(w) return w->id;
+#endif
+    return 0;
+}
+
+int scheduler_worker_count() {
+#if COROCGO_HAS_THREADS
+    if(_mt_on()) return (int)mtWorkers.size();
+#endif
+    return 1;
 }
 
 void coro_yield() {
     mco_yield(mco_running());
 }
 
-void sleep(int milliseconds) {
+bool sleep_until(chrono::steady_clock::time_point deadline) {
     mco_coro* co=mco_running();
     Coroutine* cor=(Coroutine*)co->user_data;
-    cor->wakeUpTime=chrono::steady_clock::now()+chrono::milliseconds(milliseconds);
-    cor->moveToWaitingQueue();
-    BiLinkedCell<Coroutine*>* pos=sleepQueue.peekFront();
-    while(pos!=nullptr && pos->data->wakeUpTime<=cor->wakeUpTime) {
-        pos=pos->next;
+    cor->wakeUpTime=deadline;
+    cor->sleepCancelled=false;
+#if COROCGO_HAS_THREADS
+    if(_mt_on()) {
+        mtPrepare(cor);
+        bool earliest;
+        {
+            lock_guard<mutex> lock(timerMtx);
+            mtTimers.push(cor);
+            earliest=mtTimers.top()==cor;
+            mtNextTimerNs.store(toNs(mtTimers.top()->wakeUpTime), memory_order_release);
+        }
+        if(earliest) mtNotify(false);   // an idle worker may be waiting on a later deadline
+        mco_yield(co);
+        return !cor->sleepCancelled;
     }
-    sleepQueue.insertBefore(cor->cell, pos);
+#endif
+    cor->moveToWaitingQueue();
+    sleepTimers.push(cor);
     mco_yield(co);
+    return !cor->sleepCancelled;
+}
+
+bool sleep(int milliseconds) {
+    return sleep_until(chrono::steady_clock::now()+chrono::milliseconds(milliseconds));
+}
+
+bool sleep_us(int64_t microseconds) {
+    return sleep_until(chrono::steady_clock::now()+chrono::microseconds(microseconds));
+}
+
+CoroHandle coro_self() {
+    mco_coro* co=mco_running();
+    if(!co) return {};
+    Coroutine* cor=(Coroutine*)co->user_data;
+    return {cor, cor->generation};
+}
+
+bool sleep_cancel(CoroHandle h) {
+    Coroutine* cor=(Coroutine*)h.cor;
+    if(!cor) return false;
+#if COROCGO_HAS_THREADS
+    if(_mt_on()) {
+        {
+            lock_guard<mutex> lock(timerMtx);
+            // timerIndex is only touched under timerMtx; while it is set the
+            // coroutine is asleep, so its generation is stable
+            if(cor->timerIndex<0 || cor->generation!=h.gen) return false;
+            mtTimers.remove(cor);
+            cor->sleepCancelled=true;
+            mtNextTimerNs.store(mtTimers.empty() ? INT64_MAX : toNs(mtTimers.top()->wakeUpTime),
+                                memory_order_release);
+        }
+        mtWakeCurrent(cor);
+        return true;
+    }
+#endif
+    if(cor->timerIndex<0 || cor->generation!=h.gen) return false;
+    sleepTimers.remove(cor);
+    cor->sleepCancelled=true;
+    cor->moveToRunningQueue();
+    return true;
 }
 
 // ── Shared scheduler phase helpers ──
@@ -711,15 +2098,19 @@ static void scheduler_drain_pending() {
     }
 }
 
+static bool uringInflight() {
+#if COROCGO_URING
+    return uringActive && ring.inflight>0;
+#else
+    return false;
+#endif
+}
+
 static void scheduler_wake_sleepers() {
+    if(sleepTimers.empty()) return;
     auto now=chrono::steady_clock::now();
-    while(true) {
-        BiLinkedCell<Coroutine*>* front=sleepQueue.peekFront();
-        if(front==nullptr) break;
-        if(front->data->wakeUpTime>now) break;
-        sleepQueue.remove(front);           // cell->list = nullptr
-        front->data->moveToRunningQueue();
-    }
+    while(!sleepTimers.empty() && sleepTimers.top()->wakeUpTime<=now)
+        sleepTimers.pop()->moveToRunningQueue();
 }
 
 static void scheduler_run_ready() {
@@ -727,8 +2118,12 @@ static void scheduler_run_ready() {
     while(cell!=NULL) {
         BiLinkedCell<Coroutine*>*next=cell->next;
         Coroutine*c=cell->data;
+        int64_t t0=profOn ? profNow() : 0;
         mco_resume(c->coroutine);
+        if(t0) profSlice(c, t0);
+        stackCheck(c->coroutine);
         if(mco_status(c->coroutine)==MCO_DEAD) {
+            if(c->profRow>=0) profRows[c->profRow].p.live--;
             mco_destroy(c->coroutine);
             mainCoroutinesQueue.remove(cell);
             releaseCell(cell);
@@ -741,18 +2136,45 @@ static void scheduler_run_ready() {
 
 // ── Scheduler lifecycle ──
 
-void scheduler_init() {
+// inlineIo: the single-thread scheduler may serve I/O itself — epoll dispatch
+// (scheduler_io_inline) and the io_uring ring (scheduler_io_uring)
+static void scheduler_init_io(bool inlineIo) {
+#if COROCGO_IDLE_TIMERFD
+    idleFdsOpen();
+#endif
 #if COROCGO_HAS_THREADS
     int poolSize=(int)thread::hardware_concurrency();
     if(poolSize<2) poolSize=2;
     globalThreadPool=new ThreadPool(poolSize);
 #endif
-#if COROCGO_HAS_FILE_IO
+#if COROCGO_URING
+    uringActive=inlineIo && uringRequested && ring.open(256);
+#endif
+#if COROCGO_EPOLL
+    ioInlineActive=inlineIo && ioInline && COROCGO_IDLE_TIMERFD;
+    globalPollThread=new PollThread(ioInlineActive);
+#elif COROCGO_HAS_FILE_IO
+    (void)inlineIo;
     globalPollThread=new PollThread();
+#else
+    (void)inlineIo;
 #endif
 }
 
+void scheduler_init() {
+    scheduler_init_io(true);
+}
+
 bool scheduler_step() {
+#if COROCGO_EPOLL
+    scheduler_poll_io(true);
+#endif
+#if COROCGO_URING
+    if(uringActive) {
+        ring.flush();
+        ring.reap();
+    }
+#endif
     scheduler_drain_pending();
     scheduler_wake_sleepers();
     if(mainCoroutinesQueue.size()>0) {
@@ -762,6 +2184,10 @@ bool scheduler_step() {
 }
 
 void scheduler_stop() {
+#if COROCGO_URING
+    if(uringActive) ring.close();
+    uringActive=false;
+#endif
 #if COROCGO_HAS_FILE_IO
     if(globalPollThread) {
         globalPollThread->stop();
@@ -774,6 +2200,9 @@ void scheduler_stop() {
         delete globalThreadPool;
         globalThreadPool=nullptr;
     }
+#endif
+#if COROCGO_IDLE_TIMERFD
+    idleFdsClose();   // after the threads that may still notify through idleWakeFd
 #endif
     for(Coroutine* c : freeCoroutines) delete c;
     freeCoroutines.clear();
@@ -784,28 +2213,253 @@ void scheduler_stop() {
     }
 }
 
-SchedulerResult scheduler_start() {
+// ── M:N scheduler ──
+
+#if COROCGO_HAS_THREADS
+static void mtShutdownAll(SchedulerResult result) {
+    lock_guard<mutex> lock(idleMtx);
+    if(!mtShutdown.load()) mtResult=result;
+    mtShutdown.store(true);
+    idleCV.notify_all();
+}
+
+static void mtFireTimers() {
+    if(mtNextTimerNs.load(memory_order_acquire)>toNs(chrono::steady_clock::now())) return;
+    static thread_local vector<Coroutine*> due;   // worker threads only
+    due.clear();
+    {
+        lock_guard<mutex> lock(timerMtx);
+        auto now=chrono::steady_clock::now();
+        while(!mtTimers.empty() && mtTimers.top()->wakeUpTime<=now)
+            due.push_back(mtTimers.pop());
+        mtNextTimerNs.store(mtTimers.empty() ? INT64_MAX : toNs(mtTimers.top()->wakeUpTime), memory_order_release);
+    }
+    for(Coroutine* c : due) mtWakeCurrent(c);
+}
+
+// Own queues first (alternating pinned / stealable so neither starves), the
+// inject queue every 61 ticks even when local work exists, then stealing.
+static Coroutine* mtNext(Worker* w) {
+    Coroutine* c=nullptr;
+    w->tick++;
+    if(w->tick%61==0) {
+        lock_guard<mutex> lock(injectMtx);
+        if(!injectQueue.empty()) { c=injectQueue.front(); injectQueue.pop_front(); return c; }
+    }
+    {
+        lock_guard<mutex> lock(w->mtx);
+        deque<Coroutine*>* first =(w->tick&1) ? &w->pinnedQueue : &w->runQueue;
+        deque<Coroutine*>* second=(w->tick&1) ? &w->runQueue : &w->pinnedQueue;
+        if(!first->empty())       { c=first->front();  first->pop_front(); }
+        else if(!second->empty()) { c=second->front(); second->pop_front(); }
+        if(c) return c;
+    }
+    {
+        lock_guard<mutex> lock(injectMtx);
+        if(!injectQueue.empty()) { c=injectQueue.front(); injectQueue.pop_front(); return c; }
+    }
+    // Steal half of the first non-empty victim's run queue, starting at a rotating offset
+    int n=(int)mtWorkers.size();
+    for(int i=1;i<n;i++) {
+        Worker* v=mtWorkers[(w->id+w->tick+i)%n];
+        if(v==w) continue;
+        vector<Coroutine*> stolen;
+        {
+            lock_guard<mutex> lock(v->mtx);
+            size_t k=(v->runQueue.size()+1)/2;
+            for(size_t j=0;j<k;j++) {
+                stolen.push_back(v->runQueue.back());
+                v->runQueue.pop_back();
+            }
+        }
+        if(stolen.empty()) continue;
+        c=stolen.back();
+        stolen.pop_back();
+        if(!stolen.empty()) {
+            lock_guard<mutex> lock(w->mtx);
+            for(auto it=stolen.rbegin(); it!=stolen.rend(); ++it) w->runQueue.push_back(*it);
+        }
+        return c;
+    }
+    return nullptr;
+}
+
+static bool mtHasWork(Worker* w) {
+    for(Worker* v : mtWorkers) {
+        lock_guard<mutex> lock(v->mtx);
+        if(!v->runQueue.empty() || (v==w && !v->pinnedQueue.empty())) return true;
+    }
+    lock_guard<mutex> lock(injectMtx);
+    return !injectQueue.empty();
+}
+
+static void mtIdle(Worker* w) {
+    unique_lock<mutex> lock(idleMtx);
+    idleWorkers.fetch_add(1);   // seq_cst — pairs with the fence in mtNotify
+    if(!mtShutdown.load() && !mtHasWork(w)) {
+        int64_t next=mtNextTimerNs.load(memory_order_acquire);
+        if(next==INT64_MAX) {
+            // Everyone idle, nothing queued, no timers, nothing an outside thread can wake
+            bool allIdle=idleWorkers.load()==(int)mtWorkers.size();
+            if(allIdle && mtExternalWaits.load()==0) {
+                bool anyPinned=false;
+                for(Worker* v : mtWorkers) {
+                    lock_guard<mutex> l(v->mtx);
+                    anyPinned|=!v->pinnedQueue.empty();
+                }
+                if(!anyPinned) {
+                    mtResult=DEADLOCK;
+                    mtShutdown.store(true);
+                    idleCV.notify_all();
+                }
+            }
+            if(!mtShutdown.load()) idleCV.wait(lock);
+        } else {
+            auto deadline=chrono::steady_clock::time_point(chrono::nanoseconds(next));
+            if(deadline>chrono::steady_clock::now()) idleCV.wait_until(lock, deadline);
+        }
+    }
+    idleWorkers.fetch_sub(1);
+}
+
+static void mtRun(Coroutine* c) {
+    uint64_t v=c->mtState.load(memory_order_relaxed);
+    c->mtState.store((v&~7ull)|MT_RUNNING, memory_order_relaxed);
+    mco_resume(c->coroutine);
+
+    if(mco_status(c->coroutine)==MCO_DEAD) {
+        stackCheck(c->coroutine);   // only here: once parked, a waker may resume it elsewhere
+        mco_destroy(c->coroutine);
+        releaseCell(c->cell);
+        releaseCoroutine(c);
+        if(mtTotal.fetch_sub(1)==1) mtShutdownAll(SUCCESS);
+        return;
+    }
+    v=c->mtState.load(memory_order_acquire);
+    switch(v&7) {
+        case MT_RUNNING:    // coro_yield
+            c->mtState.store((v&~7ull)|MT_RUNNABLE, memory_order_relaxed);
+            mtEnqueue(c, /*notify=*/false);
+            return;
+        case MT_PARKING:
+            if(c->mtState.compare_exchange_strong(v, (v&~7ull)|MT_PARKED, memory_order_acq_rel))
+                return;     // parked — a waker owns it now
+            [[fallthrough]]; // woken while yielding
+        default:
+            c->mtState.store((v&~7ull)|MT_RUNNABLE, memory_order_relaxed);
+            mtEnqueue(c);
+            return;
+    }
+}
+
+// Before sleeping on idleCV, up to half the workers poll for a few µs: a
+// blocking channel handoff usually makes work appear that fast, and a futex
+// wake costs far more.
+static Coroutine* mtSpin(Worker* w) {
+    if(spinningWorkers.fetch_add(1)>=maxSpinning) {
+        spinningWorkers.fetch_sub(1);
+        return nullptr;
+    }
+    Coroutine* c=nullptr;
+    for(int i=0;i<200 && !c && !mtShutdown.load(memory_order_relaxed);i++) {
+        for(int j=0;j<32;j++) corocgo::_cpu_relax();
+        mtFireTimers();
+        c=mtNext(w);
+    }
+    spinningWorkers.fetch_sub(1);
+    return c;
+}
+
+static void mtWorkerLoop(Worker* w) {
+    tlsWorker=w;
+#if COROCGO_IDLE_TIMERFD
+    // Idle workers sleep in idleCV.wait_until; the default 50 µs timer slack
+    // would add that much to every sleeper's wakeup
+    int oldSlack=prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0);
+    prctl(PR_SET_TIMERSLACK, 1000, 0, 0, 0);
+#endif
+    while(!mtShutdown.load(memory_order_acquire)) {
+        mtFireTimers();
+        Coroutine* c=mtNext(w);
+        if(!c) c=mtSpin(w);
+        if(c) mtRun(c);
+        else  mtIdle(w);
+    }
+#if COROCGO_IDLE_TIMERFD
+    if(oldSlack>0) prctl(PR_SET_TIMERSLACK, oldSlack, 0, 0, 0);   // worker 0 is the caller's thread
+#endif
+    tlsWorker=nullptr;
+}
+
+static SchedulerResult scheduler_start_mt(int workers) {
+    scheduler_init_io(false);   // workers block in mtIdle — the poll thread serves fds
+    mtShutdown.store(false);
+    mtResult=SUCCESS;
+    for(int i=0;i<workers;i++) {
+        Worker* w=new Worker();
+        w->id=i;
+        mtWorkers.push_back(w);
+    }
+    int cpus=(int)thread::hardware_concurrency();
+    maxSpinning=cpus>1 ? (workers+1)/2 : 0;
+    _mt_active=true;
+
+    // Coroutines created before start sit in the single-thread run queue
+    mtTotal.store(totalCoroutines);
+    totalCoroutines=0;
+    while(BiLinkedCell<Coroutine*>* cell=mainCoroutinesQueue.removeFront())
+        mtEnqueue(cell->data, /*notify=*/false);
+
+    if(mtTotal.load()>0) {
+        for(int i=1;i<workers;i++)
+            mtWorkers[i]->th=thread([w=mtWorkers[i]]() { mtWorkerLoop(w); });
+        mtWorkerLoop(mtWorkers[0]);
+        for(int i=1;i<workers;i++) mtWorkers[i]->th.join();
+    }
+
+    _mt_active=false;
+    for(Worker* w : mtWorkers) delete w;
+    mtWorkers.clear();
+    injectQueue.clear();
+    mtTimers.clear();
+    mtNextTimerNs.store(INT64_MAX);
+    scheduler_stop();
+    return mtResult;
+}
+#endif // COROCGO_HAS_THREADS
+
+SchedulerResult scheduler_start(int workers) {
+#if COROCGO_HAS_THREADS
+    if(workers>1) return scheduler_start_mt(workers);
+#else
+    (void)workers;
+#endif
     scheduler_init();
 
     while(totalCoroutines>0) {
+#if COROCGO_EPOLL
+        scheduler_poll_io(false);
+#endif
+#if COROCGO_URING
+        if(uringActive) {
+            ring.flush();   // one io_uring_enter for everything queued last pass
+            ring.reap();
+        }
+#endif
         scheduler_drain_pending();
         scheduler_wake_sleepers();
 
         // Phase 2: if nothing ready, block (unique to scheduler_start)
         if(mainCoroutinesQueue.size()==0) {
             coro_unique_lock_t<coro_mutex_t> lock(pendingWakeMtx);
-            if(sleepQueue.size()>0) {
-                auto dur=sleepQueue.peekFront()->data->wakeUpTime-chrono::steady_clock::now();
-                auto ms=chrono::duration_cast<chrono::milliseconds>(dur).count();
-                if(ms>0)
-                    schedulerCV.wait_for(lock,chrono::milliseconds(ms),
-                        []() { return pendingWakeQueue.size()>0; });
-            } else if(threadWaitCount>0) {
-                schedulerCV.wait(lock,
-                    []() { return pendingWakeQueue.size()>0; });
-            } else if(pendingWakeQueue.size()>0) {
+            if(pendingWakeQueue.size()>0) {
                 // Items arrived between drain and this check — retry.
                 continue;
+            } else if(!sleepTimers.empty()) {
+                auto deadline=sleepTimers.top()->wakeUpTime;
+                if(deadline>chrono::steady_clock::now()) idleWaitUntil(lock, deadline);
+            } else if(threadWaitCount>0 || uringInflight()) {
+                idleWaitUntil(lock, chrono::steady_clock::time_point::max());
             } else {
                 scheduler_stop();
                 return DEADLOCK;
@@ -13,7 +13,11 @@
 // ---------------------------------------------------------------------------
 // Feature flags  (can be overridden by the user before including this header)
 // COROCGO_HAS_THREADS — enables ThreadPool, PollThread, exec_thread(), wait_file()
+//                       and the M:N scheduler (scheduler_start(workers > 1))
 // COROCGO_HAS_FILE_IO — enables poll/pipe/fcntl based I/O waiting
+// COROCGO_STACK_POOL_BYTES — idle coroutine stacks kept per size class
+// COROCGO_STACK_CHECK — canary at the stack limit, checked by the scheduler;
+//                       on by default unless NDEBUG
 // ---------------------------------------------------------------------------
 
 #if defined(COROCGO_PLATFORM_PICO)
@@ -23,6 +27,9 @@
     #ifndef COROCGO_HAS_FILE_IO
         #define COROCGO_HAS_FILE_IO 0
     #endif
+    #ifndef COROCGO_STACK_POOL_BYTES
+        #define COROCGO_STACK_POOL_BYTES (16*1024)
+    #endif
 #else
     #ifndef COROCGO_HAS_THREADS
         #define COROCGO_HAS_THREADS 1
@@ -30,6 +37,17 @@
     #ifndef COROCGO_HAS_FILE_IO
         #define COROCGO_HAS_FILE_IO 1
     #endif
+    #ifndef COROCGO_STACK_POOL_BYTES
+        #define COROCGO_STACK_POOL_BYTES (4*1024*1024)
+    #endif
+#endif
+
+#ifndef COROCGO_STACK_CHECK
+    #ifdef NDEBUG
+        #define COROCGO_STACK_CHECK 0
+    #else
+        #define COROCGO_STACK_CHECK 1
+    #endif
 #endif
 
 #ifndef goengine_h
@@ -84,6 +102,11 @@ namespace corocgo {
         bool wait_for(L&, const Duration&, Predicate pred) {
             return pred();
         }
+
+        template<class L, class TimePoint, class Predicate>
+        bool wait_until(L&, const TimePoint&, Predicate pred) {
+            return pred();
+        }
     };
 
 } // namespace corocgo
@@ -93,45 +116,208 @@ namespace corocgo {
 #include <functional>
 #include <utility>
 #include <atomic>
+#include <cstdint>
+#include <chrono>
+#if COROCGO_HAS_THREADS
+#include <thread>
+#endif
 #include <cassert>
 #include <tuple>
 #include <type_traits>
+#include <vector>
+#if COROCGO_HAS_FILE_IO
+#include <sys/types.h>
+#include <sys/socket.h>
+#endif
 
 namespace corocgo {
 
 enum WAIT_MODE { WAIT_IN=1, WAIT_OUT=2 };
 enum SchedulerResult { SUCCESS, DEADLOCK };
 
-void coro(std::function<void()>runnable);
-SchedulerResult scheduler_start();
+// stackSize: stack bytes for the new coroutine, 0 = minicoro's default
+// (56 KB on Linux, MCO_DEFAULT_STACK_SIZE). Rounded up to a size class of the
+// stack pool; sizes above the largest class are allocated and freed as is.
+void coro(std::function<void()>runnable, size_t stackSize=0);
+// Like coro(), but the coroutine only ever runs on worker `workerId` (modulo
+// the worker count) of the M:N scheduler. Coroutines it spawns inherit the
+// pin. Same as coro() under the single-thread scheduler.
+void coro_pinned(int workerId, std::function<void()>runnable);
+// workers <= 1 (default): single-thread scheduler on the calling thread.
+// workers > 1: M:N scheduler — the calling thread plus workers-1 threads, each
+// with its own run queue, stealing from the others when idle. Needs
+// COROCGO_HAS_THREADS; otherwise workers is ignored.
+SchedulerResult scheduler_start(int workers=1);
 void scheduler_init();
 bool scheduler_step();
 void scheduler_stop();
 void coro_yield();
-void sleep(int milliseconds);
+
+// Identifies a coroutine for sleep_cancel(). Safe to keep after the coroutine
+// exits — the generation no longer matches and the call is a no-op.
+struct CoroHandle {
+    void*    cor=nullptr;
+    uint32_t gen=0;
+    explicit operator bool() const { return cor!=nullptr; }
+};
+CoroHandle coro_self();
+
+// Returns false if the sleep was ended early by sleep_cancel().
+bool sleep(int milliseconds);
+bool sleep_us(int64_t microseconds);
+// Absolute deadline; a periodic loop that advances its own deadline doesn't
+// accumulate drift. A deadline in the past just yields.
+bool sleep_until(std::chrono::steady_clock::time_point deadline);
+// Wakes `h` now if it is inside sleep() (call from a coroutine). Returns
+// false if it is not sleeping — running, blocked on something else, or gone.
+bool sleep_cancel(CoroHandle h);
+
+// Dead coroutines hand their block (stack included) back to a per-size-class
+// pool instead of freeing it, so spawning skips malloc and the first-touch
+// page faults. Process-wide counters.
+struct StackPoolStats {
+    uint64_t hits;          // spawns served from the pool
+    uint64_t misses;        // spawns that allocated a new block
+    uint64_t oversize;      // stacks above the largest class, never pooled
+    int      pooled;        // idle blocks held now
+    size_t   pooledBytes;
+};
+StackPoolStats stack_pool_stats();
+
+// ── Profiler ──
+// Off by default; when off the scheduler pays one branch per resume. Only the
+// single-thread scheduler records (scheduler_start() / scheduler_step()).
+// `name` must stay valid while the coroutine is alive; the profiler copies it
+// into its row. Coroutines that share a name share one profile row, unnamed
+// ones are grouped as "(unnamed)".
+void coro_named(const char* name, std::function<void()>runnable, size_t stackSize=0);
+
+struct CoroProfile {
+    const char* name;       // owned by the profiler, valid for the process lifetime
+    int      live;          // alive now (seen since profiling was enabled)
+    uint64_t coroutines;    // instances seen running
+    uint64_t resumes;
+    int64_t  runNs;         // total time inside slices
+    int64_t  maxSliceNs;
+    int64_t  parkedNs;      // blocked (channel, select, sleep, wait_file, ...) until resumed
+    uint64_t longSlices;    // slices over the budget
+};
+// sliceBudgetUs > 0: a slice longer than that is counted and logged to stderr
+// (at most once a second per name).
+void profiler_enable(bool enable, int64_t sliceBudgetUs=0);
+bool profiler_enabled();
+int64_t profiler_slice_budget_us();
+std::vector<CoroProfile> profiler_snapshot();   // call from the scheduler thread
+void profiler_reset();
+
+// Index of the worker running the calling coroutine (0 in single-thread mode)
+int coro_worker_id();
+int scheduler_worker_count();
 
 void exec_thread(std::function<void(std::function<void()>)> future);
 std::pair<int,int> wait_file(int fd, int modeBitFlag);
+// Keeps `fd` in the poll set (edge-triggered epoll on Linux) for a coroutine
+// that waits on it in a loop: wait_file() then needs no syscall and returns at
+// once if the fd became ready since the last wait. Readers must drain the fd
+// (read to EAGAIN or a short read) before waiting again, and tolerate an
+// occasional wake with nothing left to read. Returns 0 or an errno. Call
+// unregister_fd() before close(); a coroutine still waiting gets EBADF.
+int register_fd(int fd, int modeBitFlag);
+void unregister_fd(int fd);
+// Single-thread scheduler on Linux: dispatch fd readiness from the scheduler
+// itself (its idle wait and every 64th pass) instead of the poll thread, so a
+// ready fd wakes its coroutine without a thread hop. Set before scheduler_start().
+void scheduler_io_inline(bool enable);
+
+#if COROCGO_HAS_FILE_IO
+// Completion-style I/O: each call returns when the operation is done, with
+// the syscall's result — bytes / new fd, or -errno (never sets errno).
+// With scheduler_io_uring(true) the single-thread scheduler runs them on an
+// io_uring ring: the operation is posted before the data is there, the
+// completion carries the data, and everything posted in one scheduler pass is
+// submitted with one io_uring_enter. Otherwise (ring unavailable, M:N
+// scheduler, non-Linux) they fall back to wait_file() plus the plain call.
+// An fd must not be closed while another coroutine has an operation on it.
+ssize_t co_read(int fd, void* buf, size_t len);
+ssize_t co_write(int fd, const void* buf, size_t len);
+int     co_accept(int fd, sockaddr* addr, socklen_t* addrlen, int flags=0);   // accept4 flags
+ssize_t co_recv(int fd, void* buf, size_t len, int flags=0);
+ssize_t co_send(int fd, const void* buf, size_t len, int flags=0);
+// Set before scheduler_start(); co_uring_active() reports whether the ring
+// came up (needs Linux 5.6+ and io_uring not disabled by policy).
+void     scheduler_io_uring(bool enable);
+bool     co_uring_active();
+uint64_t co_uring_enters();   // io_uring_enter calls so far (benchmarks)
+#endif
+
+// ── M:N support ──
+// Channels take _SpinLock only while the M:N scheduler runs, so the
+// single-thread scheduler pays one predictable branch per operation.
+#if COROCGO_HAS_THREADS
+extern bool _mt_active;
+inline bool _mt_on() { return _mt_active; }
+
+inline void _cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+struct _SpinLock {
+    std::atomic<bool> held{false};
+    void lock() {
+        int spins=0;
+        while(held.exchange(true,std::memory_order_acquire)) {
+            while(held.load(std::memory_order_relaxed)) {
+                if(++spins<64) _cpu_relax();
+                else std::this_thread::yield();
+            }
+        }
+    }
+    void unlock() { held.store(false,std::memory_order_release); }
+};
+#else
+inline bool _mt_on() { return false; }
+struct _SpinLock {
+    void lock() {}
+    void unlock() {}
+};
+#endif
+
+// Holds `l` for the scope, but only under the M:N scheduler
+struct _MtGuard {
+    _SpinLock* lk;
+    explicit _MtGuard(_SpinLock& l) : lk(_mt_on() ? &l : nullptr) { if(lk) lk->lock(); }
+    ~_MtGuard() { if(lk) lk->unlock(); }
+};
 
 // internal monitor bridge (used by Channel template)
+// `held` (M:N only) is released once the caller is registered as a waiter and
+// re-acquired after wake-up.
 void* _monitor_create();
 void _monitor_destroy(void* monitor);
-void _monitor_wait(void* monitor);
+void _monitor_wait(void* monitor, _SpinLock* held=nullptr);
 void _monitor_wake(void* monitor);
 void _monitor_wake_all(void* monitor);
 
 // thread-safe monitor bridge (used by Channel with external send)
+// If `word` is given, the wait is abandoned when *word no longer equals `seen`
+// after registering — closes the race with an external producer.
 void* _monitor_ts_create();
 void _monitor_ts_destroy(void* monitor);
-void _monitor_ts_wait(void* monitor);
+void _monitor_ts_wait(void* monitor, _SpinLock* held=nullptr,
+                      const std::atomic<int>* word=nullptr, int seen=0);
 void _monitor_ts_wake(void* monitor);
 void _monitor_ts_wake_external(void* monitor);
 void _monitor_ts_wake_all(void* monitor);
 
 // select support
+// `recheck(ctx)` runs after registering on all monitors; true cancels the wait.
 void _monitor_add_waiter(void* monitor, void* cell);
 void _monitor_remove_waiter(void* monitor, void* cell);
-void _select_wait(void** monitors, int count);
+void _select_wait(void** monitors, int count, bool (*recheck)(void*)=nullptr, void* ctx=nullptr);
 
 template<typename T>
 struct ChannelResult {
@@ -157,6 +343,8 @@ class Channel {
     std::atomic<int> extWriteIdx;  // producer (IRQ) writes, consumer reads
     std::atomic<int> extReadIdx;   // consumer (main) writes, producer reads
 
+    _SpinLock _lock;               // M:N scheduler only
+
     void drainExternal() {
         int w = extWriteIdx.load(std::memory_order_acquire);
         while(extReadIdx.load(std::memory_order_relaxed) != w && count < bufferSize) {
@@ -202,59 +390,96 @@ public:
         delete[] buffer;
     }
     bool send(const T& value) {
+        T copy=value;
+        return send(std::move(copy));
+    }
+    // Moves `value` into the channel. Move-only T (e.g. pooled buffer
+    // handles) travel sender → receiver without a copy. On false (closed)
+    // `value` is left untouched.
+    bool send(T&& value) {
+        _MtGuard g(_lock);
         if(_closed.load(std::memory_order_relaxed)) return false;
         while (count>=bufferSize && !_closed.load(std::memory_order_relaxed)) {
             if (_extEnabled) {
-                _monitor_ts_wait(sendMonitor);
+                _monitor_ts_wait(sendMonitor, g.lk);
             } else {
-                _monitor_wait(sendMonitor);
+                _monitor_wait(sendMonitor, g.lk);
             }
         }
         if(_closed.load(std::memory_order_relaxed)) return false;
-        buffer[writeIdx]=value;
+        buffer[writeIdx]=std::move(value);
+        writeIdx=(writeIdx+1)%bufferSize;
+        count++;
+        if(_extEnabled) _monitor_ts_wake(recvMonitor);
+        else _monitor_wake(recvMonitor);
+        return true;
+    }
+    // Never waits: false if the buffer is full or the channel is closed.
+    // `value` is only moved from on success.
+    bool trySend(const T& value) {
+        T copy=value;
+        return trySend(std::move(copy));
+    }
+    bool trySend(T&& value) {
+        _MtGuard g(_lock);
+        if(_closed.load(std::memory_order_relaxed) || count>=bufferSize) return false;
+        buffer[writeIdx]=std::move(value);
         writeIdx=(writeIdx+1)%bufferSize;
         count++;
         if(_extEnabled) _monitor_ts_wake(recvMonitor);
         else _monitor_wake(recvMonitor);
         return true;
     }
+    // The value is moved out of the slot
     ChannelResult<T> receive() {
+        _MtGuard g(_lock);
         while(true) {
             if(count>0) {
-                T value=buffer[readIdx];
+                ChannelResult<T> r{std::move(buffer[readIdx]), false};
                 readIdx=(readIdx+1)%bufferSize;
                 count--;
                 if(_extEnabled) _monitor_ts_wake(sendMonitor);
                 else _monitor_wake(sendMonitor);
-                return {value, false};
+                return r;
             }
-            if(_extEnabled && extWriteIdx.load(std::memory_order_acquire)!=extReadIdx.load(std::memory_order_relaxed)) {
-                drainExternal();
-                continue;
+            int extSeen=0;
+            if(_extEnabled) {
+                extSeen=extWriteIdx.load(std::memory_order_acquire);
+                if(extSeen!=extReadIdx.load(std::memory_order_relaxed)) {
+                    drainExternal();
+                    continue;
+                }
             }
             if(_closed.load(std::memory_order_relaxed)) {
                 return {T{}, true};
             }
-            if(_extEnabled) _monitor_ts_wait(recvMonitor);
-            else _monitor_wait(recvMonitor);
+            if(_extEnabled) _monitor_ts_wait(recvMonitor, g.lk, &extWriteIdx, extSeen);
+            else _monitor_wait(recvMonitor, g.lk);
         }
     }
     // Thread-safe non-blocking send from external (non-coroutine) thread.
     // Returns false if buffer is full, channel is closed, or external send not enabled.
     // Channel must be created with extSize > 0.
-    bool sendExternalNoBlock(T value) {
+    bool sendExternalNoBlock(const T& value) {
+        T copy=value;
+        return sendExternalNoBlock(std::move(copy));
+    }
+    // `value` is only moved from on success, so a caller may retry with it
+    bool sendExternalNoBlock(T&& value) {
         if(!_extEnabled) return false;
         if(_closed.load(std::memory_order_acquire)) return false;
         int w = extWriteIdx.load(std::memory_order_relaxed);
         int next = (w+1)%extBufSize;
         if(next == extReadIdx.load(std::memory_order_acquire)) return false; // full
-        extBuffer[w] = value;
+        extBuffer[w] = std::move(value);
         extWriteIdx.store(next, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_seq_cst);   // pairs with the recheck in _monitor_ts_wait
         _monitor_ts_wake_external(recvMonitor);
         return true;
     }
     // Safe to call from external thread if _extEnabled.
     void close() {
+        _MtGuard g(_lock);
         _closed.store(true,std::memory_order_release);
         if (_extEnabled) {
             _monitor_ts_wake_all(sendMonitor);
@@ -268,19 +493,26 @@ public:
         return _closed.load(std::memory_order_relaxed);
     }
     ChannelResult<T> tryReceive() {
+        _MtGuard g(_lock);
         if(_extEnabled && extWriteIdx.load(std::memory_order_acquire)!=extReadIdx.load(std::memory_order_relaxed)) {
             drainExternal();
         }
         if(count>0) {
-            T value=buffer[readIdx];
+            ChannelResult<T> r{std::move(buffer[readIdx]), false};
             readIdx=(readIdx+1)%bufferSize;
             count--;
             if(_extEnabled) _monitor_ts_wake(sendMonitor);
             else _monitor_wake(sendMonitor);
-            return {value, false};
+            return r;
         }
         return {T{}, true};
     }
+    // Non-consuming readiness check for select (a receive would not block)
+    bool readyToReceive() {
+        _MtGuard g(_lock);
+        return count>0 || _closed.load(std::memory_order_relaxed) ||
+               (_extEnabled && extWriteIdx.load(std::memory_order_acquire)!=extReadIdx.load(std::memory_order_relaxed));
+    }
     void* getRecvMonitor() { return recvMonitor; }
     bool isExtEnabled() { return _extEnabled; }
 };
@@ -334,7 +566,7 @@ template<typename Case>
 int tryOne(Case& c, int idx) {
     auto r=c.channel->tryReceive();
     if(!r.error) {
-        c.handler(r.value);
+        c.handler(std::move(r.value));
         return idx;
     }
     return -1;
@@ -369,6 +601,16 @@ bool allClosed(First& first, Rest&... rest) {
     return isCaseClosed(first) && allClosed(rest...);
 }
 
+// True if any RecvCase channel would not block (value ready or closed)
+template<typename Case>
+bool isCaseReady(Case& c) { return c.channel->readyToReceive(); }
+inline bool isCaseReady(DefaultCase&) { return false; }
+
+template<typename... Cases>
+bool anyReady(Cases&... cases) {
+    return (... || isCaseReady(cases));
+}
+
 // Collect monitors from RecvCases (skip DefaultCase)
 template<typename Case>
 void collectMonitor(Case& c, void** monitors, int& idx) {
@@ -412,9 +654,15 @@ int select(Last last) {
         while(true) {
             auto r=last.channel->tryReceive();
             if(!r.error) { last.handler(r.value); return 0; }
-            if(last.channel->isClosed()) return SELECT_CLOSED;
+            if(last.channel->isClosed()) {
+                // A value may have been sent just before close (other worker thread)
+                r=last.channel->tryReceive();
+                if(!r.error) { last.handler(r.value); return 0; }
+                return SELECT_CLOSED;
+            }
+            using Ch=decltype(last.channel);
             void* mon=last.channel->getRecvMonitor();
-            _select_wait(&mon, 1);
+            _select_wait(&mon, 1, [](void* ch) { return ((Ch)ch)->readyToReceive(); }, last.channel);
         }
     }
 }
@@ -428,7 +676,11 @@ int select(Cases... cases) {
         int result=_select_detail::tryAll(0, cases...);
         if(result>=0) return result;
 
-        if(_select_detail::allClosed(cases...)) return SELECT_CLOSED;
+        if(_select_detail::allClosed(cases...)) {
+            // Values sent just before close (other worker thread) are still delivered
+            result=_select_detail::tryAll(0, cases...);
+            return result>=0 ? result : SELECT_CLOSED;
+        }
 
         if constexpr(hasDefault) {
             auto tup=std::tie(cases...);
@@ -440,7 +692,10 @@ int select(Cases... cases) {
         void* monitors[N];
         int mIdx=0;
         _select_detail::collectMonitors(monitors, mIdx, cases...);
-        _select_wait(monitors, N);
+        auto recheck=[&]() { return _select_detail::anyReady(cases...); };
+        _select_wait(monitors, N, [](void* fn) {
+            return (*(decltype(recheck)*)fn)();
+        }, &recheck);
     }
 }
 
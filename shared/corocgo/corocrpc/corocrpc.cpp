@@ -1,62 +1,206 @@
 #include "corocrpc.h"
 #include <cstring>
 #include <chrono>
+#include <algorithm>
 
 namespace corocrpc {
 
 // ── CRC16-IBM ─────────────────────────────────────────────────────────────
+// Slicing-by-N: table k holds the CRC of a byte followed by k zero bytes, so
+// N input bytes fold into the CRC with N independent lookups instead of a
+// chain of N dependent ones. Table 0 is the classic byte-at-a-time table.
 
-static const uint16_t CRC16_TABLE[256] = {
-    0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241,
-    0xC601, 0x06C0, 0x0780, 0xC741, 0x0500, 0xC5C1, 0xC481, 0x0440,
-    0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
-    0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841,
-    0xD801, 0x18C0, 0x1980, 0xD941, 0x1B00, 0xDBC1, 0xDA81, 0x1A40,
-    0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
-    0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641,
-    0xD201, 0x12C0, 0x1380, 0xD341, 0x1100, 0xD1C1, 0xD081, 0x1040,
-    0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
-    0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441,
-    0x3C00, 0xFCC1, 0xFD81, 0x3D40, 0xFF01, 0x3FC0, 0x3E80, 0xFE41,
-    0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
-    0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41,
-    0xEE01, 0x2EC0, 0x2F80, 0xEF41, 0x2D00, 0xEDC1, 0xEC81, 0x2C40,
-    0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
-    0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041,
-    0xA001, 0x60C0, 0x6180, 0xA141, 0x6300, 0xA3C1, 0xA281, 0x6240,
-    0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
-    0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41,
-    0xAA01, 0x6AC0, 0x6B80, 0xAB41, 0x6900, 0xA9C1, 0xA881, 0x6840,
-    0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
-    0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40,
-    0xB401, 0x74C0, 0x7580, 0xB541, 0x7700, 0xB7C1, 0xB681, 0x7640,
-    0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
-    0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241,
-    0x9601, 0x56C0, 0x5780, 0x9741, 0x5500, 0x95C1, 0x9481, 0x5440,
-    0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
-    0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841,
-    0x8801, 0x48C0, 0x4980, 0x8941, 0x4B00, 0x8BC1, 0x8A81, 0x4A40,
-    0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
-    0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641,
-    0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040
+struct Crc16Tables {
+    uint16_t t[COROCRPC_CRC_SLICES][256];
 };
 
-static uint16_t crc16(const uint8_t* data, size_t len) {
+static constexpr Crc16Tables makeCrc16Tables() {
+    Crc16Tables tb{};
+    for (int i = 0; i < 256; i++) {
+        uint16_t c = (uint16_t)i;
+        for (int b = 0; b < 8; b++) c = (c & 1) ? (uint16_t)((c >> 1) ^ 0xA001) : (uint16_t)(c >> 1);
+        tb.t[0][i] = c;
+    }
+    for (int k = 1; k < COROCRPC_CRC_SLICES; k++)
+        for (int i = 0; i < 256; i++) {
+            uint16_t prev = tb.t[k - 1][i];
+            tb.t[k][i] = (uint16_t)((prev >> 8) ^ tb.t[0][prev & 0xFF]);
+        }
+    return tb;
+}
+
+static constexpr Crc16Tables CRC16 = makeCrc16Tables();
+static_assert(CRC16.t[0][1] == 0xC0C1 && CRC16.t[0][128] == 0xA001 && CRC16.t[0][255] == 0x4040,
+              "CRC16-IBM table");
+
+uint16_t crc16(const uint8_t* data, size_t len) {
+    const auto& t = CRC16.t;
     uint16_t crc = 0xFFFF;
-    for (size_t i = 0; i < len; i++) {
-        uint8_t idx = (uint8_t)(crc ^ data[i]);
-        crc = (crc >> 8) ^ CRC16_TABLE[idx];
+#if COROCRPC_CRC_SLICES == 8
+    for (; len >= 8; data += 8, len -= 8) {
+        crc = t[7][(uint8_t)(data[0] ^ crc)] ^ t[6][(uint8_t)(data[1] ^ (crc >> 8))] ^
+              t[5][data[2]] ^ t[4][data[3]] ^ t[3][data[4]] ^ t[2][data[5]] ^
+              t[1][data[6]] ^ t[0][data[7]];
+    }
+#elif COROCRPC_CRC_SLICES == 4
+    for (; len >= 4; data += 4, len -= 4) {
+        crc = t[3][(uint8_t)(data[0] ^ crc)] ^ t[2][(uint8_t)(data[1] ^ (crc >> 8))] ^
+              t[1][data[2]] ^ t[0][data[3]];
     }
+#elif COROCRPC_CRC_SLICES != 1
+#error "COROCRPC_CRC_SLICES must be 1, 4 or 8"
+#endif
+    for (; len > 0; data++, len--)
+        crc = (uint16_t)((crc >> 8) ^ t[0][(uint8_t)(crc ^ *data)]);
     return crc;
 }
 
+// ── PacketBuf ─────────────────────────────────────────────────────────────
+
+struct PacketBlock {
+    uint8_t      bytes[SF_BUFFER_SIZE];
+    uint16_t     begin;
+    uint16_t     end;
+    uint16_t     channel;
+    uint32_t     trace;
+    PacketBlock* next;      // free list
+};
+
+namespace {
+struct PacketPool {
+    PacketBlock*       blocks;
+    PacketBlock*       freeList = nullptr;
+    int                inUse    = 0;
+    int                peak     = 0;
+    corocgo::_SpinLock lock;
+#if COROCGO_HAS_THREADS
+    // acquire() parks here while the slab is empty. Writer threads release
+    // buffers too, so the wait rechecks `releases` after registering.
+    void*              waiters  = corocgo::_monitor_ts_create();
+    std::atomic<int>   releases{0};
+#else
+    void*              waiters  = corocgo::_monitor_create();
+#endif
+
+    PacketPool() : blocks(new PacketBlock[COROCRPC_PACKET_POOL]) {
+        for (int i = COROCRPC_PACKET_POOL - 1; i >= 0; i--) {
+            blocks[i].next = freeList;
+            freeList = &blocks[i];
+        }
+    }
+};
+}
+
+// Never destroyed: handles in static objects may be released during exit
+static PacketPool& packetPool() {
+    static PacketPool* pool = new PacketPool();
+    return *pool;
+}
+
+PacketBuf PacketBuf::tryAcquire(uint16_t headroom) {
+    PacketPool& pool = packetPool();
+    PacketBlock* blk;
+    {
+        std::lock_guard<corocgo::_SpinLock> g(pool.lock);
+        blk = pool.freeList;
+        if (!blk) return {};
+        pool.freeList = blk->next;
+        if (++pool.inUse > pool.peak) pool.peak = pool.inUse;
+    }
+    blk->begin   = headroom;
+    blk->end     = headroom;
+    blk->channel = 0;
+    blk->trace   = 0;
+    PacketBuf buf;
+    buf._blk = blk;
+    return buf;
+}
+
+PacketBuf PacketBuf::acquire(uint16_t headroom) {
+    PacketPool& pool = packetPool();
+    while (true) {
+#if COROCGO_HAS_THREADS
+        int seen = pool.releases.load(std::memory_order_acquire);
+#endif
+        PacketBuf buf = tryAcquire(headroom);
+        if (buf) return buf;
+        // Slab exhausted — sleep until reset() hands a buffer back
+#if COROCGO_HAS_THREADS
+        corocgo::_monitor_ts_wait(pool.waiters, nullptr, &pool.releases, seen);
+#else
+        corocgo::_monitor_wait(pool.waiters);
+#endif
+    }
+}
+
+void PacketBuf::reset() {
+    if (!_blk) return;
+    PacketPool& pool = packetPool();
+    {
+        std::lock_guard<corocgo::_SpinLock> g(pool.lock);
+        _blk->next    = pool.freeList;
+        pool.freeList = _blk;
+        pool.inUse--;
+    }
+    _blk = nullptr;
+#if COROCGO_HAS_THREADS
+    pool.releases.fetch_add(1, std::memory_order_seq_cst);
+    corocgo::_monitor_ts_wake_external(pool.waiters);   // one load when nobody waits
+#else
+    corocgo::_monitor_wake(pool.waiters);
+#endif
+}
+
+PacketBuf& PacketBuf::operator=(PacketBuf&& o) noexcept {
+    if (this != &o) {
+        reset();
+        _blk   = o._blk;
+        o._blk = nullptr;
+    }
+    return *this;
+}
+
+uint8_t*       PacketBuf::data()           { return _blk->bytes + _blk->begin; }
+const uint8_t* PacketBuf::data() const     { return _blk->bytes + _blk->begin; }
+uint16_t       PacketBuf::size() const     { return _blk ? _blk->end - _blk->begin : 0; }
+uint16_t       PacketBuf::headroom() const { return _blk ? _blk->begin : 0; }
+uint16_t       PacketBuf::tailroom() const { return _blk ? SF_BUFFER_SIZE - _blk->end : 0; }
+uint16_t       PacketBuf::channel() const  { return _blk ? _blk->channel : 0; }
+uint8_t*       PacketBuf::raw()            { return _blk->bytes; }
+void           PacketBuf::setChannel(uint16_t ch) { _blk->channel = ch; }
+uint32_t       PacketBuf::trace() const    { return _blk ? _blk->trace : 0; }
+void           PacketBuf::setTrace(uint32_t t) { _blk->trace = t; }
+
+void PacketBuf::setRange(uint16_t begin, uint16_t len) {
+    _blk->begin = begin;
+    _blk->end   = begin + len;
+}
+
+uint8_t* PacketBuf::push(uint16_t n) {
+    if (!_blk || _blk->begin < n) return nullptr;
+    _blk->begin -= n;
+    return data();
+}
+
+bool PacketBuf::append(const void* src, uint16_t n) {
+    if (!_blk || n > tailroom()) return false;
+    if (src && n > 0) memcpy(_blk->bytes + _blk->end, src, n);
+    _blk->end += n;
+    return true;
+}
+
+PacketPoolStats packetPoolStats() {
+    PacketPool& pool = packetPool();
+    std::lock_guard<corocgo::_SpinLock> g(pool.lock);
+    return {COROCRPC_PACKET_POOL, pool.inUse, pool.peak};
+}
+
 // ── StreamFramer ──────────────────────────────────────────────────────────
 
-StreamFramer::StreamFramer()
-    : state_(State::SEARCH_MAGIC_1), bytes_received_(0), content_size_(0) {
+StreamFramer::StreamFramer() {
     writeCh = corocgo::makeChannel<RawChunk>(8);
-    readCh  = corocgo::makeChannel<FramedPacket>(4);
-    corocgo::coro([this]() { _parseLoop(); });
+    readCh  = corocgo::makeChannel<PacketBuf>(READ_QUEUE);
+    corocgo::coro_named("framer-parse", [this]() { _parseLoop(); });
 }
 
 StreamFramer::~StreamFramer() {
@@ -66,39 +210,38 @@ StreamFramer::~StreamFramer() {
     delete readCh;
 }
 
+void StreamFramer::writeHeader(uint8_t* h, uint16_t channel, const uint8_t* content, uint16_t length) {
+    h[0] = MAGIC_BYTE_1;
+    h[1] = MAGIC_BYTE_2;
+    write_u16_le(&h[2], length);
+    write_u16_le(&h[4], (length > 0) ? crc16(content, length) : 0xFFFF);
+    h[6] = 0x00;
+    h[7] = 0x00;
+    write_u16_le(&h[8], channel);
+    write_u16_le(&h[10], crc16(h, 10));
+}
+
+bool StreamFramer::frame(PacketBuf& buf, uint16_t channel) {
+    if (!buf || buf.size() > MAX_CONTENT_SIZE || buf.headroom() < HEADER_SIZE) return false;
+    uint16_t length = buf.size();
+    const uint8_t* content = buf.data();
+    writeHeader(buf.push(HEADER_SIZE), channel, content, length);
+    buf.setChannel(channel);
+    return true;
+}
+
 FramedPacket StreamFramer::createPacket(uint16_t channel, const char* buffer, unsigned int length) {
     FramedPacket fp{};
     if (length > MAX_CONTENT_SIZE) return fp;  // size==0 signals error
 
-    fp.data[0] = MAGIC_BYTE_1;
-    fp.data[1] = MAGIC_BYTE_2;
-    write_u16_le(&fp.data[2], static_cast<uint16_t>(length));
-
-    uint16_t content_crc = (length > 0)
-        ? crc16(reinterpret_cast<const uint8_t*>(buffer), length)
-        : 0xFFFF;
-    write_u16_le(&fp.data[4], content_crc);
-
-    fp.data[6] = 0x00;
-    fp.data[7] = 0x00;
-    write_u16_le(&fp.data[8], channel);
-
-    uint16_t header_crc = crc16(fp.data, 10);
-    write_u16_le(&fp.data[10], header_crc);
-
     if (length > 0) std::memcpy(&fp.data[HEADER_SIZE], buffer, length);
+    writeHeader(fp.data, channel, &fp.data[HEADER_SIZE], static_cast<uint16_t>(length));
 
     fp.size    = static_cast<uint16_t>(HEADER_SIZE + length);
     fp.channel = channel;
     return fp;
 }
 
-void StreamFramer::reset() {
-    state_ = State::SEARCH_MAGIC_1;
-    bytes_received_ = 0;
-    content_size_ = 0;
-}
-
 uint16_t StreamFramer::read_u16_le(const uint8_t* p) {
     return uint16_t(p[0]) | (uint16_t(p[1]) << 8);
 }
@@ -108,103 +251,131 @@ void StreamFramer::write_u16_le(uint8_t* p, uint16_t v) {
     p[1] = uint8_t((v >> 8) & 0xFF);
 }
 
-void StreamFramer::_emit(uint16_t channel, uint16_t totalSize) {
-    FramedPacket fp{};
-    fp.channel = channel;
-    fp.size    = totalSize;
-    std::memcpy(fp.data, input_buffer_, totalSize);
-    readCh->send(fp);  // yields until consumer reads if channel is full
+// Hands the complete frame at head_ to readCh (content range, header in the
+// headroom). Whichever is smaller gets copied: a frame followed by more input
+// is copied out, otherwise the staging buffer itself goes out as the frame
+// and the remaining input moves to a fresh one.
+void StreamFramer::_emit(uint16_t channel, size_t contentSize) {
+    size_t total    = HEADER_SIZE + contentSize;
+    size_t end      = head_ + total;
+    size_t leftover = fill_ - end;
+    PacketBuf out;
+    if (total <= leftover) {
+        out = PacketBuf::acquire();
+        std::memcpy(out.raw(), stage_.raw() + head_, total);
+        out.setRange(HEADER_SIZE, static_cast<uint16_t>(contentSize));
+        stats_.copied += total;
+        head_ = end;
+    } else {
+        PacketBuf next = PacketBuf::acquire();
+        if (leftover > 0) std::memcpy(next.raw(), stage_.raw() + end, leftover);
+        stage_.setRange(static_cast<uint16_t>(head_ + HEADER_SIZE), static_cast<uint16_t>(contentSize));
+        out    = std::move(stage_);
+        stage_ = std::move(next);
+        stats_.copied += leftover;
+        head_ = 0;
+        fill_ = leftover;
+    }
+    out.setChannel(channel);
+    stats_.frames++;
+    readCh->send(std::move(out));  // yields until consumer reads if channel is full
 }
 
-void StreamFramer::_writeBytesInternal(const uint8_t* data, unsigned int length, int depth) {
-    if (depth > 5) { reset(); return; }
+// Parses every complete frame in the staged input. Stops at a partial frame
+// (head_ left on its magic) or when the input is used up.
+void StreamFramer::_parse() {
+    while (head_ < fill_) {
+        const uint8_t* p = stage_.raw() + head_;
+        size_t avail = fill_ - head_;
+        if (p[0] != MAGIC_BYTE_1) {
+            const void* m = std::memchr(p, MAGIC_BYTE_1, avail);
+            size_t skip = m ? static_cast<size_t>(static_cast<const uint8_t*>(m) - p) : avail;
+            stats_.skipped += skip;
+            head_ += skip;
+            continue;
+        }
+        if (avail < 2) break;
+        if (p[1] != MAGIC_BYTE_2) { stats_.skipped++; head_++; continue; }
+        if (avail < HEADER_SIZE) break;
+
+        uint16_t contentSize = read_u16_le(p + 2);
+        if (contentSize > MAX_CONTENT_SIZE || read_u16_le(p + 10) != crc16(p, 10)) {
+            // False magic or damaged header: rescan from the byte after it
+            stats_.headerErrors++;
+            stats_.skipped += 2;
+            head_ += 2;
+            continue;
+        }
+        if (avail < HEADER_SIZE + contentSize) break;
+        if (read_u16_le(p + 4) != crc16(p + HEADER_SIZE, contentSize)) {
+            // Damaged content, or a truncated frame whose "content" is the
+            // next frames — rescan it rather than dropping it whole
+            stats_.contentErrors++;
+            stats_.skipped += 2;
+            head_ += 2;
+            continue;
+        }
+        _emit(read_u16_le(p + 8), contentSize);
+    }
+    if (head_ == fill_) head_ = fill_ = 0;
+}
 
-    unsigned int offset = 0;
-    while (offset < length) {
-        if (state_ == State::SEARCH_MAGIC_1) {
-            if (data[offset] == MAGIC_BYTE_1) {
-                input_buffer_[0] = data[offset];
-                bytes_received_ = 1;
-                state_ = State::SEARCH_MAGIC_2;
-            }
-            offset++;
-        } else if (state_ == State::SEARCH_MAGIC_2) {
-            if (data[offset] == MAGIC_BYTE_2) {
-                input_buffer_[1] = data[offset];
-                bytes_received_ = 2;
-                state_ = State::READING_HEADER;
-                offset++;
-            } else {
-                reset();
-                // Don't advance — retry this byte as SEARCH_MAGIC_1
-            }
-        } else if (state_ == State::READING_HEADER) {
-            size_t bytes_needed    = HEADER_SIZE - bytes_received_;
-            size_t bytes_available = length - offset;
-            size_t bytes_to_copy   = (bytes_needed < bytes_available) ? bytes_needed : bytes_available;
-            std::memcpy(&input_buffer_[bytes_received_], &data[offset], bytes_to_copy);
-            bytes_received_ += bytes_to_copy;
-            offset += bytes_to_copy;
-
-            if (bytes_received_ >= HEADER_SIZE) {
-                content_size_ = read_u16_le(&input_buffer_[2]);
-                if (content_size_ > MAX_CONTENT_SIZE) {
-                    uint8_t tmp[10]; std::memcpy(tmp, &input_buffer_[2], 10);
-                    reset(); _writeBytesInternal(tmp, 10, depth + 1); continue;
-                }
-                uint16_t expected_hcrc = read_u16_le(&input_buffer_[10]);
-                uint16_t actual_hcrc   = crc16(input_buffer_, 10);
-                if (expected_hcrc == actual_hcrc) {
-                    if (content_size_ == 0) {
-                        uint16_t ch = read_u16_le(&input_buffer_[8]);
-                        _emit(ch, static_cast<uint16_t>(HEADER_SIZE));
-                        reset();
-                    } else {
-                        state_ = State::READING_CONTENT;
-                    }
-                } else {
-                    uint8_t tmp[10]; std::memcpy(tmp, &input_buffer_[2], 10);
-                    reset(); _writeBytesInternal(tmp, 10, depth + 1);
-                }
-            }
-        } else { // READING_CONTENT
-            size_t bytes_needed    = (HEADER_SIZE + content_size_) - bytes_received_;
-            size_t bytes_available = length - offset;
-            size_t bytes_to_copy   = (bytes_needed < bytes_available) ? bytes_needed : bytes_available;
-            std::memcpy(&input_buffer_[bytes_received_], &data[offset], bytes_to_copy);
-            bytes_received_ += bytes_to_copy;
-            offset += bytes_to_copy;
-
-            if (bytes_received_ >= HEADER_SIZE + content_size_) {
-                uint16_t expected_ccrc = read_u16_le(&input_buffer_[4]);
-                uint16_t actual_ccrc   = crc16(&input_buffer_[HEADER_SIZE], content_size_);
-                if (expected_ccrc == actual_ccrc) {
-                    uint16_t ch = read_u16_le(&input_buffer_[8]);
-                    _emit(ch, static_cast<uint16_t>(HEADER_SIZE + content_size_));
-                }
-                reset();
-            }
+void StreamFramer::_writeBytesInternal(const uint8_t* data, size_t length) {
+    stats_.bytesIn += length;
+    while (length > 0) {
+        // Full: slide the partial frame to the front. _parse() never leaves a
+        // full buffer at head_ 0 (a BUFFER_SIZE frame is complete), so this
+        // always makes room.
+        if (fill_ == BUFFER_SIZE) {
+            fill_ -= head_;
+            std::memmove(stage_.raw(), stage_.raw() + head_, fill_);
+            stats_.copied += fill_;
+            head_ = 0;
         }
+        size_t n = std::min(length, BUFFER_SIZE - fill_);
+        std::memcpy(stage_.raw() + fill_, data, n);
+        fill_  += n;
+        data   += n;
+        length -= n;
+        _parse();
     }
 }
 
+void StreamFramer::write(const uint8_t* data, size_t length) {
+    if (!stage_) stage_ = PacketBuf::acquire();
+    _writeBytesInternal(data, length);
+}
+
 void StreamFramer::_parseLoop() {
     while (true) {
         auto res = writeCh->receive();
         if (res.error) break;  // writeCh closed → shut down
-        _writeBytesInternal(res.value.data, res.value.len, 0);
+        if (!stage_) stage_ = PacketBuf::acquire();
+        _writeBytesInternal(res.value.data, res.value.len);
     }
 }
 
 // ── RpcArg ────────────────────────────────────────────────────────────────
 
+RpcArg::RpcArg()
+    : buf(new char[RPC_ARG_BUF_SIZE]), capacity(RPC_ARG_BUF_SIZE), writeIdx(0), readIdx(0) {}
+
+RpcArg::~RpcArg() {
+    if (!_pool) delete[] buf;
+}
+
 void RpcArg::reset() {
     writeIdx = 0;
     readIdx  = 0;
 }
 
+bool RpcArg::grow(int needed) {
+    if (needed > RPC_ARG_BUF_SIZE || !_pool || capacity >= RPC_ARG_BUF_SIZE) return false;
+    return _pool->promote(this);
+}
+
 void RpcArg::putInt32(int32_t v) {
-    if (writeIdx + 4 > RPC_ARG_BUF_SIZE) return;
+    if (!fit(4)) return;
     buf[writeIdx++] = (char)( v        & 0xFF);
     buf[writeIdx++] = (char)((v >>  8) & 0xFF);
     buf[writeIdx++] = (char)((v >> 16) & 0xFF);
@@ -212,13 +383,13 @@ void RpcArg::putInt32(int32_t v) {
 }
 
 void RpcArg::putBool(bool v) {
-    if (writeIdx + 1 > RPC_ARG_BUF_SIZE) return;
+    if (!fit(1)) return;
     buf[writeIdx++] = v ? 1 : 0;
 }
 
 void RpcArg::putString(const char* s) {
     uint16_t len = (uint16_t)strlen(s);
-    if (writeIdx + 2 + len > RPC_ARG_BUF_SIZE) return;
+    if (!fit(2 + len)) return;
     buf[writeIdx++] = (char)( len       & 0xFF);
     buf[writeIdx++] = (char)((len >> 8) & 0xFF);
     memcpy(&buf[writeIdx], s, len);
@@ -226,13 +397,38 @@ void RpcArg::putString(const char* s) {
 }
 
 void RpcArg::putBuffer(const void* data, uint16_t len) {
-    if (writeIdx + 2 + len > RPC_ARG_BUF_SIZE) return;
+    if (!fit(2 + len)) return;
     buf[writeIdx++] = (char)( len       & 0xFF);
     buf[writeIdx++] = (char)((len >> 8) & 0xFF);
     memcpy(&buf[writeIdx], data, len);
     writeIdx += len;
 }
 
+void RpcArg::putVarUInt(uint32_t v) {
+    uint8_t tmp[5];
+    int n = 0;
+    do {
+        uint8_t b = v & 0x7F;
+        v >>= 7;
+        tmp[n++] = v ? (b | 0x80) : b;
+    } while (v);
+    if (!fit(n)) return;
+    memcpy(&buf[writeIdx], tmp, n);
+    writeIdx += n;
+}
+
+void RpcArg::putVarInt(int32_t v) {
+    putVarUInt(((uint32_t)v << 1) ^ (uint32_t)(v >> 31));
+}
+
+bool RpcArg::putAxisUpdate(int32_t device, int32_t axis, int32_t value) {
+    if (device < 0 || device > 15 || axis < 0 || axis > 0x0FFFFFFF) return false;
+    if (!fit(RPC_AXIS_UPDATE_MAX_SIZE)) return false;
+    putVarUInt(((uint32_t)axis << 4) | (uint32_t)device);
+    putVarInt(value);
+    return true;
+}
+
 int32_t RpcArg::getInt32() {
     if (readIdx + 4 > writeIdx) return 0;
     int32_t v = ((uint8_t)buf[readIdx  ]      ) |
@@ -243,6 +439,42 @@ int32_t RpcArg::getInt32() {
     return v;
 }
 
+// Decodes one LEB128 value from buf[idx..end). On truncated/overlong input
+// returns false and moves idx to end so later reads fail too.
+static bool readVarUInt(const char* buf, int& idx, int end, uint32_t& out) {
+    uint32_t v = 0;
+    for (int shift = 0; shift < 35 && idx < end; shift += 7) {
+        uint8_t b = (uint8_t)buf[idx++];
+        v |= (uint32_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) { out = v; return true; }
+    }
+    idx = end;
+    return false;
+}
+
+static int32_t zigzagDecode(uint32_t z) {
+    return (int32_t)((z >> 1) ^ (~(z & 1) + 1));
+}
+
+uint32_t RpcArg::getVarUInt() {
+    uint32_t v = 0;
+    return readVarUInt(buf, readIdx, writeIdx, v) ? v : 0;
+}
+
+int32_t RpcArg::getVarInt() {
+    return zigzagDecode(getVarUInt());
+}
+
+bool RpcArg::getAxisUpdate(int32_t& device, int32_t& axis, int32_t& value) {
+    uint32_t key = 0, z = 0;
+    if (!readVarUInt(buf, readIdx, writeIdx, key)) return false;
+    if (!readVarUInt(buf, readIdx, writeIdx, z))   return false;
+    device = (int32_t)(key & 0x0F);
+    axis   = (int32_t)(key >> 4);
+    value  = zigzagDecode(z);
+    return true;
+}
+
 bool RpcArg::getBool() {
     if (readIdx + 1 > writeIdx) return false;
     return buf[readIdx++] != 0;
@@ -271,11 +503,187 @@ uint16_t RpcArg::getBuffer(void* out, uint16_t maxLen) {
     return copy;
 }
 
+// ── RpcArgPool ────────────────────────────────────────────────────────────
+
+// One allocation of `count` buffers of one class. Free buffers are chained
+// through their first bytes.
+struct RpcArgSlab {
+    char* mem;
+    int   count;
+    int   used;
+    char* freeList;
+};
+
+static constexpr int ARG_BLOCK_ALIGN = 8;
+
+RpcArgPool::RpcArgPool(const RpcArgPoolConfig& cfg) : _cfg(cfg), _monitor(corocgo::_monitor_create()) {
+    if (_cfg.slabSize  < 1) _cfg.slabSize  = 1;
+    if (_cfg.highWater < 1) _cfg.highWater = 1;
+    if (_cfg.lowWater  < 0) _cfg.lowWater  = 0;
+    _classes[LARGE].size = RPC_ARG_BUF_SIZE;
+    int small = (_cfg.smallSize + ARG_BLOCK_ALIGN - 1) / ARG_BLOCK_ALIGN * ARG_BLOCK_ALIGN;
+    _classes[SMALL].size = (small > 0 && small < RPC_ARG_BUF_SIZE) ? small : 0;   // 0: class unused
+}
+
+RpcArgPool::~RpcArgPool() {
+    for (Class& c : _classes)
+        for (RpcArgSlab* slab : c.slabs) {
+            delete[] slab->mem;
+            delete slab;
+        }
+    for (RpcArg* a : _allArgs) delete a;
+    corocgo::_monitor_destroy(_monitor);
+}
+
+// Gives `arg` a buffer of class `cls`, adding a slab while the class is
+// below `limit` buffers.
+bool RpcArgPool::takeBlock(int cls, RpcArg* arg, int limit) {
+    Class& c = _classes[cls];
+    if (c.size == 0) return false;
+    RpcArgSlab* slab = nullptr;
+    for (RpcArgSlab* sl : c.slabs)
+        if (sl->freeList) { slab = sl; break; }
+    if (!slab) {
+        int n = std::min(_cfg.slabSize, limit - c.capacity);
+        if (n <= 0) return false;
+        slab           = new RpcArgSlab();
+        slab->mem      = new char[(size_t)n * c.size];
+        slab->count    = n;
+        slab->used     = 0;
+        slab->freeList = nullptr;
+        for (int i = n - 1; i >= 0; i--) {
+            char* block = slab->mem + (size_t)i * c.size;
+            memcpy(block, &slab->freeList, sizeof(char*));
+            slab->freeList = block;
+        }
+        c.slabs.push_back(slab);
+        c.capacity += n;
+    }
+    char* block = slab->freeList;
+    memcpy(&slab->freeList, block, sizeof(char*));
+    slab->used++;
+    if (++c.inUse > c.peak) c.peak = c.inUse;
+    arg->buf      = block;
+    arg->capacity = c.size;
+    arg->_slab    = slab;
+    return true;
+}
+
+void RpcArgPool::releaseBlock(RpcArg* arg) {
+    RpcArgSlab* slab = arg->_slab;
+    Class& c = _classes[arg->capacity == RPC_ARG_BUF_SIZE ? LARGE : SMALL];
+    memcpy(arg->buf, &slab->freeList, sizeof(char*));
+    slab->freeList = arg->buf;
+    slab->used--;
+    c.inUse--;
+    arg->buf   = nullptr;
+    arg->_slab = nullptr;
+    // Give an idle slab back while the class keeps lowWater buffers
+    if (slab->used == 0 && c.capacity - slab->count >= _cfg.lowWater) {
+        c.slabs.erase(std::find(c.slabs.begin(), c.slabs.end(), slab));
+        c.capacity -= slab->count;
+        delete[] slab->mem;
+        delete slab;
+        _stats.slabsFreed++;
+    }
+}
+
+// Moves a small arg's contents into a large buffer. May go one slab past the
+// large class's high-water mark: failing a write halfway through building a
+// message is worse than a little extra memory.
+bool RpcArgPool::promote(RpcArg* arg) {
+    RpcArg big{RpcArg::PoolTag{}};
+    big._pool = this;   // ~RpcArg must not free a pool block
+    if (!takeBlock(LARGE, &big, _cfg.highWater) &&
+        !takeBlock(LARGE, &big, _classes[LARGE].capacity + 1)) return false;
+    memcpy(big.buf, arg->buf, arg->writeIdx);
+    releaseBlock(arg);
+    arg->buf      = big.buf;
+    arg->capacity = big.capacity;
+    arg->_slab    = big._slab;
+    _stats.promotions++;
+    return true;
+}
+
+RpcArg* RpcArgPool::tryGet(int sizeHint) {
+    RpcArg* arg = _freeArgs;
+    if (arg) {
+        _freeArgs = arg->_nextFree;
+    } else {
+        arg = new RpcArg(RpcArg::PoolTag{});
+        arg->_pool = this;
+        _allArgs.push_back(arg);
+    }
+    bool ok = false;
+    if (sizeHint <= _classes[SMALL].size) {
+        ok = takeBlock(SMALL, arg, _cfg.highWater);
+        if (!ok && takeBlock(LARGE, arg, _cfg.highWater)) {
+            ok = true;
+            if (_classes[SMALL].size) _stats.borrowed++;
+        }
+    } else if (sizeHint <= RPC_ARG_BUF_SIZE) {
+        ok = takeBlock(LARGE, arg, _cfg.highWater);
+    }
+    if (!ok) {
+        arg->_nextFree = _freeArgs;
+        _freeArgs      = arg;
+        return nullptr;
+    }
+    arg->reset();
+    return arg;
+}
+
+RpcArg* RpcArgPool::get(int sizeHint) {
+    RpcArg* arg = tryGet(sizeHint);
+    while (!arg && sizeHint <= RPC_ARG_BUF_SIZE && corocgo::coro_self()) {
+        _stats.waits++;
+        _waiters++;
+        corocgo::_monitor_wait(_monitor);
+        _waiters--;
+        arg = tryGet(sizeHint);
+    }
+    return arg;
+}
+
+void RpcArgPool::dispose(RpcArg* arg) {
+    if (!arg || arg->_pool != this || !arg->buf) return;
+    releaseBlock(arg);
+    arg->_nextFree = _freeArgs;
+    _freeArgs      = arg;
+    if (_waiters > 0) corocgo::_monitor_wake(_monitor);
+}
+
+RpcArgPoolStats RpcArgPool::stats() const {
+    RpcArgPoolStats   st     = _stats;
+    RpcArgClassStats* out[2] = {&st.small, &st.large};
+    for (int i = 0; i < 2; i++) {
+        out[i]->size     = _classes[i].size;
+        out[i]->capacity = _classes[i].capacity;
+        out[i]->inUse    = _classes[i].inUse;
+        out[i]->peak     = _classes[i].peak;
+    }
+    return st;
+}
+
 // ── Time helper (used by RpcManager and streaming) ───────────────────────
 
-static int64_t nowMs() {
+static int64_t nowUs() {
     using namespace std::chrono;
-    return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// ── Packet helpers ────────────────────────────────────────────────────────
+
+static void putRpcHeader(RpcPacket& pkt, uint16_t methodId, uint32_t callId, uint8_t flags) {
+    uint8_t h[RPC_HEADER_SIZE];
+    h[0] = (uint8_t)( methodId       & 0xFF);
+    h[1] = (uint8_t)((methodId >>  8) & 0xFF);
+    h[2] = (uint8_t)( callId          & 0xFF);
+    h[3] = (uint8_t)((callId  >>  8)  & 0xFF);
+    h[4] = (uint8_t)((callId  >> 16)  & 0xFF);
+    h[5] = (uint8_t)((callId  >> 24)  & 0xFF);
+    h[6] = flags;
+    pkt.append(h, RPC_HEADER_SIZE);
 }
 
 #ifdef COROCRPC_STREAMING
@@ -286,20 +694,22 @@ static RpcPacket makeStreamPacket(uint16_t methodId, uint32_t streamId,
                                    uint8_t flags,
                                    const uint8_t* payload = nullptr,
                                    int payloadLen = 0) {
-    RpcPacket pkt{};
-    pkt.data[0] = (uint8_t)(methodId & 0xFF);
-    pkt.data[1] = (uint8_t)(methodId >> 8);
-    pkt.data[2] = (uint8_t)(streamId & 0xFF);
-    pkt.data[3] = (uint8_t)((streamId >> 8) & 0xFF);
-    pkt.data[4] = (uint8_t)((streamId >> 16) & 0xFF);
-    pkt.data[5] = (uint8_t)((streamId >> 24) & 0xFF);
-    pkt.data[6] = flags;
+    RpcPacket pkt = PacketBuf::acquire(StreamFramer::HEADER_SIZE);
+    putRpcHeader(pkt, methodId, streamId, flags);
     if (payload && payloadLen > 0)
-        memcpy(&pkt.data[RPC_HEADER_SIZE], payload, payloadLen);
-    pkt.size = (uint16_t)(RPC_HEADER_SIZE + payloadLen);
+        pkt.append(payload, (uint16_t)payloadLen);
     return pkt;
 }
 
+// Payload of a received packet (after the RPC header) into buf; returns bytes copied
+static int copyPayload(const RpcPacket& pkt, uint8_t* buf, int maxSize) {
+    int payloadLen = pkt.size() - RPC_HEADER_SIZE;
+    if (payloadLen <= 0) return 0;
+    int toCopy = (payloadLen < maxSize) ? payloadLen : maxSize;
+    memcpy(buf, pkt.data() + RPC_HEADER_SIZE, toCopy);
+    return toCopy;
+}
+
 // ── RpcStreamClient ───────────────────────────────────────────────────────
 
 RpcStreamClient::RpcStreamClient(RpcStreamSession* session,
@@ -315,11 +725,11 @@ RpcStreamClient::RpcStreamClient(RpcStreamSession* session,
 
 RpcStreamState RpcStreamClient::waitReadySend(int timeoutMs) {
     int tms = (timeoutMs < 0) ? _timeoutMs : timeoutMs;
-    _session->waitDeadlineMs = nowMs() + tms;
+    _session->manager->_armDeadline(_session->waitDeadline, tms);
     auto res = _session->inCh->receive();
-    _session->waitDeadlineMs = 0;
+    _session->manager->_disarmDeadline(_session->waitDeadline);
     if (res.error) return RpcStreamState::ABORTED;
-    uint8_t flags = res.value.data[6];
+    uint8_t flags = res.value.data()[6];
     if (flags & RPC_FLAG_STREAM_TIMEOUT) return RpcStreamState::TIMEOUT;
     if (flags & RPC_FLAG_STREAM_ABORT)   return RpcStreamState::ABORTED;
     if (flags & RPC_FLAG_STREAM_READY)   return RpcStreamState::SEND_READY;
@@ -332,7 +742,7 @@ int RpcStreamClient::send(const uint8_t* buf, int size, int offset) {
     RpcPacket pkt = makeStreamPacket(_methodId, _streamId,
                                       RPC_FLAG_IS_STREAM,
                                       buf + offset, toSend);
-    _outCh->send(pkt);
+    _outCh->send(std::move(pkt));
     corocgo::sleep(0);
     return toSend;
 }
@@ -342,22 +752,22 @@ void RpcStreamClient::finishSend() {
     _sendFinished = true;
     RpcPacket pkt = makeStreamPacket(_methodId, _streamId,
                                       RPC_FLAG_IS_STREAM | RPC_FLAG_STREAM_END);
-    _outCh->send(pkt);
+    _outCh->send(std::move(pkt));
 }
 
 RpcStreamState RpcStreamClient::waitReadyReceive(int timeoutMs) {
     RpcPacket ready = makeStreamPacket(_methodId, _streamId,
                                         RPC_FLAG_IS_STREAM | RPC_FLAG_STREAM_READY);
-    _outCh->send(ready);
+    _outCh->send(std::move(ready));
 
     int tms = (timeoutMs < 0) ? _timeoutMs : timeoutMs;
-    _session->waitDeadlineMs = nowMs() + tms;
+    _session->manager->_armDeadline(_session->waitDeadline, tms);
     auto res = _session->inCh->receive();
-    _session->waitDeadlineMs = 0;
+    _session->manager->_disarmDeadline(_session->waitDeadline);
     if (res.error) return RpcStreamState::ABORTED;
-    _pendingPacket    = res.value;
+    _pendingPacket    = std::move(res.value);
     _hasPendingPacket = true;
-    uint8_t flags = res.value.data[6];
+    uint8_t flags = _pendingPacket.data()[6];
     if (flags & RPC_FLAG_STREAM_TIMEOUT) return RpcStreamState::TIMEOUT;
     if (flags & RPC_FLAG_STREAM_ABORT)   return RpcStreamState::ABORTED;
     if (flags & RPC_FLAG_STREAM_END) {
@@ -370,17 +780,15 @@ RpcStreamState RpcStreamClient::waitReadyReceive(int timeoutMs) {
 int RpcStreamClient::receive(uint8_t* buf, int maxSize) {
     if (!_hasPendingPacket) return 0;
     _hasPendingPacket = false;
-    int payloadLen = _pendingPacket.size - RPC_HEADER_SIZE;
-    if (payloadLen <= 0) return 0;
-    int toCopy = (payloadLen < maxSize) ? payloadLen : maxSize;
-    memcpy(buf, &_pendingPacket.data[RPC_HEADER_SIZE], toCopy);
-    return toCopy;
+    int n = copyPayload(_pendingPacket, buf, maxSize);
+    _pendingPacket.reset();
+    return n;
 }
 
 void RpcStreamClient::cancel() {
     RpcPacket pkt = makeStreamPacket(_methodId, _streamId,
                                       RPC_FLAG_IS_STREAM | RPC_FLAG_STREAM_ABORT);
-    _outCh->send(pkt);
+    _outCh->send(std::move(pkt));
     _cleanup(_streamId);
 }
 
@@ -421,16 +829,16 @@ RpcStreamServer::RpcStreamServer(RpcStreamSession* session,
 RpcStreamState RpcStreamServer::waitReadyReceive(int timeoutMs) {
     RpcPacket ready = makeStreamPacket(_methodId, _streamId,
                                         RPC_FLAG_IS_STREAM | RPC_FLAG_IS_RESPONSE | RPC_FLAG_STREAM_READY);
-    _outCh->send(ready);
+    _outCh->send(std::move(ready));
 
     int tms = (timeoutMs < 0) ? _timeoutMs : timeoutMs;
-    _session->waitDeadlineMs = nowMs() + tms;
+    _session->manager->_armDeadline(_session->waitDeadline, tms);
     auto res = _session->inCh->receive();
-    _session->waitDeadlineMs = 0;
+    _session->manager->_disarmDeadline(_session->waitDeadline);
     if (res.error) return RpcStreamState::ABORTED;
-    _pendingPacket    = res.value;
+    _pendingPacket    = std::move(res.value);
     _hasPendingPacket = true;
-    uint8_t flags = res.value.data[6];
+    uint8_t flags = _pendingPacket.data()[6];
     if (flags & RPC_FLAG_STREAM_TIMEOUT) return RpcStreamState::TIMEOUT;
     if (flags & RPC_FLAG_STREAM_ABORT)   return RpcStreamState::ABORTED;
     if (flags & RPC_FLAG_STREAM_END)     return RpcStreamState::RECEIVE_FINISH;
@@ -440,20 +848,18 @@ RpcStreamState RpcStreamServer::waitReadyReceive(int timeoutMs) {
 int RpcStreamServer::receive(uint8_t* buf, int maxSize) {
     if (!_hasPendingPacket) return 0;
     _hasPendingPacket = false;
-    int payloadLen = _pendingPacket.size - RPC_HEADER_SIZE;
-    if (payloadLen <= 0) return 0;
-    int toCopy = (payloadLen < maxSize) ? payloadLen : maxSize;
-    memcpy(buf, &_pendingPacket.data[RPC_HEADER_SIZE], toCopy);
-    return toCopy;
+    int n = copyPayload(_pendingPacket, buf, maxSize);
+    _pendingPacket.reset();
+    return n;
 }
 
 RpcStreamState RpcStreamServer::waitReadySend(int timeoutMs) {
     int tms = (timeoutMs < 0) ? _timeoutMs : timeoutMs;
-    _session->waitDeadlineMs = nowMs() + tms;
+    _session->manager->_armDeadline(_session->waitDeadline, tms);
     auto res = _session->inCh->receive();
-    _session->waitDeadlineMs = 0;
+    _session->manager->_disarmDeadline(_session->waitDeadline);
     if (res.error) return RpcStreamState::ABORTED;
-    uint8_t flags = res.value.data[6];
+    uint8_t flags = res.value.data()[6];
     if (flags & RPC_FLAG_STREAM_TIMEOUT) return RpcStreamState::TIMEOUT;
     if (flags & RPC_FLAG_STREAM_ABORT)   return RpcStreamState::ABORTED;
     if (flags & RPC_FLAG_STREAM_READY)   return RpcStreamState::SEND_READY;
@@ -466,7 +872,7 @@ int RpcStreamServer::send(const uint8_t* buf, int size, int offset) {
     RpcPacket pkt = makeStreamPacket(_methodId, _streamId,
                                       RPC_FLAG_IS_STREAM | RPC_FLAG_IS_RESPONSE,
                                       buf + offset, toSend);
-    _outCh->send(pkt);
+    _outCh->send(std::move(pkt));
     corocgo::sleep(0);
     return toSend;
 }
@@ -476,13 +882,13 @@ void RpcStreamServer::finishSend() {
     _sendFinished = true;
     RpcPacket pkt = makeStreamPacket(_methodId, _streamId,
                                       RPC_FLAG_IS_STREAM | RPC_FLAG_IS_RESPONSE | RPC_FLAG_STREAM_END);
-    _outCh->send(pkt);
+    _outCh->send(std::move(pkt));
 }
 
 void RpcStreamServer::cancel() {
     RpcPacket pkt = makeStreamPacket(_methodId, _streamId,
                                       RPC_FLAG_IS_STREAM | RPC_FLAG_IS_RESPONSE | RPC_FLAG_STREAM_ABORT);
-    _outCh->send(pkt);
+    _outCh->send(std::move(pkt));
 }
 
 void RpcStreamServer::sendAll(const uint8_t* buf, int size) {
@@ -499,38 +905,44 @@ void RpcStreamServer::sendAll(const uint8_t* buf, int size) {
 
 // ── RpcManager ────────────────────────────────────────────────────────────
 
-int64_t RpcManager::_nowMs() { return nowMs(); }
+int64_t RpcManager::_nowUs() { return nowUs(); }
 
-RpcPacket RpcManager::_makePacket(uint16_t methodId, uint32_t callId,
-                                   uint8_t flags, RpcArg* arg) {
-    RpcPacket pkt;
-    pkt.data[0] = (uint8_t)( methodId       & 0xFF);
-    pkt.data[1] = (uint8_t)((methodId >>  8) & 0xFF);
-    pkt.data[2] = (uint8_t)( callId          & 0xFF);
-    pkt.data[3] = (uint8_t)((callId  >>  8)  & 0xFF);
-    pkt.data[4] = (uint8_t)((callId  >> 16)  & 0xFF);
-    pkt.data[5] = (uint8_t)((callId  >> 24)  & 0xFF);
-    pkt.data[6] = flags;
-    int payloadLen = (arg && arg->writeIdx > 0) ? arg->writeIdx : 0;
-    if (payloadLen > 0) {
-        memcpy(&pkt.data[RPC_HEADER_SIZE], arg->buf, payloadLen);
+void RpcManager::_makePacket(RpcPacket& pkt, uint16_t methodId, uint32_t callId,
+                             uint8_t flags, RpcArg* arg) {
+    if (pkt) {
+        pkt.setRange(StreamFramer::HEADER_SIZE, 0);
+        pkt.setTrace(0);
+    } else {
+        pkt = PacketBuf::acquire(StreamFramer::HEADER_SIZE);
     }
-    pkt.size = (uint16_t)(RPC_HEADER_SIZE + payloadLen);
-    return pkt;
+    putRpcHeader(pkt, methodId, callId, flags);
+    int payloadLen = (arg && arg->writeIdx > 0) ? arg->writeIdx : 0;
+    if (payloadLen > 0) pkt.append(arg->buf, (uint16_t)payloadLen);
 }
 
 RpcManager::RpcManager(corocgo::Channel<RpcPacket>* outCh,
                         corocgo::Channel<RpcPacket>* inCh,
-                        int timeoutMs)
-    : _outCh(outCh), _inCh(inCh), _timeoutMs(timeoutMs),
-      _running(true), _nextCallId(1) {
-    memset(_poolUsed, 0, sizeof(_poolUsed));
-    corocgo::coro([this]() { _dispatchLoop(); });
-    corocgo::coro([this]() { _timeoutLoop(); });
+                        int timeoutMs,
+                        int maxInFlight,
+                        const RpcArgPoolConfig& argPool)
+    : _args(argPool), _outCh(outCh), _inCh(inCh), _timeoutMs(timeoutMs),
+      _running(true), _closed(false), _nextCallId(1),
+      _maxInFlight(maxInFlight > 0 ? maxInFlight : 1),
+      _windowMonitor(corocgo::_monitor_create()),
+      _timerTargetUs(INT64_MAX) {
+    corocgo::coro_named("rpc-dispatch", [this]() { _dispatchLoop(); });
+    corocgo::coro_named("rpc-timer", [this]() { _timerLoop(); });
 }
 
 RpcManager::~RpcManager() {
     _running = false;
+    while (_freeCalls) {
+        PendingCall* pc = _freeCalls;
+        _freeCalls = pc->nextFree;
+        corocgo::_monitor_destroy(pc->monitor);
+        delete pc;
+    }
+    corocgo::_monitor_destroy(_windowMonitor);
 }
 
 void RpcManager::registerMethod(uint16_t methodId,
@@ -538,57 +950,180 @@ void RpcManager::registerMethod(uint16_t methodId,
     _methods[methodId] = std::move(handler);
 }
 
-RpcArg* RpcManager::getRpcArg() {
-    for (int i = 0; i < POOL_SIZE; i++) {
-        if (!_poolUsed[i]) {
-            _poolUsed[i] = true;
-            _pool[i].reset();
-            return &_pool[i];
-        }
+RpcResult RpcManager::call(uint16_t methodId, RpcArg* arg) {
+    return callAsync(methodId, arg).get();
+}
+
+RpcFuture RpcManager::callAsync(uint16_t methodId, RpcArg* arg, int timeoutMs) {
+    while (_stats.inFlight >= (uint32_t)_maxInFlight && !_closed) {
+        _stats.windowStalls++;
+        corocgo::_monitor_wait(_windowMonitor);
     }
-    return nullptr; // pool exhausted
+
+    PendingCall* pc = _acquireCall();
+    if (_closed) {
+        pc->error = RPC_CLOSED;
+        pc->done  = true;
+        return RpcFuture(this, pc);
+    }
+
+    uint32_t callId = _nextCallId++;
+    _pending[callId] = pc;
+    _stats.calls++;
+    if (++_stats.inFlight > _stats.peakInFlight) _stats.peakInFlight = _stats.inFlight;
+    pc->deadline.id     = callId;
+    pc->deadline.stream = false;
+    _armDeadline(pc->deadline, timeoutMs < 0 ? _timeoutMs : timeoutMs);
+
+    RpcPacket pkt;
+    _makePacket(pkt, methodId, callId, 0x00, arg);
+    _outCh->send(std::move(pkt));
+    return RpcFuture(this, pc);
 }
 
-void RpcManager::disposeRpcArg(RpcArg* arg) {
-    if (!arg) return;
-    int idx = (int)(arg - _pool);
-    if (idx >= 0 && idx < POOL_SIZE) {
-        _poolUsed[idx] = false;
+void RpcManager::setMaxInFlight(int n) {
+    _maxInFlight = n > 0 ? n : 1;
+    corocgo::_monitor_wake_all(_windowMonitor);
+}
+
+RpcCallStats RpcManager::callStats() const {
+    return _stats;
+}
+
+RpcManager::PendingCall* RpcManager::_acquireCall() {
+    PendingCall* pc = _freeCalls;
+    if (pc) {
+        _freeCalls = pc->nextFree;
+    } else {
+        pc = new PendingCall();
+        pc->monitor = corocgo::_monitor_create();
+        _stats.pooledCalls++;
     }
+    pc->result    = nullptr;
+    pc->error     = RPC_OK;
+    pc->done      = false;
+    pc->abandoned = false;
+    return pc;
 }
 
-RpcResult RpcManager::call(uint16_t methodId, RpcArg* arg) {
-    uint32_t callId = _nextCallId++;
+void RpcManager::_releaseCall(PendingCall* pc) {
+    pc->nextFree = _freeCalls;
+    _freeCalls   = pc;
+}
+
+// Response, timeout or close: the call leaves the window. A call whose future
+// is gone is recycled here; otherwise its owner is woken.
+void RpcManager::_finishCall(PendingCall* pc, int error) {
+    _pending.erase(pc->deadline.id);
+    _disarmDeadline(pc->deadline);
+    pc->error = error;
+    pc->done  = true;
+    _stats.inFlight--;
+    corocgo::_monitor_wake(_windowMonitor);
+    if (pc->abandoned) {
+        disposeRpcArg(pc->result);
+        _releaseCall(pc);
+    } else {
+        corocgo::_monitor_wake(pc->monitor);
+    }
+}
+
+// ── RpcFuture ─────────────────────────────────────────────────────────────
+
+RpcFuture& RpcFuture::operator=(RpcFuture&& o) noexcept {
+    if (this != &o) {
+        drop();
+        _mgr    = o._mgr;
+        _call   = o._call;
+        o._call = nullptr;
+    }
+    return *this;
+}
+
+RpcFuture::~RpcFuture() {
+    drop();
+}
+
+void RpcFuture::drop() {
+    if (!_call) return;
+    if (_call->done) {
+        _mgr->disposeRpcArg(_call->result);
+        _mgr->_releaseCall(_call);
+    } else {
+        _call->abandoned = true;   // _finishCall recycles it
+    }
+    _call = nullptr;
+}
+
+RpcResult RpcFuture::get() {
+    if (!_call) return {RPC_CLOSED, nullptr};
+    while (!_call->done) corocgo::_monitor_wait(_call->monitor);
+    RpcResult r{_call->error, _call->error == RPC_OK ? _call->result : nullptr};
+    if (_call->error != RPC_OK) _mgr->disposeRpcArg(_call->result);
+    _mgr->_releaseCall(_call);
+    _call = nullptr;
+    return r;
+}
 
-    PendingCall pending;
-    pending.monitor    = corocgo::_monitor_create();
-    pending.result     = nullptr;
-    pending.done       = false;
-    pending.timedOut   = false;
-    pending.deadlineMs = _nowMs() + _timeoutMs;
+// ── Deadline heap ─────────────────────────────────────────────────────────
 
-    _pending[callId] = &pending;
+void RpcManager::_deadlinePlace(size_t i, RpcDeadline* d) {
+    _deadlines[i] = d;
+    d->heapIdx    = (int)i;
+}
 
-    RpcPacket pkt = _makePacket(methodId, callId, 0x00, arg);
-    _outCh->send(pkt);
+void RpcManager::_deadlineUp(size_t i) {
+    RpcDeadline* d = _deadlines[i];
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (_deadlines[parent]->atUs <= d->atUs) break;
+        _deadlinePlace(i, _deadlines[parent]);
+        i = parent;
+    }
+    _deadlinePlace(i, d);
+}
 
-    while (!pending.done && !pending.timedOut) {
-        corocgo::_monitor_wait(pending.monitor);
+void RpcManager::_deadlineDown(size_t i) {
+    RpcDeadline* d = _deadlines[i];
+    size_t n = _deadlines.size();
+    while (true) {
+        size_t child = 2 * i + 1;
+        if (child >= n) break;
+        if (child + 1 < n && _deadlines[child + 1]->atUs < _deadlines[child]->atUs) child++;
+        if (d->atUs <= _deadlines[child]->atUs) break;
+        _deadlinePlace(i, _deadlines[child]);
+        i = child;
     }
+    _deadlinePlace(i, d);
+}
 
-    _pending.erase(callId);
-    corocgo::_monitor_destroy(pending.monitor);
+void RpcManager::_armDeadline(RpcDeadline& d, int timeoutMs) {
+    _disarmDeadline(d);
+    d.atUs = _nowUs() + (int64_t)timeoutMs * 1000;
+    _deadlines.push_back(&d);
+    _deadlineUp(_deadlines.size() - 1);
+    if (d.atUs < _timerTargetUs) corocgo::sleep_cancel(_timer);   // timer re-reads the top
+}
 
-    if (pending.timedOut) {
-        return {RPC_TIMEOUT, nullptr};
+void RpcManager::_disarmDeadline(RpcDeadline& d) {
+    if (d.heapIdx < 0) return;
+    size_t i = (size_t)d.heapIdx;
+    RpcDeadline* last = _deadlines.back();
+    _deadlines.pop_back();
+    d.heapIdx = -1;
+    if (i < _deadlines.size()) {
+        _deadlinePlace(i, last);
+        _deadlineUp(i);
+        _deadlineDown((size_t)last->heapIdx);
     }
-    return {RPC_OK, pending.result};
 }
 
-void RpcManager::callNoResponse(uint16_t methodId, RpcArg* arg) {
+void RpcManager::callNoResponse(uint16_t methodId, RpcArg* arg, uint32_t trace) {
     uint32_t callId = _nextCallId++;
-    RpcPacket pkt = _makePacket(methodId, callId, RPC_FLAG_NO_RESPONSE, arg);
-    _outCh->send(pkt);
+    RpcPacket pkt;
+    _makePacket(pkt, methodId, callId, RPC_FLAG_NO_RESPONSE, arg);
+    pkt.setTrace(trace);
+    _outCh->send(std::move(pkt));
 }
 
 #ifdef COROCRPC_STREAMING
@@ -596,18 +1131,21 @@ RpcStreamClient RpcManager::callStreamed(uint16_t methodId) {
     uint32_t streamId = _nextCallId++;
 
     RpcStreamSession* session = new RpcStreamSession();
-    session->streamId       = streamId;
-    session->methodId       = methodId;
-    session->inCh           = corocgo::makeChannel<RpcPacket>(4);
-    session->waitDeadlineMs = 0;
+    session->streamId            = streamId;
+    session->methodId            = methodId;
+    session->inCh                = corocgo::makeChannel<RpcPacket>(4);
+    session->manager             = this;
+    session->waitDeadline.id     = streamId;
+    session->waitDeadline.stream = true;
     _streamSessions[streamId] = session;
 
     RpcPacket open = makeStreamPacket(methodId, streamId, RPC_FLAG_IS_STREAM);
-    _outCh->send(open);
+    _outCh->send(std::move(open));
 
     auto cleanup = [this](uint32_t id) {
         auto it = _streamSessions.find(id);
         if (it != _streamSessions.end()) {
+            _disarmDeadline(it->second->waitDeadline);
             it->second->inCh->close();
             delete it->second->inCh;
             delete it->second;
@@ -629,15 +1167,22 @@ void RpcManager::registerStreamedMethod(
 void RpcManager::_dispatchLoop() {
     while (_running) {
         auto res = _inCh->receive();
-        if (res.error) break; // channel closed
+        if (res.error) {
+            // Channel closed: nothing will answer what is still in flight
+            _closed = true;
+            while (!_pending.empty()) _finishCall(_pending.begin()->second, RPC_CLOSED);
+            corocgo::_monitor_wake_all(_windowMonitor);
+            corocgo::sleep_cancel(_timer);
+            break;
+        }
 
         RpcPacket& pkt = res.value;
-        if (pkt.size < RPC_HEADER_SIZE) continue;
+        if (pkt.size() < RPC_HEADER_SIZE) continue;
 
-        uint16_t methodId   = (uint16_t)(pkt.data[0] | (pkt.data[1] << 8));
-        uint32_t callId     = (uint32_t)(pkt.data[2] | (pkt.data[3] << 8) |
-                                         (pkt.data[4] << 16) | (pkt.data[5] << 24));
-        uint8_t  flags      = pkt.data[6];
+        const uint8_t* d    = pkt.data();
+        uint16_t methodId   = (uint16_t)(d[0] | (d[1] << 8));
+        uint32_t callId     = (uint32_t)(d[2] | (d[3] << 8) | (d[4] << 16) | (d[5] << 24));
+        uint8_t  flags      = d[6];
 
 #ifdef COROCRPC_STREAMING
         if (flags & RPC_FLAG_IS_STREAM) {
@@ -645,28 +1190,34 @@ void RpcManager::_dispatchLoop() {
             if (isResp) {
                 auto it = _streamSessions.find(callId);
                 if (it != _streamSessions.end()) {
-                    it->second->inCh->send(pkt);
+                    it->second->inCh->send(std::move(pkt));
                 }
             } else {
                 auto sessionIt = _streamSessions.find(callId);
                 if (sessionIt == _streamSessions.end()) {
                     // OPEN packet: new stream from client, spawn handler coroutine.
+                    // A late READY/END/ABORT for a finished session is dropped.
                     auto methodIt = _streamMethods.find(methodId);
-                    if (methodIt != _streamMethods.end()) {
+                    bool control  = (flags & (RPC_FLAG_STREAM_READY | RPC_FLAG_STREAM_END |
+                                              RPC_FLAG_STREAM_ABORT)) != 0;
+                    if (!control && methodIt != _streamMethods.end()) {
                         RpcStreamSession* session = new RpcStreamSession();
-                        session->streamId       = callId;
-                        session->methodId       = methodId;
-                        session->inCh           = corocgo::makeChannel<RpcPacket>(4);
-                        session->waitDeadlineMs = 0;
+                        session->streamId            = callId;
+                        session->methodId            = methodId;
+                        session->inCh                = corocgo::makeChannel<RpcPacket>(4);
+                        session->manager             = this;
+                        session->waitDeadline.id     = callId;
+                        session->waitDeadline.stream = true;
                         _streamSessions[callId] = session;
                         auto handler = methodIt->second;
-                        corocgo::coro([this, session, handler]() {
+                        corocgo::coro_named("rpc-stream", [this, session, handler]() {
                             RpcStreamServer srv(session, _outCh,
                                                 session->methodId, session->streamId,
                                                 _timeoutMs);
                             handler(srv);
                             auto it2 = _streamSessions.find(session->streamId);
                             if (it2 != _streamSessions.end()) {
+                                _disarmDeadline(it2->second->waitDeadline);
                                 it2->second->inCh->close();
                                 delete it2->second->inCh;
                                 delete it2->second;
@@ -675,7 +1226,7 @@ void RpcManager::_dispatchLoop() {
                         });
                     }
                 } else {
-                    sessionIt->second->inCh->send(pkt);
+                    sessionIt->second->inCh->send(std::move(pkt));
                 }
             }
             continue;
@@ -684,40 +1235,54 @@ void RpcManager::_dispatchLoop() {
 
         bool     isResponse = (flags & RPC_FLAG_IS_RESPONSE) != 0;
         bool     noResponse = (flags & RPC_FLAG_NO_RESPONSE) != 0;
-        int      payloadLen = pkt.size - RPC_HEADER_SIZE;
+        int      payloadLen = pkt.size() - RPC_HEADER_SIZE;
+        if (payloadLen > RPC_ARG_BUF_SIZE) continue;   // cannot be an RpcArg
 
         if (isResponse) {
-            // Client side: wake the waiting call()
+            // Client side: complete the call's future
             auto it = _pending.find(callId);
-            if (it != _pending.end()) {
-                PendingCall* pc = it->second;
-                if (payloadLen > 0) {
-                    RpcArg* result = getRpcArg();
-                    if (result) {
-                        memcpy(result->buf, &pkt.data[RPC_HEADER_SIZE], payloadLen);
-                        result->writeIdx = payloadLen;
-                        pc->result = result;
-                    }
+            if (it == _pending.end()) continue;
+            PendingCall* pc = it->second;
+            if (payloadLen > 0 && !pc->abandoned) {
+                RpcArg* result = getRpcArg(payloadLen);   // waits at the pool's high-water mark
+                // The wait can outlast the call: it may have timed out and
+                // its PendingCall been recycled into a newer call meanwhile,
+                // or its future may have been dropped
+                it = _pending.find(callId);
+                if (it == _pending.end() || it->second != pc) {
+                    disposeRpcArg(result);
+                    continue;
+                }
+                if (pc->abandoned) {
+                    disposeRpcArg(result);
+                    result = nullptr;
+                }
+                if (result) {
+                    memcpy(result->buf, d + RPC_HEADER_SIZE, payloadLen);
+                    result->writeIdx = payloadLen;
+                    pc->result = result;
                 }
-                pc->done = true;
-                corocgo::_monitor_wake(pc->monitor);
             }
+            _finishCall(pc, RPC_OK);
         } else {
             // Server side: dispatch to registered handler
             auto it = _methods.find(methodId);
             if (it != _methods.end()) {
-                RpcArg* inArg = getRpcArg();
+                // Waits for a free arg rather than dropping the request; the
+                // stall backs up inCh and with it the sender.
+                RpcArg* inArg = getRpcArg(payloadLen);
                 if (inArg) {
                     if (payloadLen > 0) {
-                        memcpy(inArg->buf, &pkt.data[RPC_HEADER_SIZE], payloadLen);
+                        memcpy(inArg->buf, d + RPC_HEADER_SIZE, payloadLen);
                         inArg->writeIdx = payloadLen;
                     }
                     RpcArg* outArg = it->second(inArg);
                     disposeRpcArg(inArg);
                     if (!noResponse) {
-                        RpcPacket resp = _makePacket(methodId, callId, RPC_FLAG_IS_RESPONSE, outArg);
+                        // The response reuses the request's buffer
+                        _makePacket(pkt, methodId, callId, RPC_FLAG_IS_RESPONSE, outArg);
                         disposeRpcArg(outArg);
-                        _outCh->send(resp);
+                        _outCh->send(std::move(pkt));
                     } else {
                         disposeRpcArg(outArg);
                     }
@@ -727,28 +1292,46 @@ void RpcManager::_dispatchLoop() {
     }
 }
 
-void RpcManager::_timeoutLoop() {
-    while (_running && !_inCh->isClosed()) {
-        corocgo::sleep(1000);
-        if (_inCh->isClosed()) break;
-        int64_t now = _nowMs();
-        for (auto& [callId, pc] : _pending) {
-            if (!pc->done && !pc->timedOut && now >= pc->deadlineMs) {
-                pc->timedOut = true;
-                corocgo::_monitor_wake(pc->monitor);
-            }
-        }
+void RpcManager::_fireDeadline(RpcDeadline* d) {
+    if (!d->stream) {
+        auto it = _pending.find(d->id);
+        if (it == _pending.end()) return;
+        _stats.timeouts++;
+        _finishCall(it->second, RPC_TIMEOUT);
+        return;
+    }
 #ifdef COROCRPC_STREAMING
-        for (auto& [streamId, session] : _streamSessions) {
-            if (session->waitDeadlineMs > 0 && now >= session->waitDeadlineMs) {
-                session->waitDeadlineMs = 0;
-                RpcPacket tp = makeStreamPacket(session->methodId, streamId,
-                                                RPC_FLAG_IS_STREAM | RPC_FLAG_STREAM_TIMEOUT);
-                session->inCh->send(tp);
-            }
-        }
+    auto it = _streamSessions.find(d->id);
+    if (it == _streamSessions.end()) return;
+    RpcStreamSession* session = it->second;
+    RpcPacket tp = makeStreamPacket(session->methodId, session->streamId,
+                                    RPC_FLAG_IS_STREAM | RPC_FLAG_STREAM_TIMEOUT);
+    session->inCh->send(std::move(tp));
 #endif // COROCRPC_STREAMING
+}
+
+// Sleeps until the earliest armed deadline. Exits once the dispatch loop has
+// seen inCh close (it cancels this sleep), so it never touches the channels.
+void RpcManager::_timerLoop() {
+    static constexpr int IDLE_MS = 60 * 60 * 1000;   // nothing armed; woken by sleep_cancel
+    _timer = corocgo::coro_self();
+    while (_running && !_closed) {
+        int64_t now = _nowUs();
+        while (!_deadlines.empty() && _deadlines.front()->atUs <= now) {
+            RpcDeadline* d = _deadlines.front();
+            _disarmDeadline(*d);
+            _fireDeadline(d);
+        }
+        if (_deadlines.empty()) {
+            _timerTargetUs = INT64_MAX;
+            corocgo::sleep(IDLE_MS);
+        } else {
+            _timerTargetUs = _deadlines.front()->atUs;
+            corocgo::sleep_until(std::chrono::steady_clock::time_point(
+                std::chrono::microseconds(_timerTargetUs)));
+        }
     }
+    _timerTargetUs = INT64_MAX;
 }
 
 } // namespace corocrpc
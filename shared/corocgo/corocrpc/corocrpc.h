@@ -25,10 +25,31 @@ namespace corocrpc {
 // Magic: 0xEF 0xFE on wire (little-endian 0xFEEF). Both CRCs: CRC16-IBM.
 //
 // Go-like usage:
-//   Send:    FramedPacket fp = framer.createPacket(ch, data, len);
-//            // ship fp.data[0..fp.size-1] over the transport
-//   Receive: framer.writeCh->send(chunk);   // feed raw bytes from transport
-//            auto res = framer.readCh->receive();  // get next complete frame
+//   Send:    framer.frame(buf, ch);                // header written into buf's headroom
+//            // ship buf.data()[0..buf.size()-1] over the transport
+//   Receive: framer.writeCh->send(chunk);          // feed raw bytes from transport
+//            (or framer.write(bytes, n) from the reader coroutine)
+//            auto res = framer.readCh->receive();  // next complete frame's content
+//
+// Incoming bytes are staged in a pooled PacketBuf and parsed there in bulk:
+// memchr finds the magic, resync after a bad header just moves the scan
+// position, and a complete frame is handed out as a view of the staging
+// buffer — the buffer a frame is parsed in is the one RpcManager dispatches
+// from.
+
+// CRC-16/IBM as used for both frame checksums: reflected polynomial 0xA001,
+// init 0xFFFF, no final xor ("123456789" → 0x4B37). COROCRPC_CRC_SLICES picks
+// the table set: 1 (512 B, byte at a time), 4 (2 KB) or 8 (4 KB, default
+// with threads; 4 without).
+#ifndef COROCRPC_CRC_SLICES
+#if COROCGO_HAS_THREADS
+#define COROCRPC_CRC_SLICES 8
+#else
+#define COROCRPC_CRC_SLICES 4
+#endif
+#endif
+
+uint16_t crc16(const uint8_t* data, size_t len);
 
 // Input chunk sent to writeCh (one call from the transport → one RawChunk).
 struct RawChunk {
@@ -37,19 +58,103 @@ struct RawChunk {
     uint16_t len;
 };
 
-// Output value received from readCh (one complete, CRC-validated frame).
 // Sized for RPC use: RPC_PACKET_MAX (~1031 B) + HEADER_SIZE (12 B) + headroom.
 // Increase if you need to frame larger payloads.
 static constexpr size_t SF_BUFFER_SIZE = 2 * 1024;  // max frame (header + content)
+
+// ── PacketBuf ─────────────────────────────────────────────────────────────
+// Move-only handle to one SF_BUFFER_SIZE buffer of a fixed slab. The valid
+// bytes are [begin, end); space in front of begin is headroom that
+// StreamFramer::frame() prepends the frame header into. Destroying or
+// reassigning the handle returns the buffer to the slab.
+//
+// Slab size: COROCRPC_PACKET_POOL buffers, allocated on first use. Every
+// packet parked in a channel, framer or writer queue is out of the slab, so
+// size it from those capacities: the defaults cover the mainboard's six UART
+// links (LINK_PACKETS_MAX in mainboard/src/main.cpp) and the Pico's one link
+// (PICO_PACKETS_MAX in Pico/src/mainPico.cpp). Release is thread-safe
+// (pipeline writer threads drop handles) and wakes a parked acquire();
+// acquire() sleeps in coroutine context while the slab is empty,
+// tryAcquire() never waits.
+#ifndef COROCRPC_PACKET_POOL
+#if COROCGO_HAS_THREADS
+#define COROCRPC_PACKET_POOL 512
+#else
+#define COROCRPC_PACKET_POOL 28
+#endif
+#endif
+
+struct PacketBlock;
+
+class PacketBuf {
+public:
+    PacketBuf() = default;
+    PacketBuf(PacketBuf&& o) noexcept : _blk(o._blk) { o._blk = nullptr; }
+    PacketBuf& operator=(PacketBuf&& o) noexcept;
+    PacketBuf(const PacketBuf&)            = delete;
+    PacketBuf& operator=(const PacketBuf&) = delete;
+    ~PacketBuf() { reset(); }
+
+    // Empty range starting at `headroom`. acquire() must run in a coroutine.
+    static PacketBuf acquire(uint16_t headroom = 0);
+    static PacketBuf tryAcquire(uint16_t headroom = 0);   // empty handle when exhausted
+
+    explicit operator bool() const { return _blk != nullptr; }
+    void reset();   // back to the slab
+
+    uint8_t*       data();
+    const uint8_t* data() const;
+    uint16_t       size() const;
+    uint16_t       headroom() const;
+    uint16_t       tailroom() const;
+    uint16_t       channel() const;   // frame channel (received frames)
+    // Opaque tag for latency tracing; 0 on acquire, never sent on the wire
+    uint32_t       trace() const;
+    void           setTrace(uint32_t t);
+
+    // Start the range at `begin` with `len` bytes (contents untouched)
+    void setRange(uint16_t begin, uint16_t len);
+    // Grow the front into the headroom; returns the new data() or nullptr
+    uint8_t* push(uint16_t n);
+    // Append n bytes (nullptr: just extend); false if they don't fit
+    bool     append(const void* src, uint16_t n);
+    void     setChannel(uint16_t ch);
+
+    uint8_t* raw();   // start of the whole buffer
+
+private:
+    PacketBlock* _blk = nullptr;
+};
+
+// Slab occupancy, for diagnostics and tests
+struct PacketPoolStats {
+    int capacity;
+    int inUse;
+    int peak;
+};
+PacketPoolStats packetPoolStats();
+
+// Kept for callers that frame into a stand-alone buffer (createPacket)
 struct FramedPacket {
     uint8_t  data[SF_BUFFER_SIZE];
     uint16_t size;     // total bytes (header + content); 0 = invalid
     uint16_t channel;
 };
 
+// Parser counters (scheduler thread; read between chunks)
+struct StreamFramerStats {
+    uint64_t bytesIn       = 0;
+    uint64_t frames        = 0;   // emitted
+    uint64_t skipped       = 0;   // bytes discarded while resyncing
+    uint64_t headerErrors  = 0;   // magic found, bad size or header CRC
+    uint64_t contentErrors = 0;   // header OK, content CRC mismatch
+    uint64_t copied        = 0;   // bytes moved between staging buffers
+};
+
 class StreamFramer {
 public:
     static constexpr size_t HEADER_SIZE = 12;
+    static constexpr int    READ_QUEUE  = 4;   // readCh capacity (+1 staging buffer held)
 
     // Allocates writeCh and readCh, spawns the internal parse coroutine.
     // Call before scheduler_start().
@@ -57,13 +162,26 @@ public:
     ~StreamFramer();
 
     // writeCh: send RawChunks of incoming raw bytes here.
-    // readCh:  receive complete FramedPackets from here.
-    corocgo::Channel<RawChunk>*     writeCh;
-    corocgo::Channel<FramedPacket>* readCh;
-
-    // Synchronously build a framed packet (send direction).
+    // readCh:  receive complete frames from here — data() is the content,
+    //          channel() the frame channel.
+    corocgo::Channel<RawChunk>*  writeCh;
+    corocgo::Channel<PacketBuf>* readCh;
+
+    // Parse bytes in the calling coroutine instead of going through writeCh
+    // (saves the RawChunk copy and hop). May yield while readCh is full.
+    // A transport feeds either writeCh or write(), not both.
+    void write(const uint8_t* data, size_t length);
+
+    // Frame buf's content in place: the header goes into its headroom (needs
+    // HEADER_SIZE bytes). Stateless; safe from any thread. False if the
+    // content is too large or there is no headroom.
+    static bool frame(PacketBuf& buf, uint16_t channel);
+
+    // Synchronously build a framed packet (send direction), copying the content.
     // Returns FramedPacket with size==0 on error (content too large).
-    FramedPacket createPacket(uint16_t channel, const char* buffer, unsigned int length);
+    static FramedPacket createPacket(uint16_t channel, const char* buffer, unsigned int length);
+
+    const StreamFramerStats& stats() const { return stats_; }
 
 private:
     static constexpr size_t  BUFFER_SIZE      = SF_BUFFER_SIZE;
@@ -71,18 +189,20 @@ private:
     static constexpr uint8_t MAGIC_BYTE_2     = 0xFE;
     static constexpr size_t  MAX_CONTENT_SIZE = BUFFER_SIZE - HEADER_SIZE;
 
-    enum class State { SEARCH_MAGIC_1, SEARCH_MAGIC_2, READING_HEADER, READING_CONTENT };
-
-    uint8_t  input_buffer_[BUFFER_SIZE];
-    State    state_;
-    size_t   bytes_received_;
-    uint16_t content_size_;
+    // Staging buffer: raw()[head_, fill_) is unparsed input. head_ always
+    // sits on a frame candidate (or equals fill_), so a partial frame is
+    // contiguous and at most BUFFER_SIZE bytes.
+    PacketBuf         stage_;
+    size_t            head_ = 0;
+    size_t            fill_ = 0;
+    StreamFramerStats stats_;
 
-    void reset();
     static uint16_t read_u16_le(const uint8_t* p);
     static void     write_u16_le(uint8_t* p, uint16_t v);
-    void _emit(uint16_t channel, uint16_t totalSize);
-    void _writeBytesInternal(const uint8_t* data, unsigned int length, int depth);
+    static void     writeHeader(uint8_t* h, uint16_t channel, const uint8_t* content, uint16_t length);
+    void _emit(uint16_t channel, size_t contentSize);
+    void _parse();
+    void _writeBytesInternal(const uint8_t* data, size_t length);
     void _parseLoop();
 };
 
@@ -92,13 +212,35 @@ static constexpr int RPC_HEADER_SIZE  = 7;  // methodId(2) + callId(4) + flags(1
 static constexpr int RPC_PACKET_MAX   = RPC_ARG_BUF_SIZE + RPC_HEADER_SIZE;
 
 // ── RpcArg ────────────────────────────────────────────────────────────────
-// Fixed 1 KB buffer with sequential write/read cursors.
-// All integers are little-endian.
+// Byte buffer with sequential write/read cursors. All integers are little-endian.
+//
+// Args from RpcManager::getRpcArg() borrow a buffer from the manager's
+// RpcArgPool: small messages get a small-class buffer, which is swapped for a
+// RPC_ARG_BUF_SIZE one the first time a write doesn't fit. A standalone
+// RpcArg owns an RPC_ARG_BUF_SIZE buffer. Writes past RPC_ARG_BUF_SIZE are
+// dropped.
+//
+// Compact encoding: putVarUInt writes LEB128 (7 bits per byte, high bit =
+// continuation, 1-5 bytes). putVarInt zigzag-maps first so small negative
+// values stay short. putAxisUpdate packs (device, axis, value) as
+// varuint(axis << 4 | device) + varint(value): 2-4 bytes for device < 16,
+// axis < 512 and |value| < 8192, instead of 12 bytes as 3×int32.
+static constexpr int RPC_AXIS_UPDATE_MAX_SIZE = 10;  // worst case: 5 + 5 bytes
+
+class RpcArgPool;
+struct RpcArgSlab;
+
 struct RpcArg {
-    char    buf[RPC_ARG_BUF_SIZE];
+    char*   buf;
+    int     capacity;
     int     writeIdx;
     int     readIdx;
 
+    RpcArg();
+    ~RpcArg();
+    RpcArg(const RpcArg&)            = delete;
+    RpcArg& operator=(const RpcArg&) = delete;
+
     void reset();
 
     // Writers
@@ -106,6 +248,10 @@ struct RpcArg {
     void putBool(bool v);
     void putString(const char* s);               // uint16 length prefix + bytes
     void putBuffer(const void* data, uint16_t len); // uint16 length prefix + bytes
+    void putVarUInt(uint32_t v);
+    void putVarInt(int32_t v);                   // zigzag + LEB128
+    // device must be 0..15. Returns false if it does not fit (nothing written).
+    bool putAxisUpdate(int32_t device, int32_t axis, int32_t value);
 
     // Readers
     int32_t  getInt32();
@@ -114,6 +260,107 @@ struct RpcArg {
     int      getString(char* out, int outSize);
     // Copies bytes into out. Returns actual length copied, 0 on error.
     uint16_t getBuffer(void* out, uint16_t maxLen);
+    // Truncated/overlong varints return 0 and leave readIdx at the end.
+    uint32_t getVarUInt();
+    int32_t  getVarInt();
+    // Returns false on truncated input.
+    bool     getAxisUpdate(int32_t& device, int32_t& axis, int32_t& value);
+
+private:
+    friend class RpcArgPool;
+    struct PoolTag {};
+    explicit RpcArg(PoolTag) : buf(nullptr), capacity(0), writeIdx(0), readIdx(0) {}
+
+    // True if `n` more bytes fit, after moving to a larger buffer if needed
+    bool fit(int n) { return writeIdx + n <= capacity || grow(writeIdx + n); }
+    bool grow(int needed);
+
+    RpcArgPool* _pool     = nullptr;   // null: standalone, owns buf
+    RpcArgSlab* _slab     = nullptr;
+    RpcArg*     _nextFree = nullptr;
+};
+
+// ── RpcArgPool ────────────────────────────────────────────────────────────
+// Per-RpcManager arg buffers in two size classes (small, RPC_ARG_BUF_SIZE),
+// carved from slabs of slabSize buffers. A class grows a slab at a time up to
+// highWater buffers; a slab whose buffers are all free again is released
+// while the class keeps at least lowWater. At the high-water mark a small
+// request borrows a large buffer, and beyond that get() waits (in a
+// coroutine) until an arg is disposed — back-pressure instead of a null arg.
+#ifndef COROCRPC_ARG_SMALL_SIZE
+#define COROCRPC_ARG_SMALL_SIZE 128
+#endif
+
+struct RpcArgPoolConfig {
+#if COROCGO_HAS_THREADS
+    int smallSize = COROCRPC_ARG_SMALL_SIZE;   // bytes; <= 0 or >= RPC_ARG_BUF_SIZE: one class only
+    int lowWater  = 16;    // buffers per class kept allocated when idle
+    int highWater = 256;   // buffers per class at most
+    int slabSize  = 16;    // buffers allocated at a time
+#else
+    int smallSize = COROCRPC_ARG_SMALL_SIZE;
+    int lowWater  = 4;
+    int highWater = 16;
+    int slabSize  = 4;
+#endif
+};
+
+struct RpcArgClassStats {
+    int size     = 0;   // bytes per buffer
+    int capacity = 0;   // buffers allocated
+    int inUse    = 0;
+    int peak     = 0;
+};
+
+struct RpcArgPoolStats {
+    RpcArgClassStats small;
+    RpcArgClassStats large;
+    uint64_t waits      = 0;   // get() calls that waited for a free arg
+    uint64_t promotions = 0;   // small args that outgrew their buffer
+    uint64_t borrowed   = 0;   // small requests served from the large class
+    uint64_t slabsFreed = 0;
+};
+
+class RpcArgPool {
+public:
+    explicit RpcArgPool(const RpcArgPoolConfig& cfg = {});
+    ~RpcArgPool();
+    RpcArgPool(const RpcArgPool&)            = delete;
+    RpcArgPool& operator=(const RpcArgPool&) = delete;
+
+    // sizeHint: bytes the caller expects to write (0 = small). Waits while
+    // both classes are at their high-water mark (coroutine only; returns
+    // nullptr outside one).
+    RpcArg* get(int sizeHint = 0);
+    RpcArg* tryGet(int sizeHint = 0);
+    void    dispose(RpcArg* arg);
+
+    RpcArgPoolStats stats() const;
+
+private:
+    friend struct RpcArg;
+    static constexpr int SMALL = 0;
+    static constexpr int LARGE = 1;
+
+    struct Class {
+        int                      size     = 0;
+        int                      capacity = 0;
+        int                      inUse    = 0;
+        int                      peak     = 0;
+        std::vector<RpcArgSlab*> slabs;
+    };
+
+    bool  takeBlock(int cls, RpcArg* arg, int limit);
+    void  releaseBlock(RpcArg* arg);
+    bool  promote(RpcArg* arg);
+
+    RpcArgPoolConfig _cfg;
+    Class            _classes[2];
+    RpcArg*          _freeArgs = nullptr;   // headers, never freed until the pool is
+    std::vector<RpcArg*> _allArgs;
+    void*            _monitor;
+    int              _waiters = 0;
+    RpcArgPoolStats  _stats;
 };
 
 // ── RpcPacket ─────────────────────────────────────────────────────────────
@@ -128,16 +375,16 @@ static constexpr uint8_t RPC_FLAG_IS_STREAM      = 0x04;
 static constexpr uint8_t RPC_FLAG_STREAM_READY   = 0x08;
 static constexpr uint8_t RPC_FLAG_STREAM_END     = 0x10;
 static constexpr uint8_t RPC_FLAG_STREAM_ABORT   = 0x20;
-// RPC_FLAG_STREAM_TIMEOUT is synthesised internally by _timeoutLoop(); never goes over the wire.
+// RPC_FLAG_STREAM_TIMEOUT is synthesised internally by _timerLoop(); never goes over the wire.
 static constexpr uint8_t RPC_FLAG_STREAM_TIMEOUT = 0x40;
 
 static constexpr int RPC_STREAM_CHUNK_SIZE = 512;
 #endif // COROCRPC_STREAMING
 
-struct RpcPacket {
-    uint8_t  data[RPC_PACKET_MAX];
-    uint16_t size;
-};
+// An RpcPacket is a PacketBuf whose range holds [header][payload]. Packets
+// built by RpcManager keep StreamFramer::HEADER_SIZE bytes of headroom so the
+// transport can frame them in place.
+using RpcPacket = PacketBuf;
 
 // ── RpcResult ─────────────────────────────────────────────────────────────
 #ifdef COROCRPC_STREAMING
@@ -157,6 +404,17 @@ struct RpcResult {
     RpcArg* arg;    // non-null when error == RPC_OK; caller must disposeRpcArg()
 };
 
+class RpcManager;
+
+// Slot in RpcManager's deadline heap. Owned by a pending call or a stream
+// session; the manager's timer coroutine fires it at atUs (steady clock).
+struct RpcDeadline {
+    int64_t  atUs    = 0;
+    int      heapIdx = -1;   // -1 = not armed
+    uint32_t id      = 0;    // callId / streamId
+    bool     stream  = false;
+};
+
 #ifdef COROCRPC_STREAMING
 enum class RpcStreamState {
     SEND_READY,      // READY received from receiver — can call send()
@@ -171,7 +429,8 @@ struct RpcStreamSession {
     uint32_t                     streamId;
     uint16_t                     methodId;
     corocgo::Channel<RpcPacket>* inCh;
-    int64_t                      waitDeadlineMs; // 0 = not waiting
+    RpcManager*                  manager;
+    RpcDeadline                  waitDeadline;   // armed while waiting for a packet
 };
 
 class RpcStreamClient {
@@ -245,16 +504,30 @@ private:
 #endif // COROCRPC_STREAMING
 
 // ── RpcManager ────────────────────────────────────────────────────────────
+class RpcFuture;
+
+struct RpcCallStats {
+    uint32_t inFlight     = 0;   // requests sent, response / timeout not yet in
+    uint32_t peakInFlight = 0;
+    uint32_t pooledCalls  = 0;   // PendingCall objects allocated (reused after that)
+    uint64_t calls        = 0;
+    uint64_t timeouts     = 0;
+    uint64_t windowStalls = 0;   // callAsync() waited for a free window slot
+};
+
 class RpcManager {
 public:
     // outCh: RpcManager writes outbound packets here; external code reads and ships them.
     // inCh:  external code writes received packets here; RpcManager dispatches them.
     // timeoutMs: how long call() waits before returning RPC_TIMEOUT.
+    // maxInFlight: window — callAsync() waits while this many calls are unanswered.
     //
-    // Spawns internal dispatch and timeout coroutines; call before scheduler_start().
+    // Spawns internal dispatch and timer coroutines; call before scheduler_start().
     RpcManager(corocgo::Channel<RpcPacket>* outCh,
                corocgo::Channel<RpcPacket>* inCh,
-               int timeoutMs = 5000);
+               int timeoutMs = 5000,
+               int maxInFlight = 8,
+               const RpcArgPoolConfig& argPool = {});
 
     ~RpcManager();
 
@@ -269,10 +542,20 @@ public:
     // On RPC_OK: caller must disposeRpcArg(result.arg) when done.
     RpcResult call(uint16_t methodId, RpcArg* arg);
 
+    // Client side: sends the request and returns without waiting for the
+    // response (must run from a coroutine; waits only while the window is
+    // full). arg is serialized before return and may be disposed right away.
+    // timeoutMs < 0 uses the manager's timeout.
+    RpcFuture callAsync(uint16_t methodId, RpcArg* arg, int timeoutMs = -1);
+
+    void         setMaxInFlight(int n);
+    RpcCallStats callStats() const;
+
     // Client side: fire-and-forget — sends the request and returns immediately.
     // No response is expected; the server will not send one.
     // arg: caller-owned input; not disposed by callNoResponse().
-    void callNoResponse(uint16_t methodId, RpcArg* arg);
+    // trace: tag for the packet's PacketBuf::trace(), read by the transport.
+    void callNoResponse(uint16_t methodId, RpcArg* arg, uint32_t trace = 0);
 
 #ifdef COROCRPC_STREAMING
     // Client side: open a streaming session (must run from a coroutine).
@@ -283,28 +566,52 @@ public:
                                 std::function<void(RpcStreamServer&)> handler);
 #endif // COROCRPC_STREAMING
 
-    // Pool: obtain a zeroed RpcArg; return it when done.
-    RpcArg* getRpcArg();
-    void    disposeRpcArg(RpcArg* arg);
+    // Pool: obtain an empty RpcArg; return it when done. sizeHint picks the
+    // buffer class (the arg grows if writes outrun it). Waits (coroutine) for
+    // a free arg at the pool's high-water mark; tryGetRpcArg() returns nullptr
+    // instead.
+    RpcArg* getRpcArg(int sizeHint = 0)    { return _args.get(sizeHint); }
+    RpcArg* tryGetRpcArg(int sizeHint = 0) { return _args.tryGet(sizeHint); }
+    void    disposeRpcArg(RpcArg* arg)     { _args.dispose(arg); }
+    RpcArgPoolStats argPoolStats() const   { return _args.stats(); }
 
 private:
-    static constexpr int POOL_SIZE = 16;
-    RpcArg   _pool[POOL_SIZE];
-    bool     _poolUsed[POOL_SIZE];
+    friend class RpcFuture;
+#ifdef COROCRPC_STREAMING
+    friend class RpcStreamClient;
+    friend class RpcStreamServer;
+#endif // COROCRPC_STREAMING
+
+    RpcArgPool _args;
 
     corocgo::Channel<RpcPacket>* _outCh;
     corocgo::Channel<RpcPacket>* _inCh;
     int      _timeoutMs;
     bool     _running;
+    bool     _closed;       // inCh closed — calls fail with RPC_CLOSED
     uint32_t _nextCallId;
 
+    // Recycled through _freeCalls; the monitor lives as long as the object.
     struct PendingCall {
-        void*   monitor;
-        RpcArg* result;
-        bool    done;
-        bool    timedOut;
-        int64_t deadlineMs;
+        void*        monitor   = nullptr;
+        RpcArg*      result    = nullptr;
+        int          error     = RPC_OK;
+        bool         done      = false;
+        bool         abandoned = false;   // future dropped before completion
+        RpcDeadline  deadline;
+        PendingCall* nextFree  = nullptr;
     };
+    PendingCall* _freeCalls = nullptr;
+
+    int          _maxInFlight;
+    void*        _windowMonitor;
+    RpcCallStats _stats;
+
+    // Min-heap on atUs over every armed call / stream deadline. The timer
+    // coroutine sleeps until the top; arming an earlier one cancels its sleep.
+    std::vector<RpcDeadline*> _deadlines;
+    corocgo::CoroHandle       _timer;
+    int64_t                   _timerTargetUs;
 
     std::unordered_map<uint16_t, std::function<RpcArg*(RpcArg*)>> _methods;
     std::unordered_map<uint32_t, PendingCall*>                     _pending;
@@ -313,11 +620,50 @@ private:
     std::unordered_map<uint16_t, std::function<void(RpcStreamServer&)>> _streamMethods;
 #endif // COROCRPC_STREAMING
 
-    static RpcPacket _makePacket(uint16_t methodId, uint32_t callId,
-                                  uint8_t flags, RpcArg* arg);
-    static int64_t   _nowMs();
+    // Builds into `pkt` (reusing its buffer if it has one)
+    static void      _makePacket(RpcPacket& pkt, uint16_t methodId, uint32_t callId,
+                                 uint8_t flags, RpcArg* arg);
+    static int64_t   _nowUs();
     void _dispatchLoop();
-    void _timeoutLoop();
+    void _timerLoop();
+
+    PendingCall* _acquireCall();
+    void         _releaseCall(PendingCall* pc);
+    void         _finishCall(PendingCall* pc, int error);
+    void         _armDeadline(RpcDeadline& d, int timeoutMs);
+    void         _disarmDeadline(RpcDeadline& d);
+    void         _deadlinePlace(size_t i, RpcDeadline* d);
+    void         _deadlineUp(size_t i);
+    void         _deadlineDown(size_t i);
+    void         _fireDeadline(RpcDeadline* d);
+};
+
+// ── RpcFuture ─────────────────────────────────────────────────────────────
+// Handle to one callAsync() request. Move-only; must not outlive its manager.
+// Dropping a future before get() is fine — the response (or timeout) still
+// frees the window slot and the result is disposed.
+class RpcFuture {
+public:
+    RpcFuture() = default;
+    RpcFuture(RpcFuture&& o) noexcept : _mgr(o._mgr), _call(o._call) { o._call = nullptr; }
+    RpcFuture& operator=(RpcFuture&& o) noexcept;
+    RpcFuture(const RpcFuture&)            = delete;
+    RpcFuture& operator=(const RpcFuture&) = delete;
+    ~RpcFuture();
+
+    bool valid() const { return _call != nullptr; }
+    // True once the response, a timeout or channel close has arrived.
+    bool ready() const { return _call && _call->done; }
+    // Waits (coroutine) until ready and consumes the future; same contract as call().
+    RpcResult get();
+
+private:
+    friend class RpcManager;
+    RpcFuture(RpcManager* mgr, RpcManager::PendingCall* pc) : _mgr(mgr), _call(pc) {}
+    void drop();
+
+    RpcManager*              _mgr  = nullptr;
+    RpcManager::PendingCall* _call = nullptr;
 };
 
 } // namespace corocrpc
@@ -11,7 +11,18 @@
 #include <iostream>
 #include <cstring>
 #include <cstdio>
+#include <chrono>
+#include <climits>
+#include <vector>
 #include "corocrpc.h"
+#if COROCGO_HAS_THREADS
+#include <thread>
+#endif
+#if COROCGO_HAS_FILE_IO
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#endif
 
 using namespace corocgo;
 using namespace corocrpc;
@@ -58,6 +69,10 @@ enum MethodId : uint16_t {
 #ifdef COROCRPC_STREAMING
     METHOD_STREAM_ECHO          = 20,
 #endif // COROCRPC_STREAMING
+
+    // Wire encoding benchmark
+    METHOD_AXIS_INT32           = 30,   // int32 device, int32 axis, int32 value
+    METHOD_AXIS_PACKED          = 31,   // varuint count, count × axisUpdate
 };
 
 // ── Loopback helpers ──────────────────────────────────────────────────────
@@ -68,7 +83,7 @@ static void startLoopback(Channel<RpcPacket>* src, Channel<RpcPacket>* dst) {
         while (true) {
             auto res = src->receive();
             if (res.error) break;
-            dst->send(res.value);
+            dst->send(std::move(res.value));
         }
     });
 }
@@ -80,7 +95,7 @@ static void startSlowLoopback(Channel<RpcPacket>* src, Channel<RpcPacket>* dst,
             auto res = src->receive();
             if (res.error) break;
             sleep(delayMs);
-            dst->send(res.value);
+            dst->send(std::move(res.value));
         }
     });
 }
@@ -389,12 +404,12 @@ static void testStreamFramer() {
 
             auto res = framer.readCh->receive();
             check("sf/basic/no error",   !res.error);
-            checkInt("sf/basic/channel", 0, res.value.channel);
+            checkInt("sf/basic/channel", 0, res.value.channel());
 
-            uint16_t contentLen = res.value.size - (uint16_t)StreamFramer::HEADER_SIZE;
+            uint16_t contentLen = res.value.size();
             checkInt("sf/basic/content length", 12, contentLen);
             char buf[32]{};
-            memcpy(buf, res.value.data + StreamFramer::HEADER_SIZE, contentLen);
+            memcpy(buf, res.value.data(), contentLen);
             check("sf/basic/content matches", strcmp(buf, "hello framer") == 0);
         }
 
@@ -414,10 +429,10 @@ static void testStreamFramer() {
 
             auto res = framer.readCh->receive();
             check("sf/frag/no error", !res.error);
-            uint16_t contentLen = res.value.size - (uint16_t)StreamFramer::HEADER_SIZE;
+            uint16_t contentLen = res.value.size();
             checkInt("sf/frag/content length", 11, contentLen);
             char buf[32]{};
-            memcpy(buf, res.value.data + StreamFramer::HEADER_SIZE, contentLen);
+            memcpy(buf, res.value.data(), contentLen);
             check("sf/frag/content matches", strcmp(buf, "fragment me") == 0);
         }
 
@@ -439,10 +454,10 @@ static void testStreamFramer() {
 
             auto res = framer.readCh->receive();
             check("sf/corrupt/no error", !res.error);
-            uint16_t contentLen = res.value.size - (uint16_t)StreamFramer::HEADER_SIZE;
+            uint16_t contentLen = res.value.size();
             checkInt("sf/corrupt/content length", 10, contentLen);
             char buf[32]{};
-            memcpy(buf, res.value.data + StreamFramer::HEADER_SIZE, contentLen);
+            memcpy(buf, res.value.data(), contentLen);
             check("sf/corrupt/content matches", strcmp(buf, "after junk") == 0);
         }
 
@@ -464,12 +479,12 @@ static void testStreamFramer() {
 
             check("sf/mux/pkt0 no error", !r0.error);
             check("sf/mux/pkt7 no error", !r7.error);
-            checkInt("sf/mux/pkt0 channel", 0, r0.value.channel);
-            checkInt("sf/mux/pkt7 channel", 7, r7.value.channel);
+            checkInt("sf/mux/pkt0 channel", 0, r0.value.channel());
+            checkInt("sf/mux/pkt7 channel", 7, r7.value.channel());
 
             char b0[8]{}, b7[8]{};
-            memcpy(b0, r0.value.data + StreamFramer::HEADER_SIZE, 3);
-            memcpy(b7, r7.value.data + StreamFramer::HEADER_SIZE, 3);
+            memcpy(b0, r0.value.data(), 3);
+            memcpy(b7, r7.value.data(), 3);
             check("sf/mux/pkt0 content", strcmp(b0, "ch0") == 0);
             check("sf/mux/pkt7 content", strcmp(b7, "ch7") == 0);
         }
@@ -491,30 +506,25 @@ static void testStreamFramer() {
                 return out;
             });
 
-            // Outbound bridge: rpcOut → frame → framer.writeCh
+            // Outbound bridge: rpcOut → frame in place → framer.writeCh
             coro([rpcOut, &framer]() {
                 while (true) {
                     auto res = rpcOut->receive();
                     if (res.error) break;
-                    FramedPacket fp = framer.createPacket(0,
-                        reinterpret_cast<const char*>(res.value.data), res.value.size);
+                    if (!StreamFramer::frame(res.value, 0)) continue;
                     RawChunk chunk;
-                    memcpy(chunk.data, fp.data, fp.size);
-                    chunk.len = fp.size;
+                    memcpy(chunk.data, res.value.data(), res.value.size());
+                    chunk.len = res.value.size();
                     framer.writeCh->send(chunk);
                 }
             });
 
-            // Inbound bridge: framer.readCh → deframe → rpcIn
+            // Inbound bridge: the frame's buffer goes to rpcIn as-is
             coro([rpcIn, &framer]() {
                 while (true) {
                     auto res = framer.readCh->receive();
                     if (res.error) break;
-                    RpcPacket pkt;
-                    uint16_t cLen = res.value.size - (uint16_t)StreamFramer::HEADER_SIZE;
-                    memcpy(pkt.data, res.value.data + StreamFramer::HEADER_SIZE, cLen);
-                    pkt.size = cLen;
-                    rpcIn->send(pkt);
+                    rpcIn->send(std::move(res.value));
                 }
             });
 
@@ -615,6 +625,8 @@ static void testStreamingEcho() {
     });
 
     scheduler_start();
+    delete aTob;   // returns packets still queued to the slab
+    delete bToa;
 }
 
 // ── Test 10: Streaming sendAll/receiveAll helpers ─────────────────────────
@@ -658,9 +670,874 @@ static void testStreamingSendAll() {
     });
 
     scheduler_start();
+    delete aTob;   // returns packets still queued to the slab
+    delete bToa;
 }
 #endif // COROCRPC_STREAMING
 
+// ── Test 11: compact encoding (varint / zigzag / axisUpdate) ──────────────
+static void testCompactEncoding() {
+    std::cout << "\n=== Test 11: compact encoding ===\n";
+
+    const int32_t values[] = {0, 1, -1, 63, -64, 64, 127, 128, 1000, -1000,
+                              16383, 65536, INT32_MAX, INT32_MIN};
+    RpcArg a;
+    a.reset();
+    for (int32_t v : values) a.putVarInt(v);
+    bool allMatch = true;
+    for (int32_t v : values) allMatch &= (a.getVarInt() == v);
+    check("varint/round-trip", allMatch);
+    checkInt("varint/fully consumed", a.writeIdx, a.readIdx);
+
+    a.reset(); a.putVarInt(0);         checkInt("varint/0 is 1 byte",     1, a.writeIdx);
+    a.reset(); a.putVarInt(-64);       checkInt("varint/-64 is 1 byte",   1, a.writeIdx);
+    a.reset(); a.putVarInt(1000);      checkInt("varint/1000 is 2 bytes", 2, a.writeIdx);
+    a.reset(); a.putVarInt(INT32_MIN); checkInt("varint/min is 5 bytes",  5, a.writeIdx);
+    a.reset(); a.putVarUInt(300);
+    check("varuint/300 encoding", (uint8_t)a.buf[0] == 0xAC && (uint8_t)a.buf[1] == 0x02);
+
+    // axisUpdate: button press on slot 1, axis 3 → 2 bytes; full-range stick on axis 100 → 4
+    a.reset();
+    check("axis/put small", a.putAxisUpdate(1, 3, 1));
+    checkInt("axis/small is 2 bytes", 2, a.writeIdx);
+    check("axis/put large", a.putAxisUpdate(7, 100, 1000));
+    checkInt("axis/large is 4 bytes", 6, a.writeIdx);
+    check("axis/put negative", a.putAxisUpdate(15, 511, -1000));
+    check("axis/reject slot 16", !a.putAxisUpdate(16, 0, 0));
+    int32_t d, ax, v;
+    check("axis/get 1", a.getAxisUpdate(d, ax, v) && d == 1  && ax == 3   && v == 1);
+    check("axis/get 2", a.getAxisUpdate(d, ax, v) && d == 7  && ax == 100 && v == 1000);
+    check("axis/get 3", a.getAxisUpdate(d, ax, v) && d == 15 && ax == 511 && v == -1000);
+    check("axis/get past end", !a.getAxisUpdate(d, ax, v));
+
+    // Truncated record: key present, value cut off mid-varint
+    a.reset();
+    a.putAxisUpdate(2, 5, 1000);
+    a.writeIdx--;
+    check("axis/truncated rejected", !a.getAxisUpdate(d, ax, v));
+}
+
+// ── Test 12: PacketBuf pool and move-only channels ───────────────────────
+static void testPacketBuf() {
+    std::cout << "\n=== Test 12: PacketBuf pool / move-only channels ===\n";
+
+    PacketPoolStats before = packetPoolStats();
+    {
+        PacketBuf a = PacketBuf::tryAcquire(StreamFramer::HEADER_SIZE);
+        check("pbuf/acquire", (bool)a);
+        checkInt("pbuf/headroom", StreamFramer::HEADER_SIZE, a.headroom());
+        check("pbuf/append", a.append("abcde", 5));
+        checkInt("pbuf/size", 5, a.size());
+        check("pbuf/frame in place", StreamFramer::frame(a, 3));
+        checkInt("pbuf/framed size", StreamFramer::HEADER_SIZE + 5, a.size());
+        checkInt("pbuf/framed headroom", 0, a.headroom());
+        check("pbuf/no headroom left", !StreamFramer::frame(a, 3));
+
+        // Same bytes as the copying path
+        FramedPacket fp = StreamFramer::createPacket(3, "abcde", 5);
+        check("pbuf/frame matches createPacket",
+              fp.size == a.size() && memcmp(fp.data, a.data(), fp.size) == 0);
+
+        PacketBuf b = std::move(a);
+        check("pbuf/moved-from is empty", !a && b);
+        checkInt("pbuf/one buffer in use", before.inUse + 1, packetPoolStats().inUse);
+    }
+    checkInt("pbuf/released on destruction", before.inUse, packetPoolStats().inUse);
+
+    // Exhaustion: tryAcquire fails cleanly, release makes room again
+    {
+        std::vector<PacketBuf> all;
+        while (PacketBuf b = PacketBuf::tryAcquire()) all.push_back(std::move(b));
+        checkInt("pbuf/slab fully handed out", before.capacity - before.inUse, (int)all.size());
+        check("pbuf/exhausted → empty handle", !PacketBuf::tryAcquire());
+        all.pop_back();
+        check("pbuf/release makes room", (bool)PacketBuf::tryAcquire());
+    }
+    checkInt("pbuf/all returned", before.inUse, packetPoolStats().inUse);
+
+    // A buffer crosses a channel without its bytes moving
+    scheduler_init();
+    auto* ch = makeChannel<PacketBuf>(2);
+    coro([ch]() {
+        PacketBuf buf = PacketBuf::acquire();
+        buf.append("xyz", 3);
+        const uint8_t* p = buf.data();
+        ch->send(std::move(buf));
+        check("pbuf/sender handle emptied", !buf);
+        auto res = ch->receive();
+        check("pbuf/same buffer received", !res.error && res.value.data() == p && res.value.size() == 3);
+    });
+    scheduler_start();
+    delete ch;
+    checkInt("pbuf/channel round trip returns buffer", before.inUse, packetPoolStats().inUse);
+
+#if COROCGO_HAS_THREADS
+    // acquire() on an empty slab sleeps until another thread drops a buffer
+    {
+        std::vector<PacketBuf> all;
+        while (PacketBuf b = PacketBuf::tryAcquire()) all.push_back(std::move(b));
+        PacketBuf last = std::move(all.back());
+        all.pop_back();
+        static bool   got;
+        static double waitedMs;
+        got = false;
+        scheduler_init();
+        coro([]() {
+            auto t0 = std::chrono::steady_clock::now();
+            PacketBuf buf = PacketBuf::acquire();
+            waitedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            got = (bool)buf;
+        });
+        std::thread releaser([&last]() {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            last.reset();
+        });
+        scheduler_start();
+        releaser.join();
+        check("pbuf/acquire woken by a release on another thread", got);
+        check("pbuf/acquire waited for the release", waitedMs >= 15);
+    }
+    checkInt("pbuf/all returned after wait", before.inUse, packetPoolStats().inUse);
+#endif
+}
+
+// ── Test 13: callAsync — window, precise deadlines, pooled calls ─────────
+// Link latency loopback: every packet is delivered delayMs after it was sent,
+// independently of the others (a wire with latency, not a slow server).
+static void startLatencyLoopback(Channel<RpcPacket>* src, Channel<RpcPacket>* dst, int delayMs) {
+    coro([src, dst, delayMs]() {
+        while (true) {
+            auto res = src->receive();
+            if (res.error) break;
+            auto* pkt = new RpcPacket(std::move(res.value));
+            coro([dst, delayMs, pkt]() {
+                sleep(delayMs);
+                if (!dst->isClosed()) dst->send(std::move(*pkt));
+                delete pkt;
+            });
+        }
+    });
+}
+
+static int64_t elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - since).count();
+}
+
+static void testCallAsync() {
+    std::cout << "\n=== Test 13: callAsync (window, deadlines, pooled calls) ===\n";
+    constexpr int WINDOW  = 4;
+    constexpr int CALLS   = 24;
+    constexpr int LINK_MS = 5;
+
+    // Pipelined vs one-at-a-time over a link with LINK_MS each way
+    {
+        auto* outCh = makeChannel<RpcPacket>(16);
+        auto* inCh  = makeChannel<RpcPacket>(16);
+        RpcManager rpc(outCh, inCh, 1000, WINDOW);
+        rpc.registerMethod(METHOD_ADD, [&rpc](RpcArg* arg) -> RpcArg* {
+            int32_t a = arg->getInt32();
+            int32_t b = arg->getInt32();
+            RpcArg* out = rpc.getRpcArg();
+            out->putInt32(a + b);
+            return out;
+        });
+        startLatencyLoopback(outCh, inCh, LINK_MS);
+
+        coro([&rpc, outCh, inCh]() {
+            auto t0 = std::chrono::steady_clock::now();
+            int serialOk = 0;
+            for (int i = 0; i < CALLS / 4; i++) {
+                RpcArg* arg = rpc.getRpcArg();
+                arg->putInt32(i);
+                arg->putInt32(1);
+                RpcResult r = rpc.call(METHOD_ADD, arg);
+                rpc.disposeRpcArg(arg);
+                if (r.error == RPC_OK && r.arg->getInt32() == i + 1) serialOk++;
+                rpc.disposeRpcArg(r.arg);
+            }
+            int64_t serialMs = elapsedMs(t0);
+
+            // Sliding window: keep WINDOW requests outstanding, consume the
+            // oldest result once the next request is queued
+            t0 = std::chrono::steady_clock::now();
+            std::vector<RpcFuture> futures(CALLS);
+            int asyncOk = 0;
+            auto consume = [&](int i) {
+                RpcResult r = futures[i].get();
+                if (r.error == RPC_OK && r.arg && r.arg->getInt32() == i + 100) asyncOk++;
+                rpc.disposeRpcArg(r.arg);
+            };
+            for (int i = 0; i < CALLS; i++) {
+                RpcArg* arg = rpc.getRpcArg();
+                arg->putInt32(i);
+                arg->putInt32(100);
+                futures[i] = rpc.callAsync(METHOD_ADD, arg);
+                rpc.disposeRpcArg(arg);   // serialized already
+                if (i >= WINDOW) consume(i - WINDOW);
+            }
+            for (int i = CALLS - WINDOW; i < CALLS; i++) consume(i);
+            int64_t asyncMs = elapsedMs(t0);
+
+            RpcCallStats st = rpc.callStats();
+            std::cout << "  serial: " << CALLS / 4 << " calls in " << serialMs << " ms, "
+                      << "async: " << CALLS << " calls in " << asyncMs << " ms (window " << WINDOW
+                      << ", peak " << st.peakInFlight << ", pooled " << st.pooledCalls << ")\n";
+            checkInt("async/serial results", CALLS / 4, serialOk);
+            checkInt("async/pipelined results in order", CALLS, asyncOk);
+            check("async/window respected", st.peakInFlight == WINDOW);
+            check("async/window stalled the producer", st.windowStalls > 0);
+            check("async/pending calls recycled", st.pooledCalls <= WINDOW + 2);
+            checkInt("async/none in flight", 0, st.inFlight);
+            // Per call: serial pays the full round trip, the window overlaps WINDOW of them
+            check("async/pipelining beats serial per call",
+                  asyncMs * (CALLS / 4) * 2 < serialMs * CALLS);
+
+            // Dropped futures: the response still frees the slot and its result
+            for (int i = 0; i < WINDOW * 2; i++) {
+                RpcArg* arg = rpc.getRpcArg();
+                arg->putInt32(1);
+                arg->putInt32(2);
+                rpc.callAsync(METHOD_ADD, arg);
+                rpc.disposeRpcArg(arg);
+            }
+            sleep(LINK_MS * 6);
+            RpcArgPoolStats ap = rpc.argPoolStats();
+            checkInt("async/dropped futures leak no RpcArg", 0, ap.small.inUse + ap.large.inUse);
+            checkInt("async/dropped futures leave the window", 0, rpc.callStats().inFlight);
+
+            outCh->close();
+            inCh->close();
+        });
+        scheduler_start();
+        delete outCh;
+        delete inCh;
+    }
+
+    // Deadlines: nothing ever answers (outCh is drained into the void)
+    {
+        auto* outCh = makeChannel<RpcPacket>(16);
+        auto* inCh  = makeChannel<RpcPacket>(16);
+        RpcManager rpc(outCh, inCh, 2000, WINDOW);
+        coro([outCh]() { while (!outCh->receive().error) {} });
+
+        coro([&rpc, outCh, inCh]() {
+            RpcArg* arg = rpc.getRpcArg();
+            auto t0 = std::chrono::steady_clock::now();
+            RpcFuture slow = rpc.callAsync(METHOD_SLOW, arg, 400);
+            RpcFuture fast = rpc.callAsync(METHOD_SLOW, arg, 40);   // armed after, fires first
+            RpcResult rf = fast.get();
+            int64_t fastMs = elapsedMs(t0);
+            check("deadline/fast still pending slow", !slow.ready());
+            RpcResult rs = slow.get();
+            int64_t slowMs = elapsedMs(t0);
+            std::cout << "  40 ms deadline fired at " << fastMs << " ms, 400 ms at " << slowMs << " ms\n";
+            checkInt("deadline/fast RPC_TIMEOUT", RPC_TIMEOUT, rf.error);
+            checkInt("deadline/slow RPC_TIMEOUT", RPC_TIMEOUT, rs.error);
+            check("deadline/fast on time", fastMs >= 40 && fastMs < 140);
+            check("deadline/slow on time", slowMs >= 400 && slowMs < 500);
+
+            // Closing inCh fails what is in flight instead of waiting for the deadline
+            RpcFuture pending = rpc.callAsync(METHOD_SLOW, arg);
+            rpc.disposeRpcArg(arg);
+            coro([inCh]() { sleep(20); inCh->close(); });
+            t0 = std::chrono::steady_clock::now();
+            RpcResult rc = pending.get();
+            checkInt("deadline/close → RPC_CLOSED", RPC_CLOSED, rc.error);
+            check("deadline/close is immediate", elapsedMs(t0) < 500);
+            checkInt("deadline/call after close", RPC_CLOSED,
+                     rpc.callAsync(METHOD_SLOW, nullptr).get().error);
+            checkInt("deadline/timeouts counted", 2, (int)rpc.callStats().timeouts);
+            outCh->close();
+        });
+        scheduler_start();
+        delete outCh;
+        delete inCh;
+    }
+}
+
+// ── Test 14: RpcArg pool — size classes, water marks, back-pressure ──────
+static void testArgPool() {
+    std::cout << "\n=== Test 14: RpcArg pool ===\n";
+
+    RpcArgPoolConfig cfg;
+    cfg.smallSize = 64;
+    cfg.lowWater  = 4;
+    cfg.highWater = 8;
+    cfg.slabSize  = 4;
+    RpcArgPool pool(cfg);
+
+    RpcArg* s = pool.tryGet();
+    RpcArg* l = pool.tryGet(500);
+    checkInt("apool/small class", 64, s->capacity);
+    checkInt("apool/size hint picks large", RPC_ARG_BUF_SIZE, l->capacity);
+
+    // Outgrowing a small buffer moves the arg to a large one, contents intact
+    char text[300];
+    memset(text, 'x', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+    s->putInt32(7);
+    s->putString(text);
+    checkInt("apool/promoted", RPC_ARG_BUF_SIZE, s->capacity);
+    checkInt("apool/promoted keeps data", 7, s->getInt32());
+    char back[300];
+    check("apool/promoted string", s->getString(back, sizeof(back)) == 299 && strcmp(back, text) == 0);
+    checkInt("apool/promotion counted", 1, (int)pool.stats().promotions);
+    pool.dispose(s);
+    pool.dispose(l);
+    pool.dispose(l);   // second dispose is ignored
+    checkInt("apool/all back", 0, pool.stats().large.inUse);
+
+    // Grows a slab at a time to the high-water mark, then borrows large
+    // buffers, then runs dry
+    std::vector<RpcArg*> held;
+    for (int i = 0; i < cfg.highWater; i++) held.push_back(pool.tryGet());
+    RpcArgPoolStats st = pool.stats();
+    checkInt("apool/small at high water", cfg.highWater, st.small.capacity);
+    held.push_back(pool.tryGet());
+    checkInt("apool/borrowed from large", 1, (int)pool.stats().borrowed);
+    while (RpcArg* a = pool.tryGet()) held.push_back(a);
+    checkInt("apool/everything handed out", 2 * cfg.highWater, (int)held.size());
+    check("apool/tryGet at high water → nullptr", pool.tryGet() == nullptr);
+
+    // Releasing everything frees idle slabs down to the low-water mark
+    for (RpcArg* a : held) pool.dispose(a);
+    held.clear();
+    st = pool.stats();
+    checkInt("apool/peak small", cfg.highWater, st.small.peak);
+    check("apool/trimmed to low water", st.small.capacity == cfg.lowWater && st.large.capacity == cfg.lowWater);
+    check("apool/slabs freed", st.slabsFreed >= 2);
+
+    // Back-pressure: the dispatch loop waits for an arg instead of dropping
+    // requests while someone else holds the whole pool
+    scheduler_init();
+    {
+        RpcArgPoolConfig tiny;
+        tiny.smallSize = 0;   // one class
+        tiny.lowWater  = 2;
+        tiny.highWater = 2;
+        tiny.slabSize  = 2;
+        auto* outCh = makeChannel<RpcPacket>(16);
+        auto* inCh  = makeChannel<RpcPacket>(16);
+        RpcManager rpc(outCh, inCh, 1000, 8, tiny);
+        int handled = 0;
+        rpc.registerMethod(METHOD_NOTIFY_NO_RESPONSE, [&handled](RpcArg*) -> RpcArg* {
+            handled++;
+            return nullptr;
+        });
+        startLoopback(outCh, inCh);
+
+        coro([&rpc, &handled, outCh, inCh]() {
+            RpcArg* a = rpc.getRpcArg();
+            RpcArg* b = rpc.getRpcArg();
+            check("apool/tiny pool exhausted", rpc.tryGetRpcArg() == nullptr);
+            a->putInt32(1);
+            for (int i = 0; i < 5; i++) rpc.callNoResponse(METHOD_NOTIFY_NO_RESPONSE, a);
+            sleep(30);
+            checkInt("apool/nothing handled while held", 0, handled);
+            rpc.disposeRpcArg(a);
+            rpc.disposeRpcArg(b);
+            sleep(10);
+            checkInt("apool/every request handled", 5, handled);
+            RpcArgPoolStats ts = rpc.argPoolStats();
+            check("apool/dispatch waited", ts.waits > 0);
+            checkInt("apool/never grew past high water", 2, ts.large.capacity);
+            outCh->close();
+            inCh->close();
+        });
+        scheduler_start();
+        delete outCh;
+        delete inCh;
+    }
+
+    // A response that waits for an arg past its call's deadline must not
+    // complete the newer call its recycled PendingCall now belongs to
+    scheduler_init();
+    {
+        RpcArgPoolConfig tiny;
+        tiny.smallSize = 0;
+        tiny.lowWater  = 2;
+        tiny.highWater = 2;
+        tiny.slabSize  = 2;
+        auto* aOut = makeChannel<RpcPacket>(16);
+        auto* aIn  = makeChannel<RpcPacket>(16);
+        auto* bOut = makeChannel<RpcPacket>(16);
+        auto* bIn  = makeChannel<RpcPacket>(16);
+        RpcManager client(aOut, aIn, 1000, 8, tiny);
+        RpcManager server(bOut, bIn);
+        server.registerMethod(METHOD_ADD, [&server](RpcArg* arg) -> RpcArg* {
+            int32_t a = arg->getInt32();
+            int32_t b = arg->getInt32();
+            RpcArg* out = server.getRpcArg();
+            out->putInt32(a + b);
+            return out;
+        });
+        startLoopback(aOut, bIn);
+        startLoopback(bOut, aIn);
+
+        coro([&client, aOut, aIn, bOut, bIn]() {
+            RpcArg* a = client.getRpcArg();
+            RpcArg* b = client.getRpcArg();
+            a->putInt32(1);
+            a->putInt32(2);
+            {
+                RpcFuture late = client.callAsync(METHOD_ADD, a, 20);
+                checkInt("apool/held response times out", RPC_TIMEOUT, late.get().error);
+            }
+            b->putInt32(10);
+            b->putInt32(20);
+            RpcFuture next = client.callAsync(METHOD_ADD, b);   // reuses the PendingCall
+            client.disposeRpcArg(a);
+            client.disposeRpcArg(b);
+            RpcResult r = next.get();
+            check("apool/late response leaves the newer call alone",
+                  r.error == RPC_OK && r.arg && r.arg->getInt32() == 30);
+            client.disposeRpcArg(r.arg);
+            checkInt("apool/nothing left in flight", 0, (int)client.callStats().inFlight);
+            aOut->close();
+            aIn->close();
+            bOut->close();
+            bIn->close();
+        });
+        scheduler_start();
+        delete aOut;
+        delete aIn;
+        delete bOut;
+        delete bIn;
+    }
+}
+
+// ── Test 15: CRC16 test vectors ──────────────────────────────────────────
+// Bit-at-a-time reference: the definition the table-driven engine must match.
+static uint16_t crc16Reference(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0xA001) : (uint16_t)(crc >> 1);
+    }
+    return crc;
+}
+
+static void testCrc16() {
+    std::cout << "\n=== Test 15: CRC16 (" << COROCRPC_CRC_SLICES << " slices) ===\n";
+    checkInt("crc/check value", 0x4B37, crc16((const uint8_t*)"123456789", 9));
+    checkInt("crc/empty", 0xFFFF, crc16(nullptr, 0));
+    const uint8_t zero = 0, ones = 0xFF;
+    checkInt("crc/0x00", crc16Reference(&zero, 1), crc16(&zero, 1));
+    checkInt("crc/0xFF", crc16Reference(&ones, 1), crc16(&ones, 1));
+
+    // Every length 0..80 at every alignment 0..7 against the reference
+    uint8_t buf[96];
+    uint32_t x = 0x12345678;
+    for (auto& b : buf) { x = x * 1103515245 + 12345; b = (uint8_t)(x >> 16); }
+    int mismatches = 0;
+    for (int off = 0; off < 8; off++)
+        for (size_t len = 0; len <= 80; len++)
+            if (crc16(buf + off, len) != crc16Reference(buf + off, len)) mismatches++;
+    checkInt("crc/all lengths and alignments", 0, mismatches);
+
+    // Frames produced before the slicing engine (byte-at-a-time table)
+    static const uint8_t FRAME_TEXT[] = {
+        0xEF,0xFE,0x0A,0x00,0x67,0x42,0x00,0x00,0x07,0x00,0xFE,0x52,
+        'I','n','p','u','t','P','r','o','x','y'};
+    static const uint8_t HEADER_300[] = {
+        0xEF,0xFE,0x2C,0x01,0xFF,0x73,0x00,0x00,0x34,0x12,0x99,0x81};
+    static const uint8_t FRAME_EMPTY[] = {
+        0xEF,0xFE,0x00,0x00,0xFF,0xFF,0x00,0x00,0x00,0x00,0x0C,0x1E};
+    FramedPacket a = StreamFramer::createPacket(7, "InputProxy", 10);
+    check("crc/golden text frame",
+          a.size == sizeof(FRAME_TEXT) && memcmp(a.data, FRAME_TEXT, a.size) == 0);
+    uint8_t pat[300];
+    for (int i = 0; i < 300; i++) pat[i] = (uint8_t)(i * 37 + 11);
+    FramedPacket b = StreamFramer::createPacket(0x1234, (const char*)pat, 300);
+    check("crc/golden 300-byte header", memcmp(b.data, HEADER_300, sizeof(HEADER_300)) == 0);
+    FramedPacket c = StreamFramer::createPacket(0, "", 0);
+    check("crc/golden empty frame",
+          c.size == sizeof(FRAME_EMPTY) && memcmp(c.data, FRAME_EMPTY, c.size) == 0);
+}
+
+// ── Benchmark: CRC16 engine vs byte-at-a-time ────────────────────────────
+static uint16_t crc16Bytewise(const uint8_t* data, size_t len) {
+    static uint16_t table[256];
+    if (!table[1])
+        for (int i = 0; i < 256; i++) {
+            uint16_t crc = (uint16_t)i;
+            for (int b = 0; b < 8; b++) crc = (crc & 1) ? (uint16_t)((crc >> 1) ^ 0xA001) : (uint16_t)(crc >> 1);
+            table[i] = crc;
+        }
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) crc = (uint16_t)((crc >> 8) ^ table[(uint8_t)(crc ^ data[i])]);
+    return crc;
+}
+
+static void benchCrc16() {
+    std::cout << "\n=== Benchmark: CRC16 (" << COROCRPC_CRC_SLICES << " slices vs byte-at-a-time) ===\n";
+    static uint8_t buf[SF_BUFFER_SIZE + 8];   // + room for the alignment offsets
+    for (size_t i = 0; i < sizeof(buf); i++) buf[i] = (uint8_t)(i * 131 + 7);
+    check("crc/bench tables agree", crc16Bytewise(buf, sizeof(buf)) == crc16(buf, sizeof(buf)));
+
+    struct Case { const char* label; size_t len; int iters; };
+    const Case cases[] = {
+        {"header 10 B", 10,             4000000},
+        {"axis 24 B",   24,             2000000},
+        {"1 KB",        1024,           50000},
+        {"2 KB",        SF_BUFFER_SIZE, 25000},
+    };
+    std::cout << "  size           bytewise MB/s   engine MB/s   speedup\n";
+    for (const Case& c : cases) {
+        double mbps[2];
+        volatile uint16_t sink = 0;
+        for (int v = 0; v < 2; v++) {
+            auto t0 = std::chrono::steady_clock::now();
+            for (int i = 0; i < c.iters; i++) {
+                const uint8_t* p = buf + (i & 7);   // vary alignment
+                sink = sink ^ (v ? crc16(p, c.len) : crc16Bytewise(p, c.len));
+            }
+            double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            mbps[v] = (double)c.len * c.iters / secs / 1e6;
+        }
+        printf("  %-12s %14.0f %13.0f %8.2fx\n", c.label, mbps[0], mbps[1], mbps[1] / mbps[0]);
+    }
+}
+
+// ── Test 16: StreamFramer fuzz ───────────────────────────────────────────
+// A deterministic stream of valid frames mixed with every resync case the
+// parser has: raw garbage full of magic bytes, false headers, oversized
+// sizes with a valid header CRC, frames cut short (header valid, content
+// missing — the parser must rescan what it swallowed) and frames with a
+// damaged byte. Fed in random chunk sizes; every valid frame must come out,
+// in order, and nothing else.
+struct FramerStreamFrame {
+    uint16_t             channel;
+    std::vector<uint8_t> content;
+};
+
+struct FramerStream {
+    std::vector<uint8_t>           bytes;
+    std::vector<FramerStreamFrame> frames;   // valid frames, in stream order
+};
+
+static uint32_t fuzzNext(uint32_t& x) { x = x * 1103515245 + 12345; return x >> 8; }
+
+// corruptPct: chance (0..100) that a slot is one of the damage cases
+static FramerStream buildFramerStream(uint32_t seed, int slots, int corruptPct, int maxContent) {
+    FramerStream st;
+    uint32_t x = seed;
+    auto emitFrame = [&](bool keep) -> std::vector<uint8_t> {
+        FramerStreamFrame f;
+        f.channel = (uint16_t)fuzzNext(x);
+        f.content.resize(fuzzNext(x) % (maxContent + 1));
+        for (auto& b : f.content) b = (uint8_t)fuzzNext(x);
+        FramedPacket fp = StreamFramer::createPacket(f.channel, (const char*)f.content.data(),
+                                                     (unsigned)f.content.size());
+        if (keep) st.frames.push_back(std::move(f));
+        return std::vector<uint8_t>(fp.data, fp.data + fp.size);
+    };
+    auto append = [&](const std::vector<uint8_t>& v) { st.bytes.insert(st.bytes.end(), v.begin(), v.end()); };
+
+    for (int i = 0; i < slots; i++) {
+        if ((int)(fuzzNext(x) % 100) >= corruptPct) { append(emitFrame(true)); continue; }
+        switch (fuzzNext(x) % 5) {
+        case 0: {   // garbage, magic-heavy
+            int n = 1 + fuzzNext(x) % 64;
+            for (int k = 0; k < n; k++) {
+                uint32_t r = fuzzNext(x);
+                st.bytes.push_back((r & 3) == 0 ? 0xEF : (r & 3) == 1 ? 0xFE : (uint8_t)(r >> 8));
+            }
+            break;
+        }
+        case 1: {   // magic + random header
+            st.bytes.push_back(0xEF); st.bytes.push_back(0xFE);
+            for (int k = 0; k < 10; k++) st.bytes.push_back((uint8_t)fuzzNext(x));
+            break;
+        }
+        case 2: {   // valid header CRC, size beyond the buffer
+            uint8_t h[12] = {0xEF, 0xFE, 0xFF, 0x7F, 0, 0, 0, 0, 1, 0};
+            uint16_t crc = crc16(h, 10);
+            h[10] = (uint8_t)crc; h[11] = (uint8_t)(crc >> 8);
+            st.bytes.insert(st.bytes.end(), h, h + 12);
+            break;
+        }
+        case 3: {   // frame cut short (inside header or content)
+            std::vector<uint8_t> v = emitFrame(false);
+            v.resize(1 + fuzzNext(x) % (v.size() - 1 ? v.size() - 1 : 1));
+            append(v);
+            break;
+        }
+        default: {  // one damaged byte
+            std::vector<uint8_t> v = emitFrame(false);
+            v[fuzzNext(x) % v.size()] ^= (uint8_t)(1 + fuzzNext(x) % 255);
+            append(v);
+            break;
+        }
+        }
+    }
+    // Flush: a cut frame may still be waiting for its declared length
+    st.bytes.insert(st.bytes.end(), SF_BUFFER_SIZE, 0x00);
+    return st;
+}
+
+// Feeds st.bytes through a framer in chunks of 1..maxChunk bytes — via
+// writeCh, or write() when `direct` — and checks the frames against
+// st.frames (only counts them when !verify). Returns the framer's counters.
+static StreamFramerStats runFramerStream(const FramerStream& st, int maxChunk, uint32_t seed,
+                                         int& mismatches, int& received,
+                                         bool direct = false, bool verify = true) {
+    StreamFramer framer;
+    StreamFramerStats out;
+    mismatches = 0;
+    received   = 0;
+
+    coro([&]() {
+        uint32_t x = seed;
+        size_t off = 0;
+        while (off < st.bytes.size()) {
+            size_t n = 1 + fuzzNext(x) % maxChunk;
+            if (n > st.bytes.size() - off) n = st.bytes.size() - off;
+            if (direct) {
+                framer.write(st.bytes.data() + off, n);
+            } else {
+                RawChunk chunk;
+                memcpy(chunk.data, st.bytes.data() + off, n);
+                chunk.len = (uint16_t)n;
+                framer.writeCh->send(chunk);
+            }
+            off += n;
+        }
+        // End marker: the only frame on channel 0xFFFF
+        FramedPacket fp = StreamFramer::createPacket(0xFFFF, "end", 3);
+        if (direct) {
+            framer.write(fp.data, fp.size);
+        } else {
+            RawChunk chunk;
+            memcpy(chunk.data, fp.data, fp.size);
+            chunk.len = fp.size;
+            framer.writeCh->send(chunk);
+        }
+    });
+
+    coro([&]() {
+        while (true) {
+            auto res = framer.readCh->receive();
+            if (res.error) break;
+            if (res.value.channel() == 0xFFFF && res.value.size() == 3) break;
+            if (!verify) {
+                received++;
+                continue;
+            }
+            if (received < (int)st.frames.size()) {
+                const FramerStreamFrame& f = st.frames[received];
+                if (res.value.channel() != f.channel || res.value.size() != f.content.size() ||
+                    (!f.content.empty() && memcmp(res.value.data(), f.content.data(), f.content.size()) != 0))
+                    mismatches++;
+            } else {
+                mismatches++;
+            }
+            received++;
+        }
+        out = framer.stats();
+        framer.writeCh->close();
+    });
+
+    scheduler_start();
+    return out;
+}
+
+static void testFramerFuzz() {
+    std::cout << "\n=== Test 16: StreamFramer fuzz ===\n";
+    int before = packetPoolStats().inUse;
+
+    const struct { const char* label; uint32_t seed; int maxChunk; bool direct; } runs[] = {
+        {"sffuzz/1-byte chunks",    11, 1,                  false},
+        {"sffuzz/small chunks",     22, 16,                 false},
+        {"sffuzz/full chunks",      33, RawChunk::MAX_SIZE, false},
+        {"sffuzz/write() 4 KB",     44, 4096,               true},
+    };
+    for (const auto& r : runs) {
+        FramerStream st = buildFramerStream(r.seed, 400, 30, 700);
+        int mismatches, received;
+        StreamFramerStats fs = runFramerStream(st, r.maxChunk, r.seed * 7, mismatches, received, r.direct);
+        std::string name = r.label;
+        checkInt((name + " frames").c_str(), (int)st.frames.size(), received);
+        checkInt((name + " content").c_str(), 0, mismatches);
+        check((name + " resynced").c_str(), fs.headerErrors > 0 && fs.contentErrors > 0 && fs.skipped > 0);
+    }
+    checkInt("sffuzz/no packet buffers leaked", before, packetPoolStats().inUse);
+}
+
+// ── Benchmark: StreamFramer parse throughput ──────────────────────────────
+// RPC-sized frames (0..300 B content): clean, with 10% damaged slots, and
+// line noise (half the slots damaged, mostly garbage to scan through).
+// Measures the whole receive path — writeCh (full RawChunks) or write()
+// (up to 4 KB reads) → parse → readCh.
+static void benchFramer() {
+    std::cout << "\n=== Benchmark: StreamFramer parse ===\n";
+    const struct { const char* label; int corruptPct; } cases[] = {
+        {"clean",        0},
+        {"10% damaged", 10},
+        {"50% damaged", 50},
+    };
+    const int reps = 40;
+    std::cout << "  traffic        writeCh MB/s   write() MB/s   frames/s (write)\n";
+    for (const auto& c : cases) {
+        FramerStream st = buildFramerStream(1234, 8000, c.corruptPct, 300);
+        double mbps[2], fps = 0;
+        for (int direct = 0; direct < 2; direct++) {
+            auto t0 = std::chrono::steady_clock::now();
+            for (int rep = 0; rep < reps; rep++) {
+                int mm, rcv;
+                runFramerStream(st, direct ? 4096 : RawChunk::MAX_SIZE, 99, mm, rcv, direct, /*verify=*/false);
+            }
+            double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+            mbps[direct] = (double)st.bytes.size() * reps / secs / 1e6;
+            fps          = (double)st.frames.size() * reps / secs;
+        }
+        printf("  %-12s %14.1f %14.1f %18.0f\n", c.label, mbps[0], mbps[1], fps);
+        int mismatches, received;
+        runFramerStream(st, RawChunk::MAX_SIZE, 99, mismatches, received);
+        check((std::string("sfbench/") + c.label + " frames intact").c_str(),
+              mismatches == 0 && received == (int)st.frames.size());
+    }
+}
+
+#if COROCGO_HAS_FILE_IO
+// ── Benchmark: axis updates over a pipe loopback ─────────────────────────
+// Topology (same as mainboard UART path, with a pipe instead of a tty):
+//   rpc.outCh → frame in place → write(pipe) … read(pipe) → framer → rpc.inCh
+// One axis update per frame, encoded either as 3×int32 or as one packed record.
+struct PipeBenchResult {
+    double framesPerSec;
+    double bytesPerFrame;
+};
+
+static PipeBenchResult benchPipeLoopback(bool packed, int frames) {
+    int fds[2];
+    if (pipe(fds) != 0) return {0, 0};
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    fcntl(fds[1], F_SETFL, fcntl(fds[1], F_GETFL) | O_NONBLOCK);
+
+    auto* rpcOut = makeChannel<RpcPacket>(16);
+    auto* rpcIn  = makeChannel<RpcPacket>(16);
+    RpcManager rpc(rpcOut, rpcIn);
+    StreamFramer framer;
+
+    static int received;
+    static long long checksum;
+    received = 0;
+    checksum = 0;
+    long long bytesOnWire = 0;
+    std::chrono::steady_clock::duration elapsed{};
+
+    rpc.registerMethod(METHOD_AXIS_INT32, [](RpcArg* arg) -> RpcArg* {
+        int32_t d = arg->getInt32(), ax = arg->getInt32(), v = arg->getInt32();
+        checksum += d + ax + v;
+        received++;
+        return nullptr;
+    });
+    rpc.registerMethod(METHOD_AXIS_PACKED, [](RpcArg* arg) -> RpcArg* {
+        uint32_t n = arg->getVarUInt();
+        int32_t d, ax, v;
+        for (uint32_t i = 0; i < n && arg->getAxisUpdate(d, ax, v); i++) {
+            checksum += d + ax + v;
+            received++;
+        }
+        return nullptr;
+    });
+
+    // Outbound: frame and write into the pipe
+    coro([rpcOut, &framer, &bytesOnWire, wfd = fds[1]]() {
+        while (true) {
+            auto res = rpcOut->receive();
+            if (res.error) break;
+            RpcPacket& pkt = res.value;
+            if (!StreamFramer::frame(pkt, 0)) continue;
+            int off = 0;
+            while (off < pkt.size()) {
+                ssize_t n = write(wfd, pkt.data() + off, pkt.size() - off);
+                if (n > 0) { off += (int)n; continue; }
+                if (n < 0 && errno != EAGAIN) return;
+                wait_file(wfd, WAIT_OUT);
+            }
+            bytesOnWire += pkt.size();
+        }
+    });
+
+    // Pipe reader: raw bytes → framer
+    coro([&framer, rfd = fds[0]]() {
+        while (true) {
+            RawChunk chunk;
+            ssize_t n = read(rfd, chunk.data, RawChunk::MAX_SIZE);
+            if (n > 0) { chunk.len = (uint16_t)n; framer.writeCh->send(chunk); continue; }
+            if (n == 0 || errno != EAGAIN) break;   // writer closed
+            wait_file(rfd, WAIT_IN);
+        }
+        framer.writeCh->close();
+    });
+
+    // Inbound: the frame's buffer (content range) → rpc.inCh
+    coro([&framer, rpcIn]() {
+        while (true) {
+            auto res = framer.readCh->receive();
+            if (res.error) break;
+            rpcIn->send(std::move(res.value));
+        }
+    });
+
+    coro([&, frames, packed]() {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; i++) {
+            int32_t device = i & 3, axis = i % 24, value = (i * 37) % 1001;
+            RpcArg* arg = rpc.getRpcArg();
+            if (packed) {
+                arg->putVarUInt(1);
+                arg->putAxisUpdate(device, axis, value);
+                rpc.callNoResponse(METHOD_AXIS_PACKED, arg);
+            } else {
+                arg->putInt32(device);
+                arg->putInt32(axis);
+                arg->putInt32(value);
+                rpc.callNoResponse(METHOD_AXIS_INT32, arg);
+            }
+            rpc.disposeRpcArg(arg);
+        }
+        while (received < frames) coro_yield();
+        elapsed = std::chrono::steady_clock::now() - start;
+
+        close(fds[1]);          // pipe reader sees EOF, closes framer.writeCh
+        rpcOut->close();
+        rpcIn->close();
+        framer.readCh->close();
+    });
+
+    scheduler_start();
+    close(fds[0]);
+    delete rpcOut;
+    delete rpcIn;
+
+    double secs = std::chrono::duration<double>(elapsed).count();
+    return { secs > 0 ? frames / secs : 0, (double)bytesOnWire / frames };
+}
+
+static void benchAxisEncoding() {
+    std::cout << "\n=== Benchmark: axis update encoding over pipe loopback ===\n";
+    const int frames = 100000;
+    const double uartBytesPerSec = 230400.0 / 10;   // 8N1
+
+    PipeBenchResult wide   = benchPipeLoopback(false, frames);
+    PipeBenchResult narrow = benchPipeLoopback(true,  frames);
+    check("bench/int32 all delivered",  wide.framesPerSec > 0);
+    check("bench/packed all delivered", narrow.framesPerSec > 0);
+    check("bench/packed frame smaller", narrow.bytesPerFrame < wide.bytesPerFrame);
+
+    printf("  %-8s %10s %12s %16s\n", "encoding", "bytes/frm", "pipe frm/s", "230400bd frm/s");
+    printf("  %-8s %10.1f %12.0f %16.0f\n", "int32",
+           wide.bytesPerFrame, wide.framesPerSec, uartBytesPerSec / wide.bytesPerFrame);
+    printf("  %-8s %10.1f %12.0f %16.0f\n", "packed",
+           narrow.bytesPerFrame, narrow.framesPerSec, uartBytesPerSec / narrow.bytesPerFrame);
+    printf("  UART-bound gain: %.2fx\n", wide.bytesPerFrame / narrow.bytesPerFrame);
+}
+#endif // COROCGO_HAS_FILE_IO
+
 // ── Main ──────────────────────────────────────────────────────────────────
 
 int main() {
@@ -771,6 +1648,35 @@ int main() {
     testStreamingSendAll();
 #endif // COROCRPC_STREAMING
 
+    // Test 11: compact encoding
+    testCompactEncoding();
+
+    // Test 12: PacketBuf
+    testPacketBuf();
+
+    // Test 13: callAsync
+    testCallAsync();
+
+    // Test 14: RpcArg pool
+    testArgPool();
+
+    // Test 15: CRC16
+    testCrc16();
+
+    // Test 16: StreamFramer fuzz
+    testFramerFuzz();
+
+    benchCrc16();
+    benchFramer();
+
+#if COROCGO_HAS_FILE_IO
+    benchAxisEncoding();
+#endif
+
+    PacketPoolStats pool = packetPoolStats();
+    checkInt("pbuf/no buffers leaked by the suite", 0, pool.inUse);
+    std::cout << "  packet slab: " << pool.capacity << " buffers, peak " << pool.peak << " in use\n";
+
     // ── Summary ───────────────────────────────────────────────────────────
     std::cout << "\n=== Results: " << g_passed << " passed, " << g_failed << " failed ===\n";
     return g_failed == 0 ? 0 : 1;
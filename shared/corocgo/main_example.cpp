@@ -1,11 +1,23 @@
 //  main_example.cpp
 
 #include "corocgo.h"
+#include "minicoro.h"   // mco_running()->stack_base for the canary test
 #include <stdio.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
 #include <string>
 #include <cassert>
 #include <thread>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <algorithm>
 
 using namespace std;
 using namespace corocgo;
@@ -128,6 +140,23 @@ static void test_channel() {
         delete log;
     }
 
+    // --- trySend: never blocks, false when full ---
+    {
+        auto* ch = makeChannel<int>(2);
+        bool a = ch->trySend(1);
+        bool b = ch->trySend(2);
+        bool c = ch->trySend(3);   // full
+        int v1 = ch->tryReceive().value;
+        bool d = ch->trySend(4);   // a slot is free again
+        int v2 = ch->tryReceive().value;
+        int v3 = ch->tryReceive().value;
+        ch->close();
+        bool e = ch->trySend(5);   // closed
+        check(a && b && !c && d && !e && v1 == 1 && v2 == 2 && v3 == 4,
+              "trySend fills free slots, fails when full or closed");
+        delete ch;
+    }
+
     // --- close propagates to receiver ---
     {
         auto* ch = makeChannel<string>(2);
@@ -277,6 +306,694 @@ static void test_wait_file() {
     delete log;
 }
 
+// ── test: sleep timers ───────────────────────────────────────────────────────
+// Many sleepers with shuffled deadlines must wake in deadline order, and
+// sleep_cancel() must end a sleep early — in both scheduler modes.
+
+static void test_sleep_timers() {
+    printf("\n[test_sleep_timers]\n");
+    const int SLEEPERS = 200;
+
+    auto* order = makeChannel<int>(SLEEPERS);
+    for (int i = 0; i < SLEEPERS; i++) {
+        int ms = 20 * ((i * 37) % 10);   // shuffled, 20 per deadline; 20 ms apart absorbs spawn skew
+        coro([order, ms]() {
+            sleep(ms);
+            order->send(ms);
+        });
+    }
+    scheduler_start();
+    bool sorted = true;
+    int prev = 0;
+    for (int i = 0; i < SLEEPERS; i++) {
+        auto [ms, err] = order->tryReceive();
+        if (err || ms < prev) { sorted = false; break; }
+        prev = ms;
+    }
+    check(sorted, "sleepers wake in deadline order");
+
+    for (int workers : {1, 4}) {
+        auto* handles  = makeChannel<CoroHandle>(1);
+        auto* sleptMs  = makeChannel<long long>(1);
+        auto* cancelOk = makeChannel<bool>(1);
+        coro([handles, sleptMs]() {
+            handles->send(coro_self());
+            auto t0 = chrono::steady_clock::now();
+            bool full = sleep(10000);
+            auto ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - t0).count();
+            sleptMs->send(full ? -1 : ms);
+        });
+        coro([handles, cancelOk]() {
+            CoroHandle h = handles->receive().value;
+            sleep(5);
+            bool woke = sleep_cancel(h);
+            sleep(5);
+            bool again = sleep_cancel(h);   // already woken and finished
+            cancelOk->send(woke && !again);
+        });
+        scheduler_start(workers);
+        long long ms = sleptMs->tryReceive().value;
+        bool      ok = cancelOk->tryReceive().value;
+        char label[96];
+        snprintf(label, sizeof(label), "sleep_cancel ends a 10 s sleep early (%d worker%s, %lld ms)",
+                 workers, workers > 1 ? "s" : "", ms);
+        check(ms >= 0 && ms < 1000 && ok, label);
+    }
+}
+
+// ── test: fd registration ────────────────────────────────────────────────────
+// A coroutine reads a pipe through a persistent register_fd() registration
+// while another thread writes bursts into it: every byte must arrive, data
+// already waiting must not block, and unregister_fd() must release a waiter.
+// Runs with the poll thread, inline I/O and the M:N scheduler.
+
+static void fd_registration_round(const char* mode, int workers, bool inlineIo) {
+    const int BURSTS = 200, BURST = 37;
+    int fds[2];
+    assert(pipe(fds) == 0);
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    scheduler_io_inline(inlineIo);
+
+    int  total     = 0;
+    bool regOk     = false;
+    bool latchedOk = false;
+    bool unregOk   = false;
+    coro([&]() {
+        regOk = register_fd(fds[0], WAIT_IN) == 0;
+        thread writer([&]() {
+            char buf[BURST];
+            memset(buf, 'x', sizeof(buf));
+            for (int i = 0; i < BURSTS; i++) {
+                (void)!write(fds[1], buf, sizeof(buf));
+                if (i % 8 == 0) this_thread::sleep_for(chrono::microseconds(200));
+            }
+        });
+        while (total < BURSTS * BURST) {
+            auto [flags, err] = wait_file(fds[0], WAIT_IN);
+            if (err) break;
+            char buf[256];
+            ssize_t n;
+            while ((n = read(fds[0], buf, sizeof(buf))) > 0) total += (int)n;   // drain to EAGAIN
+        }
+        writer.join();
+
+        // Written while nobody waits: the next wait returns without parking
+        (void)!write(fds[1], "y", 1);
+        sleep(5);
+        auto t0 = chrono::steady_clock::now();
+        auto [flags, err] = wait_file(fds[0], WAIT_IN);
+        latchedOk = !err && (flags & WAIT_IN) && chrono::steady_clock::now() - t0 < chrono::milliseconds(2);
+        char c;
+        (void)!read(fds[0], &c, 1);
+
+        // unregister_fd() wakes a parked waiter with EBADF
+        auto* done = makeChannel<int>(1);
+        coro([&fds, done]() {
+            auto [f, e] = wait_file(fds[0], WAIT_IN);
+            done->send(e);
+        });
+        sleep(5);
+        unregister_fd(fds[0]);
+        unregOk = done->receive().value == EBADF;
+        delete done;
+    });
+    scheduler_start(workers);
+    scheduler_io_inline(false);
+    close(fds[0]);
+    close(fds[1]);
+
+    char label[96];
+    snprintf(label, sizeof(label), "register_fd: all %d bytes read (%s)", BURSTS * BURST, mode);
+    check(regOk && total == BURSTS * BURST, label);
+    snprintf(label, sizeof(label), "register_fd: latched readiness returns at once (%s)", mode);
+    check(latchedOk, label);
+    snprintf(label, sizeof(label), "unregister_fd wakes the waiter with EBADF (%s)", mode);
+    check(unregOk, label);
+}
+
+static void test_fd_registration() {
+    printf("\n[test_fd_registration]\n");
+    fd_registration_round("poll thread", 1, false);
+    fd_registration_round("inline",      1, true);
+    fd_registration_round("4 workers",   4, false);
+}
+
+// ── test: completion I/O ─────────────────────────────────────────────────────
+// co_read/co_write over a pipe and co_accept/co_recv/co_send over a loopback
+// TCP connection, with the io_uring ring and with the readiness fallback.
+
+static void co_io_round(bool uring) {
+    scheduler_io_uring(uring);
+    int p[2];
+    assert(pipe(p) == 0);
+    int lsock = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t alen       = sizeof(addr);
+    assert(bind(lsock, (sockaddr*)&addr, sizeof(addr)) == 0 && listen(lsock, 4) == 0);
+    getsockname(lsock, (sockaddr*)&addr, &alen);
+
+    bool active = false, pipeOk = false, sockOk = false;
+    coro([&]() {
+        active = co_uring_active();
+        coro([&]() {   // reader posts first; the writer shows up later
+            char buf[16] = {};
+            ssize_t n = co_read(p[0], buf, sizeof(buf));
+            pipeOk = n == 5 && string(buf) == "hello";
+        });
+        sleep(5);
+        co_write(p[1], "hello", 5);
+
+        thread client([addr]() {
+            int c = socket(AF_INET, SOCK_STREAM, 0);
+            connect(c, (sockaddr*)&addr, sizeof(addr));
+            (void)!write(c, "ping", 4);
+            char buf[4];
+            (void)!read(c, buf, 4);
+            close(c);
+        });
+        int conn = co_accept(lsock, nullptr, nullptr, SOCK_NONBLOCK);
+        char buf[8] = {};
+        ssize_t n = co_recv(conn, buf, sizeof(buf));
+        ssize_t w = co_send(conn, "pong", 4, MSG_NOSIGNAL);
+        client.join();
+        sockOk = conn >= 0 && n == 4 && string(buf) == "ping" && w == 4;
+        close(conn);
+    });
+    scheduler_start();
+    scheduler_io_uring(false);
+    close(p[0]);
+    close(p[1]);
+    close(lsock);
+
+    const char* mode = uring ? (active ? "io_uring" : "io_uring unavailable, fallback") : "readiness fallback";
+    char label[96];
+    snprintf(label, sizeof(label), "co_read/co_write pipe (%s)", mode);
+    check(pipeOk, label);
+    snprintf(label, sizeof(label), "co_accept/co_recv/co_send TCP (%s)", mode);
+    check(sockOk, label);
+}
+
+static void test_co_io() {
+    printf("\n[test_co_io]\n");
+    co_io_round(true);
+    co_io_round(false);
+}
+
+// ── test: M:N scheduler ──────────────────────────────────────────────────────
+// Runs the same primitives with scheduler_start(workers > 1): channels shared
+// by coroutines on different worker threads, select, sleep, pinned coroutines,
+// external wakes and deadlock detection.
+
+static void test_mt_scheduler() {
+    printf("\n[test_mt_scheduler]\n");
+    const int WORKERS = 4;
+
+    // --- many producers / consumers on one channel ---
+    {
+        const int PRODUCERS = 8, CONSUMERS = 8, PER_PRODUCER = 20000;
+        auto* ch       = makeChannel<int>(16);
+        auto* finished = makeChannel<int>(PRODUCERS);
+        atomic<long> sum{0};
+        atomic<int>  received{0};
+
+        for (int p = 0; p < PRODUCERS; p++) {
+            coro([ch, finished]() {
+                for (int i = 1; i <= PER_PRODUCER; i++) ch->send(i);
+                finished->send(1);
+            });
+        }
+        coro([ch, finished]() {
+            for (int p = 0; p < PRODUCERS; p++) finished->receive();
+            ch->close();
+        });
+        for (int c = 0; c < CONSUMERS; c++) {
+            coro([ch, &sum, &received]() {
+                while (true) {
+                    auto [v, err] = ch->receive();
+                    if (err) break;
+                    sum += v;
+                    received++;
+                }
+            });
+        }
+
+        SchedulerResult r = scheduler_start(WORKERS);
+        long expected = (long)PRODUCERS * PER_PRODUCER * (PER_PRODUCER + 1) / 2;
+        check(r == SUCCESS, "mt: producers/consumers finish without deadlock");
+        check(received == PRODUCERS * PER_PRODUCER && sum == expected,
+              "mt: every value received exactly once");
+        delete ch;
+        delete finished;
+    }
+
+    // --- select across workers ---
+    {
+        const int PER_CHANNEL = 5000;
+        auto* a = makeChannel<int>(4);
+        auto* b = makeChannel<int>(4);
+        long got = 0;
+
+        coro([a]() { for (int i = 0; i < PER_CHANNEL; i++) a->send(1); a->close(); });
+        coro([b]() { for (int i = 0; i < PER_CHANNEL; i++) b->send(2); b->close(); });
+        coro([a, b, &got]() {
+            while (true) {
+                int r = select(Recv(a, [&got](int v) { got += v; }),
+                               Recv(b, [&got](int v) { got += v; }));
+                if (r == SELECT_CLOSED) break;
+            }
+        });
+
+        scheduler_start(WORKERS);
+        check(got == 3L * PER_CHANNEL, "mt: select sees every value from both channels");
+        delete a;
+        delete b;
+    }
+
+    // --- sleep, pinning, inheritance ---
+    {
+        atomic<int> woke{0};
+        atomic<bool> pinnedOk{true};
+        auto start = chrono::steady_clock::now();
+
+        for (int i = 0; i < 50; i++) coro([&woke]() { sleep(10); woke++; });
+        coro_pinned(2, [&pinnedOk]() {
+            for (int i = 0; i < 100; i++) {
+                if (coro_worker_id() != 2) pinnedOk = false;
+                if (i % 10 == 0) sleep(1); else coro_yield();
+            }
+            coro([&pinnedOk]() {   // inherits the pin
+                for (int i = 0; i < 20; i++) {
+                    if (coro_worker_id() != 2) pinnedOk = false;
+                    coro_yield();
+                }
+            });
+        });
+
+        scheduler_start(WORKERS);
+        auto ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+        check(woke == 50 && ms >= 10, "mt: all sleepers wake after their deadline");
+        check(pinnedOk, "mt: pinned coroutine and its children stay on their worker");
+    }
+
+    // --- external producer + exec_thread ---
+    {
+        auto* ch = makeChannel<int>(4, 16);
+        int sum = 0;
+        coro([ch]() {
+            exec_thread([ch](auto wake) {
+                for (int i = 1; i <= 100; i++)
+                    while (!ch->sendExternalNoBlock(i)) this_thread::yield();
+                wake();
+            });
+            ch->close();
+        });
+        coro([ch, &sum]() {
+            while (true) {
+                auto [v, err] = ch->receive();
+                if (err) break;
+                sum += v;
+            }
+        });
+        scheduler_start(WORKERS);
+        check(sum == 5050, "mt: sendExternalNoBlock values all received");
+        delete ch;
+    }
+
+    // --- deadlock detection ---
+    {
+        auto* ch = makeChannel<int>(1);
+        coro([ch]() { ch->receive(); });
+        check(scheduler_start(WORKERS) == DEADLOCK, "mt: blocked-forever receive reported as DEADLOCK");
+    }
+}
+
+// ── test: stack pool ─────────────────────────────────────────────────────────
+// coro(fn, stackSize) gives a stack that holds what was asked for, dead
+// coroutines' stacks are reused, and a clobbered canary aborts the process.
+
+static void test_stack_pool() {
+    printf("\n[test_stack_pool]\n");
+
+    bool deepOk = false;
+    coro([&deepOk]() {
+        volatile char big[192 * 1024];   // far past the 56 KB default
+        big[0] = 1;
+        big[sizeof(big) - 1] = 2;
+        deepOk = big[0] + big[sizeof(big) - 1] == 3;
+    }, 256 * 1024);
+    scheduler_start();
+    check(deepOk, "coro(fn, 256 KB) runs a 192 KB frame");
+
+    StackPoolStats before = stack_pool_stats();
+    coro([]() {
+        for (int i = 0; i < 10; i++) {
+            bool ran = false;
+            coro([&ran]() { ran = true; }, 32 * 1024);
+            while (!ran) coro_yield();
+        }
+    });
+    coro([]() {}, 64 * 1024 * 1024);   // above the largest class
+    scheduler_start();
+    StackPoolStats after = stack_pool_stats();
+    check(after.hits - before.hits >= 9, "sequential spawns reuse a pooled stack");
+    check(after.oversize - before.oversize == 1, "oversized stack bypasses the pool");
+
+#if COROCGO_STACK_CHECK
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        dup2(open("/dev/null", O_WRONLY), 2);   // keep the abort message out of the log
+        coro([]() {
+            memset(mco_running()->stack_base, 0, 16);   // what an overflow does to the canary
+            coro_yield();
+        });
+        scheduler_start();
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    check(WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT, "clobbered stack canary aborts");
+#endif
+}
+
+// ── test: profiler ───────────────────────────────────────────────────────────
+// Rows per coroutine name: a CPU hog shows a long slice over the budget, a
+// sleeper shows parked time, and finished coroutines leave live at 0.
+
+static void test_profiler() {
+    printf("\n[test_profiler]\n");
+    profiler_reset();
+    profiler_enable(true, 2000);
+    coro_named("test-hog", []() {
+        auto until = chrono::steady_clock::now() + chrono::milliseconds(5);
+        while (chrono::steady_clock::now() < until) {}
+        coro_yield();
+    });
+    coro_named("test-sleeper", []() {
+        for (int i = 0; i < 3; i++) sleep(20);
+    });
+    for (int i = 0; i < 4; i++) coro([]() { coro_yield(); });
+    scheduler_start();
+    profiler_enable(false);
+
+    CoroProfile hog{}, sleeper{}, unnamed{};
+    for (const CoroProfile& p : profiler_snapshot()) {
+        if (strcmp(p.name, "test-hog") == 0)     hog = p;
+        if (strcmp(p.name, "test-sleeper") == 0) sleeper = p;
+        if (strcmp(p.name, "(unnamed)") == 0)    unnamed = p;
+    }
+    check(hog.resumes == 2 && hog.maxSliceNs >= 5000000 && hog.longSlices == 1,
+          "profiler: hog has one 5 ms slice over a 2 ms budget");
+    check(sleeper.resumes == 4 && sleeper.parkedNs >= 55000000 && sleeper.longSlices == 0,
+          "profiler: sleeper's time shows up as parked");
+    check(unnamed.coroutines == 4 && unnamed.resumes == 8, "profiler: unnamed coroutines share one row");
+    check(hog.live == 0 && sleeper.live == 0 && unnamed.live == 0, "profiler: no live coroutines after the run");
+
+    profiler_reset();
+    bool cleared = true;
+    for (const CoroProfile& p : profiler_snapshot()) cleared = cleared && p.resumes == 0 && p.runNs == 0;
+    check(cleared, "profiler: reset clears the counters");
+}
+
+// ── bench: ping-pong and fan-out ────────────────────────────────────────────
+// ping-pong: two coroutines bounce a token through two 1-slot channels — the
+// cost of a blocking handoff (cross-thread once workers > 1; "profiled" adds
+// the profiler's two clock reads per resume).
+// fan-out: one producer feeds CPU-bound jobs to many consumers — shows what
+// the extra workers buy when coroutines actually compute.
+
+static void bench_ping_pong(int workers, bool profiled = false) {
+    const int ROUNDS = 100000;
+    auto* ping = makeChannel<int>(1);
+    auto* pong = makeChannel<int>(1);
+
+    coro([ping, pong]() {
+        for (int i = 0; i < ROUNDS; i++) {
+            ping->send(i);
+            pong->receive();
+        }
+        ping->close();
+    });
+    coro([ping, pong]() {
+        while (true) {
+            auto [v, err] = ping->receive();
+            if (err) break;
+            pong->send(v);
+        }
+    });
+
+    profiler_enable(profiled);
+    auto start = chrono::steady_clock::now();
+    scheduler_start(workers);
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    profiler_enable(false);
+    printf("  ping-pong  workers=%d%s: %d round trips, %.0f ns/round trip\n",
+           workers, profiled ? " profiled" : "", ROUNDS, secs * 1e9 / ROUNDS);
+    delete ping;
+    delete pong;
+}
+
+static uint64_t spin_work(uint64_t x, int iters) {
+    for (int i = 0; i < iters; i++) x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+    return x;
+}
+
+static void bench_fan_out(int workers) {
+    const int JOBS = 4000, CONSUMERS = 16, ITERS = 50000;
+    auto* jobs = makeChannel<int>(64);
+    atomic<uint64_t> acc{0};
+
+    coro([jobs]() {
+        for (int i = 0; i < JOBS; i++) jobs->send(i);
+        jobs->close();
+    });
+    for (int c = 0; c < CONSUMERS; c++) {
+        coro([jobs, &acc]() {
+            while (true) {
+                auto [v, err] = jobs->receive();
+                if (err) break;
+                acc += spin_work((uint64_t)v, ITERS);
+            }
+        });
+    }
+
+    auto start = chrono::steady_clock::now();
+    scheduler_start(workers);
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    printf("  fan-out    workers=%d: %d jobs in %.3f s, %.0f jobs/s\n",
+           workers, JOBS, secs, JOBS / secs);
+    delete jobs;
+}
+
+static void bench_scheduler() {
+    printf("\n[bench_scheduler]\n");
+    int hw = (int)thread::hardware_concurrency();
+    int n  = hw < 2 ? 2 : (hw > 4 ? 4 : hw);
+    bench_ping_pong(1);
+    bench_ping_pong(1, true);
+    bench_ping_pong(n);
+    bench_fan_out(1);
+    bench_fan_out(n);
+}
+
+// ── bench: timer jitter ──────────────────────────────────────────────────────
+// Periodic coroutines pace themselves with sleep_until(next += period) and
+// record how late each wakeup lands. With load, extra coroutines burn CPU in
+// ~50 µs slices between yields, so lateness includes waiting for a slice.
+
+static void bench_jitter(int workers, int periodUs, bool load) {
+    const int SLEEPERS = 4, WAKEUPS = 400, LOADERS = 2;
+    static vector<int64_t> lateNs[SLEEPERS];
+    atomic<int> running{SLEEPERS};
+
+    for (int s = 0; s < SLEEPERS; s++) {
+        lateNs[s].clear();
+        coro([s, periodUs, &running]() {
+            auto next = chrono::steady_clock::now();
+            for (int i = 0; i < WAKEUPS; i++) {
+                next += chrono::microseconds(periodUs);
+                sleep_until(next);
+                lateNs[s].push_back(chrono::duration_cast<chrono::nanoseconds>(
+                    chrono::steady_clock::now() - next).count());
+            }
+            running--;
+        });
+    }
+    if (load) {
+        for (int l = 0; l < LOADERS; l++) {
+            coro([&running]() {
+                uint64_t x = 1;
+                while (running.load() > 0) {
+                    auto end = chrono::steady_clock::now() + chrono::microseconds(50);
+                    while (chrono::steady_clock::now() < end) x = spin_work(x, 64);
+                    coro_yield();
+                }
+                if (x == 42) printf(" ");   // keep the work
+            });
+        }
+    }
+    scheduler_start(workers);
+
+    vector<int64_t> all;
+    for (auto& v : lateNs) all.insert(all.end(), v.begin(), v.end());
+    sort(all.begin(), all.end());
+    double sum = 0;
+    for (int64_t ns : all) sum += (double)ns;
+    printf("  jitter workers=%d period=%4d us %-6s: mean %6.1f us  p50 %6.1f us  p99 %6.1f us  max %7.1f us\n",
+           workers, periodUs, load ? "loaded" : "idle",
+           sum / all.size() / 1e3, all[all.size() / 2] / 1e3,
+           all[all.size() * 99 / 100] / 1e3, all.back() / 1e3);
+}
+
+static void bench_timer_jitter() {
+    printf("\n[bench_timer_jitter]\n");
+    for (int workers : {1, 4}) {
+        bench_jitter(workers, 250,  false);
+        bench_jitter(workers, 1000, false);
+        bench_jitter(workers, 250,  true);
+    }
+}
+
+// ── bench: fd wait ───────────────────────────────────────────────────────────
+// An OS thread writes one byte to a pipe and blocks until a coroutine echoes
+// it back on a second pipe — the shape of an evdev report waking its reader.
+
+static void bench_fd_round_trip(const char* mode, bool registered, bool inlineIo) {
+    const int ROUNDS = 20000;
+    int in[2], out[2];
+    assert(pipe(in) == 0 && pipe(out) == 0);
+    fcntl(in[0], F_SETFL, O_NONBLOCK);
+    scheduler_io_inline(inlineIo);
+
+    double secs = 0;
+    coro([&]() {
+        if (registered) register_fd(in[0], WAIT_IN);
+        thread client([&]() {
+            char c = 'p';
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < ROUNDS; i++) {
+                (void)!write(in[1], &c, 1);
+                (void)!read(out[0], &c, 1);
+            }
+            secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        });
+        for (int got = 0; got < ROUNDS;) {
+            wait_file(in[0], WAIT_IN);
+            char buf[64];
+            ssize_t n;
+            while ((n = read(in[0], buf, sizeof(buf))) > 0) {
+                got += (int)n;
+                (void)!write(out[1], buf, (size_t)n);
+            }
+        }
+        client.join();
+        if (registered) unregister_fd(in[0]);
+    });
+    scheduler_start();
+    scheduler_io_inline(false);
+    for (int fd : {in[0], in[1], out[0], out[1]}) close(fd);
+    printf("  fd round trip %-22s: %.1f us\n", mode, secs * 1e6 / ROUNDS);
+}
+
+static void bench_fd_wait() {
+    printf("\n[bench_fd_wait]\n");
+    bench_fd_round_trip("one-shot wait_file", false, false);
+    bench_fd_round_trip("register_fd",        true,  false);
+    bench_fd_round_trip("register_fd + inline", true, true);
+}
+
+// ── bench: completion I/O ────────────────────────────────────────────────────
+// PAIRS coroutine pairs ping-pong one byte over their own two pipes with
+// co_write/co_read. Reports the round-trip cost and, with io_uring, how many
+// io_uring_enter calls each round trip took — pairs share submissions.
+
+static void bench_co_io_pairs(bool uring, int pairs) {
+    const int ROUNDS = 20000 / pairs;
+    scheduler_io_uring(uring);
+    vector<int> fds;
+    for (int i = 0; i < pairs; i++) {
+        int a[2], b[2];
+        assert(pipe(a) == 0 && pipe(b) == 0);
+        fds.insert(fds.end(), {a[0], a[1], b[0], b[1]});
+        coro([=, a0 = a[0], b1 = b[1]]() {   // echo
+            char c;
+            for (int r = 0; r < ROUNDS; r++) {
+                co_read(a0, &c, 1);
+                co_write(b1, &c, 1);
+            }
+        });
+        coro([=, a1 = a[1], b0 = b[0]]() {
+            char c = 'x';
+            for (int r = 0; r < ROUNDS; r++) {
+                co_write(a1, &c, 1);
+                co_read(b0, &c, 1);
+            }
+        });
+    }
+    bool     active = false;
+    uint64_t enters = 0;
+    coro([&]() { active = co_uring_active(); enters = co_uring_enters(); });   // ring is open now
+    auto start = chrono::steady_clock::now();
+    scheduler_start();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    enters = co_uring_enters() - enters;   // the counter survives ring teardown
+    scheduler_io_uring(false);
+    for (int fd : fds) close(fd);
+
+    int total = ROUNDS * pairs;
+    if (uring && active)
+        printf("  co_io %-8s pairs=%2d: %.2f us/round trip, %.2f io_uring_enter/round trip\n",
+               "io_uring", pairs, secs * 1e6 / total, (double)enters / total);
+    else
+        printf("  co_io %-8s pairs=%2d: %.2f us/round trip\n",
+               uring ? "fallback" : "epoll", pairs, secs * 1e6 / total);
+}
+
+static void bench_co_io() {
+    printf("\n[bench_co_io]\n");
+    for (int pairs : {1, 16}) {
+        bench_co_io_pairs(false, pairs);
+        bench_co_io_pairs(true,  pairs);
+    }
+}
+
+// ── bench: coroutine spawn/exit ─────────────────────────────────────────────
+// The shape of a REST session, a turbo press or an RPC stream: a spawner
+// starts short-lived coroutines. single: one child at a time, run to exit
+// before the next spawn. burst: `burst` children alive at once, each yielding
+// once. Stacks come from the per-class pool after the first round.
+
+static void bench_spawn_rate(const char* label, size_t stackSize, int burst) {
+    const int SPAWNS = 200000;
+    int done = 0;
+    coro([&]() {
+        for (int i = 0; i < SPAWNS; i += burst) {
+            for (int b = 0; b < burst; b++)
+                coro([&done]() { coro_yield(); done++; }, stackSize);
+            while (done < i + burst) coro_yield();
+        }
+    });
+    StackPoolStats before = stack_pool_stats();
+    auto start = chrono::steady_clock::now();
+    scheduler_start();
+    double secs = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    StackPoolStats after = stack_pool_stats();
+    printf("  spawn %-6s stack=%4zuK burst=%3d: %.0f ns/spawn, %.2f M spawns/s (pool hits %llu, misses %llu)\n",
+           label, stackSize / 1024, burst, secs * 1e9 / SPAWNS, SPAWNS / secs / 1e6,
+           (unsigned long long)(after.hits - before.hits),
+           (unsigned long long)(after.misses - before.misses));
+}
+
+static void bench_spawn() {
+    printf("\n[bench_spawn]\n");
+    bench_spawn_rate("single", 0,          1);
+    bench_spawn_rate("burst",  0,          64);
+    bench_spawn_rate("single", 32 * 1024,  1);
+    bench_spawn_rate("burst",  256 * 1024, 16);
+}
+
 // ── main ─────────────────────────────────────────────────────────────────────
 
 int main() {
@@ -284,6 +1001,17 @@ int main() {
     test_channel();
     //test_external_thread();
     //test_wait_file();
+    test_sleep_timers();
+    test_fd_registration();
+    test_co_io();
+    test_mt_scheduler();
+    test_stack_pool();
+    test_profiler();
+    bench_scheduler();
+    bench_timer_jitter();
+    bench_fd_wait();
+    bench_co_io();
+    bench_spawn();
 
     printf("\n──────────────────────────────\n");
     printf("Results: %d passed, %d failed\n", passed, failed);
@@ -10,7 +10,23 @@
 enum Pico2MainMethod : uint16_t {
     P2M_PING        = 1, /* args: int32 val                                   | returns: int32 val */
     P2M_DEBUG_PRINT = 2, /* args: string message                              | returns: void */
-    P2M_ON_BOOT     = 3, /* args: string picoId, uint32 configCrc32           | returns: bool success */
+    P2M_ON_BOOT     = 3, /* args: string picoId, uint32 configCrc32, int32 wireCaps | returns: bool success
+                            wireCaps is a WireCap bitmask; older firmware omits it (reads as 0). */
+    P2M_LATENCY_REPORT = 4, /* args: varuint count, int32 baseUs, count × (varuint tag,
+                               varuint appliedUs - baseUs, varuint reportUs - appliedUs + 1)
+                               returns: void
+                               Stamps for earlier M2P_LATENCY_MARKs, in Pico time_us_32().
+                               The last field is 0 when no USB report followed the batch.
+                               Sent periodically; see shared/LatencyProbe.h. */
+};
+
+// ── Wire capabilities ────────────────────────────────────────────────────
+// Optional encodings the Pico advertises in P2M_ON_BOOT. Main only uses an
+// encoding when the matching bit was set by that Pico.
+
+enum WireCap : int32_t {
+    WIRE_CAP_PACKED_AXIS   = 0x01, // understands M2P_SET_AXIS_PACKED
+    WIRE_CAP_LATENCY_PROBE = 0x02, // understands M2P_CLOCK_PROBE / M2P_LATENCY_MARK, sends P2M_LATENCY_REPORT
 };
 
 // ── Main2Pico method IDs ─────────────────────────────────────────────────
@@ -32,4 +48,20 @@ enum Main2PicoMethod : uint16_t {
                                   On failure: Pico replies {false, reason}, no reboot. */
     M2P_SET_USB_CONNECTED = 10, /* args: bool connected | returns: void
                                    false = tud_disconnect(); true = tud_connect() */
+    M2P_SET_AXIS_BATCH    = 11, /* args: int32 count, count × (int32 device, int32 axis, int32 value)
+                                   returns: void
+                                   Pico applies the whole batch before its next deviceManager->update(). */
+    M2P_SET_AXIS_PACKED   = 12, /* args: varuint count, count × axisUpdate | returns: void
+                                   axisUpdate = RpcArg::putAxisUpdate record (2-4 bytes typical).
+                                   Only sent when the Pico advertised WIRE_CAP_PACKED_AXIS.
+                                   Same apply-before-update guarantee as M2P_SET_AXIS_BATCH. */
+    M2P_CLOCK_PROBE       = 13, /* args: void | returns: int32 receivedUs, int32 repliedUs
+                                   Pico time_us_32() when the handler ran and when it replied.
+                                   Main estimates the clock offset from the round trip (NTP style).
+                                   Only sent when the Pico advertised WIRE_CAP_LATENCY_PROBE. */
+    M2P_LATENCY_MARK      = 14, /* args: varuint tag, varint device | returns: void
+                                   Sent right after a traced axis batch. The Pico stamps when it
+                                   ran (batch applied) and when `device` next queued a USB report,
+                                   and returns both in a later P2M_LATENCY_REPORT.
+                                   Only sent when the Pico advertised WIRE_CAP_LATENCY_PROBE. */
 };